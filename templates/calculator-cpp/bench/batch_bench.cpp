@@ -0,0 +1,86 @@
+/**
+ * @file batch_bench.cpp
+ * @brief End-to-end throughput of BatchProcessor on binary and CSV operand files
+ *
+ * Usage: batch_bench [megabytes] [directory]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "batch_processor.h"
+#include "bench_common.h"
+
+namespace {
+
+constexpr int kRepetitions = 3;
+
+void writeOperands(const std::string& path, std::size_t rows, bool csv) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "Error: Could not create " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::mt19937_64 rng(11);
+    std::uniform_real_distribution<double> value(-1000.0, 1000.0);
+    std::vector<double> row(2);
+    for (std::size_t i = 0; i < rows; ++i) {
+        row[0] = value(rng);
+        row[1] = value(rng);
+        if (csv) {
+            std::fprintf(file, "%.17g,%.17g\n", row[0], row[1]);
+        } else {
+            std::fwrite(row.data(), sizeof(double), row.size(), file);
+        }
+    }
+    std::fclose(file);
+}
+
+void run(const std::string& label, const BatchOptions& options) {
+    BatchProcessor processor(options);
+    BatchStats stats;
+    const double seconds = bench::bestOf(kRepetitions, [&] { stats = processor.run(); });
+    std::cout << std::left << std::setw(40) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << static_cast<double>(stats.bytesRead) / 1e9 / seconds << " GB/s"
+              << std::setw(12) << std::setprecision(1) << static_cast<double>(stats.rows) / 1e6 / seconds
+              << " M rows/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+    const std::string directory = argc > 2 ? argv[2] : "/tmp";
+    const std::size_t rows = megabytes * (1 << 20) / (2 * sizeof(double));
+    const std::string binaryPath = directory + "/calculator_batch_bench.bin";
+    const std::string csvPath = directory + "/calculator_batch_bench.csv";
+    const std::string outputPath = directory + "/calculator_batch_bench.out";
+
+    std::cout << "=== Batch benchmark (" << rows << " rows, " << megabytes << " MB binary) ===" << std::endl;
+    writeOperands(binaryPath, rows, false);
+    writeOperands(csvPath, rows / 8, true);
+
+    BatchOptions options;
+    options.inputPath = binaryPath;
+    options.outputPath = outputPath;
+    options.formula = "add";
+    run("binary -> binary, add", options);
+    options.formula = "divide";
+    run("binary -> binary, divide", options);
+    options.formula = "(a + 2) * b - a / 3";
+    run("binary -> binary, expression", options);
+
+    options.inputPath = csvPath;
+    options.inputFormat = BatchFormat::Csv;
+    options.outputFormat = BatchFormat::Csv;
+    options.formula = "add";
+    run("csv -> csv, add", options);
+
+    std::remove(binaryPath.c_str());
+    std::remove(csvPath.c_str());
+    std::remove(outputPath.c_str());
+    return EXIT_SUCCESS;
+}
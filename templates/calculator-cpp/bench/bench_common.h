@@ -0,0 +1,63 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/**
+ * @brief Minimal timing helpers shared by the standalone benchmarks
+ */
+namespace bench {
+
+/**
+ * @brief Keep the compiler from optimizing away a computed value
+ * @param value Value that must be materialized
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * @brief Run a function repeatedly and return the best wall time in seconds
+ * @param repetitions Number of timed runs
+ * @param fn Function to time
+ * @return Fastest run in seconds
+ */
+template <typename Fn>
+double bestOf(int repetitions, Fn&& fn) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+}
+
+/**
+ * @brief Print one result row: label, throughput and time per item
+ * @param label Benchmark name
+ * @param items Items processed per run
+ * @param seconds Time of one run
+ */
+inline void report(const std::string& label, std::size_t items, double seconds) {
+    const double rate = static_cast<double>(items) / seconds;
+    std::cout << std::left << std::setw(40) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << rate / 1e6 << " M items/s" << std::setprecision(2) << std::setw(10)
+              << seconds * 1e9 / static_cast<double>(items) << " ns/item" << std::endl;
+}
+
+} // namespace bench
+
+#endif // BENCH_COMMON_H
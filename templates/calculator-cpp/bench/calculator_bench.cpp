@@ -0,0 +1,301 @@
+/**
+ * @file calculator_bench.cpp
+ * @brief Google Benchmark suite for calculator_lib
+ *
+ * Measures every operation as
+ * - latency: a dependent chain, one operation waiting for the previous one
+ * - throughput: a tight loop over independent operands
+ * for the out-of-line Calculator API, the inlined BasicCalculator<double>
+ * and the SIMD batch API, plus the cost of the divide-by-zero paths, the
+ * reductions and the Decimal backend compared with double.
+ *
+ * JSON for regression tracking: cmake --build build --target calculator_bench_json
+ */
+
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+#include <vector>
+#include "basic_calculator.h"
+#include "calculator.h"
+#include "decimal.h"
+#include "expression.h"
+
+namespace {
+
+constexpr std::size_t kLoopSize = 4096;
+
+// Operand chosen so dependent chains neither overflow nor go denormal.
+constexpr double kStep = 1.0000001;
+
+struct OutOfLineAdd {
+    static double apply(double a, double b) { return Calculator::add(a, b); }
+};
+struct OutOfLineSubtract {
+    static double apply(double a, double b) { return Calculator::subtract(a, b); }
+};
+struct OutOfLineMultiply {
+    static double apply(double a, double b) { return Calculator::multiply(a, b); }
+};
+struct OutOfLineDivide {
+    static double apply(double a, double b) { return Calculator::divide(a, b); }
+};
+
+struct InlineAdd {
+    static double apply(double a, double b) { return BasicCalculator<double>::add(a, b); }
+};
+struct InlineSubtract {
+    static double apply(double a, double b) { return BasicCalculator<double>::subtract(a, b); }
+};
+struct InlineMultiply {
+    static double apply(double a, double b) { return BasicCalculator<double>::multiply(a, b); }
+};
+struct InlineDivide {
+    static double apply(double a, double b) { return BasicCalculator<double>::divide(a, b); }
+};
+
+std::vector<double> makeOperands(double base) {
+    std::vector<double> values(kLoopSize);
+    for (std::size_t i = 0; i < kLoopSize; ++i) {
+        values[i] = base + static_cast<double>(i % 17);
+    }
+    return values;
+}
+
+template <typename Op>
+void BM_Latency(benchmark::State& state) {
+    double x = 1.0;
+    for (auto _ : state) {
+        x = Op::apply(x, kStep);
+        benchmark::DoNotOptimize(x);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Op>
+void BM_Throughput(benchmark::State& state) {
+    const std::vector<double> a = makeOperands(10.0);
+    const std::vector<double> b = makeOperands(1.5);
+    std::vector<double> out(kLoopSize);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < kLoopSize; ++i) {
+            out[i] = Op::apply(a[i], b[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kLoopSize));
+}
+
+void BM_BatchAdd(benchmark::State& state) {
+    Calculator::setSimdLevel(static_cast<Calculator::SimdLevel>(state.range(0)));
+    state.SetLabel(Calculator::simdLevelName(Calculator::simdLevel()));
+    const std::vector<double> a = makeOperands(10.0);
+    const std::vector<double> b = makeOperands(1.5);
+    std::vector<double> out(kLoopSize);
+    for (auto _ : state) {
+        Calculator::add(a, b, out);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kLoopSize));
+    Calculator::setSimdLevel(Calculator::detectedSimdLevel());
+}
+
+void BM_BatchDivide(benchmark::State& state) {
+    Calculator::setSimdLevel(static_cast<Calculator::SimdLevel>(state.range(0)));
+    state.SetLabel(Calculator::simdLevelName(Calculator::simdLevel()));
+    const std::vector<double> a = makeOperands(10.0);
+    const std::vector<double> b = makeOperands(1.5);
+    std::vector<double> out(kLoopSize);
+    std::vector<std::uint64_t> mask(Calculator::zeroMaskWords(kLoopSize));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Calculator::divide(a, b, out, mask));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kLoopSize));
+    Calculator::setSimdLevel(Calculator::detectedSimdLevel());
+}
+
+// The loop the reductions replace: one out-of-line call per element.
+void BM_SumLoop(benchmark::State& state) {
+    const std::vector<double> values = makeOperands(0.5);
+    for (auto _ : state) {
+        double total = 0.0;
+        for (double value : values) {
+            total = Calculator::add(total, value);
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kLoopSize));
+}
+
+template <typename Reduce>
+void runReduction(benchmark::State& state, Reduce reduce) {
+    Calculator::setSimdLevel(static_cast<Calculator::SimdLevel>(state.range(0)));
+    state.SetLabel(Calculator::simdLevelName(Calculator::simdLevel()));
+    const std::vector<double> a = makeOperands(0.5);
+    const std::vector<double> b = makeOperands(1.5);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(reduce(a, b));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kLoopSize));
+    Calculator::setSimdLevel(Calculator::detectedSimdLevel());
+}
+
+void BM_Sum(benchmark::State& state) {
+    runReduction(state, [](const auto& a, const auto&) { return Calculator::sum(a); });
+}
+
+void BM_Dot(benchmark::State& state) {
+    runReduction(state, [](const auto& a, const auto& b) { return Calculator::dot(a, b); });
+}
+
+void BM_Variance(benchmark::State& state) {
+    runReduction(state, [](const auto& a, const auto&) { return Calculator::variance(a); });
+}
+
+void BM_MinMax(benchmark::State& state) {
+    runReduction(state, [](const auto& a, const auto&) { return Calculator::minMax(a).max; });
+}
+
+// Cost of one zero-divisor division with each way of reporting it.
+void BM_DivideByZero_Throw(benchmark::State& state) {
+    double divisor = 0.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(divisor);
+        try {
+            benchmark::DoNotOptimize(Calculator::divide(1.0, divisor));
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DivideByZero_Status(benchmark::State& state) {
+    double divisor = 0.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(divisor);
+        benchmark::DoNotOptimize(Calculator::divide<StatusPolicy>(1.0, divisor).value_or(0.0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DivideByZero_Ieee(benchmark::State& state) {
+    double divisor = 0.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(divisor);
+        benchmark::DoNotOptimize(Calculator::divide<IeeePolicy>(1.0, divisor));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Decimal operations write into reused results, the way batch evaluation does.
+struct DecimalAdd {
+    static void apply(const Decimal& a, const Decimal& b, Decimal& out) { Decimal::add(a, b, out); }
+};
+struct DecimalSubtract {
+    static void apply(const Decimal& a, const Decimal& b, Decimal& out) { Decimal::subtract(a, b, out); }
+};
+struct DecimalMultiply {
+    static void apply(const Decimal& a, const Decimal& b, Decimal& out) { Decimal::multiply(a, b, out); }
+};
+struct DecimalDivide {
+    static void apply(const Decimal& a, const Decimal& b, Decimal& out) { Decimal::divide(a, b, out); }
+};
+
+std::vector<Decimal> makeDecimalOperands(double base) {
+    std::vector<Decimal> values;
+    values.reserve(kLoopSize);
+    for (double value : makeOperands(base)) {
+        values.push_back(Decimal::fromDouble(value + 0.25));
+    }
+    return values;
+}
+
+template <typename Op>
+void BM_DecimalThroughput(benchmark::State& state) {
+    const std::vector<Decimal> a = makeDecimalOperands(10.0);
+    const std::vector<Decimal> b = makeDecimalOperands(1.5);
+    std::vector<Decimal> out(kLoopSize);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < kLoopSize; ++i) {
+            Op::apply(a[i], b[i], out[i]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kLoopSize));
+}
+
+constexpr const char* kFormula = "(a + 2) * b - a / (b + 3)";
+
+void BM_ExpressionDouble(benchmark::State& state) {
+    const Expression expression = Expression::compile(kFormula);
+    const std::vector<double> a = makeOperands(10.25);
+    const std::vector<double> b = makeOperands(1.75);
+    const std::vector<std::span<const double>> columns = {a, b};
+    std::vector<double> out(kLoopSize);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(expression.evaluate(columns, out));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kLoopSize));
+}
+
+void BM_ExpressionDecimal(benchmark::State& state) {
+    const Expression expression = Expression::compile(kFormula);
+    const std::vector<Decimal> a = makeDecimalOperands(10.0);
+    const std::vector<Decimal> b = makeDecimalOperands(1.5);
+    const std::vector<std::span<const Decimal>> columns = {a, b};
+    std::vector<Decimal> out(kLoopSize);
+    DecimalArena arena;
+    for (auto _ : state) {
+        expression.evaluate(columns, out, arena);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kLoopSize));
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Latency, OutOfLineAdd);
+BENCHMARK_TEMPLATE(BM_Latency, OutOfLineSubtract);
+BENCHMARK_TEMPLATE(BM_Latency, OutOfLineMultiply);
+BENCHMARK_TEMPLATE(BM_Latency, OutOfLineDivide);
+BENCHMARK_TEMPLATE(BM_Latency, InlineAdd);
+BENCHMARK_TEMPLATE(BM_Latency, InlineSubtract);
+BENCHMARK_TEMPLATE(BM_Latency, InlineMultiply);
+BENCHMARK_TEMPLATE(BM_Latency, InlineDivide);
+
+BENCHMARK_TEMPLATE(BM_Throughput, OutOfLineAdd);
+BENCHMARK_TEMPLATE(BM_Throughput, OutOfLineSubtract);
+BENCHMARK_TEMPLATE(BM_Throughput, OutOfLineMultiply);
+BENCHMARK_TEMPLATE(BM_Throughput, OutOfLineDivide);
+BENCHMARK_TEMPLATE(BM_Throughput, InlineAdd);
+BENCHMARK_TEMPLATE(BM_Throughput, InlineSubtract);
+BENCHMARK_TEMPLATE(BM_Throughput, InlineMultiply);
+BENCHMARK_TEMPLATE(BM_Throughput, InlineDivide);
+
+BENCHMARK(BM_BatchAdd)->DenseRange(0, 2);
+BENCHMARK(BM_BatchDivide)->DenseRange(0, 2);
+
+BENCHMARK(BM_SumLoop);
+BENCHMARK(BM_Sum)->DenseRange(0, 2);
+BENCHMARK(BM_Dot)->DenseRange(0, 2);
+BENCHMARK(BM_Variance)->DenseRange(0, 2);
+BENCHMARK(BM_MinMax)->DenseRange(0, 2);
+
+BENCHMARK(BM_DivideByZero_Throw);
+BENCHMARK(BM_DivideByZero_Status);
+BENCHMARK(BM_DivideByZero_Ieee);
+
+BENCHMARK_TEMPLATE(BM_DecimalThroughput, DecimalAdd);
+BENCHMARK_TEMPLATE(BM_DecimalThroughput, DecimalSubtract);
+BENCHMARK_TEMPLATE(BM_DecimalThroughput, DecimalMultiply);
+BENCHMARK_TEMPLATE(BM_DecimalThroughput, DecimalDivide);
+
+BENCHMARK(BM_ExpressionDouble);
+BENCHMARK(BM_ExpressionDecimal);
+
+BENCHMARK_MAIN();
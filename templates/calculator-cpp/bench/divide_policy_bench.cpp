@@ -0,0 +1,91 @@
+/**
+ * @file divide_policy_bench.cpp
+ * @brief Throughput of Calculator::divide<Policy> with 0%, 1% and 10% zero divisors
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "bench_common.h"
+#include "calculator.h"
+
+namespace {
+
+constexpr std::size_t kRows = 1 << 20;
+constexpr int kRepetitions = 5;
+
+std::vector<double> makeDivisors(double zeroFraction) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> value(0.5, 100.0);
+    std::bernoulli_distribution isZero(zeroFraction);
+    std::vector<double> divisors(kRows);
+    for (auto& d : divisors) {
+        d = isZero(rng) ? 0.0 : value(rng);
+    }
+    return divisors;
+}
+
+// The throwing API is the only one that needs a try block per row.
+double runThrow(const std::vector<double>& a, const std::vector<double>& b) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        try {
+            sum += Calculator::divide(a[i], b[i]);
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    return sum;
+}
+
+double runStatus(const std::vector<double>& a, const std::vector<double>& b) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        sum += Calculator::divide<StatusPolicy>(a[i], b[i]).value_or(0.0);
+    }
+    return sum;
+}
+
+double runIeee(const std::vector<double>& a, const std::vector<double>& b) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        const double q = Calculator::divide<IeeePolicy>(a[i], b[i]);
+        sum += b[i] != 0.0 ? q : 0.0;
+    }
+    return sum;
+}
+
+double runStickyFlag(const std::vector<double>& a, const std::vector<double>& b) {
+    StickyFlagPolicy::clear();
+    double sum = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        const double q = Calculator::divide<StickyFlagPolicy>(a[i], b[i]);
+        sum += b[i] != 0.0 ? q : 0.0;
+    }
+    return StickyFlagPolicy::raised() ? -sum : sum;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== Calculator::divide policy benchmark (" << kRows << " rows) ===" << std::endl;
+
+    const std::vector<double> dividends(kRows, 12345.678);
+    for (double zeroFraction : {0.0, 0.01, 0.10}) {
+        const std::vector<double> divisors = makeDivisors(zeroFraction);
+        const std::string suffix = " (" + std::to_string(static_cast<int>(zeroFraction * 100)) + "% zero)";
+
+        double sink = 0.0;
+        bench::report("ThrowPolicy" + suffix, kRows,
+                      bench::bestOf(kRepetitions, [&] { sink += runThrow(dividends, divisors); }));
+        bench::report("StatusPolicy" + suffix, kRows,
+                      bench::bestOf(kRepetitions, [&] { sink += runStatus(dividends, divisors); }));
+        bench::report("IeeePolicy" + suffix, kRows,
+                      bench::bestOf(kRepetitions, [&] { sink += runIeee(dividends, divisors); }));
+        bench::report("StickyFlagPolicy" + suffix, kRows,
+                      bench::bestOf(kRepetitions, [&] { sink += runStickyFlag(dividends, divisors); }));
+        bench::doNotOptimize(sink);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file expression_bench.cpp
+ * @brief Compiled bytecode evaluation versus naive tree-walking evaluation
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "bench_common.h"
+#include "calculator.h"
+#include "expression.h"
+#include "expression_cache.h"
+#include "expression_parser.h"
+
+namespace {
+
+constexpr std::size_t kRows = 1 << 20;
+constexpr int kRepetitions = 5;
+constexpr std::size_t kDistinctFormulas = 300;
+constexpr const char* kFormula = "(a + 2 * 3) * b - c / (4 - 2) + a * 0.5 - (b - 1) / c";
+
+// Reference: walk the unfolded parse tree once per row.
+double walk(const ExpressionNode& node, const double* values) {
+    switch (node.kind) {
+    case ExpressionNode::Kind::Number:
+        return node.value;
+    case ExpressionNode::Kind::Variable:
+        return values[node.variable];
+    case ExpressionNode::Kind::Negate:
+        return -walk(*node.lhs, values);
+    case ExpressionNode::Kind::Add:
+        return Calculator::add(walk(*node.lhs, values), walk(*node.rhs, values));
+    case ExpressionNode::Kind::Subtract:
+        return Calculator::subtract(walk(*node.lhs, values), walk(*node.rhs, values));
+    case ExpressionNode::Kind::Multiply:
+        return Calculator::multiply(walk(*node.lhs, values), walk(*node.rhs, values));
+    case ExpressionNode::Kind::Divide:
+        return Calculator::divide(walk(*node.lhs, values), walk(*node.rhs, values));
+    }
+    return 0.0;
+}
+
+} // namespace
+
+int main() {
+    const ParsedExpression tree = parseExpression(kFormula);
+    const Expression compiled = Expression::compile(kFormula);
+
+    std::cout << "=== Expression benchmark (" << kRows << " rows) ===" << std::endl;
+    std::cout << "Formula: " << kFormula << std::endl;
+    std::cout << "Bytecode (" << compiled.code().size() << " instructions, " << compiled.registerCount()
+              << " registers):\n" << compiled.disassemble() << std::endl;
+
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> value(1.0, 100.0);
+    const std::size_t vars = compiled.variables().size();
+    std::vector<std::vector<double>> columns(vars, std::vector<double>(kRows));
+    std::vector<double> rowMajor(kRows * vars);
+    for (std::size_t v = 0; v < vars; ++v) {
+        for (std::size_t i = 0; i < kRows; ++i) {
+            columns[v][i] = value(rng);
+            rowMajor[i * vars + v] = columns[v][i];
+        }
+    }
+    std::vector<std::span<const double>> columnSpans(columns.begin(), columns.end());
+    std::vector<double> out(kRows);
+
+    double sink = 0.0;
+    bench::report("tree walk (per row)", kRows, bench::bestOf(kRepetitions, [&] {
+        for (std::size_t i = 0; i < kRows; ++i) {
+            out[i] = walk(*tree.root, &rowMajor[i * vars]);
+        }
+        sink += out[kRows / 2];
+    }));
+    bench::report("bytecode (per row)", kRows, bench::bestOf(kRepetitions, [&] {
+        for (std::size_t i = 0; i < kRows; ++i) {
+            out[i] = compiled.evaluate(std::span<const double>(&rowMajor[i * vars], vars));
+        }
+        sink += out[kRows / 2];
+    }));
+    bench::report(std::string("bytecode (columns, ") + Calculator::simdLevelName(Calculator::simdLevel()) + ")",
+                  kRows, bench::bestOf(kRepetitions, [&] {
+        compiled.evaluate(columnSpans, out);
+        sink += out[kRows / 2];
+    }));
+
+    // Steady state of a formula-string workload: a few hundred distinct
+    // formulas, submitted over and over with varying whitespace.
+    ExpressionCache cache(1024);
+    std::vector<std::string> requests;
+    for (std::size_t i = 0; i < kDistinctFormulas; ++i) {
+        requests.push_back("a * " + std::to_string(i) + " + b / c");
+        requests.push_back("a*" + std::to_string(i) + ".0+b/c");
+    }
+    for (const auto& request : requests) {
+        cache.get(request);
+    }
+    bench::report("cache lookup (normalize + hit)", requests.size() * 100, bench::bestOf(kRepetitions, [&] {
+        for (int round = 0; round < 100; ++round) {
+            for (const auto& request : requests) {
+                sink += static_cast<double>(cache.get(request)->registerCount());
+            }
+        }
+    }));
+    bench::report("compile (no cache)", requests.size(), bench::bestOf(kRepetitions, [&] {
+        for (const auto& request : requests) {
+            sink += static_cast<double>(Expression::compile(request).registerCount());
+        }
+    }));
+    const ExpressionCache::Stats stats = cache.stats();
+    std::cout << "Cache: " << stats.size << " entries, " << stats.hits << " hits, " << stats.misses << " misses, "
+              << stats.evictions << " evictions" << std::endl;
+    bench::doNotOptimize(sink);
+    return EXIT_SUCCESS;
+}
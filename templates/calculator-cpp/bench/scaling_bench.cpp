@@ -0,0 +1,73 @@
+/**
+ * @file scaling_bench.cpp
+ * @brief Strong scaling of ParallelExecutor from 1 to N worker threads
+ *
+ * Usage: scaling_bench [rows] [max_workers]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "bench_common.h"
+#include "expression.h"
+#include "parallel_executor.h"
+
+namespace {
+
+constexpr int kRepetitions = 3;
+constexpr const char* kFormula = "(a + 2) * b - a / (b + 3)";
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (std::size_t{1} << 24);
+    const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t maxWorkers = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : hardware;
+
+    const Expression expression = Expression::compile(kFormula);
+    std::vector<double> a(rows);
+    std::vector<double> b(rows);
+    std::vector<double> out(rows);
+    std::vector<std::span<const double>> columns = {a, b};
+
+    std::cout << "=== Scaling benchmark (" << rows << " rows, " << hardware << " hardware threads) ===" << std::endl;
+    std::cout << "Formula: " << kFormula << std::endl;
+
+    double baseline = 0.0;
+    for (std::size_t workers = 1; workers <= maxWorkers; workers *= 2) {
+        ParallelExecutor executor(workers, true);
+
+        // First touch through the executor places pages near the workers
+        // that will read them.
+        executor.parallelFor(rows, 0, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                a[i] = static_cast<double>(i % 1000) + 0.5;
+                b[i] = static_cast<double>(i % 97) + 1.0;
+                out[i] = 0.0;
+            }
+        });
+        executor.resetStats();
+
+        const double seconds = bench::bestOf(kRepetitions, [&] { executor.evaluate(expression, columns, out); });
+        if (workers == 1) {
+            baseline = seconds;
+        }
+        bench::report(std::to_string(workers) + " worker(s), speedup " +
+                          std::to_string(baseline / seconds).substr(0, 4) + "x",
+                      rows, seconds);
+
+        const auto stats = executor.stats();
+        for (std::size_t w = 0; w < stats.size(); ++w) {
+            std::cout << "    worker " << w << ": " << stats[w].chunks << " chunks, " << stats[w].steals
+                      << " steals, " << std::setprecision(1) << stats[w].rowsPerSecond() / 1e6 << " M rows/s"
+                      << std::endl;
+        }
+        bench::doNotOptimize(out[rows / 2]);
+
+        if (workers < maxWorkers && workers * 2 > maxWorkers) {
+            workers = maxWorkers / 2;  // always finish with maxWorkers
+        }
+    }
+    return EXIT_SUCCESS;
+}
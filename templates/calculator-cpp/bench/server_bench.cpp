@@ -0,0 +1,152 @@
+/**
+ * @file server_bench.cpp
+ * @brief Load generator for CalculatorServer: throughput and latency percentiles
+ *
+ * Every client connection keeps a fixed number of requests in flight (the
+ * pipeline depth) and records the round-trip time of each one. Without a
+ * socket argument the server runs in-process on a temporary socket; pass the
+ * socket of a running `CalculatorProject --serve` to measure that instead.
+ *
+ * Usage: server_bench [requests_per_client] [clients] [socket]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "calculator_client.h"
+#include "calculator_server.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const char* kFormula = "a * b + a / 2";
+
+/**
+ * @brief Run one client; returns the latency of every request in nanoseconds
+ */
+std::vector<std::uint32_t> runClient(const std::string& socketPath, std::size_t requests, std::size_t depth,
+                                     unsigned seed) {
+    CalculatorClient client(socketPath);
+    std::vector<std::uint32_t> latencies;
+    latencies.reserve(requests);
+    std::vector<Clock::time_point> sentAt(depth);
+
+    std::size_t sent = 0;
+    const auto sendNext = [&] {
+        const double a = static_cast<double>((seed + sent) % 1000) + 0.5;
+        const double b = static_cast<double>(sent % 7) + 1.0;
+        std::uint32_t id = 0;
+        switch (sent % 4) {
+        case 0:
+            id = client.send(ServerOp::Add, a, b);
+            break;
+        case 1:
+            id = client.send(ServerOp::Multiply, a, b);
+            break;
+        case 2:
+            id = client.send(ServerOp::Divide, a, b);
+            break;
+        default: {
+            const double values[2] = {a, b};
+            id = client.send(ServerOp::Evaluate, values, kFormula);
+            break;
+        }
+        }
+        // Ids are consecutive and at most depth requests are in flight.
+        sentAt[id % depth] = Clock::now();
+        ++sent;
+    };
+
+    while (sent < std::min(depth, requests)) {
+        sendNext();
+    }
+    for (std::size_t received = 0; received < requests; ++received) {
+        const ServerResponse response = client.receive();
+        const auto elapsed = Clock::now() - sentAt[response.id % depth];
+        latencies.push_back(static_cast<std::uint32_t>(
+            std::min<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), UINT32_MAX)));
+        if (response.status != ServerStatus::Ok) {
+            std::cerr << "Error: " << response.error << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        if (sent < requests) {
+            sendNext();
+        }
+    }
+    return latencies;
+}
+
+double percentile(std::vector<std::uint32_t>& sorted, double fraction) {
+    const std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(fraction * static_cast<double>(sorted.size())));
+    return static_cast<double>(sorted[index]) / 1e3;
+}
+
+void run(const std::string& socketPath, std::size_t clients, std::size_t depth, std::size_t requests) {
+    std::vector<std::vector<std::uint32_t>> latencies(clients);
+    std::vector<std::thread> threads;
+    const auto start = Clock::now();
+    for (std::size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            latencies[c] = runClient(socketPath, requests, depth, static_cast<unsigned>(c * 7919));
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<std::uint32_t> all;
+    for (const std::vector<std::uint32_t>& client : latencies) {
+        all.insert(all.end(), client.begin(), client.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    const std::string label = std::to_string(clients) + " clients, depth " + std::to_string(depth);
+    std::cout << std::left << std::setw(28) << label << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << static_cast<double>(all.size()) / seconds << " req/s" << std::setprecision(1)
+              << "  p50 " << std::setw(8) << percentile(all, 0.50) << " us"
+              << "  p99 " << std::setw(8) << percentile(all, 0.99) << " us"
+              << "  p999 " << std::setw(8) << percentile(all, 0.999) << " us" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t requests = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const std::size_t clients = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+
+    std::unique_ptr<CalculatorServer> server;
+    std::thread serverThread;
+    std::string socketPath;
+    if (argc > 3) {
+        socketPath = argv[3];
+    } else {
+        socketPath = "/tmp/calculator_server_bench." + std::to_string(::getpid()) + ".sock";
+        server = std::make_unique<CalculatorServer>(ServerOptions{socketPath, 0});
+        serverThread = std::thread([&] { server->run(); });
+    }
+
+    std::cout << "=== Server benchmark (" << requests << " requests per client, " << socketPath << ") ===" << std::endl;
+    for (std::size_t depth : {1, 8, 64}) {
+        run(socketPath, 1, depth, requests);
+        run(socketPath, clients, depth, requests);
+    }
+
+    if (server) {
+        server->stop();
+        serverThread.join();
+        const ServerStats stats = server->stats();
+        std::cout << "Server: " << stats.requests << " requests, " << std::setprecision(1)
+                  << stats.requestsPerBatch() << " requests per batch" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
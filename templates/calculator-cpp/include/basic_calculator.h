@@ -0,0 +1,192 @@
+#ifndef BASIC_CALCULATOR_H
+#define BASIC_CALCULATOR_H
+
+#include <limits>
+#include <type_traits>
+#include "fixed_point.h"
+
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+#include <stdexcept>
+#endif
+
+/**
+ * @brief Header-only calculator for any supported number type
+ *
+ * Unlike Calculator, which is fixed to double and compiled out-of-line, every
+ * operation here is constexpr and inlined into the caller. Supported types:
+ *
+ * - float and double: plain IEEE 754 arithmetic
+ * - integral types: saturating arithmetic (results clamp to the type's range)
+ * - FixedPoint (Q16_16, Q31, ...): saturating, round-to-nearest arithmetic
+ *   using only integer instructions
+ *
+ * Dividing by zero inside a constant expression is a compile-time error.
+ * At runtime it throws std::invalid_argument like Calculator::divide; when
+ * exceptions are disabled (e.g. -fno-exceptions on embedded targets) it
+ * saturates instead, or yields the IEEE 754 result for floating point.
+ *
+ * The header only requires C++17, so it can be used from the embedded
+ * templates as well.
+ *
+ * @tparam T Number type
+ */
+template <typename T>
+class BasicCalculator {
+    static_assert(std::is_floating_point_v<T> || std::is_integral_v<T> || kIsFixedPoint<T>,
+                  "BasicCalculator supports floating point, integral and FixedPoint types");
+    static_assert(!std::is_same_v<T, bool>, "BasicCalculator does not support bool");
+
+public:
+    using value_type = T;
+
+    /**
+     * @brief Add two numbers
+     * @param a First number
+     * @param b Second number
+     * @return Sum of a and b (saturated for integral and fixed-point types)
+     */
+    static constexpr T add(T a, T b) {
+        if constexpr (std::is_floating_point_v<T>) {
+            return a + b;
+        } else if constexpr (std::is_unsigned_v<T>) {
+            return a > std::numeric_limits<T>::max() - b ? std::numeric_limits<T>::max() : static_cast<T>(a + b);
+        } else if constexpr (std::is_integral_v<T>) {
+            if (b > 0 && a > std::numeric_limits<T>::max() - b) {
+                return std::numeric_limits<T>::max();
+            }
+            if (b < 0 && a < std::numeric_limits<T>::min() - b) {
+                return std::numeric_limits<T>::min();
+            }
+            return static_cast<T>(a + b);
+        } else {
+            return T::fromRaw(T::saturate(static_cast<typename T::Wide>(a.raw()) + b.raw()));
+        }
+    }
+
+    /**
+     * @brief Subtract two numbers
+     * @param a First number
+     * @param b Second number
+     * @return Difference of a and b (saturated for integral and fixed-point types)
+     */
+    static constexpr T subtract(T a, T b) {
+        if constexpr (std::is_floating_point_v<T>) {
+            return a - b;
+        } else if constexpr (std::is_unsigned_v<T>) {
+            return a < b ? T(0) : static_cast<T>(a - b);
+        } else if constexpr (std::is_integral_v<T>) {
+            if (b < 0 && a > std::numeric_limits<T>::max() + b) {
+                return std::numeric_limits<T>::max();
+            }
+            if (b > 0 && a < std::numeric_limits<T>::min() + b) {
+                return std::numeric_limits<T>::min();
+            }
+            return static_cast<T>(a - b);
+        } else {
+            return T::fromRaw(T::saturate(static_cast<typename T::Wide>(a.raw()) - b.raw()));
+        }
+    }
+
+    /**
+     * @brief Multiply two numbers
+     * @param a First number
+     * @param b Second number
+     * @return Product of a and b (saturated for integral and fixed-point types)
+     */
+    static constexpr T multiply(T a, T b) {
+        if constexpr (std::is_floating_point_v<T>) {
+            return a * b;
+        } else if constexpr (std::is_unsigned_v<T>) {
+            if (b != 0 && a > std::numeric_limits<T>::max() / b) {
+                return std::numeric_limits<T>::max();
+            }
+            return static_cast<T>(a * b);
+        } else if constexpr (std::is_integral_v<T>) {
+            if (a == 0 || b == 0) {
+                return 0;
+            }
+            // -1 is the one divisor for which the checks below would compute min / -1
+            if (a == -1 || b == -1) {
+                const T other = a == -1 ? b : a;
+                return other == std::numeric_limits<T>::min() ? std::numeric_limits<T>::max() : static_cast<T>(-other);
+            }
+            // Overflow checks by division work for every width, including 64-bit.
+            if ((a < 0) != (b < 0)) {
+                const bool overflows = a < 0 ? b > std::numeric_limits<T>::min() / a
+                                             : a > std::numeric_limits<T>::min() / b;
+                if (overflows) {
+                    return std::numeric_limits<T>::min();
+                }
+            } else {
+                const bool overflows = a > 0 ? a > std::numeric_limits<T>::max() / b
+                                             : a < std::numeric_limits<T>::max() / b;
+                if (overflows) {
+                    return std::numeric_limits<T>::max();
+                }
+            }
+            return static_cast<T>(a * b);
+        } else {
+            using Wide = typename T::Wide;
+            const Wide product = static_cast<Wide>(a.raw()) * b.raw();
+            const Wide half = Wide{1} << (T::kFracBits - 1);
+            return T::fromRaw(T::saturate((product + half) >> T::kFracBits));
+        }
+    }
+
+    /**
+     * @brief Divide two numbers
+     * @param a Dividend
+     * @param b Divisor
+     * @return Quotient of a and b (truncated for integral types, rounded and
+     *         saturated for fixed-point types)
+     * @throws std::invalid_argument if b is zero (compile-time error in a constant expression)
+     */
+    static constexpr T divide(T a, T b) {
+        if (b == T(0)) {
+            return divisionByZero(a);
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            return a / b;
+        } else if constexpr (std::is_integral_v<T>) {
+            if constexpr (std::is_signed_v<T>) {
+                if (a == std::numeric_limits<T>::min() && b == -1) {
+                    return std::numeric_limits<T>::max();
+                }
+            }
+            return static_cast<T>(a / b);
+        } else {
+            using Wide = typename T::Wide;
+            Wide numerator = static_cast<Wide>(a.raw()) * (Wide{1} << T::kFracBits);
+            // Round to nearest: bias the numerator by half the divisor.
+            const Wide halfDivisor = static_cast<Wide>(b.raw()) / 2;
+            numerator += (numerator < 0) != (b.raw() < 0) ? -halfDivisor : halfDivisor;
+            return T::fromRaw(T::saturate(numerator / b.raw()));
+        }
+    }
+
+private:
+    // Deliberately not constexpr: reaching it during constant evaluation makes
+    // the expression ill-formed, which turns a constant division by zero into
+    // a compile-time error mentioning this function.
+    static T divisionByZero(T a) {
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+        (void)a;
+        throw std::invalid_argument("Division by zero is not allowed");
+#else
+        if constexpr (std::is_floating_point_v<T>) {
+            return a / T(0);
+        } else if constexpr (std::is_integral_v<T>) {
+            if constexpr (std::is_signed_v<T>) {
+                if (a < 0) {
+                    return std::numeric_limits<T>::min();
+                }
+            }
+            return a == 0 ? T(0) : std::numeric_limits<T>::max();
+        } else {
+            return a == T(0) ? T(0) : (a < T(0) ? T::lowest() : T::max());
+        }
+#endif
+    }
+};
+
+#endif // BASIC_CALCULATOR_H
@@ -0,0 +1,93 @@
+#ifndef BATCH_PROCESSOR_H
+#define BATCH_PROCESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "expression.h"
+
+/**
+ * @brief Operand and result file format of a batch job
+ */
+enum class BatchFormat {
+    Binary,  ///< Native doubles, one row = one value per variable, no separators
+    Csv      ///< Comma-separated text, one row per line, optional header line
+};
+
+/**
+ * @brief Description of a batch job
+ */
+struct BatchOptions {
+    std::string formula;      ///< add, subtract, multiply, divide, or an expression
+    std::string inputPath;    ///< Operand file, "-" for stdin
+    std::string outputPath;   ///< Result file, "-" for stdout
+    BatchFormat inputFormat = BatchFormat::Binary;
+    BatchFormat outputFormat = BatchFormat::Binary;
+};
+
+/**
+ * @brief Counters of a finished batch job
+ */
+struct BatchStats {
+    std::uint64_t rows = 0;
+    std::uint64_t zeroDivisorRows = 0;  ///< Rows that divided by zero (IEEE result written)
+    std::uint64_t bytesRead = 0;
+    std::uint64_t bytesWritten = 0;
+    double seconds = 0.0;
+};
+
+/**
+ * @brief Evaluates a formula for every row of an operand file
+ *
+ * Regular files are memory-mapped and read sequentially; pipes, stdin and
+ * all input on Windows are read with read() instead. Rows are decoded into per-variable columns of
+ * kChunkRows rows, which stay in cache while the compiled expression runs
+ * over them, and the results are streamed to the output through a fixed
+ * buffer with write(). Memory use is therefore constant regardless of the
+ * input size, and no iostream formatting is involved.
+ *
+ * The formula is either one of the operation names (add, subtract, multiply,
+ * divide), applied to two operands a and b, or an expression. CSV files may
+ * start with a header line naming the columns; expression variables are then
+ * bound by name. Otherwise columns bind to variables in order of their first
+ * appearance in the formula.
+ */
+class BatchProcessor {
+public:
+    /// Rows decoded and evaluated per chunk
+    static constexpr std::size_t kChunkRows = 4096;
+
+    /**
+     * @brief Prepare a batch job
+     * @param options Job description
+     * @throws std::invalid_argument if the formula does not compile or uses no variables
+     */
+    explicit BatchProcessor(BatchOptions options);
+
+    /**
+     * @brief Run the job to completion
+     * @return Counters of the job
+     * @throws std::runtime_error on I/O errors or malformed input rows
+     */
+    BatchStats run();
+
+    /**
+     * @brief Expression text for an operation name
+     * @param formula Operation name or expression
+     * @return "a + b" for "add" etc., otherwise formula unchanged
+     */
+    static std::string expandOperation(const std::string& formula);
+
+    /**
+     * @brief Guess a file format from its extension
+     * @param path File path
+     * @return Csv for *.csv and *.txt, Binary otherwise
+     */
+    static BatchFormat formatForPath(const std::string& path);
+
+private:
+    BatchOptions options_;
+    Expression expression_;
+};
+
+#endif // BATCH_PROCESSOR_H
@@ -1,11 +1,29 @@
 #ifndef CALCULATOR_H
 #define CALCULATOR_H
 
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "division_policy.h"
+
 /**
  * @brief Simple calculator class for basic arithmetic operations
+ *
+ * Besides the scalar operations, the calculator offers batch overloads that
+ * operate on whole arrays of operands. The batch overloads use SIMD kernels
+ * (AVX2 or SSE2) selected at runtime, with a portable scalar fallback.
  */
 class Calculator {
 public:
+    /**
+     * @brief Instruction set used by the batch operations
+     */
+    enum class SimdLevel {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
     /**
      * @brief Add two numbers
      * @param a First number
@@ -38,6 +56,168 @@ public:
      * @throws std::invalid_argument if b is zero
      */
     static double divide(double a, double b);
+
+    /**
+     * @brief Divide two numbers with a selectable zero-divisor policy
+     *
+     * Inlined into the caller, so the non-throwing policies cost no more than
+     * a compare on the hot path. See division_policy.h for the policies.
+     *
+     * @tparam Policy ThrowPolicy, StatusPolicy, IeeePolicy or StickyFlagPolicy
+     * @param a Dividend
+     * @param b Divisor
+     * @return Quotient of a and b, reported as Policy::Result
+     */
+    template <typename Policy>
+    static typename Policy::Result divide(double a, double b) {
+        if (b == 0.0) [[unlikely]] {
+            return Policy::divisionByZero(a, b);
+        }
+        return Policy::quotient(a / b);
+    }
+
+    /**
+     * @brief Add two arrays element-wise (out[i] = a[i] + b[i])
+     * @param a First operands
+     * @param b Second operands
+     * @param out Results, may alias a or b
+     * @throws std::invalid_argument if the spans differ in size
+     */
+    static void add(std::span<const double> a, std::span<const double> b, std::span<double> out);
+
+    /**
+     * @brief Subtract two arrays element-wise (out[i] = a[i] - b[i])
+     * @param a First operands
+     * @param b Second operands
+     * @param out Results, may alias a or b
+     * @throws std::invalid_argument if the spans differ in size
+     */
+    static void subtract(std::span<const double> a, std::span<const double> b, std::span<double> out);
+
+    /**
+     * @brief Multiply two arrays element-wise (out[i] = a[i] * b[i])
+     * @param a First operands
+     * @param b Second operands
+     * @param out Results, may alias a or b
+     * @throws std::invalid_argument if the spans differ in size
+     */
+    static void multiply(std::span<const double> a, std::span<const double> b, std::span<double> out);
+
+    /**
+     * @brief Divide two arrays element-wise (out[i] = a[i] / b[i])
+     *
+     * A zero divisor does not stop the batch. Instead, bit (i % 64) of
+     * zeroMask[i / 64] is set for every lane i whose divisor is zero, and
+     * out[i] holds the IEEE 754 quotient (+/-inf or NaN) for that lane.
+     *
+     * @param a Dividends
+     * @param b Divisors
+     * @param out Quotients, may alias a or b
+     * @param zeroMask Bitmask of zero-divisor lanes, at least zeroMaskWords(a.size()) words
+     * @return Number of lanes with a zero divisor
+     * @throws std::invalid_argument if the spans differ in size or zeroMask is too small
+     */
+    static std::size_t divide(std::span<const double> a, std::span<const double> b, std::span<double> out,
+                              std::span<std::uint64_t> zeroMask);
+
+    /**
+     * @brief Smallest and largest element of an array
+     */
+    struct MinMax {
+        double min;
+        double max;
+    };
+
+    /**
+     * @brief Sum of an array with compensated accumulation
+     *
+     * The reductions below keep the exact rounding error of every addition
+     * (TwoSum) in several independent SIMD accumulators. The result is as
+     * accurate as summing in twice the precision and rounding once: the error
+     * is at most about eps * |sum| + n^2 * eps^2 * sum(|x|), with eps = 2^-53,
+     * instead of growing like n * eps * sum(|x|) for a plain loop.
+     *
+     * @param values Operands
+     * @return Sum, 0 for an empty array
+     */
+    static double sum(std::span<const double> values);
+
+    /**
+     * @brief Dot product with compensated accumulation
+     *
+     * Each product is rounded once, then the products are summed like sum(),
+     * so the error is at most about eps * sum(|a[i] * b[i]|).
+     *
+     * @param a First operands
+     * @param b Second operands
+     * @return Sum of a[i] * b[i], 0 for empty arrays
+     * @throws std::invalid_argument if the spans differ in size
+     */
+    static double dot(std::span<const double> a, std::span<const double> b);
+
+    /**
+     * @brief Arithmetic mean, sum(values) / n
+     * @param values Operands
+     * @return Mean
+     * @throws std::invalid_argument if values is empty
+     */
+    static double mean(std::span<const double> values);
+
+    /**
+     * @brief Variance by the corrected two-pass algorithm
+     * @param values Operands
+     * @param sample Divide by n - 1 (sample variance) instead of n (population variance)
+     * @return Variance
+     * @throws std::invalid_argument if values is empty, or has one element for a sample variance
+     */
+    static double variance(std::span<const double> values, bool sample = false);
+
+    /**
+     * @brief Smallest and largest element
+     * @param values Operands
+     * @return Minimum and maximum; both NaN if any element is NaN
+     * @throws std::invalid_argument if values is empty
+     */
+    static MinMax minMax(std::span<const double> values);
+
+    /**
+     * @brief Number of mask words needed by the batch divide for count lanes
+     * @param count Number of lanes
+     * @return Required size of the zeroMask span
+     */
+    static constexpr std::size_t zeroMaskWords(std::size_t count) {
+        return (count + 63) / 64;
+    }
+
+    /**
+     * @brief Instruction set currently used by the batch operations
+     * @return Active SIMD level
+     */
+    static SimdLevel simdLevel();
+
+    /**
+     * @brief Best instruction set supported by the running CPU
+     * @return Highest available SIMD level
+     */
+    static SimdLevel detectedSimdLevel();
+
+    /**
+     * @brief Force the batch operations to a given instruction set
+     *
+     * Requests above detectedSimdLevel() are clamped to it. Mainly useful for
+     * benchmarking and for comparing kernels against the scalar fallback.
+     *
+     * @param level Requested SIMD level
+     * @return SIMD level actually selected
+     */
+    static SimdLevel setSimdLevel(SimdLevel level);
+
+    /**
+     * @brief Human readable name of a SIMD level
+     * @param level SIMD level
+     * @return "scalar", "sse2" or "avx2"
+     */
+    static const char* simdLevelName(SimdLevel level);
 };
 
-#endif // CALCULATOR_H
\ No newline at end of file
+#endif // CALCULATOR_H
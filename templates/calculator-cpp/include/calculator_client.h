@@ -0,0 +1,107 @@
+#ifndef CALCULATOR_CLIENT_H
+#define CALCULATOR_CLIENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include "calculator_server.h"
+
+/**
+ * @brief One decoded server response
+ */
+struct ServerResponse {
+    std::uint32_t id = 0;
+    ServerStatus status = ServerStatus::Ok;
+    double value = 0.0;  ///< Result if status is Ok
+    std::string error;   ///< Message otherwise
+};
+
+/**
+ * @brief Blocking client for CalculatorServer
+ *
+ * Requests are queued by send() and written together by flush(), so any
+ * number of them can be pipelined on the connection; responses are then
+ * read back in the same order with receive(). call() and evaluate() do a
+ * single round trip.
+ *
+ * The server stops reading from a connection whose responses are not being
+ * read, so keep the number of unanswered requests well below
+ * CalculatorServer::kMaxBufferedBytes worth of frames.
+ */
+class CalculatorClient {
+public:
+    /**
+     * @brief Connect to a server
+     * @param socketPath Path of the server socket
+     * @throws std::runtime_error if the connection fails
+     */
+    explicit CalculatorClient(const std::string& socketPath);
+    ~CalculatorClient();
+
+    CalculatorClient(const CalculatorClient&) = delete;
+    CalculatorClient& operator=(const CalculatorClient&) = delete;
+
+    /**
+     * @brief Queue a request
+     * @param op Operation
+     * @param values Operands, or variable values for Evaluate
+     * @param formula Formula for Evaluate, empty otherwise
+     * @return Request id
+     * @throws std::invalid_argument if the request does not fit in one frame
+     */
+    std::uint32_t send(ServerOp op, std::span<const double> values, std::string_view formula = {});
+
+    /**
+     * @brief Queue a two-operand request
+     * @param op Add, Subtract, Multiply or Divide
+     * @param a First operand
+     * @param b Second operand
+     * @return Request id
+     */
+    std::uint32_t send(ServerOp op, double a, double b);
+
+    /**
+     * @brief Write all queued requests
+     * @throws std::runtime_error if the connection fails
+     */
+    void flush();
+
+    /**
+     * @brief Wait for the next response, flushing queued requests first
+     * @return Response to the oldest unanswered request
+     * @throws std::runtime_error if the connection fails or the server closed it
+     */
+    ServerResponse receive();
+
+    /**
+     * @brief Run one two-operand request
+     * @param op Add, Subtract, Multiply or Divide
+     * @param a First operand
+     * @param b Second operand
+     * @return Result
+     * @throws std::invalid_argument if the server reports an error
+     * @throws std::runtime_error if the connection fails
+     */
+    double call(ServerOp op, double a, double b);
+
+    /**
+     * @brief Evaluate one formula on the server
+     * @param formula Formula text
+     * @param values One value per variable, in order of first appearance
+     * @return Result
+     * @throws std::invalid_argument if the server reports an error
+     * @throws std::runtime_error if the connection fails
+     */
+    double evaluate(std::string_view formula, std::span<const double> values);
+
+private:
+    int fd_ = -1;
+    std::uint32_t nextId_ = 1;
+    std::string output_;
+    std::string input_;
+    std::size_t inputOffset_ = 0;  ///< Start of the unread part of input_
+};
+
+#endif // CALCULATOR_CLIENT_H
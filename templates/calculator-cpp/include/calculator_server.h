@@ -0,0 +1,237 @@
+#ifndef CALCULATOR_SERVER_H
+#define CALCULATOR_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Operation requested by a client
+ */
+enum class ServerOp : std::uint8_t {
+    Add = 1,       ///< values a, b -> a + b
+    Subtract = 2,  ///< values a, b -> a - b
+    Multiply = 3,  ///< values a, b -> a * b
+    Divide = 4,    ///< values a, b -> a / b
+    Evaluate = 5   ///< formula and one value per variable, in order of first appearance
+};
+
+/**
+ * @brief Outcome of a request
+ */
+enum class ServerStatus : std::uint8_t {
+    Ok = 0,         ///< Payload is the result
+    Error = 1,      ///< Evaluation failed (division by zero, invalid formula); payload is the message
+    BadRequest = 2  ///< Unknown operation or wrong number of values; payload is the message
+};
+
+/**
+ * @brief Binary frames exchanged with CalculatorServer
+ *
+ * Both ends run on the same host, so all fields are in host byte order and
+ * doubles are sent as their native 8 bytes. Every frame starts with a
+ * 12-byte header:
+ *
+ *     offset  size  request                    response
+ *     0       4     frame size incl. header    frame size incl. header
+ *     4       4     request id                 id of the request
+ *     8       1     ServerOp                   ServerStatus
+ *     9       1     reserved (0)               reserved (0)
+ *     10      2     number of values           reserved (0)
+ *
+ * A request continues with its values (8 bytes each) and, for Evaluate, the
+ * formula text up to the end of the frame. A response carries one double
+ * if the status is Ok and the error message otherwise. An Ok response is
+ * therefore 20 bytes, and an arithmetic request 28.
+ *
+ * Responses on a connection come back in request order. Frames smaller than
+ * the header or larger than kMaxFrameBytes are a protocol error: the server
+ * closes the connection.
+ */
+class ServerProtocol {
+public:
+    /// Size of the frame header
+    static constexpr std::size_t kHeaderBytes = 12;
+
+    /// Largest accepted frame
+    static constexpr std::size_t kMaxFrameBytes = 64 * 1024;
+
+    /**
+     * @brief Decoded frame header
+     */
+    struct Header {
+        std::uint32_t size = 0;
+        std::uint32_t id = 0;
+        std::uint8_t code = 0;    ///< ServerOp of a request, ServerStatus of a response
+        std::uint16_t count = 0;  ///< Number of values of a request
+    };
+
+    /**
+     * @brief Decode a frame header
+     * @param data At least kHeaderBytes bytes
+     * @return Header fields
+     */
+    static Header readHeader(const char* data);
+
+    /**
+     * @brief Append a request frame
+     * @param out Buffer the frame is appended to
+     * @param id Request id, echoed in the response
+     * @param op Operation
+     * @param values Operands, or variable values for Evaluate
+     * @param formula Formula for Evaluate, empty otherwise
+     * @throws std::invalid_argument if the frame would exceed kMaxFrameBytes
+     */
+    static void appendRequest(std::string& out, std::uint32_t id, ServerOp op, std::span<const double> values,
+                              std::string_view formula = {});
+
+    /**
+     * @brief Append an Ok response frame
+     * @param out Buffer the frame is appended to
+     * @param id Request id
+     * @param value Result
+     */
+    static void appendResult(std::string& out, std::uint32_t id, double value);
+
+    /**
+     * @brief Append an error response frame
+     * @param out Buffer the frame is appended to
+     * @param id Request id
+     * @param status Error or BadRequest
+     * @param message Error message, truncated to fit kMaxFrameBytes
+     */
+    static void appendError(std::string& out, std::uint32_t id, ServerStatus status, std::string_view message);
+};
+
+/**
+ * @brief Configuration of a CalculatorServer
+ */
+struct ServerOptions {
+    std::string socketPath;    ///< Path of the Unix domain socket; a stale socket file is replaced
+    std::size_t workers = 0;   ///< Worker threads, 0 for std::thread::hardware_concurrency()
+};
+
+/**
+ * @brief Counters of a CalculatorServer since it was created
+ */
+struct ServerStats {
+    std::uint64_t connections = 0;     ///< Accepted connections
+    std::uint64_t requests = 0;        ///< Requests answered
+    std::uint64_t batches = 0;         ///< Groups of requests handed to the workers
+    std::uint64_t protocolErrors = 0;  ///< Connections closed because of a malformed frame
+
+    double requestsPerBatch() const {
+        return batches > 0 ? static_cast<double>(requests) / static_cast<double>(batches) : 0.0;
+    }
+};
+
+/**
+ * @brief Long-running calculator service on a Unix domain socket (Linux)
+ *
+ * One event-loop thread owns all sockets and waits on them with epoll. It
+ * reads whatever a client has sent, and once the buffered bytes contain
+ * complete frames, hands all of them as one batch to a fixed pool of worker
+ * threads. The worker evaluates the batch and encodes every response into
+ * a single buffer, which the event loop then writes with one send(). A
+ * client that pipelines requests therefore costs one read, one handoff and
+ * one write per batch, not per request.
+ *
+ * A connection has at most one batch in flight, which keeps its responses
+ * in request order; requests arriving meanwhile are buffered and form the
+ * next batch. Different connections are served by the workers in parallel.
+ * A connection whose client stops reading responses stops being read from
+ * once about kMaxBufferedBytes are queued.
+ */
+class CalculatorServer {
+public:
+    /// Buffered input or unsent output per connection before it is throttled
+    static constexpr std::size_t kMaxBufferedBytes = 1 << 20;
+
+    /**
+     * @brief Bind and listen on the socket
+     * @param options Socket path and worker count
+     * @throws std::invalid_argument if the socket path is empty or too long
+     * @throws std::runtime_error if the socket cannot be created, or the path
+     *         exists and is not a socket
+     */
+    explicit CalculatorServer(ServerOptions options);
+
+    /**
+     * @brief Close all connections and remove the socket file
+     */
+    ~CalculatorServer();
+
+    CalculatorServer(const CalculatorServer&) = delete;
+    CalculatorServer& operator=(const CalculatorServer&) = delete;
+
+    /**
+     * @brief Serve clients on the calling thread until stop() is called
+     *
+     * Starts the worker threads on entry and joins them, closing all client
+     * connections, before returning.
+     */
+    void run();
+
+    /**
+     * @brief Make run() return; safe to call from any thread and from a signal handler
+     */
+    void stop();
+
+    /**
+     * @brief Snapshot of the counters
+     * @return Counters since construction
+     */
+    ServerStats stats() const;
+
+    /**
+     * @brief Path the server listens on
+     */
+    const std::string& socketPath() const { return options_.socketPath; }
+
+private:
+    struct Connection;
+
+    void release();
+    void acceptConnections();
+    void readFrom(Connection& connection);
+    void writeTo(Connection& connection);
+    void dispatch(Connection& connection);
+    void finishBatches();
+    void service(Connection& connection);
+    void close(Connection& connection);
+    void workerLoop();
+    static void execute(std::string_view frames, std::string& responses);
+
+    ServerOptions options_;
+    int listenFd_ = -1;
+    int epollFd_ = -1;
+    int wakeFd_ = -1;  ///< eventfd signalled by workers and stop()
+    std::atomic<bool> stopping_{false};
+
+    std::unordered_map<std::uint64_t, std::unique_ptr<Connection>> connections_;
+    std::uint64_t nextConnection_ = 0;
+
+    std::vector<std::thread> workers_;
+    std::mutex queueMutex_;
+    std::condition_variable queueReady_;
+    std::deque<Connection*> queue_;     ///< Connections with a batch to evaluate
+    std::vector<Connection*> finished_;  ///< Connections whose batch is evaluated
+    bool workersStopping_ = false;
+
+    std::atomic<std::uint64_t> connectionCount_{0};
+    std::atomic<std::uint64_t> requestCount_{0};
+    std::atomic<std::uint64_t> batchCount_{0};
+    std::atomic<std::uint64_t> protocolErrorCount_{0};
+};
+
+#endif // CALCULATOR_SERVER_H
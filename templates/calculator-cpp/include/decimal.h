@@ -0,0 +1,259 @@
+#ifndef DECIMAL_H
+#define DECIMAL_H
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "basic_calculator.h"
+
+/**
+ * @brief Bump allocator for the limbs of intermediate Decimal values
+ *
+ * Batch evaluation writes intermediate results with an arena: limbs that no
+ * longer fit a value's inline buffer come from large blocks here instead of
+ * the heap, and are released all at once by reset(). Blocks are kept and
+ * reused, so a batch that has warmed up the arena allocates nothing.
+ */
+class DecimalArena {
+public:
+    /// Limbs per block; larger requests get a block of their own
+    static constexpr std::size_t kBlockLimbs = 4096;
+
+    DecimalArena() = default;
+    DecimalArena(const DecimalArena&) = delete;
+    DecimalArena& operator=(const DecimalArena&) = delete;
+
+    /**
+     * @brief Allocate uninitialized limbs
+     * @param limbs Number of limbs
+     * @return Storage valid until the next reset()
+     */
+    std::uint32_t* allocate(std::size_t limbs);
+
+    /**
+     * @brief Release all allocations, keeping the blocks for reuse
+     */
+    void reset();
+
+    /**
+     * @brief Total size of the blocks held by the arena
+     * @return Bytes
+     */
+    std::size_t bytesReserved() const;
+
+private:
+    struct Block {
+        std::unique_ptr<std::uint32_t[]> limbs;
+        std::size_t size = 0;
+    };
+
+    std::vector<Block> blocks_;
+    std::size_t block_ = 0;  ///< Block currently allocated from
+    std::size_t used_ = 0;   ///< Limbs used in blocks_[block_]
+};
+
+/**
+ * @brief Signed arbitrary-precision decimal number
+ *
+ * A value is magnitude * 10^-scale, with the magnitude stored as base 10^9
+ * limbs. Addition, subtraction and multiplication are exact, so amounts such
+ * as 0.1 + 0.2 come out as exactly 0.3. Division rounds half to even to a
+ * given number of fractional digits.
+ *
+ * Up to kInlineLimbs limbs (45 digits, enough for any 38-digit amount) are
+ * stored inside the object, so ordinary values never allocate. Longer values
+ * use the heap, or a DecimalArena when written by the static operations with
+ * an arena. Such a value must not be used after the arena is reset; copies
+ * and moves always take their own storage, so copy results out first.
+ */
+class Decimal {
+public:
+    /// Limb base: every limb holds nine decimal digits
+    static constexpr std::uint32_t kLimbBase = 1'000'000'000;
+    static constexpr int kLimbDigits = 9;
+
+    /// Limbs stored without allocating
+    static constexpr std::size_t kInlineLimbs = 5;
+
+    /// Fractional digits kept by division unless another scale is given
+    static constexpr int kDefaultDivisionScale = 18;
+
+    /// Largest number of fractional digits a value may have
+    static constexpr int kMaxScale = 10000;
+
+    /**
+     * @brief Zero
+     */
+    Decimal() = default;
+
+    /**
+     * @brief Construct an integer value
+     * @param value Value
+     */
+    Decimal(long long value);
+
+    Decimal(const Decimal& other);
+    Decimal(Decimal&& other) noexcept;
+    Decimal& operator=(const Decimal& other);
+    Decimal& operator=(Decimal&& other) noexcept;
+    ~Decimal();
+
+    /**
+     * @brief Parse decimal text such as "-1234.5600" or "1.5e-3"
+     * @param text Number text
+     * @return Exact value; trailing fractional zeros are kept in the scale
+     * @throws std::invalid_argument if text is not a number
+     */
+    static Decimal parse(std::string_view text);
+
+    /**
+     * @brief Convert a double through its shortest round-trip representation
+     * @param value Finite number, e.g. 0.1 becomes exactly 0.1
+     * @return Decimal value
+     * @throws std::invalid_argument if value is infinite or NaN
+     */
+    static Decimal fromDouble(double value);
+
+    /**
+     * @brief Sum a + b
+     * @param a First number
+     * @param b Second number
+     * @param out Result; may alias a or b, its storage is reused
+     * @param arena Optional arena for limbs beyond the inline buffer
+     */
+    static void add(const Decimal& a, const Decimal& b, Decimal& out, DecimalArena* arena = nullptr);
+
+    /**
+     * @brief Difference a - b
+     * @param a First number
+     * @param b Second number
+     * @param out Result; may alias a or b, its storage is reused
+     * @param arena Optional arena for limbs beyond the inline buffer
+     */
+    static void subtract(const Decimal& a, const Decimal& b, Decimal& out, DecimalArena* arena = nullptr);
+
+    /**
+     * @brief Product a * b, with scale a.scale() + b.scale()
+     * @param a First number
+     * @param b Second number
+     * @param out Result; may alias a or b, its storage is reused
+     * @param arena Optional arena for limbs beyond the inline buffer
+     * @throws std::invalid_argument if the scale would exceed kMaxScale
+     */
+    static void multiply(const Decimal& a, const Decimal& b, Decimal& out, DecimalArena* arena = nullptr);
+
+    /**
+     * @brief Quotient a / b, rounded half to even
+     *
+     * Trailing fractional zeros are dropped, so exact quotients keep their
+     * shortest form (1 / 4 = 0.25, 1 / 3 = 0.333333333333333333).
+     *
+     * @param a Dividend
+     * @param b Divisor
+     * @param out Result; may alias a or b, its storage is reused
+     * @param scale Fractional digits to round to
+     * @param arena Optional arena for limbs beyond the inline buffer
+     * @throws std::invalid_argument if b is zero or scale is out of range
+     */
+    static void divide(const Decimal& a, const Decimal& b, Decimal& out, int scale = kDefaultDivisionScale,
+                       DecimalArena* arena = nullptr);
+
+    /**
+     * @brief Negation -a
+     * @param a Number
+     * @param out Result; may alias a, its storage is reused
+     * @param arena Optional arena for limbs beyond the inline buffer
+     */
+    static void negate(const Decimal& a, Decimal& out, DecimalArena* arena = nullptr);
+
+    /**
+     * @brief Copy a value into existing storage
+     * @param a Number
+     * @param out Copy of a; its storage is reused
+     * @param arena Optional arena for limbs beyond the inline buffer
+     */
+    static void assign(const Decimal& a, Decimal& out, DecimalArena* arena = nullptr);
+
+    /**
+     * @brief Round half to even to a number of fractional digits
+     * @param scale Fractional digits; larger than scale() pads with zeros
+     * @return Rounded value
+     * @throws std::invalid_argument if scale is out of range
+     */
+    Decimal rounded(int scale) const;
+
+    bool isZero() const { return size_ == 0; }
+    bool isNegative() const { return negative_; }
+
+    /**
+     * @brief Number of fractional digits
+     */
+    int scale() const { return scale_; }
+
+    /**
+     * @brief Whether the limbs are stored inside the object, without heap or arena
+     */
+    bool isInline() const { return limbs_ == inline_; }
+
+    /**
+     * @brief Plain decimal text, e.g. "-1234.5600"
+     */
+    std::string toString() const;
+
+    /**
+     * @brief Nearest double
+     */
+    double toDouble() const;
+
+    friend Decimal operator+(const Decimal& a, const Decimal& b);
+    friend Decimal operator-(const Decimal& a, const Decimal& b);
+    friend Decimal operator*(const Decimal& a, const Decimal& b);
+    friend Decimal operator/(const Decimal& a, const Decimal& b);
+    friend Decimal operator-(const Decimal& a);
+
+    /// Compares values, so 1.5 == 1.50
+    friend bool operator==(const Decimal& a, const Decimal& b) { return compare(a, b) == 0; }
+    friend std::strong_ordering operator<=>(const Decimal& a, const Decimal& b) { return compare(a, b) <=> 0; }
+
+private:
+    static int compare(const Decimal& a, const Decimal& b);
+    static void addSigned(const Decimal& a, const Decimal& b, bool negateB, Decimal& out, DecimalArena* arena);
+
+    void setMagnitude(const std::uint32_t* limbs, std::size_t size, DecimalArena* arena);
+    void release();
+
+    std::uint32_t* limbs_ = inline_;  ///< Little-endian base 10^9 magnitude
+    std::uint32_t size_ = 0;          ///< Limbs in use, no leading zero limbs
+    std::uint32_t capacity_ = kInlineLimbs;
+    std::int32_t scale_ = 0;
+    bool negative_ = false;           ///< Never set for zero
+    bool ownsHeap_ = false;           ///< limbs_ was allocated with new[]
+    std::uint32_t inline_[kInlineLimbs] = {};
+};
+
+/**
+ * @brief BasicCalculator backend for exact decimal arithmetic
+ *
+ * Same interface as the other BasicCalculator types, but not constexpr.
+ * Division rounds to Decimal::kDefaultDivisionScale fractional digits.
+ */
+template <>
+class BasicCalculator<Decimal> {
+public:
+    using value_type = Decimal;
+
+    static Decimal add(const Decimal& a, const Decimal& b) { return a + b; }
+    static Decimal subtract(const Decimal& a, const Decimal& b) { return a - b; }
+    static Decimal multiply(const Decimal& a, const Decimal& b) { return a * b; }
+
+    /**
+     * @throws std::invalid_argument if b is zero
+     */
+    static Decimal divide(const Decimal& a, const Decimal& b) { return a / b; }
+};
+
+#endif // DECIMAL_H
@@ -0,0 +1,122 @@
+#ifndef DIVISION_POLICY_H
+#define DIVISION_POLICY_H
+
+/**
+ * @brief Error policies for Calculator::divide<Policy>()
+ *
+ * Every policy returns exactly a / b for a non-zero divisor. They only differ
+ * in how a zero divisor is reported:
+ *
+ * - ThrowPolicy:      throws std::invalid_argument (same as Calculator::divide)
+ * - StatusPolicy:     returns a DivisionResult carrying a status code
+ * - IeeePolicy:       returns the IEEE 754 quotient (+/-inf or NaN)
+ * - StickyFlagPolicy: returns the IEEE 754 quotient and raises a per-thread flag
+ */
+
+/**
+ * @brief Outcome of a division
+ */
+enum class DivisionStatus {
+    Ok,
+    DivisionByZero
+};
+
+/**
+ * @brief expected-style result of StatusPolicy: a quotient or a status
+ */
+class DivisionResult {
+public:
+    constexpr DivisionResult(double value, DivisionStatus status) : value_(value), status_(status) {}
+
+    /**
+     * @brief Whether the division succeeded
+     * @return true if a quotient is available
+     */
+    constexpr bool has_value() const { return status_ == DivisionStatus::Ok; }
+    constexpr explicit operator bool() const { return has_value(); }
+
+    /**
+     * @brief Quotient of the division
+     * @return a / b; the IEEE 754 quotient if the divisor was zero
+     */
+    constexpr double value() const { return value_; }
+
+    /**
+     * @brief Quotient, or a fallback if the division failed
+     * @param fallback Value returned on a zero divisor
+     * @return Quotient or fallback
+     */
+    constexpr double value_or(double fallback) const { return has_value() ? value_ : fallback; }
+
+    /**
+     * @brief Status of the division
+     * @return DivisionStatus::Ok or the error that occurred
+     */
+    constexpr DivisionStatus error() const { return status_; }
+
+private:
+    double value_;
+    DivisionStatus status_;
+};
+
+/**
+ * @brief Throw std::invalid_argument on a zero divisor
+ */
+struct ThrowPolicy {
+    using Result = double;
+
+    static Result quotient(double q) { return q; }
+    [[noreturn]] static Result divisionByZero(double a, double b);
+};
+
+/**
+ * @brief Report a zero divisor through DivisionResult
+ */
+struct StatusPolicy {
+    using Result = DivisionResult;
+
+    static Result quotient(double q) { return {q, DivisionStatus::Ok}; }
+    static Result divisionByZero(double a, double b) { return {a / b, DivisionStatus::DivisionByZero}; }
+};
+
+/**
+ * @brief Let IEEE 754 arithmetic produce +/-inf or NaN on a zero divisor
+ */
+struct IeeePolicy {
+    using Result = double;
+
+    static Result quotient(double q) { return q; }
+    static Result divisionByZero(double a, double b) { return a / b; }
+};
+
+/**
+ * @brief Produce the IEEE 754 quotient and raise a sticky per-thread flag
+ *
+ * The flag stays raised until clear() is called, so a whole batch can be
+ * checked once at the end instead of after every division.
+ */
+struct StickyFlagPolicy {
+    using Result = double;
+
+    static Result quotient(double q) { return q; }
+    static Result divisionByZero(double a, double b) {
+        raised_ = true;
+        return a / b;
+    }
+
+    /**
+     * @brief Whether a zero divisor was seen since the last clear()
+     * @return true if the flag is raised on the calling thread
+     */
+    static bool raised() { return raised_; }
+
+    /**
+     * @brief Reset the flag of the calling thread
+     */
+    static void clear() { raised_ = false; }
+
+private:
+    static inline thread_local bool raised_ = false;
+};
+
+#endif // DIVISION_POLICY_H
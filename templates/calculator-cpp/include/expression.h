@@ -0,0 +1,152 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Decimal;
+class DecimalArena;
+
+/**
+ * @brief Infix expression compiled to register bytecode
+ *
+ * An Expression is parsed and constant-folded once by compile(), after which
+ * it can be evaluated any number of times without re-parsing, either for a
+ * single row of variable values or over whole columns. Column evaluation
+ * runs the bytecode on fixed-size chunks of rows using the Calculator batch
+ * operations, so every instruction processes a chunk with SIMD kernels.
+ */
+class Expression {
+public:
+    /**
+     * @brief Bytecode operation
+     */
+    enum class OpCode : std::uint8_t {
+        LoadVariable,  ///< r[dst] = variable[a]
+        LoadConstant,  ///< r[dst] = constant[a]
+        Negate,        ///< r[dst] = -r[a]
+        Add,           ///< r[dst] = r[a] + r[b]
+        Subtract,      ///< r[dst] = r[a] - r[b]
+        Multiply,      ///< r[dst] = r[a] * r[b]
+        Divide         ///< r[dst] = r[a] / r[b]
+    };
+
+    /**
+     * @brief One three-address bytecode instruction
+     */
+    struct Instruction {
+        OpCode op;
+        std::uint8_t dst;
+        std::uint16_t a;
+        std::uint16_t b;
+    };
+
+    /// Maximum number of registers (nesting depth) of a compiled expression
+    static constexpr std::size_t kMaxRegisters = 64;
+
+    /// Rows evaluated per chunk by the column overload of evaluate()
+    static constexpr std::size_t kChunkRows = 256;
+
+    /**
+     * @brief Parse, constant-fold and compile an expression
+     * @param source Expression text, see parseExpression() for the grammar
+     * @return Compiled expression
+     * @throws std::invalid_argument on a syntax error or if nesting exceeds kMaxRegisters
+     */
+    static Expression compile(std::string_view source);
+
+    /**
+     * @brief Variable names, in the order their values must be supplied
+     * @return Variable names
+     */
+    const std::vector<std::string>& variables() const { return variables_; }
+
+    /**
+     * @brief Position of a variable in variables()
+     * @param name Variable name
+     * @return Index, or variables().size() if the expression does not use it
+     */
+    std::size_t variableIndex(std::string_view name) const;
+
+    /**
+     * @brief Compiled bytecode, mainly for diagnostics
+     * @return Instructions; the result is left in register 0
+     */
+    const std::vector<Instruction>& code() const { return code_; }
+
+    /**
+     * @brief Constant pool referenced by LoadConstant
+     * @return Constants
+     */
+    const std::vector<double>& constants() const { return constants_; }
+
+    /**
+     * @brief Number of registers the bytecode needs
+     * @return Register count
+     */
+    std::size_t registerCount() const { return registerCount_; }
+
+    /**
+     * @brief Evaluate for one set of variable values
+     * @param values One value per variable, in variables() order
+     * @return Result of the expression
+     * @throws std::invalid_argument if values has the wrong size or on division by zero
+     */
+    double evaluate(std::span<const double> values) const;
+
+    /**
+     * @brief Evaluate over columns of variable values
+     *
+     * Division by zero does not stop the evaluation: the IEEE 754 result is
+     * stored and the row is flagged in zeroMask (bit i % 64 of word i / 64),
+     * if one is supplied.
+     *
+     * @param columns One column per variable, in variables() order, all of out.size() rows
+     * @param out Results, one per row
+     * @param zeroMask Optional bitmask of rows that divided by zero,
+     *                 at least Calculator::zeroMaskWords(out.size()) words
+     * @return Number of rows that divided by zero
+     * @throws std::invalid_argument if the column count or sizes do not match
+     */
+    std::size_t evaluate(std::span<const std::span<const double>> columns, std::span<double> out,
+                         std::span<std::uint64_t> zeroMask = {}) const;
+
+    /**
+     * @brief Evaluate over columns of Decimal values with exact decimal arithmetic
+     *
+     * Rows are evaluated one at a time into registers that keep their storage
+     * from row to row; limbs that outgrow a register's inline buffer come from
+     * the arena, which is reset on entry. Constants keep the exact value of
+     * the literals as written, and compile() folds constant subexpressions in
+     * Decimal as well, so x * (0.1 + 0.2) multiplies by exactly 0.3.
+     * Division rounds to Decimal::kDefaultDivisionScale fractional digits.
+     *
+     * @param columns One column per variable, in variables() order, all of out.size() rows
+     * @param out Results, one per row
+     * @param arena Arena for intermediate results
+     * @throws std::invalid_argument if the column count or sizes do not match, or on division by zero
+     */
+    void evaluate(std::span<const std::span<const Decimal>> columns, std::span<Decimal> out,
+                  DecimalArena& arena) const;
+
+    /**
+     * @brief Human readable listing of the bytecode
+     * @return One instruction per line
+     */
+    std::string disassemble() const;
+
+private:
+    Expression() = default;
+
+    std::vector<Instruction> code_;
+    std::vector<double> constants_;
+    std::vector<std::string> constantTexts_;  ///< Exact decimal text of each constant
+    std::vector<std::string> variables_;
+    std::size_t registerCount_ = 0;
+};
+
+#endif // EXPRESSION_H
@@ -0,0 +1,118 @@
+#ifndef EXPRESSION_CACHE_H
+#define EXPRESSION_CACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "expression.h"
+
+/**
+ * @brief Thread-safe, bounded LRU cache of compiled expressions
+ *
+ * Formulas are looked up by their normalized text, so "a+2", "a + 2.0" and
+ * " a+2e0 " share one compiled Expression. Once a formula is cached, a lookup
+ * neither parses nor allocates: the key is normalized into a per-thread
+ * buffer, looked up by string_view, and the expression is returned as a
+ * shared pointer.
+ *
+ * The cache is split into up to kShards shards with their own mutex and LRU
+ * list, so concurrent lookups of different formulas rarely contend.
+ */
+class ExpressionCache {
+public:
+    /**
+     * @brief Cache counters
+     */
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        std::size_t size = 0;
+    };
+
+    /**
+     * @brief Create a cache
+     * @param capacity Maximum number of compiled expressions kept, at least 1; above
+     *                 kShards it is rounded up to a multiple of kShards
+     */
+    explicit ExpressionCache(std::size_t capacity = 1024);
+
+    ExpressionCache(const ExpressionCache&) = delete;
+    ExpressionCache& operator=(const ExpressionCache&) = delete;
+
+    /**
+     * @brief Process-wide cache shared by the calculator front ends
+     * @return Global cache instance
+     */
+    static ExpressionCache& global();
+
+    /**
+     * @brief Compiled expression for a formula, compiling it on a miss
+     * @param source Formula text
+     * @return Shared compiled expression
+     * @throws std::invalid_argument if the formula does not compile (nothing is cached)
+     */
+    std::shared_ptr<const Expression> get(std::string_view source);
+
+    /**
+     * @brief Current counters
+     * @return Hits, misses, evictions and number of cached expressions
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Drop all cached expressions (counters are kept)
+     */
+    void clear();
+
+    /**
+     * @brief Maximum number of cached expressions
+     * @return Capacity
+     */
+    std::size_t capacity() const { return shardCapacity_ * shardCount_; }
+
+    /**
+     * @brief Canonical text of a formula
+     *
+     * Removes whitespace and rewrites every number in its shortest round-trip
+     * form, e.g. " x * 2.50 " becomes "x*2.5". Numbers with more significant
+     * digits than a double holds are kept as written, so formulas that differ
+     * only beyond double precision still get their own exact Decimal constants.
+     *
+     * @param source Formula text
+     * @param out Receives the normalized text (its capacity is reused)
+     */
+    static void normalize(std::string_view source, std::string& out);
+
+    /// Most shards; smaller caches have one shard per entry
+    static constexpr std::size_t kShards = 8;
+
+private:
+
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const Expression> expression;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  ///< Most recently used first
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> index;  ///< Keys view Entry::key
+    };
+
+    std::size_t shardCount_;
+    std::size_t shardCapacity_;
+    std::array<Shard, kShards> shards_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+};
+
+#endif // EXPRESSION_CACHE_H
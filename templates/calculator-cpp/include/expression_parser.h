@@ -0,0 +1,59 @@
+#ifndef EXPRESSION_PARSER_H
+#define EXPRESSION_PARSER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Node of a parsed infix expression
+ *
+ * The tree is the direct output of parseExpression(). Expression compiles it
+ * into bytecode; walking it directly is only meant for diagnostics and as a
+ * reference implementation.
+ */
+struct ExpressionNode {
+    enum class Kind {
+        Number,
+        Variable,
+        Negate,
+        Add,
+        Subtract,
+        Multiply,
+        Divide
+    };
+
+    using Ptr = std::unique_ptr<ExpressionNode>;
+
+    Kind kind = Kind::Number;
+    double value = 0.0;        ///< Literal value (Number)
+    std::string text;          ///< Literal as written (Number), the exact value for Decimal evaluation
+    std::size_t variable = 0;  ///< Index into ParsedExpression::variables (Variable)
+    Ptr lhs;                   ///< Operand (Negate) or left operand (binary)
+    Ptr rhs;                   ///< Right operand (binary)
+};
+
+/**
+ * @brief Result of parsing: the tree plus the variables it refers to
+ */
+struct ParsedExpression {
+    ExpressionNode::Ptr root;
+    std::vector<std::string> variables;  ///< Variable names in order of first use
+};
+
+/**
+ * @brief Parse an infix expression
+ *
+ * Grammar: numbers, identifiers ([A-Za-z_][A-Za-z0-9_]*), parentheses,
+ * unary + and -, and the binary operators + - * / with the usual precedence
+ * and left associativity. Parentheses and unary operators may nest at most
+ * 256 levels deep, and an expression may have at most 65536 operators.
+ *
+ * @param source Expression text, e.g. "(a + 2) * b / 3"
+ * @return Parsed tree and its variables
+ * @throws std::invalid_argument on a syntax error or an expression over those limits, with the column in the message
+ */
+ParsedExpression parseExpression(std::string_view source);
+
+#endif // EXPRESSION_PARSER_H
@@ -0,0 +1,162 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/**
+ * @brief Signed binary fixed-point number with FracBits fractional bits
+ *
+ * The value is stored as a 32-bit two's complement integer scaled by
+ * 2^FracBits, so arithmetic only needs integer instructions. This makes it
+ * the fast choice on targets without a double-precision FPU such as the
+ * STM32F407 (Cortex-M4, fpv4-sp-d16), where every double operation is
+ * emulated in software.
+ *
+ * Arithmetic lives in BasicCalculator; this type only handles storage and
+ * conversions. The header is C++17 and does not need exceptions, so it can
+ * be shared with the embedded templates.
+ *
+ * @tparam FracBits Number of fractional bits (1..31)
+ */
+template <int FracBits>
+class FixedPoint {
+    static_assert(FracBits > 0 && FracBits < 32, "FixedPoint needs 1 to 31 fractional bits");
+
+public:
+    using Raw = std::int32_t;
+    using Wide = std::int64_t;
+
+    static constexpr int kFracBits = FracBits;
+
+    constexpr FixedPoint() = default;
+
+    /**
+     * @brief Convert from an integer, saturating to the representable range
+     * @param value Integer value
+     */
+    template <typename Int, std::enable_if_t<std::is_integral_v<Int>, int> = 0>
+    constexpr FixedPoint(Int value) : raw_(fromInteger(value)) {}
+
+    /**
+     * @brief Convert from floating point, rounding to nearest and saturating
+     *
+     * Intended for literals evaluated at compile time; at runtime on a
+     * single-precision target prefer a float argument over a double.
+     *
+     * @param value Floating point value
+     */
+    template <typename Float, std::enable_if_t<std::is_floating_point_v<Float>, int> = 0>
+    constexpr FixedPoint(Float value) : raw_(fromFloating(value)) {}
+
+    /**
+     * @brief Build a value from its scaled integer representation
+     * @param raw value * 2^FracBits
+     * @return Fixed-point value
+     */
+    static constexpr FixedPoint fromRaw(Raw raw) {
+        FixedPoint result;
+        result.raw_ = raw;
+        return result;
+    }
+
+    /**
+     * @brief Largest representable value
+     */
+    static constexpr FixedPoint max() { return fromRaw(std::numeric_limits<Raw>::max()); }
+
+    /**
+     * @brief Most negative representable value
+     */
+    static constexpr FixedPoint lowest() { return fromRaw(std::numeric_limits<Raw>::min()); }
+
+    /**
+     * @brief Scaled integer representation
+     * @return value * 2^FracBits
+     */
+    constexpr Raw raw() const { return raw_; }
+
+    /**
+     * @brief Convert to floating point
+     * @return Nearest value of type Float
+     */
+    template <typename Float = float>
+    constexpr Float to() const {
+        return static_cast<Float>(raw_) / static_cast<Float>(Wide{1} << FracBits);
+    }
+
+    /**
+     * @brief Clamp a wide intermediate result to the 32-bit range
+     * @param value Scaled value
+     * @return Saturated raw value
+     */
+    static constexpr Raw saturate(Wide value) {
+        if (value > std::numeric_limits<Raw>::max()) {
+            return std::numeric_limits<Raw>::max();
+        }
+        if (value < std::numeric_limits<Raw>::min()) {
+            return std::numeric_limits<Raw>::min();
+        }
+        return static_cast<Raw>(value);
+    }
+
+    friend constexpr bool operator==(FixedPoint a, FixedPoint b) { return a.raw_ == b.raw_; }
+    friend constexpr bool operator!=(FixedPoint a, FixedPoint b) { return a.raw_ != b.raw_; }
+    friend constexpr bool operator<(FixedPoint a, FixedPoint b) { return a.raw_ < b.raw_; }
+    friend constexpr bool operator>(FixedPoint a, FixedPoint b) { return a.raw_ > b.raw_; }
+
+private:
+    template <typename Int>
+    static constexpr Raw fromInteger(Int value) {
+        // Any magnitude above 2^31 saturates, and clamping to it first keeps
+        // the scaled product inside Wide (2^31 * 2^31 at most)
+        constexpr Wide limit = Wide{1} << 31;
+        Wide wide = 0;
+        if constexpr (std::is_signed_v<Int>) {
+            wide = static_cast<Wide>(value);
+            wide = wide < -limit ? -limit : wide;
+        } else {
+            wide = value > static_cast<std::uint64_t>(limit) ? limit : static_cast<Wide>(value);
+        }
+        wide = wide > limit ? limit : wide;
+        return saturate(wide * (Wide{1} << FracBits));
+    }
+
+    template <typename Float>
+    static constexpr Raw fromFloating(Float value) {
+        const Float scaled = value * static_cast<Float>(Wide{1} << FracBits);
+        if (!(scaled == scaled)) {
+            return 0;  // NaN
+        }
+        if (scaled >= static_cast<Float>(std::numeric_limits<Raw>::max())) {
+            return std::numeric_limits<Raw>::max();
+        }
+        if (scaled <= static_cast<Float>(std::numeric_limits<Raw>::min())) {
+            return std::numeric_limits<Raw>::min();
+        }
+        return static_cast<Raw>(scaled < 0 ? scaled - Float(0.5) : scaled + Float(0.5));
+    }
+
+    Raw raw_ = 0;
+};
+
+/// Q16.16: 16 integer bits (including sign) and 16 fractional bits
+using Q16_16 = FixedPoint<16>;
+
+/// Q31: range [-1, 1) with 31 fractional bits, the usual DSP sample format
+using Q31 = FixedPoint<31>;
+
+/**
+ * @brief Whether T is a FixedPoint instantiation
+ */
+template <typename T>
+struct IsFixedPoint : std::false_type {};
+
+template <int FracBits>
+struct IsFixedPoint<FixedPoint<FracBits>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool kIsFixedPoint = IsFixedPoint<T>::value;
+
+#endif // FIXED_POINT_H
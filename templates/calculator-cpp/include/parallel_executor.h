@@ -0,0 +1,147 @@
+#ifndef PARALLEL_EXECUTOR_H
+#define PARALLEL_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+class Expression;
+
+/**
+ * @brief Cooperative cancellation flag for ParallelExecutor jobs
+ */
+class CancellationToken {
+public:
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+    void reset() { cancelled_.store(false, std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled_{false};
+};
+
+/**
+ * @brief Work-stealing thread pool for evaluating large operand arrays
+ *
+ * A job over rows [0, n) is cut into fixed-size chunks. Each worker starts
+ * with one contiguous block of chunks, so it streams through its own region
+ * of the arrays (and, with pinned threads, keeps touching the same NUMA
+ * node). Workers take chunks from the front of their block; a worker that
+ * runs dry steals the back half of another worker's remaining block. Blocks
+ * are packed into a single atomic word per worker, so taking and stealing
+ * are lock-free.
+ *
+ * Every chunk writes only its own output range, so results keep the input
+ * order no matter which worker computes them.
+ */
+class ParallelExecutor {
+public:
+    /// Default rows per chunk; a multiple of 64 so zero-divisor mask words are never shared
+    static constexpr std::size_t kDefaultChunkRows = 16384;
+
+    /**
+     * @brief Counters of one worker, accumulated over all jobs since resetStats()
+     */
+    struct WorkerStats {
+        std::uint64_t chunks = 0;
+        std::uint64_t rows = 0;
+        std::uint64_t steals = 0;   ///< Successful steals from other workers
+        double busySeconds = 0.0;   ///< Time spent inside chunk functions
+
+        double rowsPerSecond() const { return busySeconds > 0.0 ? static_cast<double>(rows) / busySeconds : 0.0; }
+    };
+
+    /**
+     * @brief Start the worker threads
+     * @param workers Number of threads, 0 for std::thread::hardware_concurrency()
+     * @param pinThreads Pin worker i to CPU i (Linux only), keeping first-touch memory local
+     */
+    explicit ParallelExecutor(std::size_t workers = 0, bool pinThreads = false);
+    ~ParallelExecutor();
+
+    ParallelExecutor(const ParallelExecutor&) = delete;
+    ParallelExecutor& operator=(const ParallelExecutor&) = delete;
+
+    /**
+     * @brief Number of worker threads
+     */
+    std::size_t workerCount() const { return threads_.size(); }
+
+    /**
+     * @brief Run fn(begin, end) over [0, rows) in chunks on all workers
+     *
+     * Blocks until every chunk has run or the job was cancelled. If fn throws,
+     * the remaining chunks are skipped and the first exception is rethrown.
+     * Jobs submitted concurrently from several threads run one after another.
+     *
+     * @param rows Number of rows
+     * @param chunkRows Rows per chunk (0 for kDefaultChunkRows)
+     * @param fn Chunk function, called concurrently for disjoint ranges
+     * @param token Optional cancellation token, checked before each chunk
+     * @return true if all chunks ran, false if cancelled
+     */
+    bool parallelFor(std::size_t rows, std::size_t chunkRows, const std::function<void(std::size_t, std::size_t)>& fn,
+                     const CancellationToken* token = nullptr);
+
+    /**
+     * @brief Evaluate an expression over columns in parallel
+     *
+     * Same contract as Expression::evaluate() for columns. If the job is
+     * cancelled, rows of chunks that did not run are left unchanged.
+     *
+     * @param expression Compiled expression
+     * @param columns One column per variable, all of out.size() rows
+     * @param out Results, in input order
+     * @param zeroMask Optional bitmask of rows that divided by zero
+     * @param token Optional cancellation token
+     * @return Number of rows that divided by zero
+     */
+    std::size_t evaluate(const Expression& expression, std::span<const std::span<const double>> columns,
+                         std::span<double> out, std::span<std::uint64_t> zeroMask = {},
+                         const CancellationToken* token = nullptr);
+
+    /**
+     * @brief Snapshot of the per-worker counters
+     * @return One entry per worker
+     */
+    std::vector<WorkerStats> stats() const;
+
+    /**
+     * @brief Reset the per-worker counters
+     */
+    void resetStats();
+
+private:
+    struct alignas(64) Worker {
+        std::atomic<std::uint64_t> range{0};  ///< Remaining chunks: begin << 32 | end
+        WorkerStats stats;
+    };
+
+    struct Job;
+
+    void workerLoop(std::size_t index);
+    void runJob(std::size_t index, Job& job);
+    bool takeOwn(Worker& worker, std::uint32_t& chunk);
+    bool steal(std::size_t thief);
+
+    std::unique_ptr<Worker[]> workers_;
+    std::vector<std::thread> threads_;
+
+    std::mutex submitMutex_;  ///< Serializes parallelFor calls
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    Job* job_ = nullptr;
+    std::uint64_t generation_ = 0;
+    std::size_t running_ = 0;
+    bool stopping_ = false;
+};
+
+#endif // PARALLEL_EXECUTOR_H
@@ -0,0 +1,139 @@
+#ifndef SPREADSHEET_H
+#define SPREADSHEET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "expression.h"
+#include "parallel_executor.h"
+
+/**
+ * @brief Named cells with formulas, recalculated incrementally
+ *
+ * Every cell holds a formula (a plain number is a formula too) whose
+ * variables name other cells. The sheet keeps the dependency graph in both
+ * directions. set() only records the change and marks the cell dirty;
+ * recalculate() then finds every cell downstream of the dirty ones and
+ * recomputes just those, level by level in topological order. A level is a
+ * set of cells whose inputs are all up to date, so they are independent and
+ * large levels are evaluated in parallel.
+ *
+ * A formula that would close a cycle is rejected and leaves the sheet
+ * unchanged. Referencing a cell that was never set creates it empty, with
+ * value 0. A cell whose formula fails (division by zero) holds an error
+ * instead of a value, and so does every cell that depends on it.
+ */
+class Spreadsheet {
+public:
+    /**
+     * @brief What one recalculate() call did
+     */
+    struct RecalcStats {
+        std::size_t cells = 0;   ///< Cells recomputed
+        std::size_t levels = 0;  ///< Topological levels, the longest dependency chain
+    };
+
+    /**
+     * @brief A cell as seen from outside the sheet
+     */
+    struct CellView {
+        std::string_view name;
+        std::string_view formula;  ///< Empty for a cell that was only referenced
+        double value;              ///< NaN if the cell has an error
+        std::string_view error;    ///< Empty unless evaluation failed
+    };
+
+    /// Levels with fewer cells are evaluated on the calling thread
+    static constexpr std::size_t kParallelLevelCells = 1024;
+
+    /**
+     * @brief Create an empty sheet
+     * @param workers Threads for large levels, 0 for std::thread::hardware_concurrency()
+     */
+    explicit Spreadsheet(std::size_t workers = 0);
+
+    Spreadsheet(const Spreadsheet&) = delete;
+    Spreadsheet& operator=(const Spreadsheet&) = delete;
+
+    /**
+     * @brief Set the formula of a cell and mark it dirty
+     * @param name Cell name, an identifier as in expressions
+     * @param formula Formula over other cells, e.g. "price * (1 + tax)" or "42"
+     * @throws std::invalid_argument on an invalid name or formula, or if the
+     *         formula would create a circular reference (the sheet is unchanged)
+     */
+    void set(std::string_view name, std::string_view formula);
+
+    /**
+     * @brief Recompute every cell downstream of the cells set since the last call
+     * @return Number of cells and levels recomputed
+     */
+    RecalcStats recalculate();
+
+    /**
+     * @brief Whether a cell exists
+     * @param name Cell name
+     * @return true if the cell was set or referenced
+     */
+    bool contains(std::string_view name) const;
+
+    /**
+     * @brief Current state of a cell; call recalculate() first after set()
+     * @param name Cell name
+     * @return Name, formula, value and error of the cell
+     * @throws std::invalid_argument if there is no such cell
+     */
+    CellView cell(std::string_view name) const;
+
+    /**
+     * @brief Value of a cell
+     * @param name Cell name
+     * @return Value
+     * @throws std::invalid_argument if there is no such cell or it holds an error
+     */
+    double value(std::string_view name) const;
+
+    /**
+     * @brief All cells in creation order
+     * @return One view per cell
+     */
+    std::vector<CellView> cells() const;
+
+    /**
+     * @brief Number of cells
+     */
+    std::size_t size() const { return cells_.size(); }
+
+private:
+    using CellId = std::uint32_t;
+
+    struct Cell {
+        std::string name;
+        std::string formula;
+        std::shared_ptr<const Expression> expression;  ///< Null for a referenced, never set cell
+        std::vector<CellId> inputs;                    ///< One per expression variable, in order
+        std::vector<CellId> dependents;
+        double value = 0.0;
+        std::string error;
+        bool dirty = false;
+        std::uint32_t pending = 0;  ///< Dirty inputs not yet recomputed, used by recalculate()
+        std::uint32_t mark = 0;     ///< Graph walk generation
+    };
+
+    CellId findOrCreate(std::string_view name);
+    void checkAcyclic(CellId target, const std::vector<CellId>& inputs);
+    void evaluate(Cell& cell);
+
+    std::vector<Cell> cells_;
+    std::unordered_map<std::string, CellId> ids_;
+    std::vector<CellId> changed_;  ///< Cells set since the last recalculate()
+    std::uint32_t generation_ = 0;
+    std::unique_ptr<ParallelExecutor> executor_;
+    std::size_t workers_;
+};
+
+#endif // SPREADSHEET_H
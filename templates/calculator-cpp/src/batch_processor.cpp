@@ -0,0 +1,529 @@
+#include "batch_processor.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "calculator.h"
+
+namespace {
+
+constexpr std::size_t kReadBufferBytes = 1 << 20;
+constexpr std::size_t kWriteBufferBytes = 1 << 20;
+// Consumed parts of a mapping are dropped from the resident set in steps of
+// this size, so a sequential pass keeps a constant footprint.
+constexpr std::size_t kReleaseBytes = 64 << 20;
+
+// Descriptor I/O. The CRT on Windows has the same calls with an underscore
+// but no memory mapping, so there every input goes through readSome().
+#ifdef _WIN32
+constexpr int kStdin = 0;
+constexpr int kStdout = 1;
+constexpr int kLastStandardFd = 2;
+
+int openInput(const std::string& path) {
+    return ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+}
+
+int createOutput(const std::string& path) {
+    return ::_open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+
+long long readSome(int fd, char* data, std::size_t bytes) {
+    return ::_read(fd, data, static_cast<unsigned>(std::min<std::size_t>(bytes, INT_MAX)));
+}
+
+long long writeSome(int fd, const char* data, std::size_t bytes) {
+    return ::_write(fd, data, static_cast<unsigned>(std::min<std::size_t>(bytes, INT_MAX)));
+}
+
+void closeFile(int fd) {
+    ::_close(fd);
+}
+#else
+constexpr int kStdin = STDIN_FILENO;
+constexpr int kStdout = STDOUT_FILENO;
+constexpr int kLastStandardFd = STDERR_FILENO;
+
+int openInput(const std::string& path) {
+    return ::open(path.c_str(), O_RDONLY);
+}
+
+int createOutput(const std::string& path) {
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+}
+
+long long readSome(int fd, char* data, std::size_t bytes) {
+    return ::read(fd, data, std::min<std::size_t>(bytes, INT_MAX));
+}
+
+long long writeSome(int fd, const char* data, std::size_t bytes) {
+    return ::write(fd, data, std::min<std::size_t>(bytes, INT_MAX));
+}
+
+void closeFile(int fd) {
+    ::close(fd);
+}
+#endif
+
+[[noreturn]] void throwSystemError(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+/**
+ * @brief Sequential input over a memory mapping, or read() for pipes
+ */
+class InputStream {
+public:
+    explicit InputStream(const std::string& path) : path_(path) {
+        fd_ = path == "-" ? kStdin : openInput(path);
+        if (fd_ < 0) {
+            throwSystemError("Could not open", path);
+        }
+
+#ifndef _WIN32
+        struct stat info {};
+        if (::fstat(fd_, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            const auto size = static_cast<std::size_t>(info.st_size);
+            void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (mapping != MAP_FAILED) {
+                ::madvise(mapping, size, MADV_SEQUENTIAL);
+                mapping_ = static_cast<char*>(mapping);
+                data_ = mapping_;
+                end_ = size;
+                eof_ = true;
+                return;
+            }
+        }
+#endif
+        buffer_.resize(kReadBufferBytes);
+        data_ = buffer_.data();
+    }
+
+    ~InputStream() {
+#ifndef _WIN32
+        if (mapping_ != nullptr) {
+            ::munmap(mapping_, end_);
+        }
+#endif
+        if (fd_ > kLastStandardFd) {
+            closeFile(fd_);
+        }
+    }
+
+    InputStream(const InputStream&) = delete;
+    InputStream& operator=(const InputStream&) = delete;
+
+    /// Bytes available without further I/O
+    std::string_view available() const { return {data_ + pos_, end_ - pos_}; }
+
+    /// Whether available() already ends at the end of the input
+    bool eof() const { return eof_; }
+
+    std::uint64_t consumedBytes() const { return consumed_; }
+
+    void consume(std::size_t bytes) {
+        pos_ += bytes;
+        consumed_ += bytes;
+#ifndef _WIN32
+        if (mapping_ != nullptr && pos_ - released_ >= kReleaseBytes) {
+            const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            const std::size_t upTo = pos_ / page * page;
+            ::madvise(mapping_ + released_, upTo - released_, MADV_DONTNEED);
+            released_ = upTo;
+        }
+#endif
+    }
+
+    /**
+     * @brief Read more input behind the unconsumed bytes
+     * @return false at end of input
+     */
+    bool refill() {
+        if (eof_) {
+            return false;
+        }
+        const std::size_t tail = end_ - pos_;
+        std::memmove(buffer_.data(), buffer_.data() + pos_, tail);
+        pos_ = 0;
+        end_ = tail;
+        if (end_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);  // a single row is longer than the buffer
+        }
+        data_ = buffer_.data();
+
+        long long count;
+        do {
+            count = readSome(fd_, buffer_.data() + end_, buffer_.size() - end_);
+        } while (count < 0 && errno == EINTR);
+        if (count < 0) {
+            throwSystemError("Could not read", path_);
+        }
+        if (count == 0) {
+            eof_ = true;
+            return false;
+        }
+        end_ += static_cast<std::size_t>(count);
+        return true;
+    }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    char* mapping_ = nullptr;
+    std::vector<char> buffer_;
+    const char* data_ = nullptr;
+    std::size_t pos_ = 0;
+    std::size_t end_ = 0;
+    std::size_t released_ = 0;
+    std::uint64_t consumed_ = 0;
+    bool eof_ = false;
+};
+
+/**
+ * @brief Buffered output written with write()
+ */
+class OutputStream {
+public:
+    explicit OutputStream(const std::string& path) : path_(path), buffer_(kWriteBufferBytes) {
+        fd_ = path == "-" ? kStdout : createOutput(path);
+        if (fd_ < 0) {
+            throwSystemError("Could not create", path);
+        }
+    }
+
+    ~OutputStream() {
+        if (fd_ > kLastStandardFd) {
+            closeFile(fd_);
+        }
+    }
+
+    OutputStream(const OutputStream&) = delete;
+    OutputStream& operator=(const OutputStream&) = delete;
+
+    /// Space for at least bytes more bytes; finish with commit()
+    char* reserve(std::size_t bytes) {
+        if (buffer_.size() - used_ < bytes) {
+            flush();
+        }
+        return buffer_.data() + used_;
+    }
+
+    void commit(std::size_t bytes) { used_ += bytes; }
+
+    void append(const void* data, std::size_t bytes) {
+        if (bytes > buffer_.size() - used_) {
+            flush();
+        }
+        if (bytes >= buffer_.size()) {
+            writeAll(static_cast<const char*>(data), bytes);
+            return;
+        }
+        std::memcpy(buffer_.data() + used_, data, bytes);
+        used_ += bytes;
+    }
+
+    void flush() {
+        writeAll(buffer_.data(), used_);
+        used_ = 0;
+    }
+
+    std::uint64_t writtenBytes() const { return written_; }
+
+private:
+    void writeAll(const char* data, std::size_t bytes) {
+        while (bytes > 0) {
+            const long long count = writeSome(fd_, data, bytes);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throwSystemError("Could not write", path_);
+            }
+            data += count;
+            bytes -= static_cast<std::size_t>(count);
+            written_ += static_cast<std::uint64_t>(count);
+        }
+    }
+
+    std::string path_;
+    int fd_ = -1;
+    std::vector<char> buffer_;
+    std::size_t used_ = 0;
+    std::uint64_t written_ = 0;
+};
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool isHeaderLine(std::string_view line) {
+    line = trim(line);
+    return !line.empty() && (std::isalpha(static_cast<unsigned char>(line.front())) || line.front() == '_');
+}
+
+/**
+ * @brief Per-job state: compiled formula plus the cache-resident chunk buffers
+ */
+class BatchJob {
+public:
+    BatchJob(const Expression& expression, const BatchOptions& options)
+        : expression_(expression), options_(options), variables_(expression.variables().size()),
+          columns_(variables_ * BatchProcessor::kChunkRows), results_(BatchProcessor::kChunkRows),
+          zeroMask_(Calculator::zeroMaskWords(BatchProcessor::kChunkRows)), spans_(variables_) {
+        columnToVariable_.resize(variables_);
+        for (std::size_t v = 0; v < variables_; ++v) {
+            columnToVariable_[v] = v;
+        }
+    }
+
+    BatchStats run() {
+        InputStream input(options_.inputPath);
+        OutputStream output(options_.outputPath);
+        if (options_.inputFormat == BatchFormat::Binary) {
+            readBinary(input, output);
+        } else {
+            readCsv(input, output);
+        }
+        output.flush();
+        stats_.bytesRead = input.consumedBytes();
+        stats_.bytesWritten = output.writtenBytes();
+        return stats_;
+    }
+
+private:
+    double* column(std::size_t variable) { return columns_.data() + variable * BatchProcessor::kChunkRows; }
+
+    void readBinary(InputStream& input, OutputStream& output) {
+        const std::size_t rowBytes = variables_ * sizeof(double);
+        while (true) {
+            const std::string_view bytes = input.available();
+            const std::size_t rows = std::min(bytes.size() / rowBytes, BatchProcessor::kChunkRows);
+            if (rows == 0) {
+                if (input.refill()) {
+                    continue;
+                }
+                if (!bytes.empty()) {
+                    throw std::runtime_error("Binary input ends with a partial row");
+                }
+                return;
+            }
+
+            // Transpose interleaved rows into one column per variable.
+            const char* src = bytes.data();
+            for (std::size_t r = 0; r < rows; ++r) {
+                for (std::size_t v = 0; v < variables_; ++v) {
+                    std::memcpy(column(v) + r, src, sizeof(double));
+                    src += sizeof(double);
+                }
+            }
+            input.consume(rows * rowBytes);
+            evaluateChunk(rows, output);
+        }
+    }
+
+    void readCsv(InputStream& input, OutputStream& output) {
+        bool firstLine = true;
+        std::size_t rows = 0;
+        while (true) {
+            const std::string_view bytes = input.available();
+            std::size_t offset = 0;
+            bool needMore = false;
+            while (rows < BatchProcessor::kChunkRows && offset < bytes.size()) {
+                const char* start = bytes.data() + offset;
+                const void* newline = std::memchr(start, '\n', bytes.size() - offset);
+                if (newline == nullptr && !input.eof()) {
+                    needMore = true;
+                    break;
+                }
+                const std::size_t length =
+                    newline == nullptr ? bytes.size() - offset : static_cast<std::size_t>(static_cast<const char*>(newline) - start);
+                const std::string_view line(start, length);
+                offset += length + (newline == nullptr ? 0 : 1);
+                ++lineNumber_;
+
+                if (firstLine) {
+                    firstLine = false;
+                    if (isHeaderLine(line)) {
+                        bindHeader(line);
+                        continue;
+                    }
+                }
+                if (trim(line).empty()) {
+                    continue;
+                }
+                parseCsvRow(line, rows++);
+            }
+            input.consume(offset);
+
+            if (rows == BatchProcessor::kChunkRows) {
+                evaluateChunk(rows, output);
+                rows = 0;
+            } else if (needMore || offset == 0) {
+                if (!input.refill() && input.available().empty()) {
+                    break;
+                }
+            }
+        }
+        if (rows > 0) {
+            evaluateChunk(rows, output);
+        }
+    }
+
+    void bindHeader(std::string_view line) {
+        columnToVariable_.clear();
+        std::vector<bool> bound(variables_, false);
+        while (true) {
+            const std::size_t comma = line.find(',');
+            const std::size_t variable = expression_.variableIndex(trim(line.substr(0, comma)));
+            columnToVariable_.push_back(variable);
+            if (variable < variables_) {
+                bound[variable] = true;
+            }
+            if (comma == std::string_view::npos) {
+                break;
+            }
+            line.remove_prefix(comma + 1);
+        }
+        for (std::size_t v = 0; v < variables_; ++v) {
+            if (!bound[v]) {
+                throw std::runtime_error("CSV header has no column for variable " + expression_.variables()[v]);
+            }
+        }
+    }
+
+    void parseCsvRow(std::string_view line, std::size_t row) {
+        std::size_t columnIndex = 0;
+        const char* p = line.data();
+        const char* end = line.data() + line.size();
+        while (true) {
+            while (p < end && (*p == ' ' || *p == '\t')) {
+                ++p;
+            }
+            if (columnIndex >= columnToVariable_.size()) {
+                malformedRow();
+            }
+            double value = 0.0;
+            const auto [next, ec] = std::from_chars(p, end, value);
+            if (ec != std::errc()) {
+                malformedRow();
+            }
+            const std::size_t variable = columnToVariable_[columnIndex++];
+            if (variable < variables_) {
+                column(variable)[row] = value;
+            }
+            p = next;
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+                ++p;
+            }
+            if (p == end) {
+                break;
+            }
+            if (*p != ',') {
+                malformedRow();
+            }
+            ++p;
+        }
+        if (columnIndex != columnToVariable_.size()) {
+            malformedRow();
+        }
+    }
+
+    [[noreturn]] void malformedRow() const {
+        throw std::runtime_error("Malformed CSV row at line " + std::to_string(lineNumber_));
+    }
+
+    void evaluateChunk(std::size_t rows, OutputStream& output) {
+        for (std::size_t v = 0; v < variables_; ++v) {
+            spans_[v] = std::span<const double>(column(v), rows);
+        }
+        stats_.zeroDivisorRows += expression_.evaluate(spans_, std::span<double>(results_.data(), rows), zeroMask_);
+        stats_.rows += rows;
+
+        if (options_.outputFormat == BatchFormat::Binary) {
+            output.append(results_.data(), rows * sizeof(double));
+            return;
+        }
+        constexpr std::size_t kMaxNumberChars = 32;
+        for (std::size_t r = 0; r < rows; ++r) {
+            char* text = output.reserve(kMaxNumberChars + 1);
+            char* last = std::to_chars(text, text + kMaxNumberChars, results_[r]).ptr;
+            *last++ = '\n';
+            output.commit(static_cast<std::size_t>(last - text));
+        }
+    }
+
+    const Expression& expression_;
+    const BatchOptions& options_;
+    std::size_t variables_;
+    std::vector<double> columns_;
+    std::vector<double> results_;
+    std::vector<std::uint64_t> zeroMask_;
+    std::vector<std::span<const double>> spans_;
+    std::vector<std::size_t> columnToVariable_;  ///< CSV column -> variable, variables_ if unused
+    std::size_t lineNumber_ = 0;
+    BatchStats stats_;
+};
+
+} // namespace
+
+BatchProcessor::BatchProcessor(BatchOptions options)
+    : options_(std::move(options)), expression_(Expression::compile(expandOperation(options_.formula))) {
+    if (expression_.variables().empty()) {
+        throw std::invalid_argument("Batch formula must use at least one variable");
+    }
+}
+
+BatchStats BatchProcessor::run() {
+    const auto start = std::chrono::steady_clock::now();
+    BatchStats stats = BatchJob(expression_, options_).run();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+std::string BatchProcessor::expandOperation(const std::string& formula) {
+    if (formula == "add") {
+        return "a + b";
+    }
+    if (formula == "subtract") {
+        return "a - b";
+    }
+    if (formula == "multiply") {
+        return "a * b";
+    }
+    if (formula == "divide") {
+        return "a / b";
+    }
+    return formula;
+}
+
+BatchFormat BatchProcessor::formatForPath(const std::string& path) {
+    const std::size_t dot = path.rfind('.');
+    if (dot != std::string::npos) {
+        const std::string extension = path.substr(dot + 1);
+        if (extension == "csv" || extension == "txt") {
+            return BatchFormat::Csv;
+        }
+    }
+    return BatchFormat::Binary;
+}
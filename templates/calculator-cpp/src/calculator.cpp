@@ -14,8 +14,9 @@ double Calculator::multiply(double a, double b) {
 }
 
 double Calculator::divide(double a, double b) {
-    if (b == 0.0) {
-        throw std::invalid_argument("Division by zero is not allowed");
-    }
-    return a / b;
-}
\ No newline at end of file
+    return divide<ThrowPolicy>(a, b);
+}
+
+ThrowPolicy::Result ThrowPolicy::divisionByZero(double, double) {
+    throw std::invalid_argument("Division by zero is not allowed");
+}
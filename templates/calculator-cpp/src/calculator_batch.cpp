@@ -0,0 +1,678 @@
+#include "calculator.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define CALCULATOR_HAS_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define CALCULATOR_HAS_X86_SIMD 0
+#endif
+
+// GCC and Clang only emit AVX2 instructions inside functions that opt in,
+// which lets the AVX2 kernels live next to the baseline ones without
+// compiling the whole library with -mavx2.
+#if CALCULATOR_HAS_X86_SIMD && (defined(__GNUC__) || defined(__clang__))
+#define CALCULATOR_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CALCULATOR_TARGET_AVX2
+#endif
+
+namespace {
+
+using BinaryKernel = void (*)(const double*, const double*, double*, std::size_t);
+using DivideKernel = std::size_t (*)(const double*, const double*, double*, std::uint64_t*, std::size_t);
+using SumKernel = double (*)(const double*, std::size_t);
+using DotKernel = double (*)(const double*, const double*, std::size_t);
+using DeviationKernel = double (*)(const double*, std::size_t, double, double*);
+using MinMaxKernel = Calculator::MinMax (*)(const double*, std::size_t);
+
+struct KernelTable {
+    Calculator::SimdLevel level;
+    BinaryKernel add;
+    BinaryKernel subtract;
+    BinaryKernel multiply;
+    DivideKernel divide;
+    SumKernel sum;
+    DotKernel dot;
+    DeviationKernel squaredDeviations;
+    MinMaxKernel minMax;
+};
+
+/**
+ * @brief Running sum that also keeps the exact rounding error of every addition
+ *
+ * Each addition goes through TwoSum, which recovers the rounding error of
+ * s + x exactly whatever the magnitudes, so the result is as accurate as if
+ * the sum had been computed in twice the precision and then rounded. The
+ * SIMD kernels run the same steps lane-wise on several independent
+ * accumulators and merge the lanes through this type at the end.
+ */
+struct CompensatedSum {
+    double sum = 0.0;
+    double error = 0.0;
+
+    void add(double x) {
+        const double t = sum + x;
+        const double z = t - sum;
+        error += (sum - (t - z)) + (x - z);
+        sum = t;
+    }
+
+    void merge(const double* sums, const double* errors, std::size_t lanes) {
+        for (std::size_t i = 0; i < lanes; ++i) {
+            add(sums[i]);
+            error += errors[i];
+        }
+    }
+
+    double value() const { return sum + error; }
+};
+
+constexpr std::size_t kScalarLanes = 4;
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// Scalar fallback ---------------------------------------------------------
+
+void addScalar(const double* a, const double* b, double* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+void subtractScalar(const double* a, const double* b, double* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = a[i] - b[i];
+    }
+}
+
+void multiplyScalar(const double* a, const double* b, double* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+std::size_t divideTail(const double* a, const double* b, double* out, std::uint64_t* mask,
+                       std::size_t begin, std::size_t n) {
+    std::size_t zeros = 0;
+    for (std::size_t i = begin; i < n; ++i) {
+        if (b[i] == 0.0) {
+            mask[i >> 6] |= std::uint64_t{1} << (i & 63);
+            ++zeros;
+        }
+        out[i] = a[i] / b[i];
+    }
+    return zeros;
+}
+
+std::size_t divideScalar(const double* a, const double* b, double* out, std::uint64_t* mask, std::size_t n) {
+    return divideTail(a, b, out, mask, 0, n);
+}
+
+double sumScalar(const double* x, std::size_t n) {
+    CompensatedSum lanes[kScalarLanes];
+    std::size_t i = 0;
+    for (; i + kScalarLanes <= n; i += kScalarLanes) {
+        for (std::size_t k = 0; k < kScalarLanes; ++k) {
+            lanes[k].add(x[i + k]);
+        }
+    }
+    CompensatedSum total;
+    for (; i < n; ++i) {
+        total.add(x[i]);
+    }
+    for (const CompensatedSum& lane : lanes) {
+        total.merge(&lane.sum, &lane.error, 1);
+    }
+    return total.value();
+}
+
+double dotScalar(const double* a, const double* b, std::size_t n) {
+    CompensatedSum lanes[kScalarLanes];
+    std::size_t i = 0;
+    for (; i + kScalarLanes <= n; i += kScalarLanes) {
+        for (std::size_t k = 0; k < kScalarLanes; ++k) {
+            lanes[k].add(a[i + k] * b[i + k]);
+        }
+    }
+    CompensatedSum total;
+    for (; i < n; ++i) {
+        total.add(a[i] * b[i]);
+    }
+    for (const CompensatedSum& lane : lanes) {
+        total.merge(&lane.sum, &lane.error, 1);
+    }
+    return total.value();
+}
+
+/// Accumulate (x - mean)^2 and x - mean over [begin, n)
+void squaredDeviationsTail(const double* x, std::size_t begin, std::size_t n, double mean,
+                           CompensatedSum& squares, CompensatedSum& deviations) {
+    for (std::size_t i = begin; i < n; ++i) {
+        const double d = x[i] - mean;
+        squares.add(d * d);
+        deviations.add(d);
+    }
+}
+
+/// Sum of (x - mean)^2, with the sum of (x - mean) stored in *deviationSum
+double squaredDeviationsScalar(const double* x, std::size_t n, double mean, double* deviationSum) {
+    CompensatedSum squares[kScalarLanes];
+    CompensatedSum deviations[kScalarLanes];
+    std::size_t i = 0;
+    for (; i + kScalarLanes <= n; i += kScalarLanes) {
+        for (std::size_t k = 0; k < kScalarLanes; ++k) {
+            const double d = x[i + k] - mean;
+            squares[k].add(d * d);
+            deviations[k].add(d);
+        }
+    }
+    CompensatedSum squareTotal;
+    CompensatedSum deviationTotal;
+    for (std::size_t k = 0; k < kScalarLanes; ++k) {
+        squareTotal.merge(&squares[k].sum, &squares[k].error, 1);
+        deviationTotal.merge(&deviations[k].sum, &deviations[k].error, 1);
+    }
+    squaredDeviationsTail(x, i, n, mean, squareTotal, deviationTotal);
+    *deviationSum = deviationTotal.value();
+    return squareTotal.value();
+}
+
+/// NaN anywhere makes both results NaN
+Calculator::MinMax minMaxTail(const double* x, std::size_t begin, std::size_t n, Calculator::MinMax result) {
+    for (std::size_t i = begin; i < n; ++i) {
+        if (std::isnan(x[i])) {
+            return {kNaN, kNaN};
+        }
+        result.min = std::min(result.min, x[i]);
+        result.max = std::max(result.max, x[i]);
+    }
+    return result;
+}
+
+Calculator::MinMax minMaxScalar(const double* x, std::size_t n) {
+    return minMaxTail(x, 0, n, {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()});
+}
+
+#if CALCULATOR_HAS_X86_SIMD
+
+// SSE2 kernels (baseline on x86-64) ---------------------------------------
+
+void addSse2(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    addScalar(a + i, b + i, out + i, n - i);
+}
+
+void subtractSse2(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    subtractScalar(a + i, b + i, out + i, n - i);
+}
+
+void multiplySse2(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    multiplyScalar(a + i, b + i, out + i, n - i);
+}
+
+std::size_t divideSse2(const double* a, const double* b, double* out, std::uint64_t* mask, std::size_t n) {
+    const __m128d zero = _mm_setzero_pd();
+    std::size_t zeros = 0;
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        const __m128d divisor = _mm_loadu_pd(b + i);
+        const unsigned bits = static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(divisor, zero)));
+        if (bits != 0) {
+            // Two-lane groups never straddle a 64-bit mask word.
+            mask[i >> 6] |= std::uint64_t{bits} << (i & 63);
+            zeros += static_cast<std::size_t>(std::popcount(bits));
+        }
+        _mm_storeu_pd(out + i, _mm_div_pd(_mm_loadu_pd(a + i), divisor));
+    }
+    return zeros + divideTail(a, b, out, mask, i, n);
+}
+
+inline void twoSumSse2(__m128d& sum, __m128d& error, __m128d x) {
+    const __m128d t = _mm_add_pd(sum, x);
+    const __m128d z = _mm_sub_pd(t, sum);
+    error = _mm_add_pd(error, _mm_add_pd(_mm_sub_pd(sum, _mm_sub_pd(t, z)), _mm_sub_pd(x, z)));
+    sum = t;
+}
+
+void mergeSse2(CompensatedSum& total, const __m128d* sums, const __m128d* errors, std::size_t count) {
+    for (std::size_t k = 0; k < count; ++k) {
+        double s[2];
+        double e[2];
+        _mm_storeu_pd(s, sums[k]);
+        _mm_storeu_pd(e, errors[k]);
+        total.merge(s, e, 2);
+    }
+}
+
+// Four independent accumulators hide the latency of the dependent adds.
+double sumSse2(const double* x, std::size_t n) {
+    __m128d sums[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+    __m128d errors[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (std::size_t k = 0; k < 4; ++k) {
+            twoSumSse2(sums[k], errors[k], _mm_loadu_pd(x + i + 2 * k));
+        }
+    }
+    CompensatedSum total;
+    mergeSse2(total, sums, errors, 4);
+    for (; i < n; ++i) {
+        total.add(x[i]);
+    }
+    return total.value();
+}
+
+double dotSse2(const double* a, const double* b, std::size_t n) {
+    __m128d sums[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+    __m128d errors[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (std::size_t k = 0; k < 4; ++k) {
+            const std::size_t j = i + 2 * k;
+            twoSumSse2(sums[k], errors[k], _mm_mul_pd(_mm_loadu_pd(a + j), _mm_loadu_pd(b + j)));
+        }
+    }
+    CompensatedSum total;
+    mergeSse2(total, sums, errors, 4);
+    for (; i < n; ++i) {
+        total.add(a[i] * b[i]);
+    }
+    return total.value();
+}
+
+double squaredDeviationsSse2(const double* x, std::size_t n, double mean, double* deviationSum) {
+    const __m128d m = _mm_set1_pd(mean);
+    __m128d squares[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+    __m128d squareErrors[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+    __m128d deviations[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+    __m128d deviationErrors[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (std::size_t k = 0; k < 2; ++k) {
+            const __m128d d = _mm_sub_pd(_mm_loadu_pd(x + i + 2 * k), m);
+            twoSumSse2(squares[k], squareErrors[k], _mm_mul_pd(d, d));
+            twoSumSse2(deviations[k], deviationErrors[k], d);
+        }
+    }
+    CompensatedSum squareTotal;
+    CompensatedSum deviationTotal;
+    mergeSse2(squareTotal, squares, squareErrors, 2);
+    mergeSse2(deviationTotal, deviations, deviationErrors, 2);
+    squaredDeviationsTail(x, i, n, mean, squareTotal, deviationTotal);
+    *deviationSum = deviationTotal.value();
+    return squareTotal.value();
+}
+
+Calculator::MinMax minMaxSse2(const double* x, std::size_t n) {
+    __m128d lo[2] = {_mm_set1_pd(std::numeric_limits<double>::infinity()),
+                     _mm_set1_pd(std::numeric_limits<double>::infinity())};
+    __m128d hi[2] = {_mm_set1_pd(-std::numeric_limits<double>::infinity()),
+                     _mm_set1_pd(-std::numeric_limits<double>::infinity())};
+    __m128d unordered = _mm_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (std::size_t k = 0; k < 2; ++k) {
+            const __m128d v = _mm_loadu_pd(x + i + 2 * k);
+            lo[k] = _mm_min_pd(lo[k], v);
+            hi[k] = _mm_max_pd(hi[k], v);
+            unordered = _mm_or_pd(unordered, _mm_cmpunord_pd(v, v));
+        }
+    }
+    if (_mm_movemask_pd(unordered) != 0) {
+        return {kNaN, kNaN};
+    }
+    double l[2];
+    double h[2];
+    _mm_storeu_pd(l, _mm_min_pd(lo[0], lo[1]));
+    _mm_storeu_pd(h, _mm_max_pd(hi[0], hi[1]));
+    return minMaxTail(x, i, n, {std::min(l[0], l[1]), std::max(h[0], h[1])});
+}
+
+// AVX2 kernels ------------------------------------------------------------
+
+CALCULATOR_TARGET_AVX2
+void addAvx2(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256d lo = _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        const __m256d hi = _mm256_add_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+        _mm256_storeu_pd(out + i, lo);
+        _mm256_storeu_pd(out + i + 4, hi);
+    }
+    addScalar(a + i, b + i, out + i, n - i);
+}
+
+CALCULATOR_TARGET_AVX2
+void subtractAvx2(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256d lo = _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        const __m256d hi = _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+        _mm256_storeu_pd(out + i, lo);
+        _mm256_storeu_pd(out + i + 4, hi);
+    }
+    subtractScalar(a + i, b + i, out + i, n - i);
+}
+
+CALCULATOR_TARGET_AVX2
+void multiplyAvx2(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256d lo = _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        const __m256d hi = _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4));
+        _mm256_storeu_pd(out + i, lo);
+        _mm256_storeu_pd(out + i + 4, hi);
+    }
+    multiplyScalar(a + i, b + i, out + i, n - i);
+}
+
+CALCULATOR_TARGET_AVX2
+std::size_t divideAvx2(const double* a, const double* b, double* out, std::uint64_t* mask, std::size_t n) {
+    const __m256d zero = _mm256_setzero_pd();
+    std::size_t zeros = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256d divisor = _mm256_loadu_pd(b + i);
+        const unsigned bits =
+            static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(divisor, zero, _CMP_EQ_OQ)));
+        if (bits != 0) {
+            // Four-lane groups never straddle a 64-bit mask word.
+            mask[i >> 6] |= std::uint64_t{bits} << (i & 63);
+            zeros += static_cast<std::size_t>(std::popcount(bits));
+        }
+        _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(a + i), divisor));
+    }
+    return zeros + divideTail(a, b, out, mask, i, n);
+}
+
+CALCULATOR_TARGET_AVX2
+inline void twoSumAvx2(__m256d& sum, __m256d& error, __m256d x) {
+    const __m256d t = _mm256_add_pd(sum, x);
+    const __m256d z = _mm256_sub_pd(t, sum);
+    error = _mm256_add_pd(error, _mm256_add_pd(_mm256_sub_pd(sum, _mm256_sub_pd(t, z)), _mm256_sub_pd(x, z)));
+    sum = t;
+}
+
+CALCULATOR_TARGET_AVX2
+void mergeAvx2(CompensatedSum& total, const __m256d* sums, const __m256d* errors, std::size_t count) {
+    for (std::size_t k = 0; k < count; ++k) {
+        double s[4];
+        double e[4];
+        _mm256_storeu_pd(s, sums[k]);
+        _mm256_storeu_pd(e, errors[k]);
+        total.merge(s, e, 4);
+    }
+}
+
+CALCULATOR_TARGET_AVX2
+double sumAvx2(const double* x, std::size_t n) {
+    __m256d sums[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256d errors[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        for (std::size_t k = 0; k < 4; ++k) {
+            twoSumAvx2(sums[k], errors[k], _mm256_loadu_pd(x + i + 4 * k));
+        }
+    }
+    CompensatedSum total;
+    mergeAvx2(total, sums, errors, 4);
+    for (; i < n; ++i) {
+        total.add(x[i]);
+    }
+    return total.value();
+}
+
+CALCULATOR_TARGET_AVX2
+double dotAvx2(const double* a, const double* b, std::size_t n) {
+    __m256d sums[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256d errors[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        for (std::size_t k = 0; k < 4; ++k) {
+            const std::size_t j = i + 4 * k;
+            twoSumAvx2(sums[k], errors[k], _mm256_mul_pd(_mm256_loadu_pd(a + j), _mm256_loadu_pd(b + j)));
+        }
+    }
+    CompensatedSum total;
+    mergeAvx2(total, sums, errors, 4);
+    for (; i < n; ++i) {
+        total.add(a[i] * b[i]);
+    }
+    return total.value();
+}
+
+CALCULATOR_TARGET_AVX2
+double squaredDeviationsAvx2(const double* x, std::size_t n, double mean, double* deviationSum) {
+    const __m256d m = _mm256_set1_pd(mean);
+    __m256d squares[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256d squareErrors[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256d deviations[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+    __m256d deviationErrors[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (std::size_t k = 0; k < 2; ++k) {
+            const __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4 * k), m);
+            twoSumAvx2(squares[k], squareErrors[k], _mm256_mul_pd(d, d));
+            twoSumAvx2(deviations[k], deviationErrors[k], d);
+        }
+    }
+    CompensatedSum squareTotal;
+    CompensatedSum deviationTotal;
+    mergeAvx2(squareTotal, squares, squareErrors, 2);
+    mergeAvx2(deviationTotal, deviations, deviationErrors, 2);
+    squaredDeviationsTail(x, i, n, mean, squareTotal, deviationTotal);
+    *deviationSum = deviationTotal.value();
+    return squareTotal.value();
+}
+
+CALCULATOR_TARGET_AVX2
+Calculator::MinMax minMaxAvx2(const double* x, std::size_t n) {
+    __m256d lo[2] = {_mm256_set1_pd(std::numeric_limits<double>::infinity()),
+                     _mm256_set1_pd(std::numeric_limits<double>::infinity())};
+    __m256d hi[2] = {_mm256_set1_pd(-std::numeric_limits<double>::infinity()),
+                     _mm256_set1_pd(-std::numeric_limits<double>::infinity())};
+    __m256d unordered = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (std::size_t k = 0; k < 2; ++k) {
+            const __m256d v = _mm256_loadu_pd(x + i + 4 * k);
+            lo[k] = _mm256_min_pd(lo[k], v);
+            hi[k] = _mm256_max_pd(hi[k], v);
+            unordered = _mm256_or_pd(unordered, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+        }
+    }
+    if (_mm256_movemask_pd(unordered) != 0) {
+        return {kNaN, kNaN};
+    }
+    double l[4];
+    double h[4];
+    _mm256_storeu_pd(l, _mm256_min_pd(lo[0], lo[1]));
+    _mm256_storeu_pd(h, _mm256_max_pd(hi[0], hi[1]));
+    return minMaxTail(x, i, n, {std::min({l[0], l[1], l[2], l[3]}), std::max({h[0], h[1], h[2], h[3]})});
+}
+
+bool cpuSupportsAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 1);
+    const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    const bool hasAvx = (info[2] & (1 << 28)) != 0;
+    __cpuidex(info, 7, 0);
+    const bool hasAvx2 = (info[1] & (1 << 5)) != 0;
+    return osSavesYmm && hasAvx && hasAvx2;
+#else
+    return false;
+#endif
+}
+
+#endif // CALCULATOR_HAS_X86_SIMD
+
+constexpr KernelTable kScalarKernels{Calculator::SimdLevel::Scalar, addScalar, subtractScalar, multiplyScalar,
+                                     divideScalar, sumScalar, dotScalar, squaredDeviationsScalar, minMaxScalar};
+#if CALCULATOR_HAS_X86_SIMD
+constexpr KernelTable kSse2Kernels{Calculator::SimdLevel::SSE2, addSse2, subtractSse2, multiplySse2, divideSse2,
+                                   sumSse2, dotSse2, squaredDeviationsSse2, minMaxSse2};
+constexpr KernelTable kAvx2Kernels{Calculator::SimdLevel::AVX2, addAvx2, subtractAvx2, multiplyAvx2, divideAvx2,
+                                   sumAvx2, dotAvx2, squaredDeviationsAvx2, minMaxAvx2};
+#endif
+
+const KernelTable* tableFor(Calculator::SimdLevel level) {
+#if CALCULATOR_HAS_X86_SIMD
+    switch (level) {
+    case Calculator::SimdLevel::AVX2:
+        return &kAvx2Kernels;
+    case Calculator::SimdLevel::SSE2:
+        return &kSse2Kernels;
+    case Calculator::SimdLevel::Scalar:
+        break;
+    }
+#else
+    (void)level;
+#endif
+    return &kScalarKernels;
+}
+
+Calculator::SimdLevel detectLevel() {
+#if CALCULATOR_HAS_X86_SIMD
+    return cpuSupportsAvx2() ? Calculator::SimdLevel::AVX2 : Calculator::SimdLevel::SSE2;
+#else
+    return Calculator::SimdLevel::Scalar;
+#endif
+}
+
+std::atomic<const KernelTable*>& activeKernels() {
+    static std::atomic<const KernelTable*> table{tableFor(detectLevel())};
+    return table;
+}
+
+const KernelTable& kernels() {
+    return *activeKernels().load(std::memory_order_relaxed);
+}
+
+void checkSizes(std::size_t a, std::size_t b, std::size_t out) {
+    if (a != b || a != out) {
+        throw std::invalid_argument("Batch operands and output must have the same size");
+    }
+}
+
+} // namespace
+
+void Calculator::add(std::span<const double> a, std::span<const double> b, std::span<double> out) {
+    checkSizes(a.size(), b.size(), out.size());
+    kernels().add(a.data(), b.data(), out.data(), a.size());
+}
+
+void Calculator::subtract(std::span<const double> a, std::span<const double> b, std::span<double> out) {
+    checkSizes(a.size(), b.size(), out.size());
+    kernels().subtract(a.data(), b.data(), out.data(), a.size());
+}
+
+void Calculator::multiply(std::span<const double> a, std::span<const double> b, std::span<double> out) {
+    checkSizes(a.size(), b.size(), out.size());
+    kernels().multiply(a.data(), b.data(), out.data(), a.size());
+}
+
+std::size_t Calculator::divide(std::span<const double> a, std::span<const double> b, std::span<double> out,
+                               std::span<std::uint64_t> zeroMask) {
+    checkSizes(a.size(), b.size(), out.size());
+    const std::size_t words = zeroMaskWords(a.size());
+    if (zeroMask.size() < words) {
+        throw std::invalid_argument("Zero-divisor mask is too small for the batch");
+    }
+    std::memset(zeroMask.data(), 0, words * sizeof(std::uint64_t));
+    return kernels().divide(a.data(), b.data(), out.data(), zeroMask.data(), a.size());
+}
+
+double Calculator::sum(std::span<const double> values) {
+    return kernels().sum(values.data(), values.size());
+}
+
+double Calculator::dot(std::span<const double> a, std::span<const double> b) {
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("Dot product operands must have the same size");
+    }
+    return kernels().dot(a.data(), b.data(), a.size());
+}
+
+double Calculator::mean(std::span<const double> values) {
+    if (values.empty()) {
+        throw std::invalid_argument("Cannot reduce an empty array");
+    }
+    return kernels().sum(values.data(), values.size()) / static_cast<double>(values.size());
+}
+
+double Calculator::variance(std::span<const double> values, bool sample) {
+    const std::size_t n = values.size();
+    if (n == 0 || (sample && n == 1)) {
+        throw std::invalid_argument("Not enough values for a variance");
+    }
+    // Corrected two-pass algorithm: the second term cancels the error left
+    // by the rounded mean, so large offsets do not swamp small spreads.
+    const KernelTable& table = kernels();
+    const double mean = table.sum(values.data(), n) / static_cast<double>(n);
+    double deviations = 0.0;
+    const double squares = table.squaredDeviations(values.data(), n, mean, &deviations);
+    const double centered = squares - deviations * deviations / static_cast<double>(n);
+    return std::max(0.0, centered) / static_cast<double>(sample ? n - 1 : n);
+}
+
+Calculator::MinMax Calculator::minMax(std::span<const double> values) {
+    if (values.empty()) {
+        throw std::invalid_argument("Cannot reduce an empty array");
+    }
+    return kernels().minMax(values.data(), values.size());
+}
+
+Calculator::SimdLevel Calculator::simdLevel() {
+    return kernels().level;
+}
+
+Calculator::SimdLevel Calculator::detectedSimdLevel() {
+    static const SimdLevel detected = detectLevel();
+    return detected;
+}
+
+Calculator::SimdLevel Calculator::setSimdLevel(SimdLevel level) {
+    const SimdLevel supported = detectedSimdLevel();
+    if (static_cast<int>(level) > static_cast<int>(supported)) {
+        level = supported;
+    }
+    activeKernels().store(tableFor(level), std::memory_order_relaxed);
+    return level;
+}
+
+const char* Calculator::simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::SSE2:
+        return "sse2";
+    case SimdLevel::Scalar:
+        break;
+    }
+    return "scalar";
+}
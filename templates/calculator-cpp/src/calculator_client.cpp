@@ -0,0 +1,130 @@
+#include "calculator_client.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::size_t kReadBytes = 64 * 1024;
+
+[[noreturn]] void throwSystemError(const std::string& what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+CalculatorClient::CalculatorClient(const std::string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        throwSystemError("Could not create socket");
+    }
+    if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        const int error = errno;
+        ::close(fd_);
+        errno = error;
+        throwSystemError("Could not connect to " + socketPath);
+    }
+}
+
+CalculatorClient::~CalculatorClient() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+std::uint32_t CalculatorClient::send(ServerOp op, std::span<const double> values, std::string_view formula) {
+    const std::uint32_t id = nextId_++;
+    ServerProtocol::appendRequest(output_, id, op, values, formula);
+    return id;
+}
+
+std::uint32_t CalculatorClient::send(ServerOp op, double a, double b) {
+    const double values[2] = {a, b};
+    return send(op, values);
+}
+
+void CalculatorClient::flush() {
+    std::size_t offset = 0;
+    while (offset < output_.size()) {
+        const ssize_t n = ::send(fd_, output_.data() + offset, output_.size() - offset, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throwSystemError("Could not send request");
+        }
+        offset += static_cast<std::size_t>(n);
+    }
+    output_.clear();
+}
+
+ServerResponse CalculatorClient::receive() {
+    if (!output_.empty()) {
+        flush();
+    }
+    while (true) {
+        const std::size_t available = input_.size() - inputOffset_;
+        if (available >= ServerProtocol::kHeaderBytes) {
+            const ServerProtocol::Header header = ServerProtocol::readHeader(input_.data() + inputOffset_);
+            if (header.size < ServerProtocol::kHeaderBytes || header.size > ServerProtocol::kMaxFrameBytes) {
+                throw std::runtime_error("Malformed response from server");
+            }
+            if (available >= header.size) {
+                ServerResponse response;
+                response.id = header.id;
+                response.status = static_cast<ServerStatus>(header.code);
+                const char* payload = input_.data() + inputOffset_ + ServerProtocol::kHeaderBytes;
+                const std::size_t payloadBytes = header.size - ServerProtocol::kHeaderBytes;
+                if (response.status == ServerStatus::Ok && payloadBytes == sizeof(double)) {
+                    std::memcpy(&response.value, payload, sizeof(double));
+                } else {
+                    response.error.assign(payload, payloadBytes);
+                }
+                inputOffset_ += header.size;
+                return response;
+            }
+        }
+
+        // Need more bytes: drop what was consumed, then read.
+        input_.erase(0, inputOffset_);
+        inputOffset_ = 0;
+        const std::size_t used = input_.size();
+        input_.resize(used + kReadBytes);
+        const ssize_t n = ::recv(fd_, input_.data() + used, kReadBytes, 0);
+        input_.resize(used + static_cast<std::size_t>(n > 0 ? n : 0));
+        if (n == 0) {
+            throw std::runtime_error("Server closed the connection");
+        }
+        if (n < 0 && errno != EINTR) {
+            throwSystemError("Could not receive response");
+        }
+    }
+}
+
+double CalculatorClient::call(ServerOp op, double a, double b) {
+    send(op, a, b);
+    ServerResponse response = receive();
+    if (response.status != ServerStatus::Ok) {
+        throw std::invalid_argument(response.error);
+    }
+    return response.value;
+}
+
+double CalculatorClient::evaluate(std::string_view formula, std::span<const double> values) {
+    send(ServerOp::Evaluate, values, formula);
+    ServerResponse response = receive();
+    if (response.status != ServerStatus::Ok) {
+        throw std::invalid_argument(response.error);
+    }
+    return response.value;
+}
@@ -0,0 +1,497 @@
+#include "calculator_server.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "calculator.h"
+#include "expression_cache.h"
+
+namespace {
+
+/// epoll tags of the two non-connection descriptors; connections use 2, 3, ...
+constexpr std::uint64_t kListenTag = 0;
+constexpr std::uint64_t kWakeTag = 1;
+constexpr std::uint64_t kFirstConnectionTag = 2;
+
+constexpr int kMaxEvents = 64;
+constexpr std::size_t kReadBytes = 64 * 1024;
+
+[[noreturn]] void throwSystemError(const std::string& what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+template <typename T>
+void put(std::string& out, std::size_t offset, T value) {
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+/// Append a header with a zero size field; finishFrame() fills it in
+std::size_t beginFrame(std::string& out, std::uint32_t id, std::uint8_t code, std::uint16_t count) {
+    const std::size_t start = out.size();
+    out.resize(start + ServerProtocol::kHeaderBytes);
+    put<std::uint32_t>(out, start, 0);
+    put<std::uint32_t>(out, start + 4, id);
+    put<std::uint8_t>(out, start + 8, code);
+    put<std::uint8_t>(out, start + 9, 0);
+    put<std::uint16_t>(out, start + 10, count);
+    return start;
+}
+
+void finishFrame(std::string& out, std::size_t start) {
+    put<std::uint32_t>(out, start, static_cast<std::uint32_t>(out.size() - start));
+}
+
+void appendDouble(std::string& out, double value) {
+    const std::size_t offset = out.size();
+    out.resize(offset + sizeof(double));
+    put(out, offset, value);
+}
+
+double binary(ServerOp op, double a, double b) {
+    switch (op) {
+    case ServerOp::Add:
+        return Calculator::add(a, b);
+    case ServerOp::Subtract:
+        return Calculator::subtract(a, b);
+    case ServerOp::Multiply:
+        return Calculator::multiply(a, b);
+    default:
+        return Calculator::divide(a, b);
+    }
+}
+
+} // namespace
+
+ServerProtocol::Header ServerProtocol::readHeader(const char* data) {
+    Header header;
+    std::memcpy(&header.size, data, 4);
+    std::memcpy(&header.id, data + 4, 4);
+    std::memcpy(&header.code, data + 8, 1);
+    std::memcpy(&header.count, data + 10, 2);
+    return header;
+}
+
+void ServerProtocol::appendRequest(std::string& out, std::uint32_t id, ServerOp op, std::span<const double> values,
+                                   std::string_view formula) {
+    if (kHeaderBytes + values.size() * sizeof(double) + formula.size() > kMaxFrameBytes) {
+        throw std::invalid_argument("Request exceeds the maximum frame size");
+    }
+    const std::size_t start = beginFrame(out, id, static_cast<std::uint8_t>(op), static_cast<std::uint16_t>(values.size()));
+    for (double value : values) {
+        appendDouble(out, value);
+    }
+    out.append(formula);
+    finishFrame(out, start);
+}
+
+void ServerProtocol::appendResult(std::string& out, std::uint32_t id, double value) {
+    const std::size_t start = beginFrame(out, id, static_cast<std::uint8_t>(ServerStatus::Ok), 0);
+    appendDouble(out, value);
+    finishFrame(out, start);
+}
+
+void ServerProtocol::appendError(std::string& out, std::uint32_t id, ServerStatus status, std::string_view message) {
+    const std::size_t start = beginFrame(out, id, static_cast<std::uint8_t>(status), 0);
+    out.append(message.substr(0, kMaxFrameBytes - kHeaderBytes));
+    finishFrame(out, start);
+}
+
+/**
+ * @brief Per-connection state, owned by the event loop
+ *
+ * While busy is set, a worker owns batch and responses and the event loop
+ * touches neither.
+ */
+struct CalculatorServer::Connection {
+    std::uint64_t tag = 0;
+    int fd = -1;                  ///< -1 once closed; the entry lives on until its batch returns
+    std::string input;            ///< Received bytes not yet handed to a worker
+    std::string output;           ///< Encoded responses not yet sent
+    std::size_t outputOffset = 0; ///< Start of the unsent part of output
+    std::string batch;            ///< Complete request frames being evaluated
+    std::string responses;        ///< Responses to batch
+    std::size_t batchRequests = 0;
+    std::uint32_t events = 0;     ///< Currently registered epoll events, 0 if not registered
+    bool busy = false;
+    bool peerClosed = false;
+    bool failed = false;
+};
+
+CalculatorServer::CalculatorServer(ServerOptions options) : options_(std::move(options)) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options_.socketPath.empty() || options_.socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid socket path: " + options_.socketPath);
+    }
+    std::memcpy(address.sun_path, options_.socketPath.c_str(), options_.socketPath.size() + 1);
+
+    // Replace the socket file of a previous run, but never any other file.
+    struct stat info {};
+    if (::lstat(options_.socketPath.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            throw std::runtime_error("Not a socket: " + options_.socketPath);
+        }
+        ::unlink(options_.socketPath.c_str());
+    }
+
+    try {
+        listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd_ < 0) {
+            throwSystemError("Could not create socket");
+        }
+        if (::bind(listenFd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            throwSystemError("Could not bind " + options_.socketPath);
+        }
+        if (::listen(listenFd_, SOMAXCONN) != 0) {
+            throwSystemError("Could not listen on " + options_.socketPath);
+        }
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd_ < 0 || wakeFd_ < 0) {
+            throwSystemError("Could not create event loop");
+        }
+        epoll_event listenEvent{EPOLLIN, {.u64 = kListenTag}};
+        epoll_event wakeEvent{EPOLLIN, {.u64 = kWakeTag}};
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &listenEvent) != 0 ||
+            ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &wakeEvent) != 0) {
+            throwSystemError("Could not create event loop");
+        }
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+CalculatorServer::~CalculatorServer() {
+    release();
+}
+
+void CalculatorServer::release() {
+    for (auto& [tag, connection] : connections_) {
+        if (connection->fd >= 0) {
+            ::close(connection->fd);
+        }
+    }
+    connections_.clear();
+    for (int fd : {listenFd_, epollFd_, wakeFd_}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    if (listenFd_ >= 0) {
+        ::unlink(options_.socketPath.c_str());
+    }
+    listenFd_ = epollFd_ = wakeFd_ = -1;
+}
+
+void CalculatorServer::run() {
+    std::size_t workerCount = options_.workers;
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workersStopping_ = false;
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+
+    epoll_event events[kMaxEvents];
+    while (!stopping_.load(std::memory_order_acquire)) {
+        const int ready = ::epoll_wait(epollFd_, events, kMaxEvents, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            stop();
+            break;
+        }
+        for (int i = 0; i < ready; ++i) {
+            const std::uint64_t tag = events[i].data.u64;
+            if (tag == kListenTag) {
+                acceptConnections();
+            } else if (tag == kWakeTag) {
+                std::uint64_t count = 0;
+                [[maybe_unused]] ssize_t drained = ::read(wakeFd_, &count, sizeof(count));
+                finishBatches();
+            } else {
+                const auto it = connections_.find(tag);
+                if (it == connections_.end() || it->second->fd < 0) {
+                    continue;
+                }
+                Connection& connection = *it->second;
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    readFrom(connection);
+                }
+                if (events[i].events & EPOLLOUT) {
+                    writeTo(connection);
+                }
+                service(connection);
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        workersStopping_ = true;
+    }
+    queueReady_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+    queue_.clear();
+    finished_.clear();
+    for (auto& [tag, connection] : connections_) {
+        if (connection->fd >= 0) {
+            ::close(connection->fd);
+        }
+    }
+    connections_.clear();
+}
+
+void CalculatorServer::stop() {
+    // Only an atomic store and write(), so this is async-signal-safe.
+    stopping_.store(true, std::memory_order_release);
+    const std::uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+}
+
+ServerStats CalculatorServer::stats() const {
+    ServerStats stats;
+    stats.connections = connectionCount_.load(std::memory_order_relaxed);
+    stats.requests = requestCount_.load(std::memory_order_relaxed);
+    stats.batches = batchCount_.load(std::memory_order_relaxed);
+    stats.protocolErrors = protocolErrorCount_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void CalculatorServer::acceptConnections() {
+    while (true) {
+        const int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // EAGAIN: no more pending connections. Anything else (e.g. out of
+            // descriptors) is retried on the next wakeup.
+            return;
+        }
+        auto connection = std::make_unique<Connection>();
+        connection->tag = kFirstConnectionTag + nextConnection_++;
+        connection->fd = fd;
+        connection->events = EPOLLIN;
+        epoll_event event{EPOLLIN, {.u64 = connection->tag}};
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_.emplace(connection->tag, std::move(connection));
+        connectionCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void CalculatorServer::readFrom(Connection& connection) {
+    while (!connection.peerClosed && connection.input.size() < kMaxBufferedBytes) {
+        const std::size_t used = connection.input.size();
+        connection.input.resize(used + kReadBytes);
+        const ssize_t n = ::recv(connection.fd, connection.input.data() + used, kReadBytes, 0);
+        connection.input.resize(used + static_cast<std::size_t>(std::max<ssize_t>(n, 0)));
+        if (n > 0) {
+            continue;
+        }
+        if (n == 0) {
+            connection.peerClosed = true;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            connection.failed = true;
+        }
+        return;
+    }
+}
+
+void CalculatorServer::writeTo(Connection& connection) {
+    while (connection.outputOffset < connection.output.size()) {
+        const ssize_t n = ::send(connection.fd, connection.output.data() + connection.outputOffset,
+                                 connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                connection.failed = true;
+            }
+            if (errno != EINTR) {
+                return;
+            }
+            continue;
+        }
+        connection.outputOffset += static_cast<std::size_t>(n);
+    }
+    connection.output.clear();
+    connection.outputOffset = 0;
+}
+
+void CalculatorServer::dispatch(Connection& connection) {
+    // Hand every complete frame received so far to one worker.
+    std::size_t end = 0;
+    std::size_t requests = 0;
+    while (connection.input.size() - end >= ServerProtocol::kHeaderBytes) {
+        const ServerProtocol::Header header = ServerProtocol::readHeader(connection.input.data() + end);
+        if (header.size < ServerProtocol::kHeaderBytes || header.size > ServerProtocol::kMaxFrameBytes) {
+            protocolErrorCount_.fetch_add(1, std::memory_order_relaxed);
+            connection.failed = true;
+            return;
+        }
+        if (connection.input.size() - end < header.size) {
+            break;
+        }
+        end += header.size;
+        ++requests;
+    }
+    if (requests == 0) {
+        return;
+    }
+
+    connection.batch.assign(connection.input, 0, end);
+    connection.input.erase(0, end);
+    connection.batchRequests = requests;
+    connection.busy = true;
+    batchCount_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        queue_.push_back(&connection);
+    }
+    queueReady_.notify_one();
+}
+
+void CalculatorServer::finishBatches() {
+    std::vector<Connection*> finished;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        finished.swap(finished_);
+    }
+    for (Connection* connection : finished) {
+        connection->busy = false;
+        requestCount_.fetch_add(connection->batchRequests, std::memory_order_relaxed);
+        if (connection->fd < 0) {
+            connections_.erase(connection->tag);
+            continue;
+        }
+        if (connection->output.empty()) {
+            connection->output.swap(connection->responses);
+        } else {
+            connection->output.append(connection->responses);
+        }
+        connection->responses.clear();
+        writeTo(*connection);
+        service(*connection);
+    }
+}
+
+void CalculatorServer::service(Connection& connection) {
+    if (!connection.failed && !connection.busy && connection.output.size() < kMaxBufferedBytes) {
+        dispatch(connection);
+    }
+    const bool drained = !connection.busy && connection.output.empty();
+    if (connection.failed || (connection.peerClosed && drained)) {
+        close(connection);
+        return;
+    }
+
+    std::uint32_t events = 0;
+    if (!connection.peerClosed && connection.input.size() < kMaxBufferedBytes) {
+        events |= EPOLLIN;
+    }
+    if (!connection.output.empty()) {
+        events |= EPOLLOUT;
+    }
+    if (events != connection.events) {
+        // A descriptor with no events is removed rather than modified: epoll
+        // reports EPOLLHUP regardless of the mask, which would spin the loop
+        // while a closed peer's last batch is still being evaluated.
+        epoll_event event{events, {.u64 = connection.tag}};
+        const int operation = events == 0 ? EPOLL_CTL_DEL : connection.events == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        ::epoll_ctl(epollFd_, operation, connection.fd, &event);
+        connection.events = events;
+    }
+}
+
+void CalculatorServer::close(Connection& connection) {
+    if (connection.events != 0) {
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, connection.fd, nullptr);
+    }
+    ::close(connection.fd);
+    connection.fd = -1;
+    if (!connection.busy) {
+        connections_.erase(connection.tag);
+    }
+}
+
+void CalculatorServer::workerLoop() {
+    while (true) {
+        Connection* connection = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueReady_.wait(lock, [this] { return workersStopping_ || !queue_.empty(); });
+            if (workersStopping_) {
+                return;
+            }
+            connection = queue_.front();
+            queue_.pop_front();
+        }
+
+        execute(connection->batch, connection->responses);
+
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            wake = finished_.empty();
+            finished_.push_back(connection);
+        }
+        // One wakeup covers everything finished before the loop drains the list.
+        if (wake) {
+            const std::uint64_t one = 1;
+            [[maybe_unused]] ssize_t written = ::write(wakeFd_, &one, sizeof(one));
+        }
+    }
+}
+
+void CalculatorServer::execute(std::string_view frames, std::string& responses) {
+    thread_local std::vector<double> values;
+    responses.reserve(frames.size());
+    std::size_t offset = 0;
+    while (offset < frames.size()) {
+        const ServerProtocol::Header header = ServerProtocol::readHeader(frames.data() + offset);
+        const std::string_view payload = frames.substr(offset + ServerProtocol::kHeaderBytes,
+                                                       header.size - ServerProtocol::kHeaderBytes);
+        offset += header.size;
+
+        const std::size_t valueBytes = std::size_t{header.count} * sizeof(double);
+        if (valueBytes > payload.size()) {
+            ServerProtocol::appendError(responses, header.id, ServerStatus::BadRequest, "Frame too short for its values");
+            continue;
+        }
+        values.resize(header.count);
+        std::memcpy(values.data(), payload.data(), valueBytes);
+        const std::string_view formula = payload.substr(valueBytes);
+
+        const auto op = static_cast<ServerOp>(header.code);
+        try {
+            if (op == ServerOp::Evaluate) {
+                const double result = ExpressionCache::global().get(formula)->evaluate(values);
+                ServerProtocol::appendResult(responses, header.id, result);
+            } else if (op >= ServerOp::Add && op <= ServerOp::Divide) {
+                if (values.size() != 2 || !formula.empty()) {
+                    ServerProtocol::appendError(responses, header.id, ServerStatus::BadRequest,
+                                                "Expected exactly two operands");
+                    continue;
+                }
+                ServerProtocol::appendResult(responses, header.id, binary(op, values[0], values[1]));
+            } else {
+                ServerProtocol::appendError(responses, header.id, ServerStatus::BadRequest,
+                                            "Unknown operation " + std::to_string(header.code));
+            }
+        } catch (const std::exception& e) {
+            ServerProtocol::appendError(responses, header.id, ServerStatus::Error, e.what());
+        }
+    }
+}
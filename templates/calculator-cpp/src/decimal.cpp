@@ -0,0 +1,669 @@
+#include "decimal.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <span>
+#include <stdexcept>
+
+namespace {
+
+using Limbs = std::vector<std::uint32_t>;
+using Magnitude = std::span<const std::uint32_t>;
+
+constexpr std::uint64_t kBase = Decimal::kLimbBase;
+constexpr std::uint32_t kPowersOf10[] = {1,      10,      100,      1000,      10000,
+                                         100000, 1000000, 10000000, 100000000, 1000000000};
+
+// Limit on the exponent of parsed text, far beyond any representable scale.
+constexpr long kMaxExponent = 1'000'000;
+
+/**
+ * @brief Per-thread work buffers, so operations on warmed-up threads do not allocate
+ */
+struct Scratch {
+    Limbs a;
+    Limbs b;
+    Limbs result;
+    Limbs remainder;
+    Limbs dividend;
+    Limbs divisor;
+};
+
+Scratch& scratch() {
+    thread_local Scratch buffers;
+    return buffers;
+}
+
+void trim(Limbs& m) {
+    while (!m.empty() && m.back() == 0) {
+        m.pop_back();
+    }
+}
+
+int compareMagnitude(Magnitude a, Magnitude b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (std::size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+void multiplySmall(Limbs& m, std::uint32_t factor) {
+    std::uint64_t carry = 0;
+    for (std::uint32_t& limb : m) {
+        const std::uint64_t value = static_cast<std::uint64_t>(limb) * factor + carry;
+        limb = static_cast<std::uint32_t>(value % kBase);
+        carry = value / kBase;
+    }
+    while (carry != 0) {
+        m.push_back(static_cast<std::uint32_t>(carry % kBase));
+        carry /= kBase;
+    }
+}
+
+/// Divide in place and return the remainder
+std::uint32_t divideSmall(Limbs& m, std::uint32_t divisor) {
+    std::uint64_t remainder = 0;
+    for (std::size_t i = m.size(); i-- > 0;) {
+        const std::uint64_t value = remainder * kBase + m[i];
+        m[i] = static_cast<std::uint32_t>(value / divisor);
+        remainder = value % divisor;
+    }
+    trim(m);
+    return static_cast<std::uint32_t>(remainder);
+}
+
+/// Multiply by 10^digits: a small multiplication plus whole zero limbs
+void scaleUp(Limbs& m, int digits) {
+    if (m.empty() || digits == 0) {
+        return;
+    }
+    multiplySmall(m, kPowersOf10[digits % Decimal::kLimbDigits]);
+    m.insert(m.begin(), static_cast<std::size_t>(digits / Decimal::kLimbDigits), 0);
+}
+
+void increment(Limbs& m) {
+    for (std::uint32_t& limb : m) {
+        if (++limb < kBase) {
+            return;
+        }
+        limb = 0;
+    }
+    m.push_back(1);
+}
+
+void addMagnitude(Magnitude a, Magnitude b, Limbs& out) {
+    if (a.size() < b.size()) {
+        std::swap(a, b);
+    }
+    out.resize(a.size() + 1);
+    std::uint32_t carry = 0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        std::uint32_t sum = a[i] + (i < b.size() ? b[i] : 0) + carry;
+        carry = sum >= kBase ? 1 : 0;
+        out[i] = carry != 0 ? sum - static_cast<std::uint32_t>(kBase) : sum;
+    }
+    out[a.size()] = carry;
+    trim(out);
+}
+
+/// out = a - b for a >= b
+void subtractMagnitude(Magnitude a, Magnitude b, Limbs& out) {
+    out.resize(a.size());
+    std::uint32_t borrow = 0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        const std::uint32_t subtrahend = (i < b.size() ? b[i] : 0) + borrow;
+        borrow = a[i] < subtrahend ? 1 : 0;
+        out[i] = a[i] + (borrow != 0 ? static_cast<std::uint32_t>(kBase) : 0) - subtrahend;
+    }
+    trim(out);
+}
+
+void multiplyMagnitude(Magnitude a, Magnitude b, Limbs& out) {
+    out.assign(a.size() + b.size(), 0);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        std::uint64_t carry = 0;
+        for (std::size_t j = 0; j < b.size(); ++j) {
+            const std::uint64_t value = out[i + j] + static_cast<std::uint64_t>(a[i]) * b[j] + carry;
+            out[i + j] = static_cast<std::uint32_t>(value % kBase);
+            carry = value / kBase;
+        }
+        out[i + b.size()] = static_cast<std::uint32_t>(carry);
+    }
+    trim(out);
+}
+
+/**
+ * @brief Long division q = u / v, r = u % v for a non-zero v
+ *
+ * Knuth's algorithm D: both operands are normalized so the divisor's top
+ * limb is at least half the base, which keeps every estimated quotient limb
+ * at most two above the true one.
+ */
+void divideMagnitude(Magnitude u, Magnitude v, Limbs& q, Limbs& r) {
+    if (compareMagnitude(u, v) < 0) {
+        q.clear();
+        r.assign(u.begin(), u.end());
+        return;
+    }
+    if (v.size() == 1) {
+        q.assign(u.begin(), u.end());
+        const std::uint32_t remainder = divideSmall(q, v[0]);
+        r.clear();
+        if (remainder != 0) {
+            r.push_back(remainder);
+        }
+        return;
+    }
+
+    const std::size_t n = v.size();
+    const std::size_t m = u.size() - n;
+    const auto d = static_cast<std::uint32_t>(kBase / (static_cast<std::uint64_t>(v[n - 1]) + 1));
+
+    Limbs& un = scratch().dividend;
+    Limbs& vn = scratch().divisor;
+    un.assign(u.begin(), u.end());
+    multiplySmall(un, d);
+    un.resize(m + n + 1, 0);
+    vn.assign(v.begin(), v.end());
+    multiplySmall(vn, d);
+
+    q.assign(m + 1, 0);
+    for (std::size_t j = m + 1; j-- > 0;) {
+        const std::uint64_t numerator = static_cast<std::uint64_t>(un[j + n]) * kBase + un[j + n - 1];
+        std::uint64_t qhat = numerator / vn[n - 1];
+        std::uint64_t rhat = numerator % vn[n - 1];
+        while (qhat >= kBase || qhat * vn[n - 2] > rhat * kBase + un[j + n - 2]) {
+            --qhat;
+            rhat += vn[n - 1];
+            if (rhat >= kBase) {
+                break;
+            }
+        }
+
+        // un[j .. j + n] -= qhat * vn
+        std::uint64_t carry = 0;
+        std::int64_t borrow = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint64_t product = qhat * vn[i] + carry;
+            carry = product / kBase;
+            std::int64_t digit = static_cast<std::int64_t>(un[i + j]) - static_cast<std::int64_t>(product % kBase) - borrow;
+            borrow = digit < 0 ? 1 : 0;
+            un[i + j] = static_cast<std::uint32_t>(digit + borrow * static_cast<std::int64_t>(kBase));
+        }
+        std::int64_t top = static_cast<std::int64_t>(un[j + n]) - static_cast<std::int64_t>(carry) - borrow;
+        borrow = top < 0 ? 1 : 0;
+        un[j + n] = static_cast<std::uint32_t>(top + borrow * static_cast<std::int64_t>(kBase));
+
+        if (borrow != 0) {
+            // qhat was one too large: add the divisor back.
+            --qhat;
+            std::uint32_t addCarry = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                std::uint32_t sum = un[i + j] + vn[i] + addCarry;
+                addCarry = sum >= kBase ? 1 : 0;
+                un[i + j] = addCarry != 0 ? sum - static_cast<std::uint32_t>(kBase) : sum;
+            }
+            un[j + n] = static_cast<std::uint32_t>((un[j + n] + addCarry) % kBase);
+        }
+        q[j] = static_cast<std::uint32_t>(qhat);
+    }
+    trim(q);
+
+    r.assign(un.begin(), un.begin() + static_cast<std::ptrdiff_t>(n));
+    trim(r);
+    divideSmall(r, d);
+}
+
+/// q = u / v rounded half to even
+void divideRounded(Magnitude u, Magnitude v, Limbs& q) {
+    Limbs& r = scratch().remainder;
+    divideMagnitude(u, v, q, r);
+    if (r.empty()) {
+        return;
+    }
+    multiplySmall(r, 2);
+    const int half = compareMagnitude(r, v);
+    if (half > 0 || (half == 0 && !q.empty() && q[0] % 2 == 1)) {
+        increment(q);
+    }
+}
+
+void checkScale(long scale) {
+    if (scale < 0 || scale > Decimal::kMaxScale) {
+        throw std::invalid_argument("Decimal scale out of range");
+    }
+}
+
+} // namespace
+
+std::uint32_t* DecimalArena::allocate(std::size_t limbs) {
+    while (block_ < blocks_.size()) {
+        Block& block = blocks_[block_];
+        if (used_ + limbs <= block.size) {
+            std::uint32_t* storage = block.limbs.get() + used_;
+            used_ += limbs;
+            return storage;
+        }
+        ++block_;
+        used_ = 0;
+    }
+    const std::size_t size = std::max(kBlockLimbs, limbs);
+    blocks_.push_back(Block{std::unique_ptr<std::uint32_t[]>(new std::uint32_t[size]), size});
+    block_ = blocks_.size() - 1;
+    used_ = limbs;
+    return blocks_.back().limbs.get();
+}
+
+void DecimalArena::reset() {
+    block_ = 0;
+    used_ = 0;
+}
+
+std::size_t DecimalArena::bytesReserved() const {
+    std::size_t bytes = 0;
+    for (const Block& block : blocks_) {
+        bytes += block.size * sizeof(std::uint32_t);
+    }
+    return bytes;
+}
+
+Decimal::Decimal(long long value) : negative_(value < 0) {
+    unsigned long long magnitude = negative_ ? 0ULL - static_cast<unsigned long long>(value)
+                                             : static_cast<unsigned long long>(value);
+    while (magnitude != 0) {
+        inline_[size_++] = static_cast<std::uint32_t>(magnitude % kBase);
+        magnitude /= kBase;
+    }
+}
+
+Decimal::Decimal(const Decimal& other) : scale_(other.scale_), negative_(other.negative_) {
+    setMagnitude(other.limbs_, other.size_, nullptr);
+}
+
+Decimal::Decimal(Decimal&& other) noexcept : scale_(other.scale_), negative_(other.negative_) {
+    if (other.ownsHeap_) {
+        limbs_ = other.limbs_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        ownsHeap_ = true;
+        other.limbs_ = other.inline_;
+        other.size_ = 0;
+        other.capacity_ = kInlineLimbs;
+        other.ownsHeap_ = false;
+    } else {
+        setMagnitude(other.limbs_, other.size_, nullptr);
+    }
+}
+
+Decimal& Decimal::operator=(const Decimal& other) {
+    if (this != &other) {
+        setMagnitude(other.limbs_, other.size_, nullptr);
+        scale_ = other.scale_;
+        negative_ = other.negative_;
+    }
+    return *this;
+}
+
+Decimal& Decimal::operator=(Decimal&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    if (other.ownsHeap_) {
+        release();
+        limbs_ = other.limbs_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        ownsHeap_ = true;
+        other.limbs_ = other.inline_;
+        other.size_ = 0;
+        other.capacity_ = kInlineLimbs;
+        other.ownsHeap_ = false;
+    } else {
+        setMagnitude(other.limbs_, other.size_, nullptr);
+    }
+    scale_ = other.scale_;
+    negative_ = other.negative_;
+    return *this;
+}
+
+Decimal::~Decimal() {
+    release();
+}
+
+Decimal Decimal::parse(std::string_view text) {
+    const auto invalid = [&] { return std::invalid_argument("Invalid decimal number: " + std::string(text)); };
+
+    std::size_t pos = 0;
+    const bool negative = pos < text.size() && text[pos] == '-';
+    if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) {
+        ++pos;
+    }
+
+    const std::size_t mantissaBegin = pos;
+    long fractionDigits = 0;
+    bool digits = false;
+    bool point = false;
+    for (; pos < text.size() && text[pos] != 'e' && text[pos] != 'E'; ++pos) {
+        if (text[pos] >= '0' && text[pos] <= '9') {
+            digits = true;
+            fractionDigits += point ? 1 : 0;
+        } else if (text[pos] == '.' && !point) {
+            point = true;
+        } else {
+            throw invalid();
+        }
+    }
+    const std::size_t mantissaEnd = pos;
+    if (!digits) {
+        throw invalid();
+    }
+
+    long exponent = 0;
+    if (pos < text.size()) {
+        ++pos;
+        const bool negativeExponent = pos < text.size() && text[pos] == '-';
+        if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) {
+            ++pos;
+        }
+        if (pos == text.size()) {
+            throw invalid();
+        }
+        for (; pos < text.size(); ++pos) {
+            if (text[pos] < '0' || text[pos] > '9' || exponent > kMaxExponent) {
+                throw invalid();
+            }
+            exponent = exponent * 10 + (text[pos] - '0');
+        }
+        exponent = negativeExponent ? -exponent : exponent;
+    }
+
+    // Nine digits per limb, starting from the least significant digit.
+    Limbs& magnitude = scratch().result;
+    magnitude.clear();
+    std::uint32_t limb = 0;
+    std::size_t digitInLimb = 0;
+    for (std::size_t i = mantissaEnd; i-- > mantissaBegin;) {
+        if (text[i] == '.') {
+            continue;
+        }
+        limb += static_cast<std::uint32_t>(text[i] - '0') * kPowersOf10[digitInLimb];
+        if (++digitInLimb == kLimbDigits) {
+            magnitude.push_back(limb);
+            limb = 0;
+            digitInLimb = 0;
+        }
+    }
+    magnitude.push_back(limb);
+    trim(magnitude);
+
+    long scale = fractionDigits - exponent;
+    if (scale < 0) {
+        checkScale(-scale);
+        scaleUp(magnitude, static_cast<int>(-scale));
+        scale = 0;
+    }
+    checkScale(scale);
+
+    Decimal result;
+    result.setMagnitude(magnitude.data(), magnitude.size(), nullptr);
+    result.scale_ = static_cast<std::int32_t>(scale);
+    result.negative_ = negative && !magnitude.empty();
+    return result;
+}
+
+Decimal Decimal::fromDouble(double value) {
+    if (!std::isfinite(value)) {
+        throw std::invalid_argument("Cannot convert a non-finite double to Decimal");
+    }
+    char buffer[32];
+    const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    (void)ec;
+    return parse(std::string_view(buffer, static_cast<std::size_t>(end - buffer)));
+}
+
+void Decimal::add(const Decimal& a, const Decimal& b, Decimal& out, DecimalArena* arena) {
+    addSigned(a, b, false, out, arena);
+}
+
+void Decimal::subtract(const Decimal& a, const Decimal& b, Decimal& out, DecimalArena* arena) {
+    addSigned(a, b, true, out, arena);
+}
+
+void Decimal::addSigned(const Decimal& a, const Decimal& b, bool negateB, Decimal& out, DecimalArena* arena) {
+    Scratch& s = scratch();
+    const std::int32_t scale = std::max(a.scale_, b.scale_);
+    Magnitude ma(a.limbs_, a.size_);
+    Magnitude mb(b.limbs_, b.size_);
+    if (a.scale_ < scale) {
+        s.a.assign(ma.begin(), ma.end());
+        scaleUp(s.a, scale - a.scale_);
+        ma = s.a;
+    }
+    if (b.scale_ < scale) {
+        s.b.assign(mb.begin(), mb.end());
+        scaleUp(s.b, scale - b.scale_);
+        mb = s.b;
+    }
+
+    const bool negativeB = b.negative_ != negateB;
+    bool negative = a.negative_;
+    if (a.negative_ == negativeB) {
+        addMagnitude(ma, mb, s.result);
+    } else if (compareMagnitude(ma, mb) >= 0) {
+        subtractMagnitude(ma, mb, s.result);
+    } else {
+        subtractMagnitude(mb, ma, s.result);
+        negative = negativeB;
+    }
+
+    out.setMagnitude(s.result.data(), s.result.size(), arena);
+    out.scale_ = scale;
+    out.negative_ = negative && !s.result.empty();
+}
+
+void Decimal::multiply(const Decimal& a, const Decimal& b, Decimal& out, DecimalArena* arena) {
+    const long scale = static_cast<long>(a.scale_) + b.scale_;
+    checkScale(scale);
+    Limbs& result = scratch().result;
+    multiplyMagnitude(Magnitude(a.limbs_, a.size_), Magnitude(b.limbs_, b.size_), result);
+
+    out.setMagnitude(result.data(), result.size(), arena);
+    out.scale_ = static_cast<std::int32_t>(scale);
+    out.negative_ = a.negative_ != b.negative_ && !result.empty();
+}
+
+void Decimal::divide(const Decimal& a, const Decimal& b, Decimal& out, int scale, DecimalArena* arena) {
+    if (b.isZero()) {
+        throw std::invalid_argument("Division by zero is not allowed");
+    }
+    checkScale(scale);
+
+    // a / b * 10^scale = (A / B) * 10^(scale + b.scale - a.scale)
+    Scratch& s = scratch();
+    s.a.assign(a.limbs_, a.limbs_ + a.size_);
+    s.b.assign(b.limbs_, b.limbs_ + b.size_);
+    const int shift = scale + b.scale_ - a.scale_;
+    if (shift >= 0) {
+        scaleUp(s.a, shift);
+    } else {
+        scaleUp(s.b, -shift);
+    }
+    divideRounded(s.a, s.b, s.result);
+
+    // Drop trailing fractional zeros, whole limbs first.
+    Limbs& result = s.result;
+    int resultScale = result.empty() ? 0 : scale;
+    std::size_t zeroLimbs = 0;
+    while (resultScale >= kLimbDigits && zeroLimbs < result.size() && result[zeroLimbs] == 0) {
+        ++zeroLimbs;
+        resultScale -= kLimbDigits;
+    }
+    result.erase(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(zeroLimbs));
+    while (resultScale > 0 && result[0] % 10 == 0) {
+        divideSmall(result, 10);
+        --resultScale;
+    }
+
+    const bool negative = a.negative_ != b.negative_ && !result.empty();
+    out.setMagnitude(result.data(), result.size(), arena);
+    out.scale_ = resultScale;
+    out.negative_ = negative;
+}
+
+void Decimal::negate(const Decimal& a, Decimal& out, DecimalArena* arena) {
+    const bool negative = !a.negative_ && a.size_ != 0;
+    out.setMagnitude(a.limbs_, a.size_, arena);
+    out.scale_ = a.scale_;
+    out.negative_ = negative;
+}
+
+void Decimal::assign(const Decimal& a, Decimal& out, DecimalArena* arena) {
+    if (&a == &out) {
+        return;
+    }
+    out.setMagnitude(a.limbs_, a.size_, arena);
+    out.scale_ = a.scale_;
+    out.negative_ = a.negative_;
+}
+
+Decimal Decimal::rounded(int scale) const {
+    checkScale(scale);
+    Scratch& s = scratch();
+    s.a.assign(limbs_, limbs_ + size_);
+    if (scale >= scale_) {
+        scaleUp(s.a, scale - scale_);
+        s.result.swap(s.a);
+    } else {
+        s.b.assign(1, 1);
+        scaleUp(s.b, scale_ - scale);
+        divideRounded(s.a, s.b, s.result);
+    }
+
+    Decimal result;
+    result.setMagnitude(s.result.data(), s.result.size(), nullptr);
+    result.scale_ = scale;
+    result.negative_ = negative_ && !s.result.empty();
+    return result;
+}
+
+std::string Decimal::toString() const {
+    std::string digits;
+    if (size_ == 0) {
+        digits = "0";
+    } else {
+        digits = std::to_string(limbs_[size_ - 1]);
+        char limb[kLimbDigits];
+        for (std::size_t i = size_ - 1; i-- > 0;) {
+            std::uint32_t value = limbs_[i];
+            for (int d = kLimbDigits; d-- > 0;) {
+                limb[d] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+            digits.append(limb, kLimbDigits);
+        }
+    }
+
+    // Assembled into a second string: inserting into digits trips GCC's -Wrestrict at -O3
+    const auto fraction = static_cast<std::size_t>(scale_);
+    std::string text;
+    text.reserve(digits.size() + fraction + 3);
+    if (negative_) {
+        text += '-';
+    }
+    if (fraction == 0) {
+        text += digits;
+    } else if (digits.size() <= fraction) {
+        text += "0.";
+        text.append(fraction - digits.size(), '0');
+        text += digits;
+    } else {
+        const std::size_t whole = digits.size() - fraction;
+        text.append(digits, 0, whole);
+        text += '.';
+        text.append(digits, whole, fraction);
+    }
+    return text;
+}
+
+double Decimal::toDouble() const {
+    return std::strtod(toString().c_str(), nullptr);
+}
+
+int Decimal::compare(const Decimal& a, const Decimal& b) {
+    if (a.negative_ != b.negative_) {
+        return a.negative_ ? -1 : 1;
+    }
+    Scratch& s = scratch();
+    Magnitude ma(a.limbs_, a.size_);
+    Magnitude mb(b.limbs_, b.size_);
+    if (a.scale_ < b.scale_) {
+        s.a.assign(ma.begin(), ma.end());
+        scaleUp(s.a, b.scale_ - a.scale_);
+        ma = s.a;
+    } else if (b.scale_ < a.scale_) {
+        s.b.assign(mb.begin(), mb.end());
+        scaleUp(s.b, a.scale_ - b.scale_);
+        mb = s.b;
+    }
+    const int order = compareMagnitude(ma, mb);
+    return a.negative_ ? -order : order;
+}
+
+void Decimal::setMagnitude(const std::uint32_t* limbs, std::size_t size, DecimalArena* arena) {
+    if (size > capacity_) {
+        std::uint32_t* storage = arena != nullptr ? arena->allocate(size) : new std::uint32_t[size];
+        std::copy_n(limbs, size, storage);
+        release();
+        limbs_ = storage;
+        capacity_ = static_cast<std::uint32_t>(size);
+        ownsHeap_ = arena == nullptr;
+    } else if (limbs != limbs_) {
+        std::copy_n(limbs, size, limbs_);
+    }
+    size_ = static_cast<std::uint32_t>(size);
+}
+
+void Decimal::release() {
+    if (ownsHeap_) {
+        delete[] limbs_;
+    }
+    limbs_ = inline_;
+    capacity_ = kInlineLimbs;
+    ownsHeap_ = false;
+}
+
+Decimal operator+(const Decimal& a, const Decimal& b) {
+    Decimal result;
+    Decimal::add(a, b, result);
+    return result;
+}
+
+Decimal operator-(const Decimal& a, const Decimal& b) {
+    Decimal result;
+    Decimal::subtract(a, b, result);
+    return result;
+}
+
+Decimal operator*(const Decimal& a, const Decimal& b) {
+    Decimal result;
+    Decimal::multiply(a, b, result);
+    return result;
+}
+
+Decimal operator/(const Decimal& a, const Decimal& b) {
+    Decimal result;
+    Decimal::divide(a, b, result);
+    return result;
+}
+
+Decimal operator-(const Decimal& a) {
+    Decimal result;
+    Decimal::negate(a, result);
+    return result;
+}
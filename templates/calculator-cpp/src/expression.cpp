@@ -0,0 +1,415 @@
+#include "expression.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include "calculator.h"
+#include "decimal.h"
+#include "expression_parser.h"
+
+namespace {
+
+using Kind = ExpressionNode::Kind;
+
+bool isNumber(const ExpressionNode::Ptr& node) {
+    return node && node->kind == Kind::Number;
+}
+
+void makeNumber(ExpressionNode& node, double value, const Decimal& exact) {
+    node.kind = Kind::Number;
+    node.value = value;
+    node.text = exact.toString();
+    node.lhs.reset();
+    node.rhs.reset();
+}
+
+/**
+ * @brief Exact value of a subtree in Decimal arithmetic, as evaluate() computes it
+ * @return False if Decimal cannot compute it (division by zero, scale out of range)
+ */
+bool foldDecimal(const ExpressionNode& node, Decimal& out) {
+    try {
+        const Decimal a = Decimal::parse(node.lhs->text);
+        if (node.kind == Kind::Negate) {
+            Decimal::negate(a, out);
+            return true;
+        }
+        const Decimal b = Decimal::parse(node.rhs->text);
+        switch (node.kind) {
+        case Kind::Add:
+            Decimal::add(a, b, out);
+            break;
+        case Kind::Subtract:
+            Decimal::subtract(a, b, out);
+            break;
+        case Kind::Multiply:
+            Decimal::multiply(a, b, out);
+            break;
+        default:
+            Decimal::divide(a, b, out);
+            break;
+        }
+        return true;
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Replace every subtree without variables by its value
+ *
+ * Folding goes through Calculator so the folded result is bit-identical to
+ * evaluating at runtime, and is repeated in Decimal so the Decimal overload
+ * of evaluate() sees the exact value of the literals as written. Division by
+ * a constant zero, and anything Decimal cannot compute, is left in place so
+ * it is reported when the expression is evaluated, not when it is compiled.
+ */
+void foldConstants(ExpressionNode& node) {
+    if (node.lhs) {
+        foldConstants(*node.lhs);
+    }
+    if (node.rhs) {
+        foldConstants(*node.rhs);
+    }
+
+    switch (node.kind) {
+    case Kind::Number:
+    case Kind::Variable:
+        return;
+    case Kind::Negate:
+        if (Decimal exact; isNumber(node.lhs) && foldDecimal(node, exact)) {
+            makeNumber(node, -node.lhs->value, exact);
+        }
+        return;
+    default:
+        break;
+    }
+
+    Decimal exact;
+    if (!isNumber(node.lhs) || !isNumber(node.rhs) || !foldDecimal(node, exact)) {
+        return;
+    }
+    const double a = node.lhs->value;
+    const double b = node.rhs->value;
+    switch (node.kind) {
+    case Kind::Add:
+        makeNumber(node, Calculator::add(a, b), exact);
+        break;
+    case Kind::Subtract:
+        makeNumber(node, Calculator::subtract(a, b), exact);
+        break;
+    case Kind::Multiply:
+        makeNumber(node, Calculator::multiply(a, b), exact);
+        break;
+    case Kind::Divide:
+        if (b != 0.0) {
+            makeNumber(node, Calculator::divide(a, b), exact);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Emits bytecode with stack-style register allocation
+ *
+ * A node whose value is needed in register r evaluates its left operand into
+ * r and its right operand into r + 1, so the register count equals the
+ * maximum nesting depth of right operands.
+ */
+class CodeGenerator {
+public:
+    CodeGenerator(std::vector<Expression::Instruction>& code, std::vector<double>& constants,
+                  std::vector<std::string>& constantTexts)
+        : code_(code), constants_(constants), constantTexts_(constantTexts) {}
+
+    void emit(const ExpressionNode& node, std::size_t reg) {
+        if (reg >= Expression::kMaxRegisters) {
+            throw std::invalid_argument("Expression is nested too deeply");
+        }
+        registerCount_ = std::max(registerCount_, reg + 1);
+        const auto dst = static_cast<std::uint8_t>(reg);
+
+        switch (node.kind) {
+        case Kind::Number:
+            push({Expression::OpCode::LoadConstant, dst, constantSlot(node.value, node.text), 0});
+            return;
+        case Kind::Variable:
+            push({Expression::OpCode::LoadVariable, dst, narrow(node.variable), 0});
+            return;
+        case Kind::Negate:
+            emit(*node.lhs, reg);
+            push({Expression::OpCode::Negate, dst, dst, 0});
+            return;
+        default:
+            break;
+        }
+
+        emit(*node.lhs, reg);
+        emit(*node.rhs, reg + 1);
+        push({opcodeFor(node.kind), dst, dst, static_cast<std::uint16_t>(reg + 1)});
+    }
+
+    std::size_t registerCount() const { return registerCount_; }
+
+private:
+    static Expression::OpCode opcodeFor(Kind kind) {
+        switch (kind) {
+        case Kind::Add:
+            return Expression::OpCode::Add;
+        case Kind::Subtract:
+            return Expression::OpCode::Subtract;
+        case Kind::Multiply:
+            return Expression::OpCode::Multiply;
+        default:
+            return Expression::OpCode::Divide;
+        }
+    }
+
+    static std::uint16_t narrow(std::size_t index) {
+        if (index > UINT16_MAX) {
+            throw std::invalid_argument("Expression has too many variables or constants");
+        }
+        return static_cast<std::uint16_t>(index);
+    }
+
+    std::uint16_t constantSlot(double value, const std::string& text) {
+        for (std::size_t i = 0; i < constants_.size(); ++i) {
+            if (std::memcmp(&constants_[i], &value, sizeof(double)) == 0 && constantTexts_[i] == text) {
+                return narrow(i);
+            }
+        }
+        constants_.push_back(value);
+        constantTexts_.push_back(text);
+        return narrow(constants_.size() - 1);
+    }
+
+    void push(Expression::Instruction instruction) { code_.push_back(instruction); }
+
+    std::vector<Expression::Instruction>& code_;
+    std::vector<double>& constants_;
+    std::vector<std::string>& constantTexts_;
+    std::size_t registerCount_ = 0;
+};
+
+std::vector<double>& scratchBuffer() {
+    // Reused by every column evaluation on this thread so repeated calls
+    // do not allocate once the buffer has grown to its working size.
+    thread_local std::vector<double> buffer;
+    return buffer;
+}
+
+} // namespace
+
+Expression Expression::compile(std::string_view source) {
+    ParsedExpression parsed = parseExpression(source);
+    foldConstants(*parsed.root);
+
+    Expression expression;
+    expression.variables_ = std::move(parsed.variables);
+    CodeGenerator generator(expression.code_, expression.constants_, expression.constantTexts_);
+    generator.emit(*parsed.root, 0);
+    expression.registerCount_ = generator.registerCount();
+    return expression;
+}
+
+std::size_t Expression::variableIndex(std::string_view name) const {
+    const auto it = std::find(variables_.begin(), variables_.end(), name);
+    return static_cast<std::size_t>(it - variables_.begin());
+}
+
+double Expression::evaluate(std::span<const double> values) const {
+    if (values.size() != variables_.size()) {
+        throw std::invalid_argument("Expected one value per expression variable");
+    }
+
+    std::array<double, kMaxRegisters> r;
+    for (const Instruction& ins : code_) {
+        switch (ins.op) {
+        case OpCode::LoadVariable:
+            r[ins.dst] = values[ins.a];
+            break;
+        case OpCode::LoadConstant:
+            r[ins.dst] = constants_[ins.a];
+            break;
+        case OpCode::Negate:
+            r[ins.dst] = -r[ins.a];
+            break;
+        case OpCode::Add:
+            r[ins.dst] = Calculator::add(r[ins.a], r[ins.b]);
+            break;
+        case OpCode::Subtract:
+            r[ins.dst] = Calculator::subtract(r[ins.a], r[ins.b]);
+            break;
+        case OpCode::Multiply:
+            r[ins.dst] = Calculator::multiply(r[ins.a], r[ins.b]);
+            break;
+        case OpCode::Divide:
+            r[ins.dst] = Calculator::divide(r[ins.a], r[ins.b]);
+            break;
+        }
+    }
+    return r[0];
+}
+
+std::size_t Expression::evaluate(std::span<const std::span<const double>> columns, std::span<double> out,
+                                 std::span<std::uint64_t> zeroMask) const {
+    if (columns.size() != variables_.size()) {
+        throw std::invalid_argument("Expected one column per expression variable");
+    }
+    const std::size_t rows = out.size();
+    for (const auto& column : columns) {
+        if (column.size() != rows) {
+            throw std::invalid_argument("All columns must have as many rows as the output");
+        }
+    }
+    if (!zeroMask.empty() && zeroMask.size() < Calculator::zeroMaskWords(rows)) {
+        throw std::invalid_argument("Zero-divisor mask is too small for the batch");
+    }
+
+    // Workspace: one chunk per register followed by one pre-filled chunk per
+    // constant. LoadVariable and LoadConstant only repoint a register at a
+    // column or constant chunk instead of copying.
+    std::vector<double>& scratch = scratchBuffer();
+    scratch.resize((registerCount_ + constants_.size()) * kChunkRows);
+    double* registers = scratch.data();
+    double* constantChunks = registers + registerCount_ * kChunkRows;
+    for (std::size_t c = 0; c < constants_.size(); ++c) {
+        std::fill_n(constantChunks + c * kChunkRows, kChunkRows, constants_[c]);
+    }
+
+    constexpr std::size_t kMaskWords = kChunkRows / 64;
+    std::array<const double*, kMaxRegisters> operand{};
+    std::size_t zeroRows = 0;
+
+    for (std::size_t offset = 0; offset < rows; offset += kChunkRows) {
+        const std::size_t n = std::min(kChunkRows, rows - offset);
+        std::array<std::uint64_t, kMaskWords> chunkMask{};
+        std::array<std::uint64_t, kMaskWords> divideMask{};
+
+        for (std::size_t pc = 0; pc < code_.size(); ++pc) {
+            const Instruction& ins = code_[pc];
+            // The last instruction writes straight into the caller's output.
+            double* target = pc + 1 == code_.size() ? out.data() + offset : registers + ins.dst * kChunkRows;
+            const std::span<double> result(target, n);
+
+            switch (ins.op) {
+            case OpCode::LoadVariable:
+                operand[ins.dst] = columns[ins.a].data() + offset;
+                continue;
+            case OpCode::LoadConstant:
+                operand[ins.dst] = constantChunks + ins.a * kChunkRows;
+                continue;
+            case OpCode::Negate:
+                for (std::size_t i = 0; i < n; ++i) {
+                    target[i] = -operand[ins.a][i];
+                }
+                break;
+            case OpCode::Add:
+                Calculator::add({operand[ins.a], n}, {operand[ins.b], n}, result);
+                break;
+            case OpCode::Subtract:
+                Calculator::subtract({operand[ins.a], n}, {operand[ins.b], n}, result);
+                break;
+            case OpCode::Multiply:
+                Calculator::multiply({operand[ins.a], n}, {operand[ins.b], n}, result);
+                break;
+            case OpCode::Divide:
+                if (Calculator::divide({operand[ins.a], n}, {operand[ins.b], n}, result, divideMask) != 0) {
+                    for (std::size_t w = 0; w < kMaskWords; ++w) {
+                        chunkMask[w] |= divideMask[w];
+                    }
+                }
+                break;
+            }
+            operand[ins.dst] = target;
+        }
+
+        if (code_.back().op == OpCode::LoadVariable || code_.back().op == OpCode::LoadConstant) {
+            std::memcpy(out.data() + offset, operand[0], n * sizeof(double));
+        }
+        for (std::size_t w = 0; w < Calculator::zeroMaskWords(n); ++w) {
+            zeroRows += static_cast<std::size_t>(std::popcount(chunkMask[w]));
+            if (!zeroMask.empty()) {
+                zeroMask[offset / 64 + w] = chunkMask[w];
+            }
+        }
+    }
+    return zeroRows;
+}
+
+void Expression::evaluate(std::span<const std::span<const Decimal>> columns, std::span<Decimal> out,
+                          DecimalArena& arena) const {
+    if (columns.size() != variables_.size()) {
+        throw std::invalid_argument("Expected one column per expression variable");
+    }
+    for (const auto& column : columns) {
+        if (column.size() != out.size()) {
+            throw std::invalid_argument("All columns must have as many rows as the output");
+        }
+    }
+
+    arena.reset();
+    std::vector<Decimal> constants;
+    constants.reserve(constantTexts_.size());
+    for (const std::string& text : constantTexts_) {
+        constants.push_back(Decimal::parse(text));
+    }
+
+    std::array<Decimal, kMaxRegisters> r;
+    for (std::size_t row = 0; row < out.size(); ++row) {
+        for (const Instruction& ins : code_) {
+            switch (ins.op) {
+            case OpCode::LoadVariable:
+                Decimal::assign(columns[ins.a][row], r[ins.dst], &arena);
+                break;
+            case OpCode::LoadConstant:
+                Decimal::assign(constants[ins.a], r[ins.dst], &arena);
+                break;
+            case OpCode::Negate:
+                Decimal::negate(r[ins.a], r[ins.dst], &arena);
+                break;
+            case OpCode::Add:
+                Decimal::add(r[ins.a], r[ins.b], r[ins.dst], &arena);
+                break;
+            case OpCode::Subtract:
+                Decimal::subtract(r[ins.a], r[ins.b], r[ins.dst], &arena);
+                break;
+            case OpCode::Multiply:
+                Decimal::multiply(r[ins.a], r[ins.b], r[ins.dst], &arena);
+                break;
+            case OpCode::Divide:
+                Decimal::divide(r[ins.a], r[ins.b], r[ins.dst], Decimal::kDefaultDivisionScale, &arena);
+                break;
+            }
+        }
+        out[row] = r[0];
+    }
+}
+
+std::string Expression::disassemble() const {
+    static constexpr const char* kOperators[] = {"", "", "", "+", "-", "*", "/"};
+    std::ostringstream text;
+    for (const Instruction& ins : code_) {
+        text << "r" << static_cast<int>(ins.dst) << " = ";
+        switch (ins.op) {
+        case OpCode::LoadVariable:
+            text << variables_[ins.a];
+            break;
+        case OpCode::LoadConstant:
+            text << constants_[ins.a];
+            break;
+        case OpCode::Negate:
+            text << "-r" << ins.a;
+            break;
+        default:
+            text << "r" << ins.a << " " << kOperators[static_cast<int>(ins.op)] << " r" << ins.b;
+            break;
+        }
+        text << "\n";
+    }
+    return text.str();
+}
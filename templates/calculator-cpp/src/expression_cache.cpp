@@ -0,0 +1,164 @@
+#include "expression_cache.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <limits>
+
+namespace {
+
+bool isWordChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+}
+
+bool startsNumber(std::string_view source, std::size_t pos) {
+    const char c = source[pos];
+    if (std::isdigit(static_cast<unsigned char>(c))) {
+        return true;
+    }
+    return c == '.' && pos + 1 < source.size() && std::isdigit(static_cast<unsigned char>(source[pos + 1]));
+}
+
+/// Whether a number literal has more significant digits than a double keeps
+bool exceedsDouble(std::string_view literal) {
+    int digits = 0;
+    for (const char c : literal) {
+        if (c == 'e' || c == 'E') {
+            break;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) && (digits > 0 || c != '0')) {
+            ++digits;
+        }
+    }
+    return digits > std::numeric_limits<double>::digits10;
+}
+
+} // namespace
+
+ExpressionCache::ExpressionCache(std::size_t capacity)
+    : shardCount_(std::clamp<std::size_t>(capacity, 1, kShards)),
+      shardCapacity_((std::max<std::size_t>(capacity, 1) + shardCount_ - 1) / shardCount_) {
+    for (std::size_t i = 0; i < shardCount_; ++i) {
+        shards_[i].index.reserve(shardCapacity_ + 1);
+    }
+}
+
+ExpressionCache& ExpressionCache::global() {
+    static ExpressionCache cache;
+    return cache;
+}
+
+void ExpressionCache::normalize(std::string_view source, std::string& out) {
+    out.clear();
+    bool spaceSkipped = false;
+    std::size_t pos = 0;
+    while (pos < source.size()) {
+        const char c = source[pos];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            spaceSkipped = true;
+            ++pos;
+            continue;
+        }
+        // Whitespace between two words is significant ("a b" must not become
+        // "ab"), so it is kept as a single space.
+        if (spaceSkipped && !out.empty() && isWordChar(out.back()) && isWordChar(c)) {
+            out += ' ';
+        }
+        spaceSkipped = false;
+
+        if (startsNumber(source, pos)) {
+            // Short integers without a leading zero are already canonical.
+            std::size_t end = pos;
+            while (end < source.size() && std::isdigit(static_cast<unsigned char>(source[end]))) {
+                ++end;
+            }
+            const bool plainInteger = end - pos < 16 && (source[pos] != '0' || end - pos == 1) &&
+                                      (end == source.size() || !isWordChar(source[end]));
+            if (plainInteger) {
+                out.append(source.substr(pos, end - pos));
+                pos = end;
+                continue;
+            }
+            double value = 0.0;
+            const char* begin = source.data() + pos;
+            const auto [next, ec] = std::from_chars(begin, source.data() + source.size(), value);
+            if (ec == std::errc() && exceedsDouble(source.substr(pos, static_cast<std::size_t>(next - begin)))) {
+                // Decimal evaluation sees every digit, so such literals stay as written.
+                out.append(begin, next);
+                pos += static_cast<std::size_t>(next - begin);
+                continue;
+            }
+            if (ec == std::errc()) {
+                char buffer[32];
+                const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                out.append(buffer, result.ptr);
+                pos += static_cast<std::size_t>(next - begin);
+                continue;
+            }
+        }
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            const std::size_t start = pos;
+            while (pos < source.size() && (std::isalnum(static_cast<unsigned char>(source[pos])) || source[pos] == '_')) {
+                ++pos;
+            }
+            out.append(source.substr(start, pos - start));
+            continue;
+        }
+        out += c;
+        ++pos;
+    }
+}
+
+std::shared_ptr<const Expression> ExpressionCache::get(std::string_view source) {
+    thread_local std::string key;
+    normalize(source, key);
+    Shard& shard = shards_[std::hash<std::string_view>{}(key) % shardCount_];
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto found = shard.index.find(key);
+        if (found != shard.index.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return found->second->expression;
+        }
+    }
+
+    // Compile outside the lock so a slow compile does not block lookups.
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    auto compiled = std::make_shared<const Expression>(Expression::compile(source));
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto found = shard.index.find(key);
+    if (found != shard.index.end()) {
+        // Another thread compiled the same formula in the meantime.
+        return found->second->expression;
+    }
+    shard.lru.push_front(Entry{key, std::move(compiled)});
+    shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+    if (shard.lru.size() > shardCapacity_) {
+        shard.index.erase(shard.lru.back().key);
+        shard.lru.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return shard.lru.front().expression;
+}
+
+ExpressionCache::Stats ExpressionCache::stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.size += shard.lru.size();
+    }
+    return stats;
+}
+
+void ExpressionCache::clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.lru.clear();
+    }
+}
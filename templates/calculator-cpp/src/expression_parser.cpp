@@ -0,0 +1,200 @@
+#include "expression_parser.h"
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+namespace {
+
+bool isIdentifierStart(char c) {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+/**
+ * @brief Recursive descent parser over a single source string
+ */
+class Parser {
+public:
+    /// Deepest nesting of parentheses and unary operators; bounds the recursion
+    static constexpr std::size_t kMaxDepth = 256;
+
+    /// Most operators in one expression; bounds the height of long operand chains
+    static constexpr std::size_t kMaxOperators = 65536;
+
+    explicit Parser(std::string_view source) : source_(source) {}
+
+    ParsedExpression parse() {
+        ParsedExpression result;
+        variables_ = &result.variables;
+        result.root = parseSum();
+        skipSpace();
+        if (pos_ != source_.size()) {
+            fail("Unexpected character '" + std::string(1, source_[pos_]) + "'");
+        }
+        return result;
+    }
+
+private:
+    // sum := product (('+' | '-') product)*
+    ExpressionNode::Ptr parseSum() {
+        ExpressionNode::Ptr lhs = parseProduct();
+        while (true) {
+            if (accept('+')) {
+                lhs = makeBinary(ExpressionNode::Kind::Add, std::move(lhs), parseProduct());
+            } else if (accept('-')) {
+                lhs = makeBinary(ExpressionNode::Kind::Subtract, std::move(lhs), parseProduct());
+            } else {
+                return lhs;
+            }
+        }
+    }
+
+    // product := unary (('*' | '/') unary)*
+    ExpressionNode::Ptr parseProduct() {
+        ExpressionNode::Ptr lhs = parseUnary();
+        while (true) {
+            if (accept('*')) {
+                lhs = makeBinary(ExpressionNode::Kind::Multiply, std::move(lhs), parseUnary());
+            } else if (accept('/')) {
+                lhs = makeBinary(ExpressionNode::Kind::Divide, std::move(lhs), parseUnary());
+            } else {
+                return lhs;
+            }
+        }
+    }
+
+    // unary := ('-' | '+') unary | primary
+    ExpressionNode::Ptr parseUnary() {
+        if (accept('-')) {
+            const Nesting nesting(*this);
+            countOperator();
+            auto node = std::make_unique<ExpressionNode>();
+            node->kind = ExpressionNode::Kind::Negate;
+            node->lhs = parseUnary();
+            return node;
+        }
+        if (accept('+')) {
+            const Nesting nesting(*this);
+            return parseUnary();
+        }
+        return parsePrimary();
+    }
+
+    // primary := number | identifier | '(' sum ')'
+    ExpressionNode::Ptr parsePrimary() {
+        skipSpace();
+        if (pos_ == source_.size()) {
+            fail("Unexpected end of expression");
+        }
+        if (accept('(')) {
+            const Nesting nesting(*this);
+            ExpressionNode::Ptr inner = parseSum();
+            if (!accept(')')) {
+                fail("Expected ')'");
+            }
+            return inner;
+        }
+
+        const char c = source_[pos_];
+        if (isIdentifierStart(c)) {
+            const std::size_t start = pos_;
+            while (pos_ < source_.size() && isIdentifierChar(source_[pos_])) {
+                ++pos_;
+            }
+            auto node = std::make_unique<ExpressionNode>();
+            node->kind = ExpressionNode::Kind::Variable;
+            node->variable = variableSlot(source_.substr(start, pos_ - start));
+            return node;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            auto node = std::make_unique<ExpressionNode>();
+            node->kind = ExpressionNode::Kind::Number;
+            const char* begin = source_.data() + pos_;
+            const char* end = source_.data() + source_.size();
+            const auto [next, ec] = std::from_chars(begin, end, node->value);
+            if (ec != std::errc()) {
+                fail("Invalid number");
+            }
+            node->text.assign(begin, next);
+            pos_ += static_cast<std::size_t>(next - begin);
+            return node;
+        }
+        fail("Unexpected character '" + std::string(1, c) + "'");
+    }
+
+    /// Counts one level of nesting for as long as it is in scope
+    class Nesting {
+    public:
+        explicit Nesting(Parser& parser) : parser_(parser) {
+            if (++parser_.depth_ > kMaxDepth) {
+                parser_.fail("Expression is nested too deeply");
+            }
+        }
+        ~Nesting() { --parser_.depth_; }
+
+        Nesting(const Nesting&) = delete;
+        Nesting& operator=(const Nesting&) = delete;
+
+    private:
+        Parser& parser_;
+    };
+
+    std::size_t variableSlot(std::string_view name) {
+        for (std::size_t i = 0; i < variables_->size(); ++i) {
+            if ((*variables_)[i] == name) {
+                return i;
+            }
+        }
+        variables_->emplace_back(name);
+        return variables_->size() - 1;
+    }
+
+    ExpressionNode::Ptr makeBinary(ExpressionNode::Kind kind, ExpressionNode::Ptr lhs, ExpressionNode::Ptr rhs) {
+        countOperator();
+        auto node = std::make_unique<ExpressionNode>();
+        node->kind = kind;
+        node->lhs = std::move(lhs);
+        node->rhs = std::move(rhs);
+        return node;
+    }
+
+    void countOperator() {
+        if (++operators_ > kMaxOperators) {
+            fail("Expression is too long");
+        }
+    }
+
+    void skipSpace() {
+        while (pos_ < source_.size() && std::isspace(static_cast<unsigned char>(source_[pos_]))) {
+            ++pos_;
+        }
+    }
+
+    bool accept(char c) {
+        skipSpace();
+        if (pos_ < source_.size() && source_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::invalid_argument(message + " at column " + std::to_string(pos_ + 1));
+    }
+
+    std::string_view source_;
+    std::size_t pos_ = 0;
+    std::size_t depth_ = 0;
+    std::size_t operators_ = 0;
+    std::vector<std::string>* variables_ = nullptr;
+};
+
+} // namespace
+
+ParsedExpression parseExpression(std::string_view source) {
+    return Parser(source).parse();
+}
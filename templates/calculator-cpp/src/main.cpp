@@ -1,7 +1,340 @@
+#include <charconv>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <vector>
+#include "basic_calculator.h"
+#include "batch_processor.h"
 #include "calculator.h"
+#include "decimal.h"
+#include "expression.h"
+#include "expression_cache.h"
+#include "spreadsheet.h"
+
+#if defined(__linux__)
+#include <csignal>
+#include "calculator_server.h"
+#endif
+
+// Evaluated entirely at compile time; a constant division by zero here
+// would be rejected by the compiler.
+static_assert(BasicCalculator<int>::divide(84, 2) == 42);
+static_assert(BasicCalculator<Q16_16>::multiply(Q16_16(1.5), Q16_16(2.25)) == Q16_16(3.375));
+
+void runFixedPointDemo() {
+    std::cout << "\n=== Fixed-point Demo ===" << std::endl;
+
+    using Q16 = BasicCalculator<Q16_16>;
+    constexpr Q16_16 price(10.5);
+    constexpr Q16_16 quantity(3.2);
+    constexpr Q16_16 total = Q16::multiply(price, quantity);
+    std::cout << "Q16.16: " << price.to<double>() << " * " << quantity.to<double>() << " = "
+              << total.to<double>() << std::endl;
+
+    using Saturating = BasicCalculator<std::int16_t>;
+    std::cout << "Saturating int16: 30000 + 10000 = " << Saturating::add(30000, 10000) << std::endl;
+}
+
+void runDecimalDemo() {
+    std::cout << "\n=== Decimal Demo ===" << std::endl;
+
+    using Exact = BasicCalculator<Decimal>;
+    const Decimal sum = Exact::add(Decimal::parse("0.1"), Decimal::parse("0.2"));
+    std::cout << "Decimal: 0.1 + 0.2 = " << sum.toString() << " (double: " << std::setprecision(17)
+              << Calculator::add(0.1, 0.2) << std::setprecision(2) << ")" << std::endl;
+
+    const Decimal price = Decimal::parse("19999999999999999999999999.99");
+    const Decimal total = Exact::multiply(price, Decimal(3));
+    std::cout << "Decimal: " << price.toString() << " * 3 = " << total.toString() << std::endl;
+    std::cout << "Decimal: 10 / 3 = " << Exact::divide(Decimal(10), Decimal(3)).toString() << std::endl;
+}
+
+void runBatchDemo() {
+    std::cout << "\n=== Batch Demo (" << Calculator::simdLevelName(Calculator::simdLevel()) << ") ===" << std::endl;
+
+    std::vector<double> dividends = {10.5, 7.0, 1.0, 9.0, 4.5};
+    std::vector<double> divisors = {3.2, 0.0, 4.0, 3.0, 0.0};
+    std::vector<double> quotients(dividends.size());
+    std::vector<std::uint64_t> zeroMask(Calculator::zeroMaskWords(dividends.size()));
+
+    std::size_t zeros = Calculator::divide(dividends, divisors, quotients, zeroMask);
+    for (std::size_t i = 0; i < quotients.size(); ++i) {
+        std::cout << "Batch division: " << dividends[i] << " / " << divisors[i] << " = ";
+        if (zeroMask[i / 64] & (std::uint64_t{1} << (i % 64))) {
+            std::cout << "skipped (zero divisor)" << std::endl;
+        } else {
+            std::cout << quotients[i] << std::endl;
+        }
+    }
+    std::cout << "Zero-divisor lanes: " << zeros << std::endl;
+}
+
+void runExpressionDemo() {
+    std::cout << "\n=== Expression Demo ===" << std::endl;
+
+    Expression expression = Expression::compile("(a + 2 * 3) * b - a / 2");
+    std::cout << "Bytecode for (a + 2 * 3) * b - a / 2:" << std::endl;
+    std::cout << expression.disassemble();
+
+    std::vector<double> a = {10.5, 1.0, 4.0};
+    std::vector<double> b = {3.2, 2.0, 0.5};
+    std::vector<double> results(a.size());
+    std::vector<std::span<const double>> columns = {a, b};
+    expression.evaluate(columns, results);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        std::cout << "a = " << a[i] << ", b = " << b[i] << " -> " << results[i] << std::endl;
+    }
+}
+
+int runEval(const std::string& source, int argc, char* argv[]) {
+    try {
+        const Expression& expression = *ExpressionCache::global().get(source);
+        std::vector<double> values(expression.variables().size());
+        std::vector<bool> bound(values.size(), false);
+
+        // Remaining arguments bind variables: name=value
+        for (int i = 0; i < argc; ++i) {
+            std::string binding = argv[i];
+            std::size_t eq = binding.find('=');
+            std::size_t index = expression.variableIndex(binding.substr(0, eq));
+            if (eq == std::string::npos || index == values.size()) {
+                std::cerr << "Error: Unknown binding " << binding << std::endl;
+                return 1;
+            }
+            values[index] = std::stod(binding.substr(eq + 1));
+            bound[index] = true;
+        }
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (!bound[i]) {
+                std::cerr << "Error: No value for variable " << expression.variables()[i] << std::endl;
+                return 1;
+            }
+        }
+
+        double result = expression.evaluate(values);
+        std::cout << source << " = " << result << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+std::string trim(const std::string& text) {
+    const std::size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+}
+
+void printCell(const Spreadsheet::CellView& cell) {
+    std::cout << cell.name << " = ";
+    if (!cell.error.empty()) {
+        std::cout << "#ERROR (" << cell.error << ")";
+    } else {
+        std::cout << cell.value;
+    }
+    if (!cell.formula.empty()) {
+        std::cout << "  [" << cell.formula << "]";
+    }
+    std::cout << std::endl;
+}
+
+/// Apply "name = formula" to the sheet; false if the line has no '='
+bool setCell(Spreadsheet& sheet, const std::string& line) {
+    const std::size_t eq = line.find('=');
+    if (eq == std::string::npos) {
+        return false;
+    }
+    sheet.set(trim(line.substr(0, eq)), trim(line.substr(eq + 1)));
+    return true;
+}
+
+/// Recalculate and describe what was recomputed
+std::string recalculate(Spreadsheet& sheet) {
+    const auto start = std::chrono::steady_clock::now();
+    const Spreadsheet::RecalcStats stats = sheet.recalculate();
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::ostringstream summary;
+    summary << "(" << stats.cells << " cells recalculated in " << stats.levels << " levels, " << std::fixed
+            << std::setprecision(3) << ms << " ms)";
+    return summary.str();
+}
+
+/// Load "name = formula" lines, recalculating once at the end
+void loadCells(Spreadsheet& sheet, const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Could not open " + path);
+    }
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        try {
+            if (!setCell(sheet, line)) {
+                throw std::invalid_argument("expected name = formula");
+            }
+        } catch (const std::exception& e) {
+            throw std::invalid_argument(path + ":" + std::to_string(lineNumber) + ": " + e.what());
+        }
+    }
+    std::cout << "Loaded " << path << " " << recalculate(sheet) << std::endl;
+}
+
+int runInteractive() {
+    Spreadsheet sheet;
+    std::cout << "Interactive mode. Type 'help' for commands." << std::endl;
+
+    std::string line;
+    while (std::cout << "> " << std::flush, std::getline(std::cin, line)) {
+        line = trim(line);
+        try {
+            if (line.empty()) {
+                continue;
+            } else if (line == "quit" || line == "exit") {
+                break;
+            } else if (line == "help") {
+                std::cout << "  name = formula   set a cell, e.g. total = price * (1 + tax)\n"
+                             "  name             show a cell\n"
+                             "  cells            list all cells\n"
+                             "  load <file>      read name = formula lines from a file\n"
+                             "  quit             leave interactive mode" << std::endl;
+            } else if (line == "cells") {
+                for (const Spreadsheet::CellView& cell : sheet.cells()) {
+                    printCell(cell);
+                }
+            } else if (line.rfind("load ", 0) == 0) {
+                loadCells(sheet, trim(line.substr(5)));
+            } else if (setCell(sheet, line)) {
+                const std::string summary = recalculate(sheet);
+                printCell(sheet.cell(trim(line.substr(0, line.find('=')))));
+                std::cout << summary << std::endl;
+            } else {
+                printCell(sheet.cell(line));
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+        }
+    }
+    return 0;
+}
+
+int runBatch(int argc, char* argv[]) {
+    // --batch <formula> <input> <output> [--input-format csv|binary] [--output-format csv|binary]
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0]
+                  << " --batch <add|subtract|multiply|divide|expression> <input> <output>"
+                     " [--input-format csv|binary] [--output-format csv|binary]" << std::endl;
+        return 1;
+    }
+
+    BatchOptions options;
+    options.formula = argv[2];
+    options.inputPath = argv[3];
+    options.outputPath = argv[4];
+    options.inputFormat = BatchProcessor::formatForPath(options.inputPath);
+    options.outputFormat = BatchProcessor::formatForPath(options.outputPath);
+    for (int i = 5; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag != "--input-format" && flag != "--output-format") {
+            std::cerr << "Error: Unknown option " << flag << std::endl;
+            return 1;
+        }
+        const std::string value = i + 1 < argc ? argv[i + 1] : "";
+        if (value != "csv" && value != "binary") {
+            std::cerr << "Error: " << flag << " must be csv or binary" << std::endl;
+            return 1;
+        }
+        const BatchFormat format = value == "csv" ? BatchFormat::Csv : BatchFormat::Binary;
+        if (flag == "--input-format") {
+            options.inputFormat = format;
+        } else {
+            options.outputFormat = format;
+        }
+    }
+
+    try {
+        BatchProcessor processor(options);
+        BatchStats stats = processor.run();
+        // Results may go to stdout, so the summary goes to stderr.
+        std::cerr << "Batch: " << stats.rows << " rows (" << stats.zeroDivisorRows << " divided by zero), "
+                  << stats.bytesRead << " bytes in " << std::fixed << std::setprecision(3) << stats.seconds
+                  << " s (" << std::setprecision(1) << static_cast<double>(stats.bytesRead) / 1e6 / stats.seconds
+                  << " MB/s)" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+#if defined(__linux__)
+namespace {
+CalculatorServer* activeServer = nullptr;
+
+extern "C" void stopServer(int) {
+    if (activeServer != nullptr) {
+        activeServer->stop();
+    }
+}
+} // namespace
+
+int runServer(int argc, char* argv[]) {
+    // --serve <socket> [--workers N]
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --serve <socket> [--workers N]" << std::endl;
+        return 1;
+    }
+
+    ServerOptions options;
+    options.socketPath = argv[2];
+    for (int i = 3; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--workers") {
+            const std::string_view value = i + 1 < argc ? argv[i + 1] : "";
+            const char* end = value.data() + value.size();
+            const auto [next, ec] = std::from_chars(value.data(), end, options.workers);
+            if (value.empty() || ec != std::errc() || next != end) {
+                std::cerr << "Error: --workers must be a number of threads" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        CalculatorServer server(options);
+        activeServer = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::cerr << "Serving on " << server.socketPath() << " (Ctrl+C to stop)" << std::endl;
+        server.run();
+        activeServer = nullptr;
+
+        const ServerStats stats = server.stats();
+        std::cerr << "Server: " << stats.requests << " requests on " << stats.connections << " connections, "
+                  << std::fixed << std::setprecision(1) << stats.requestsPerBatch() << " requests per batch"
+                  << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        activeServer = nullptr;
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+#endif
 
 void runDemo() {
     std::cout << "\n=== Calculator Demo ===" << std::endl;
@@ -31,6 +364,11 @@ void runDemo() {
             std::cout << "Division by zero test: " << e.what() << std::endl;
         }
         
+        runFixedPointDemo();
+        runDecimalDemo();
+        runBatchDemo();
+        runExpressionDemo();
+
         std::cout << "Calculator demo completed successfully." << std::endl;
         
     } catch (const std::exception& e) {
@@ -39,13 +377,25 @@ void runDemo() {
 }
 
 int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        return runBatch(argc, argv);
+    }
+
+#if defined(__linux__)
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+        return runServer(argc, argv);
+    }
+#endif
+
     std::cout << "Welcome to the Calculator!" << std::endl;
     
     // CI/CD friendly: Run demo by default, or use command line arguments
     if (argc > 1 && std::string(argv[1]) == "--interactive") {
-        std::cout << "Interactive mode not implemented in CI/CD version." << std::endl;
-        std::cout << "Use without arguments for demo mode." << std::endl;
-        return 1;
+        return runInteractive();
+    }
+
+    if (argc > 2 && std::string(argv[1]) == "--eval") {
+        return runEval(argv[2], argc - 3, argv + 3);
     }
     
     runDemo();
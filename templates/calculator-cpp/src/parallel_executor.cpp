@@ -0,0 +1,258 @@
+#include "parallel_executor.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include "calculator.h"
+#include "expression.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+constexpr std::uint64_t pack(std::uint32_t begin, std::uint32_t end) {
+    return (static_cast<std::uint64_t>(begin) << 32) | end;
+}
+
+constexpr std::uint32_t rangeBegin(std::uint64_t range) {
+    return static_cast<std::uint32_t>(range >> 32);
+}
+
+constexpr std::uint32_t rangeEnd(std::uint64_t range) {
+    return static_cast<std::uint32_t>(range);
+}
+
+void pinToCpu(std::thread& thread, std::size_t cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<int>(cpu % CPU_SETSIZE), &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+} // namespace
+
+struct ParallelExecutor::Job {
+    std::size_t rows = 0;
+    std::size_t chunkRows = 0;
+    const std::function<void(std::size_t, std::size_t)>* fn = nullptr;
+    const CancellationToken* token = nullptr;
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;  ///< First exception thrown by fn, guarded by mutex_
+};
+
+ParallelExecutor::ParallelExecutor(std::size_t workers, bool pinThreads) {
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_ = std::make_unique<Worker[]>(workers);
+    threads_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        threads_.emplace_back([this, i] { workerLoop(i); });
+        if (pinThreads) {
+            pinToCpu(threads_.back(), i);
+        }
+    }
+}
+
+ParallelExecutor::~ParallelExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+bool ParallelExecutor::parallelFor(std::size_t rows, std::size_t chunkRows,
+                                   const std::function<void(std::size_t, std::size_t)>& fn,
+                                   const CancellationToken* token) {
+    if (chunkRows == 0) {
+        chunkRows = kDefaultChunkRows;
+    }
+    // Chunk indices must fit the 32-bit halves of a packed range.
+    const std::size_t maxChunks = std::numeric_limits<std::uint32_t>::max();
+    if ((rows + chunkRows - 1) / chunkRows > maxChunks) {
+        chunkRows = (rows + maxChunks - 1) / maxChunks;
+    }
+    if (rows == 0) {
+        return token == nullptr || !token->cancelled();
+    }
+
+    std::lock_guard<std::mutex> submit(submitMutex_);
+    Job job;
+    job.rows = rows;
+    job.chunkRows = chunkRows;
+    job.fn = &fn;
+    job.token = token;
+
+    // One contiguous block of chunks per worker.
+    const std::size_t chunks = (rows + chunkRows - 1) / chunkRows;
+    const std::size_t workers = workerCount();
+    for (std::size_t w = 0; w < workers; ++w) {
+        const auto begin = static_cast<std::uint32_t>(chunks * w / workers);
+        const auto end = static_cast<std::uint32_t>(chunks * (w + 1) / workers);
+        workers_[w].range.store(pack(begin, end), std::memory_order_relaxed);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_ = &job;
+    running_ = workers;
+    ++generation_;
+    wake_.notify_all();
+    done_.wait(lock, [this] { return running_ == 0; });
+    job_ = nullptr;
+
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+    return token == nullptr || !token->cancelled();
+}
+
+std::size_t ParallelExecutor::evaluate(const Expression& expression, std::span<const std::span<const double>> columns,
+                                       std::span<double> out, std::span<std::uint64_t> zeroMask,
+                                       const CancellationToken* token) {
+    if (columns.size() != expression.variables().size()) {
+        throw std::invalid_argument("Expected one column per expression variable");
+    }
+    for (const auto& column : columns) {
+        if (column.size() != out.size()) {
+            throw std::invalid_argument("All columns must have as many rows as the output");
+        }
+    }
+    if (!zeroMask.empty() && zeroMask.size() < Calculator::zeroMaskWords(out.size())) {
+        throw std::invalid_argument("Zero-divisor mask is too small for the batch");
+    }
+
+    std::atomic<std::size_t> zeroRows{0};
+    parallelFor(out.size(), kDefaultChunkRows, [&](std::size_t begin, std::size_t end) {
+        // Small per-chunk column table; chunks start at multiples of 64 rows,
+        // so each one owns whole words of the zero mask.
+        std::vector<std::span<const double>> slices(columns.size());
+        for (std::size_t v = 0; v < columns.size(); ++v) {
+            slices[v] = columns[v].subspan(begin, end - begin);
+        }
+        std::span<std::uint64_t> mask =
+            zeroMask.empty() ? zeroMask : zeroMask.subspan(begin / 64, Calculator::zeroMaskWords(end - begin));
+        const std::size_t zeros = expression.evaluate(slices, out.subspan(begin, end - begin), mask);
+        zeroRows.fetch_add(zeros, std::memory_order_relaxed);
+    }, token);
+    return zeroRows.load(std::memory_order_relaxed);
+}
+
+std::vector<ParallelExecutor::WorkerStats> ParallelExecutor::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<WorkerStats> result;
+    for (std::size_t w = 0; w < workerCount(); ++w) {
+        result.push_back(workers_[w].stats);
+    }
+    return result;
+}
+
+void ParallelExecutor::resetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t w = 0; w < workerCount(); ++w) {
+        workers_[w].stats = WorkerStats{};
+    }
+}
+
+void ParallelExecutor::workerLoop(std::size_t index) {
+    std::uint64_t seen = 0;
+    while (true) {
+        Job* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) {
+                return;
+            }
+            seen = generation_;
+            job = job_;
+        }
+        runJob(index, *job);
+    }
+}
+
+void ParallelExecutor::runJob(std::size_t index, Job& job) {
+    Worker& self = workers_[index];
+    WorkerStats local;
+    std::exception_ptr error;
+
+    while (!job.failed.load(std::memory_order_relaxed) && (job.token == nullptr || !job.token->cancelled())) {
+        std::uint32_t chunk = 0;
+        if (!takeOwn(self, chunk)) {
+            if (!steal(index)) {
+                break;
+            }
+            ++local.steals;
+            continue;
+        }
+
+        const std::size_t begin = chunk * job.chunkRows;
+        const std::size_t end = std::min(job.rows, begin + job.chunkRows);
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            (*job.fn)(begin, end);
+        } catch (...) {
+            error = std::current_exception();
+            job.failed.store(true, std::memory_order_relaxed);
+        }
+        local.busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++local.chunks;
+        local.rows += end - begin;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    self.stats.chunks += local.chunks;
+    self.stats.rows += local.rows;
+    self.stats.steals += local.steals;
+    self.stats.busySeconds += local.busySeconds;
+    if (error && !job.error) {
+        job.error = error;
+    }
+    if (--running_ == 0) {
+        done_.notify_all();
+    }
+}
+
+bool ParallelExecutor::takeOwn(Worker& worker, std::uint32_t& chunk) {
+    std::uint64_t range = worker.range.load(std::memory_order_acquire);
+    while (rangeBegin(range) < rangeEnd(range)) {
+        if (worker.range.compare_exchange_weak(range, pack(rangeBegin(range) + 1, rangeEnd(range)),
+                                               std::memory_order_acq_rel)) {
+            chunk = rangeBegin(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParallelExecutor::steal(std::size_t thief) {
+    const std::size_t workers = workerCount();
+    for (std::size_t offset = 1; offset < workers; ++offset) {
+        Worker& victim = workers_[(thief + offset) % workers];
+        std::uint64_t range = victim.range.load(std::memory_order_acquire);
+        while (rangeBegin(range) < rangeEnd(range)) {
+            // Take the back half, leaving the victim the chunks it is about to reach.
+            const std::uint32_t begin = rangeBegin(range);
+            const std::uint32_t end = rangeEnd(range);
+            const std::uint32_t middle = begin + (end - begin) / 2;
+            if (victim.range.compare_exchange_weak(range, pack(begin, middle), std::memory_order_acq_rel)) {
+                workers_[thief].range.store(pack(middle, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,237 @@
+#include "spreadsheet.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+#include "expression_cache.h"
+
+namespace {
+
+/// Cells per parallelFor chunk when a level is evaluated in parallel
+constexpr std::size_t kLevelChunkCells = 256;
+
+bool isIdentifier(std::string_view name) {
+    if (name.empty() || !(std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_')) {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(),
+                       [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; });
+}
+
+} // namespace
+
+Spreadsheet::Spreadsheet(std::size_t workers) : workers_(workers) {}
+
+void Spreadsheet::set(std::string_view name, std::string_view formula) {
+    if (!isIdentifier(name)) {
+        throw std::invalid_argument("Invalid cell name: " + std::string(name));
+    }
+    std::shared_ptr<const Expression> expression = ExpressionCache::global().get(formula);
+
+    // Check for cycles before creating anything, so a rejected formula leaves
+    // the sheet untouched. Cells that do not exist yet cannot be on a cycle.
+    const std::vector<std::string>& variables = expression->variables();
+    if (std::find(variables.begin(), variables.end(), name) != variables.end()) {
+        throw std::invalid_argument("Circular reference: " + std::string(name) + " -> " + std::string(name));
+    }
+    const auto target = ids_.find(std::string(name));
+    if (target != ids_.end()) {
+        std::vector<CellId> existing;
+        for (const std::string& variable : variables) {
+            const auto it = ids_.find(variable);
+            if (it != ids_.end()) {
+                existing.push_back(it->second);
+            }
+        }
+        checkAcyclic(target->second, existing);
+    }
+
+    const CellId id = findOrCreate(name);
+    std::vector<CellId> inputs;
+    inputs.reserve(variables.size());
+    for (const std::string& variable : variables) {
+        inputs.push_back(findOrCreate(variable));
+    }
+
+    Cell& cell = cells_[id];
+    for (CellId input : cell.inputs) {
+        std::vector<CellId>& dependents = cells_[input].dependents;
+        dependents.erase(std::find(dependents.begin(), dependents.end(), id));
+    }
+    for (CellId input : inputs) {
+        cells_[input].dependents.push_back(id);
+    }
+    cell.inputs = std::move(inputs);
+    cell.formula = std::string(formula);
+    cell.expression = std::move(expression);
+    if (!cell.dirty) {
+        cell.dirty = true;
+        changed_.push_back(id);
+    }
+}
+
+Spreadsheet::RecalcStats Spreadsheet::recalculate() {
+    RecalcStats stats;
+    if (changed_.empty()) {
+        return stats;
+    }
+
+    // Everything downstream of a changed cell is affected.
+    const std::uint32_t mark = ++generation_;
+    std::vector<CellId> affected;
+    std::vector<CellId> stack = changed_;
+    while (!stack.empty()) {
+        const CellId id = stack.back();
+        stack.pop_back();
+        Cell& cell = cells_[id];
+        if (cell.mark == mark) {
+            continue;
+        }
+        cell.mark = mark;
+        affected.push_back(id);
+        stack.insert(stack.end(), cell.dependents.begin(), cell.dependents.end());
+    }
+
+    // Kahn's algorithm restricted to the affected cells: a cell is ready
+    // once all of its affected inputs have been recomputed.
+    std::vector<CellId> level;
+    for (CellId id : affected) {
+        Cell& cell = cells_[id];
+        cell.pending = static_cast<std::uint32_t>(std::count_if(
+            cell.inputs.begin(), cell.inputs.end(), [&](CellId input) { return cells_[input].mark == mark; }));
+        if (cell.pending == 0) {
+            level.push_back(id);
+        }
+    }
+
+    std::vector<CellId> next;
+    while (!level.empty()) {
+        if (level.size() >= kParallelLevelCells) {
+            if (!executor_) {
+                executor_ = std::make_unique<ParallelExecutor>(workers_);
+            }
+            executor_->parallelFor(level.size(), kLevelChunkCells, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    evaluate(cells_[level[i]]);
+                }
+            });
+        } else {
+            for (CellId id : level) {
+                evaluate(cells_[id]);
+            }
+        }
+
+        for (CellId id : level) {
+            for (CellId dependent : cells_[id].dependents) {
+                if (cells_[dependent].mark == mark && --cells_[dependent].pending == 0) {
+                    next.push_back(dependent);
+                }
+            }
+        }
+        stats.cells += level.size();
+        ++stats.levels;
+        level.swap(next);
+        next.clear();
+    }
+
+    for (CellId id : changed_) {
+        cells_[id].dirty = false;
+    }
+    changed_.clear();
+    return stats;
+}
+
+bool Spreadsheet::contains(std::string_view name) const {
+    return ids_.find(std::string(name)) != ids_.end();
+}
+
+Spreadsheet::CellView Spreadsheet::cell(std::string_view name) const {
+    const auto it = ids_.find(std::string(name));
+    if (it == ids_.end()) {
+        throw std::invalid_argument("Unknown cell: " + std::string(name));
+    }
+    const Cell& cell = cells_[it->second];
+    return {cell.name, cell.formula, cell.value, cell.error};
+}
+
+double Spreadsheet::value(std::string_view name) const {
+    const CellView view = cell(name);
+    if (!view.error.empty()) {
+        throw std::invalid_argument(std::string(name) + ": " + std::string(view.error));
+    }
+    return view.value;
+}
+
+std::vector<Spreadsheet::CellView> Spreadsheet::cells() const {
+    std::vector<CellView> views;
+    views.reserve(cells_.size());
+    for (const Cell& cell : cells_) {
+        views.push_back({cell.name, cell.formula, cell.value, cell.error});
+    }
+    return views;
+}
+
+Spreadsheet::CellId Spreadsheet::findOrCreate(std::string_view name) {
+    const auto [it, inserted] = ids_.try_emplace(std::string(name), static_cast<CellId>(cells_.size()));
+    if (inserted) {
+        Cell& cell = cells_.emplace_back();
+        cell.name = it->first;
+    }
+    return it->second;
+}
+
+void Spreadsheet::checkAcyclic(CellId target, const std::vector<CellId>& inputs) {
+    if (inputs.empty()) {
+        return;
+    }
+    // The new formula makes target depend on inputs. That closes a cycle if
+    // one of the inputs already depends on target, i.e. is downstream of it.
+    const std::uint32_t mark = ++generation_;
+    std::unordered_map<CellId, CellId> reachedFrom;
+    std::vector<CellId> stack = {target};
+    cells_[target].mark = mark;
+    while (!stack.empty()) {
+        const CellId id = stack.back();
+        stack.pop_back();
+        for (CellId dependent : cells_[id].dependents) {
+            if (cells_[dependent].mark == mark) {
+                continue;
+            }
+            cells_[dependent].mark = mark;
+            reachedFrom[dependent] = id;
+            if (std::find(inputs.begin(), inputs.end(), dependent) != inputs.end()) {
+                std::string path = cells_[target].name;
+                for (CellId step = dependent; step != target; step = reachedFrom[step]) {
+                    path += " -> " + cells_[step].name;
+                }
+                throw std::invalid_argument("Circular reference: " + path + " -> " + cells_[target].name);
+            }
+            stack.push_back(dependent);
+        }
+    }
+}
+
+void Spreadsheet::evaluate(Cell& cell) {
+    if (!cell.expression) {
+        cell.value = 0.0;
+        return;
+    }
+    thread_local std::vector<double> values;
+    values.resize(cell.inputs.size());
+    for (std::size_t i = 0; i < cell.inputs.size(); ++i) {
+        const Cell& input = cells_[cell.inputs[i]];
+        if (!input.error.empty()) {
+            cell.value = std::numeric_limits<double>::quiet_NaN();
+            cell.error = "Error in " + input.name;
+            return;
+        }
+        values[i] = input.value;
+    }
+    try {
+        cell.value = cell.expression->evaluate(values);
+        cell.error.clear();
+    } catch (const std::invalid_argument& e) {
+        cell.value = std::numeric_limits<double>::quiet_NaN();
+        cell.error = e.what();
+    }
+}
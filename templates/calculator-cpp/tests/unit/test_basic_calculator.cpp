@@ -0,0 +1,101 @@
+/**
+ * @file test_basic_calculator.cpp
+ * @brief Saturation edge cases of BasicCalculator, at compile time and at runtime
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include "basic_calculator.h"
+
+namespace {
+
+template <typename T>
+constexpr T kMin = std::numeric_limits<T>::min();
+template <typename T>
+constexpr T kMax = std::numeric_limits<T>::max();
+
+using I32 = BasicCalculator<std::int32_t>;
+using I64 = BasicCalculator<std::int64_t>;
+using U32 = BasicCalculator<std::uint32_t>;
+using Fixed = BasicCalculator<Q16_16>;
+
+// Multiplying by -1 and 1, including the one product (MIN * -1) that overflows
+static_assert(I32::multiply(5, -1) == -5);
+static_assert(I32::multiply(-1, 5) == -5);
+static_assert(I32::multiply(-1, -1) == 1);
+static_assert(I32::multiply(kMin<std::int32_t>, -1) == kMax<std::int32_t>);
+static_assert(I32::multiply(-1, kMin<std::int32_t>) == kMax<std::int32_t>);
+static_assert(I32::multiply(kMax<std::int32_t>, -1) == -kMax<std::int32_t>);
+static_assert(I32::multiply(kMin<std::int32_t>, 1) == kMin<std::int32_t>);
+static_assert(I32::multiply(1, kMax<std::int32_t>) == kMax<std::int32_t>);
+static_assert(I64::multiply(kMin<std::int64_t>, -1) == kMax<std::int64_t>);
+static_assert(I64::multiply(-1, 7) == -7);
+
+// Saturation at both ends
+static_assert(I32::multiply(kMin<std::int32_t>, 2) == kMin<std::int32_t>);
+static_assert(I32::multiply(kMin<std::int32_t>, -2) == kMax<std::int32_t>);
+static_assert(I32::multiply(kMax<std::int32_t>, kMax<std::int32_t>) == kMax<std::int32_t>);
+static_assert(I32::multiply(kMax<std::int32_t>, kMin<std::int32_t>) == kMin<std::int32_t>);
+static_assert(I32::multiply(kMin<std::int32_t>, kMin<std::int32_t>) == kMax<std::int32_t>);
+static_assert(I32::multiply(46341, 46341) == kMax<std::int32_t>);
+static_assert(I32::multiply(46340, 46340) == 2147395600);
+static_assert(I64::multiply(kMax<std::int64_t>, -2) == kMin<std::int64_t>);
+static_assert(BasicCalculator<std::int8_t>::multiply(-128, -1) == 127);
+static_assert(U32::multiply(kMax<std::uint32_t>, 2) == kMax<std::uint32_t>);
+
+static_assert(I32::add(kMax<std::int32_t>, 1) == kMax<std::int32_t>);
+static_assert(I32::add(kMin<std::int32_t>, -1) == kMin<std::int32_t>);
+static_assert(I32::subtract(kMin<std::int32_t>, 1) == kMin<std::int32_t>);
+static_assert(I32::subtract(0, kMin<std::int32_t>) == kMax<std::int32_t>);
+static_assert(U32::subtract(1, 2) == 0);
+static_assert(I32::divide(kMin<std::int32_t>, -1) == kMax<std::int32_t>);
+static_assert(I32::divide(-7, 2) == -3);
+
+static_assert(Fixed::multiply(Q16_16::max(), Q16_16::fromRaw(-(1 << 16))) == Q16_16::fromRaw(-kMax<std::int32_t>));
+static_assert(Fixed::multiply(Q16_16::lowest(), Q16_16::fromRaw(-(1 << 16))) == Q16_16::max());
+
+// Integer conversion saturates without overflowing the scaled intermediate
+static_assert(Q16_16(32767) == Q16_16::fromRaw(32767 << 16));
+static_assert(Q16_16(32768) == Q16_16::max());
+static_assert(Q16_16(-32768) == Q16_16::lowest());
+static_assert(Q16_16(kMax<std::int64_t>) == Q16_16::max());
+static_assert(Q16_16(kMin<std::int64_t>) == Q16_16::lowest());
+static_assert(Q16_16(kMax<std::uint64_t>) == Q16_16::max());
+static_assert(Q31(kMax<std::int32_t>) == Q31::max());
+static_assert(Q31(kMin<std::int32_t>) == Q31::lowest());
+static_assert(Q31(-1) == Q31::lowest());
+
+} // namespace
+
+TEST(BasicCalculatorTest, MultiplyByMinusOneAtRuntime) {
+    // volatile keeps the compiler from folding the calls
+    volatile std::int32_t minusOne = -1;
+    volatile std::int32_t min32 = kMin<std::int32_t>;
+    volatile std::int64_t min64 = kMin<std::int64_t>;
+    EXPECT_EQ(I32::multiply(5, minusOne), -5);
+    EXPECT_EQ(I32::multiply(minusOne, 5), -5);
+    EXPECT_EQ(I32::multiply(min32, minusOne), kMax<std::int32_t>);
+    EXPECT_EQ(I32::multiply(minusOne, min32), kMax<std::int32_t>);
+    EXPECT_EQ(I64::multiply(min64, std::int64_t{minusOne}), kMax<std::int64_t>);
+    EXPECT_EQ(I64::multiply(std::int64_t{minusOne}, kMax<std::int64_t>), -kMax<std::int64_t>);
+}
+
+TEST(BasicCalculatorTest, MultiplyMatchesWideProductForSmallTypes) {
+    for (int a = -128; a <= 127; ++a) {
+        for (int b = -128; b <= 127; ++b) {
+            const int exact = std::clamp(a * b, -128, 127);
+            ASSERT_EQ(BasicCalculator<std::int8_t>::multiply(static_cast<std::int8_t>(a), static_cast<std::int8_t>(b)),
+                      exact)
+                << a << " * " << b;
+        }
+    }
+}
+
+TEST(BasicCalculatorTest, DivisionByZeroThrowsAtRuntime) {
+    volatile std::int32_t zero = 0;
+    EXPECT_THROW(I32::divide(1, zero), std::invalid_argument);
+    EXPECT_THROW(Fixed::divide(Q16_16::fromRaw(1), Q16_16::fromRaw(zero)), std::invalid_argument);
+}
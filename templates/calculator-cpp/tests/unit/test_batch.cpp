@@ -0,0 +1,144 @@
+/**
+ * @file test_batch.cpp
+ * @brief Batch operations at every SIMD level
+ *
+ * The batch kernels must give the same bits as the scalar operations for
+ * every length, including the tails that do not fill a SIMD register.
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "calculator.h"
+
+namespace {
+
+std::vector<double> randomValues(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> value(-1e6, 1e6);
+    std::vector<double> values(n);
+    for (double& x : values) {
+        x = value(rng);
+    }
+    return values;
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+bool maskBit(const std::vector<std::uint64_t>& mask, std::size_t i) {
+    return (mask[i / 64] >> (i % 64) & 1) != 0;
+}
+
+} // namespace
+
+class BatchTest : public ::testing::TestWithParam<Calculator::SimdLevel> {
+protected:
+    void SetUp() override {
+        Calculator::setSimdLevel(GetParam());
+    }
+
+    void TearDown() override {
+        Calculator::setSimdLevel(Calculator::detectedSimdLevel());
+    }
+};
+
+TEST_P(BatchTest, MatchesScalarOperationsForEveryTailLength) {
+    for (std::size_t n = 0; n <= 70; ++n) {
+        const std::vector<double> a = randomValues(n, 1);
+        const std::vector<double> b = randomValues(n, 2);
+        std::vector<double> sums(n);
+        std::vector<double> differences(n);
+        std::vector<double> products(n);
+        Calculator::add(a, b, sums);
+        Calculator::subtract(a, b, differences);
+        Calculator::multiply(a, b, products);
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_TRUE(sameBits(sums[i], Calculator::add(a[i], b[i]))) << "n = " << n << ", i = " << i;
+            ASSERT_TRUE(sameBits(differences[i], Calculator::subtract(a[i], b[i]))) << "n = " << n << ", i = " << i;
+            ASSERT_TRUE(sameBits(products[i], Calculator::multiply(a[i], b[i]))) << "n = " << n << ", i = " << i;
+        }
+    }
+}
+
+TEST_P(BatchTest, OutputMayAliasAnOperand) {
+    std::vector<double> a = randomValues(37, 3);
+    const std::vector<double> b = randomValues(37, 4);
+    const std::vector<double> original = a;
+    Calculator::multiply(a, b, a);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        EXPECT_TRUE(sameBits(a[i], original[i] * b[i])) << "i = " << i;
+    }
+}
+
+TEST_P(BatchTest, RejectsMismatchedSizes) {
+    std::vector<double> a(8);
+    std::vector<double> b(7);
+    std::vector<double> out(8);
+    std::vector<std::uint64_t> mask(1);
+    EXPECT_THROW(Calculator::add(a, b, out), std::invalid_argument);
+    EXPECT_THROW(Calculator::subtract(a, a, b), std::invalid_argument);
+    EXPECT_THROW(Calculator::multiply(b, a, out), std::invalid_argument);
+    EXPECT_THROW(Calculator::divide(a, b, out, mask), std::invalid_argument);
+}
+
+TEST_P(BatchTest, DivideFlagsExactlyTheZeroDivisorLanes) {
+    for (std::size_t n : {std::size_t{1}, std::size_t{5}, std::size_t{63}, std::size_t{64}, std::size_t{65},
+                          std::size_t{200}}) {
+        std::vector<double> a = randomValues(n, 5);
+        std::vector<double> b = randomValues(n, 6);
+        for (std::size_t i = 0; i < n; i += 3) {
+            b[i] = i % 2 == 0 ? 0.0 : -0.0;
+        }
+        a[0] = 0.0;  // 0 / 0 is NaN
+        std::vector<double> out(n);
+        // Stale bits from an earlier call must be cleared
+        std::vector<std::uint64_t> mask(Calculator::zeroMaskWords(n), ~std::uint64_t{0});
+
+        const std::size_t zeros = Calculator::divide(a, b, out, mask);
+        EXPECT_EQ(zeros, (n + 2) / 3) << "n = " << n;
+        for (std::size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(maskBit(mask, i), b[i] == 0.0) << "n = " << n << ", i = " << i;
+            if (b[i] != 0.0) {
+                ASSERT_TRUE(sameBits(out[i], Calculator::divide(a[i], b[i]))) << "n = " << n << ", i = " << i;
+            }
+        }
+        EXPECT_TRUE(std::isnan(out[0]));
+        if (n > 3) {
+            EXPECT_TRUE(std::isinf(out[3]));
+            EXPECT_EQ(std::signbit(out[3]), std::signbit(a[3]) != std::signbit(b[3]));
+        }
+    }
+}
+
+TEST_P(BatchTest, DivideNeedsAWholeMask) {
+    std::vector<double> a(65, 1.0);
+    std::vector<double> out(65);
+    std::vector<std::uint64_t> mask(1);
+    EXPECT_THROW(Calculator::divide(a, a, out, mask), std::invalid_argument);
+    mask.resize(Calculator::zeroMaskWords(a.size()));
+    EXPECT_EQ(Calculator::divide(a, a, out, mask), 0u);
+    EXPECT_EQ(out[64], 1.0);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, BatchTest,
+                         ::testing::Values(Calculator::SimdLevel::Scalar, Calculator::SimdLevel::SSE2,
+                                           Calculator::SimdLevel::AVX2),
+                         [](const ::testing::TestParamInfo<Calculator::SimdLevel>& info) {
+                             return std::string(Calculator::simdLevelName(info.param));
+                         });
+
+TEST(SimdLevelTest, RequestsAreClampedToTheCpu) {
+    const Calculator::SimdLevel detected = Calculator::detectedSimdLevel();
+    EXPECT_EQ(Calculator::setSimdLevel(Calculator::SimdLevel::Scalar), Calculator::SimdLevel::Scalar);
+    EXPECT_EQ(Calculator::simdLevel(), Calculator::SimdLevel::Scalar);
+    EXPECT_EQ(Calculator::setSimdLevel(Calculator::SimdLevel::AVX2), detected);
+    EXPECT_EQ(Calculator::simdLevel(), detected);
+}
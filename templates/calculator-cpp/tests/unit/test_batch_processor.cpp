@@ -0,0 +1,135 @@
+/**
+ * @file test_batch_processor.cpp
+ * @brief File formats, column binding and error handling of BatchProcessor
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "batch_processor.h"
+
+class BatchProcessorTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        for (const std::string& path : paths_) {
+            std::remove(path.c_str());
+        }
+    }
+
+    std::string path(const std::string& name) {
+        paths_.push_back("/tmp/batch_processor_test." + std::to_string(::getpid()) + "." + name);
+        return paths_.back();
+    }
+
+    static void write(const std::string& path, const std::string& bytes) {
+        std::ofstream(path, std::ios::binary) << bytes;
+    }
+
+    static std::string read(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream bytes;
+        bytes << file.rdbuf();
+        return bytes.str();
+    }
+
+    static BatchStats run(const std::string& formula, const std::string& input, const std::string& output) {
+        BatchOptions options;
+        options.formula = formula;
+        options.inputPath = input;
+        options.outputPath = output;
+        options.inputFormat = BatchProcessor::formatForPath(input);
+        options.outputFormat = BatchProcessor::formatForPath(output);
+        return BatchProcessor(options).run();
+    }
+
+    std::vector<std::string> paths_;
+};
+
+TEST_F(BatchProcessorTest, CsvHeaderBindsColumnsByName) {
+    const std::string input = path("in.csv");
+    const std::string output = path("out.csv");
+    write(input, "b, a\n2, 10\n4, 1.5\n0.5,-3\n");
+    const BatchStats stats = run("a - b", input, output);
+    EXPECT_EQ(stats.rows, 3u);
+    EXPECT_EQ(read(output), "8\n-2.5\n-3.5\n");
+}
+
+TEST_F(BatchProcessorTest, CsvWithoutHeaderBindsColumnsInOrder) {
+    const std::string input = path("in.csv");
+    const std::string output = path("out.csv");
+    write(input, "1,2\r\n3,4\r\n");
+    EXPECT_EQ(run("divide", input, output).rows, 2u);
+    EXPECT_EQ(read(output), "0.5\n0.75\n");
+}
+
+TEST_F(BatchProcessorTest, BinaryRoundTripAndZeroDivisors) {
+    const std::string input = path("in.bin");
+    const std::string output = path("out.bin");
+    // More rows than one chunk, so chunk boundaries are crossed
+    const std::size_t rows = BatchProcessor::kChunkRows * 2 + 17;
+    std::vector<double> operands;
+    for (std::size_t i = 0; i < rows; ++i) {
+        operands.push_back(static_cast<double>(i));
+        operands.push_back(i % 100 == 0 ? 0.0 : 2.0);
+    }
+    write(input, std::string(reinterpret_cast<const char*>(operands.data()), operands.size() * sizeof(double)));
+
+    const BatchStats stats = run("divide", input, output);
+    EXPECT_EQ(stats.rows, rows);
+    EXPECT_EQ(stats.zeroDivisorRows, (rows + 99) / 100);
+    EXPECT_EQ(stats.bytesWritten, rows * sizeof(double));
+
+    const std::string bytes = read(output);
+    ASSERT_EQ(bytes.size(), rows * sizeof(double));
+    const auto* results = reinterpret_cast<const double*>(bytes.data());
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (i % 100 == 0) {
+            ASSERT_TRUE(i == 0 ? std::isnan(results[i]) : std::isinf(results[i])) << "row " << i;
+        } else {
+            ASSERT_EQ(results[i], static_cast<double>(i) / 2.0) << "row " << i;
+        }
+    }
+}
+
+TEST_F(BatchProcessorTest, MalformedInputIsReported) {
+    const std::string output = path("out.csv");
+    const std::string badRow = path("bad.csv");
+    write(badRow, "a,b\n1,2\n3,x\n");
+    try {
+        run("a + b", badRow, output);
+        FAIL() << "malformed row accepted";
+    } catch (const std::runtime_error& e) {
+        EXPECT_EQ(std::string(e.what()), "Malformed CSV row at line 3");
+    }
+
+    const std::string missingColumn = path("missing.csv");
+    write(missingColumn, "a,c\n1,2\n");
+    EXPECT_THROW(run("a + b", missingColumn, output), std::runtime_error);
+
+    const std::string partial = path("partial.bin");
+    const double values[3] = {1.0, 2.0, 3.0};
+    write(partial, std::string(reinterpret_cast<const char*>(values), sizeof(values)));
+    EXPECT_THROW(run("add", partial, path("out.bin")), std::runtime_error);
+
+    EXPECT_THROW(run("add", path("does-not-exist.bin"), output), std::runtime_error);
+}
+
+TEST_F(BatchProcessorTest, FormulasAndFormats) {
+    EXPECT_EQ(BatchProcessor::expandOperation("multiply"), "a * b");
+    EXPECT_EQ(BatchProcessor::expandOperation("x / 2"), "x / 2");
+    EXPECT_EQ(BatchProcessor::formatForPath("values.csv"), BatchFormat::Csv);
+    EXPECT_EQ(BatchProcessor::formatForPath("values.txt"), BatchFormat::Csv);
+    EXPECT_EQ(BatchProcessor::formatForPath("values.bin"), BatchFormat::Binary);
+
+    BatchOptions options;
+    options.formula = "1 + 2";
+    EXPECT_THROW(BatchProcessor{options}, std::invalid_argument);
+    options.formula = "a +";
+    EXPECT_THROW(BatchProcessor{options}, std::invalid_argument);
+}
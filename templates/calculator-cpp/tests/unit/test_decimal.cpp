@@ -0,0 +1,84 @@
+/**
+ * @file test_decimal.cpp
+ * @brief Exactness, rounding and storage tests for Decimal
+ */
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include "decimal.h"
+
+namespace {
+
+Decimal d(const char* text) {
+    return Decimal::parse(text);
+}
+
+std::string divided(const char* a, const char* b, int scale) {
+    Decimal out;
+    Decimal::divide(d(a), d(b), out, scale);
+    return out.toString();
+}
+
+} // namespace
+
+TEST(DecimalTest, ParsesAndPrintsExactly) {
+    EXPECT_EQ(d("-1234.5600").toString(), "-1234.5600");
+    EXPECT_EQ(d("-1234.5600").scale(), 4);
+    EXPECT_EQ(d("1.5e-3").toString(), "0.0015");
+    EXPECT_EQ(d("-0.05").toString(), "-0.05");
+    EXPECT_EQ(d("0.000000000001").toString(), "0.000000000001");
+    EXPECT_EQ(d("1234567890123456789012345678901234567890").toString(), "1234567890123456789012345678901234567890");
+    EXPECT_EQ(d("-0").toString(), "0");
+    EXPECT_EQ(Decimal::fromDouble(0.1).toString(), "0.1");
+    EXPECT_THROW(d("1.2.3"), std::invalid_argument);
+    EXPECT_THROW(d(""), std::invalid_argument);
+    EXPECT_THROW(Decimal::fromDouble(1.0 / 0.0), std::invalid_argument);
+}
+
+TEST(DecimalTest, AdditionAndMultiplicationAreExact) {
+    EXPECT_EQ((d("0.1") + d("0.2")).toString(), "0.3");
+    EXPECT_EQ(d("0.1") + d("0.2"), d("0.30"));
+    EXPECT_EQ((d("1") - d("1.000000000000000000001")).toString(), "-0.000000000000000000001");
+    EXPECT_EQ((d("19999999999999999999999999.99") * Decimal(3)).toString(), "59999999999999999999999999.97");
+    EXPECT_EQ((d("-1.5") * d("-1.5")).toString(), "2.25");
+    EXPECT_TRUE(d("-2") < d("1.5"));
+}
+
+TEST(DecimalTest, DivisionRoundsHalfToEven) {
+    EXPECT_EQ((Decimal(1) / Decimal(4)).toString(), "0.25");
+    EXPECT_EQ((Decimal(10) / Decimal(3)).toString(), "3.333333333333333333");
+    EXPECT_EQ((Decimal(2) / Decimal(3)).toString(), "0.666666666666666667");
+    EXPECT_EQ(divided("1", "8", 2), "0.12");    // 0.125: tie, 2 is even
+    EXPECT_EQ(divided("3", "8", 2), "0.38");    // 0.375: tie, 8 is even
+    EXPECT_EQ(divided("-1", "8", 2), "-0.12");
+    EXPECT_EQ(divided("5", "2", 0), "2");
+    EXPECT_EQ(divided("7", "2", 0), "4");
+    EXPECT_EQ(divided("1", "3", 0), "0");
+    EXPECT_EQ(divided("1", "0.003", 3), "333.333");
+    EXPECT_THROW(Decimal(1) / Decimal(0), std::invalid_argument);
+    EXPECT_THROW(divided("1", "3", Decimal::kMaxScale + 1), std::invalid_argument);
+}
+
+TEST(DecimalTest, RoundedToScale) {
+    EXPECT_EQ(d("2.345").rounded(2).toString(), "2.34");
+    EXPECT_EQ(d("2.355").rounded(2).toString(), "2.36");
+    EXPECT_EQ(d("-2.5").rounded(0).toString(), "-2");
+    EXPECT_EQ(d("9.995").rounded(2).toString(), "10.00");
+    EXPECT_EQ(d("1.5").rounded(3).toString(), "1.500");
+}
+
+TEST(DecimalTest, LongValuesUseTheArena) {
+    const Decimal small = d("123456789012345678901234567890.12345678");
+    EXPECT_TRUE(small.isInline());
+
+    DecimalArena arena;
+    Decimal product;
+    Decimal::multiply(small, small, product, &arena);
+    EXPECT_FALSE(product.isInline());
+    EXPECT_GT(arena.bytesReserved(), 0u);
+    const Decimal copy = product;  // takes its own storage
+    arena.reset();
+    EXPECT_EQ(copy.toString(),
+              "15241578753238836750495351562566681942783112355403139767652.7968299765279684");
+}
@@ -0,0 +1,39 @@
+/**
+ * @file test_division.cpp
+ * @brief Results and zero-divisor reporting of every division policy
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "calculator.h"
+
+TEST(DivisionPolicyTest, EveryPolicyReturnsTheQuotient) {
+    EXPECT_EQ(Calculator::divide<ThrowPolicy>(9.0, 4.0), 2.25);
+    EXPECT_EQ(Calculator::divide<StatusPolicy>(9.0, 4.0).value(), 2.25);
+    EXPECT_EQ(Calculator::divide<IeeePolicy>(9.0, 4.0), 2.25);
+    StickyFlagPolicy::clear();
+    EXPECT_EQ(Calculator::divide<StickyFlagPolicy>(9.0, 4.0), 2.25);
+    EXPECT_FALSE(StickyFlagPolicy::raised());
+}
+
+TEST(DivisionPolicyTest, ZeroDivisorIsReportedPerPolicy) {
+    EXPECT_THROW(Calculator::divide<ThrowPolicy>(1.0, 0.0), std::invalid_argument);
+
+    const DivisionResult status = Calculator::divide<StatusPolicy>(1.0, 0.0);
+    EXPECT_FALSE(status);
+    EXPECT_EQ(status.error(), DivisionStatus::DivisionByZero);
+    EXPECT_EQ(status.value_or(-1.0), -1.0);
+    EXPECT_EQ(Calculator::divide<StatusPolicy>(1.0, 2.0).error(), DivisionStatus::Ok);
+
+    EXPECT_EQ(Calculator::divide<IeeePolicy>(-1.0, 0.0), -std::numeric_limits<double>::infinity());
+    EXPECT_TRUE(std::isnan(Calculator::divide<IeeePolicy>(0.0, 0.0)));
+
+    StickyFlagPolicy::clear();
+    EXPECT_EQ(Calculator::divide<StickyFlagPolicy>(1.0, 0.0), std::numeric_limits<double>::infinity());
+    Calculator::divide<StickyFlagPolicy>(1.0, 2.0);
+    EXPECT_TRUE(StickyFlagPolicy::raised());  // sticky until cleared
+    StickyFlagPolicy::clear();
+    EXPECT_FALSE(StickyFlagPolicy::raised());
+}
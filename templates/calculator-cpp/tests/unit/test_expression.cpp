@@ -0,0 +1,154 @@
+/**
+ * @file test_expression.cpp
+ * @brief Parsing, constant folding and evaluation tests for Expression
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "calculator.h"
+#include "decimal.h"
+#include "expression.h"
+#include "expression_parser.h"
+
+namespace {
+
+std::string nested(std::size_t depth) {
+    return std::string(depth, '(') + "1" + std::string(depth, ')');
+}
+
+/// Message of the std::invalid_argument thrown by compiling source
+std::string compileError(const std::string& source) {
+    try {
+        Expression::compile(source);
+    } catch (const std::invalid_argument& e) {
+        return e.what();
+    }
+    return "";
+}
+
+} // namespace
+
+TEST(ExpressionTest, NestingIsLimited) {
+    EXPECT_EQ(Expression::compile(nested(256)).evaluate({}), 1.0);
+    EXPECT_EQ(Expression::compile(std::string(256, '-') + "2").evaluate({}), 2.0);
+
+    EXPECT_EQ(compileError(nested(257)), "Expression is nested too deeply at column 258");
+    EXPECT_EQ(compileError(std::string(257, '-') + "2"), "Expression is nested too deeply at column 258");
+    // Deep enough to overflow the stack without the limit
+    EXPECT_THROW(parseExpression(nested(100000)), std::invalid_argument);
+    EXPECT_THROW(parseExpression(std::string(100000, '+') + "1"), std::invalid_argument);
+}
+
+TEST(ExpressionTest, OperatorCountIsLimited) {
+    std::string sum = "x";
+    for (int i = 0; i < 65536; ++i) {
+        sum += "+x";
+    }
+    EXPECT_EQ(Expression::compile(sum).evaluate(std::vector<double>{1.0}), 65537.0);
+    sum += "+x";
+    EXPECT_NE(compileError(sum).find("Expression is too long"), std::string::npos);
+}
+
+TEST(ExpressionTest, ParseErrorsReportTheColumn) {
+    EXPECT_EQ(compileError("1 +"), "Unexpected end of expression at column 4");
+    EXPECT_EQ(compileError("(a + 2"), "Expected ')' at column 7");
+    EXPECT_EQ(compileError("a $ b"), "Unexpected character '$' at column 3");
+    EXPECT_EQ(compileError("2 3"), "Unexpected character '3' at column 3");
+    EXPECT_EQ(compileError(""), "Unexpected end of expression at column 1");
+    EXPECT_EQ(compileError("* 2"), "Unexpected character '*' at column 1");
+}
+
+TEST(ExpressionTest, PrecedenceAndAssociativity) {
+    EXPECT_EQ(Expression::compile("1 + 2 * 3").evaluate({}), 7.0);
+    EXPECT_EQ(Expression::compile("8 - 4 - 2").evaluate({}), 2.0);
+    EXPECT_EQ(Expression::compile("16 / 4 / 2").evaluate({}), 2.0);
+    EXPECT_EQ(Expression::compile("-(2 + 3) * +2").evaluate({}), -10.0);
+    EXPECT_EQ(Expression::compile("1.5e2 + .5").evaluate({}), 150.5);
+}
+
+TEST(ExpressionTest, VariablesAreOrderedByFirstUse) {
+    const Expression expression = Expression::compile("b * 10 + a - b");
+    ASSERT_EQ(expression.variables(), (std::vector<std::string>{"b", "a"}));
+    EXPECT_EQ(expression.variableIndex("a"), 1u);
+    EXPECT_EQ(expression.variableIndex("c"), 2u);
+    EXPECT_EQ(expression.evaluate(std::vector<double>{2.0, 1.0}), 19.0);
+    EXPECT_THROW(expression.evaluate(std::vector<double>{2.0}), std::invalid_argument);
+}
+
+TEST(ExpressionTest, ConstantsAreFolded) {
+    const Expression expression = Expression::compile("x * (2 + 3 * 4)");
+    ASSERT_EQ(expression.constants().size(), 1u);
+    EXPECT_EQ(expression.constants()[0], 14.0);
+    EXPECT_EQ(expression.code().size(), 3u);  // load x, load 14, multiply
+
+    // A constant division by zero is kept, and reported when evaluated
+    const Expression byZero = Expression::compile("1 / 0");
+    EXPECT_THROW(byZero.evaluate({}), std::invalid_argument);
+}
+
+TEST(ExpressionTest, ColumnsFlagDivisionByZero) {
+    const Expression expression = Expression::compile("(a + 1) / b");
+    std::vector<double> a(300);
+    std::vector<double> b(300);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<double>(i);
+        b[i] = i % 7 == 0 ? 0.0 : static_cast<double>(i % 5 + 1);
+    }
+    const std::vector<std::span<const double>> columns = {a, b};
+    std::vector<double> out(a.size());
+    std::vector<std::uint64_t> mask(Calculator::zeroMaskWords(out.size()));
+    EXPECT_EQ(expression.evaluate(columns, out, mask), 43u);
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        ASSERT_EQ((mask[i / 64] >> (i % 64) & 1) != 0, b[i] == 0.0) << "i = " << i;
+        if (b[i] == 0.0) {
+            ASSERT_TRUE(std::isinf(out[i])) << "i = " << i;
+        } else {
+            ASSERT_EQ(out[i], (a[i] + 1.0) / b[i]) << "i = " << i;
+        }
+    }
+
+    std::vector<double> shortColumn(10);
+    const std::vector<std::span<const double>> mismatched = {a, shortColumn};
+    EXPECT_THROW(expression.evaluate(mismatched, out), std::invalid_argument);
+}
+
+TEST(ExpressionTest, DecimalColumnsAreExact) {
+    const Expression expression = Expression::compile("price * 3 + 0.1");
+    const std::vector<Decimal> prices = {Decimal::parse("0.2"), Decimal::parse("19999999999999999999999999.99")};
+    const std::vector<std::span<const Decimal>> columns = {prices};
+    std::vector<Decimal> out(prices.size());
+    DecimalArena arena;
+    expression.evaluate(columns, out, arena);
+    EXPECT_EQ(out[0].toString(), "0.7");
+    EXPECT_EQ(out[1].toString(), "60000000000000000000000000.07");
+}
+
+TEST(ExpressionTest, DecimalConstantsKeepTheLiteralsAsWritten) {
+    const auto evaluate = [](const Expression& expression, const char* x) {
+        const std::vector<Decimal> xs = {Decimal::parse(x)};
+        const std::vector<std::span<const Decimal>> columns = {xs};
+        std::vector<Decimal> out(1);
+        DecimalArena arena;
+        expression.evaluate(columns, out, arena);
+        return out[0].toString();
+    };
+
+    // Folded once in double for the double overloads, and exactly for Decimal
+    const Expression folded = Expression::compile("x * (0.1 + 0.2)");
+    ASSERT_EQ(folded.constants().size(), 1u);
+    EXPECT_EQ(folded.constants()[0], 0.1 + 0.2);
+    EXPECT_EQ(evaluate(folded, "1"), "0.3");
+
+    EXPECT_EQ(evaluate(Expression::compile("x * 12345678901234567890.12"), "1"), "12345678901234567890.12");
+    EXPECT_EQ(evaluate(Expression::compile("x * -(1 / 3) + 1.5e2"), "3"), "149.000000000000000001");
+
+    // Literals that are the same double are still different constants
+    const Expression close = Expression::compile("x * 0.1 + 0.10000000000000000001");
+    EXPECT_EQ(close.constants().size(), 2u);
+    EXPECT_EQ(evaluate(close, "1"), "0.20000000000000000001");
+}
@@ -0,0 +1,107 @@
+/**
+ * @file test_expression_cache.cpp
+ * @brief Key normalization, LRU eviction and capacity of ExpressionCache
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "expression_cache.h"
+
+TEST(ExpressionCacheTest, EquivalentSpellingsShareOneEntry) {
+    std::string key;
+    ExpressionCache::normalize(" x * 2.50 ", key);
+    EXPECT_EQ(key, "x*2.5");
+    ExpressionCache::normalize("a b", key);
+    EXPECT_EQ(key, "a b");
+
+    ExpressionCache cache(64);
+    const auto first = cache.get("a+2");
+    EXPECT_EQ(cache.get("a + 2.0"), first);
+    EXPECT_EQ(cache.get(" a+2e0 "), first);
+    const ExpressionCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.size, 1u);
+}
+
+TEST(ExpressionCacheTest, LiteralsBeyondDoublePrecisionAreKept) {
+    std::string key;
+    ExpressionCache::normalize("x * 0.10000000000000000001 + 12345678901234567890", key);
+    EXPECT_EQ(key, "x*0.10000000000000000001+12345678901234567890");
+    ExpressionCache::normalize("x * 0.000123456789012345", key);  // 15 significant digits
+    EXPECT_EQ(key, "x*0.000123456789012345");
+
+    ExpressionCache cache(64);
+    EXPECT_NE(cache.get("x * 0.1"), cache.get("x * 0.10000000000000000001"));
+}
+
+TEST(ExpressionCacheTest, FailedCompilesAreNotCached) {
+    ExpressionCache cache(64);
+    EXPECT_THROW(cache.get("1 +"), std::invalid_argument);
+    EXPECT_THROW(cache.get("1 +"), std::invalid_argument);
+    EXPECT_EQ(cache.stats().size, 0u);
+    EXPECT_EQ(cache.stats().misses, 2u);
+}
+
+TEST(ExpressionCacheTest, EvictsTheLeastRecentlyUsedEntry) {
+    // Formulas in the same shard as "x + 0": with one slot in each of the
+    // kShards shards, getting one of them evicts "x + 0"
+    std::vector<std::string> sameShard;
+    for (int i = 1; sameShard.size() < 2 && i < 1000; ++i) {
+        ExpressionCache probe(ExpressionCache::kShards);
+        probe.get("x + 0");
+        const std::string formula = "x + " + std::to_string(i);
+        probe.get(formula);
+        probe.get("x + 0");
+        if (probe.stats().hits == 0) {
+            sameShard.push_back(formula);
+        }
+    }
+    ASSERT_EQ(sameShard.size(), 2u);
+
+    // Two slots per shard: touching "x + 0" makes sameShard[0] the oldest
+    ExpressionCache cache(16);
+    EXPECT_EQ(cache.capacity(), 16u);
+    cache.get("x + 0");
+    cache.get(sameShard[0]);
+    cache.get("x + 0");
+    cache.get(sameShard[1]);
+    EXPECT_EQ(cache.stats().evictions, 1u);
+
+    const std::uint64_t hits = cache.stats().hits;
+    cache.get("x + 0");
+    cache.get(sameShard[1]);
+    EXPECT_EQ(cache.stats().hits, hits + 2);
+    cache.get(sameShard[0]);
+    EXPECT_EQ(cache.stats().hits, hits + 2);
+    EXPECT_EQ(cache.stats().evictions, 2u);
+}
+
+TEST(ExpressionCacheTest, SizeStaysWithinCapacity) {
+    ExpressionCache cache(8);
+    for (int i = 0; i < 100; ++i) {
+        cache.get("y * " + std::to_string(i));
+    }
+    const ExpressionCache::Stats stats = cache.stats();
+    EXPECT_LE(stats.size, 8u);
+    EXPECT_EQ(stats.evictions, 100 - stats.size);
+    cache.clear();
+    EXPECT_EQ(cache.stats().size, 0u);
+}
+
+TEST(ExpressionCacheTest, SmallCapacitiesAreExact) {
+    for (const std::size_t capacity : {std::size_t{0}, std::size_t{1}, std::size_t{3}, std::size_t{7}}) {
+        ExpressionCache cache(capacity);
+        EXPECT_EQ(cache.capacity(), std::max<std::size_t>(capacity, 1)) << "capacity " << capacity;
+        for (int i = 0; i < 100; ++i) {
+            cache.get("z - " + std::to_string(i));
+        }
+        EXPECT_EQ(cache.stats().size, cache.capacity()) << "capacity " << capacity;
+    }
+    EXPECT_EQ(ExpressionCache(8).capacity(), 8u);
+    EXPECT_EQ(ExpressionCache(10).capacity(), 16u);  // rounded up to whole shards
+}
@@ -0,0 +1,99 @@
+/**
+ * @file test_parallel_executor.cpp
+ * @brief Coverage, ordering, cancellation and errors of ParallelExecutor jobs
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include "calculator.h"
+#include "expression.h"
+#include "parallel_executor.h"
+
+TEST(ParallelExecutorTest, EveryRowRunsExactlyOnce) {
+    ParallelExecutor executor(4);
+    ASSERT_EQ(executor.workerCount(), 4u);
+    for (std::size_t rows : {std::size_t{0}, std::size_t{1}, std::size_t{999}, std::size_t{100000}}) {
+        std::vector<std::atomic<int>> visits(rows);
+        EXPECT_TRUE(executor.parallelFor(rows, 64, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                visits[i].fetch_add(1, std::memory_order_relaxed);
+            }
+        }));
+        for (std::size_t i = 0; i < rows; ++i) {
+            ASSERT_EQ(visits[i].load(), 1) << "rows = " << rows << ", i = " << i;
+        }
+    }
+
+    std::uint64_t counted = 0;
+    for (const ParallelExecutor::WorkerStats& stats : executor.stats()) {
+        counted += stats.rows;
+    }
+    EXPECT_EQ(counted, 101000u);
+    executor.resetStats();
+    EXPECT_EQ(executor.stats()[0].rows, 0u);
+}
+
+TEST(ParallelExecutorTest, EvaluateMatchesSerialEvaluation) {
+    const Expression expression = Expression::compile("a * 2 / b - a");
+    const std::size_t rows = 3 * ParallelExecutor::kDefaultChunkRows + 123;
+    std::vector<double> a(rows);
+    std::vector<double> b(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        a[i] = static_cast<double>(i) * 0.5;
+        b[i] = i % 1000 == 0 ? 0.0 : static_cast<double>(i % 13 + 1);
+    }
+    const std::vector<std::span<const double>> columns = {a, b};
+
+    std::vector<double> serial(rows);
+    std::vector<std::uint64_t> serialMask(Calculator::zeroMaskWords(rows));
+    const std::size_t serialZeros = expression.evaluate(columns, serial, serialMask);
+
+    ParallelExecutor executor(3);
+    std::vector<double> parallel(rows);
+    std::vector<std::uint64_t> parallelMask(Calculator::zeroMaskWords(rows));
+    EXPECT_EQ(executor.evaluate(expression, columns, parallel, parallelMask), serialZeros);
+    EXPECT_EQ(parallelMask, serialMask);
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (b[i] != 0.0) {
+            ASSERT_EQ(parallel[i], serial[i]) << "i = " << i;
+        }
+    }
+}
+
+TEST(ParallelExecutorTest, CancelledJobStopsEarly) {
+    ParallelExecutor executor(2);
+    CancellationToken token;
+    std::atomic<std::size_t> chunks{0};
+    const bool finished = executor.parallelFor(
+        1 << 20, 64,
+        [&](std::size_t, std::size_t) {
+            if (chunks.fetch_add(1) == 10) {
+                token.cancel();
+            }
+        },
+        &token);
+    EXPECT_FALSE(finished);
+    EXPECT_LT(chunks.load(), (std::size_t{1} << 20) / 64);
+
+    token.reset();
+    EXPECT_TRUE(executor.parallelFor(1000, 64, [](std::size_t, std::size_t) {}, &token));
+}
+
+TEST(ParallelExecutorTest, FirstExceptionIsRethrown) {
+    ParallelExecutor executor(3);
+    EXPECT_THROW(executor.parallelFor(100000, 64,
+                                      [](std::size_t begin, std::size_t) {
+                                          if (begin >= 50000) {
+                                              throw std::runtime_error("chunk failed");
+                                          }
+                                      }),
+                 std::runtime_error);
+    // The pool is still usable
+    std::atomic<std::size_t> rows{0};
+    EXPECT_TRUE(executor.parallelFor(500, 64, [&](std::size_t begin, std::size_t end) { rows += end - begin; }));
+    EXPECT_EQ(rows.load(), 500u);
+}
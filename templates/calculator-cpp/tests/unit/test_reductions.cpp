@@ -0,0 +1,205 @@
+/**
+ * @file test_reductions.cpp
+ * @brief Accuracy and edge-case tests for the Calculator reductions
+ *
+ * Every test runs once per SIMD level, so the scalar, SSE2 and AVX2 kernels
+ * are all checked against exact references.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "calculator.h"
+
+namespace {
+
+constexpr double kEps = std::numeric_limits<double>::epsilon() / 2;  // unit roundoff, 2^-53
+
+/**
+ * @brief Exact sum of doubles, rounded once (Shewchuk's non-overlapping partials)
+ */
+double exactSum(const std::vector<double>& values) {
+    std::vector<double> partials;
+    for (double x : values) {
+        std::size_t used = 0;
+        for (double y : partials) {
+            if (std::abs(x) < std::abs(y)) {
+                std::swap(x, y);
+            }
+            const double high = x + y;
+            const double low = y - (high - x);
+            if (low != 0.0) {
+                partials[used++] = low;
+            }
+            x = high;
+        }
+        partials.resize(used);
+        partials.push_back(x);
+    }
+    double sum = 0.0;
+    for (auto it = partials.rbegin(); it != partials.rend(); ++it) {
+        sum += *it;
+    }
+    return sum;
+}
+
+double absoluteSum(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double x : values) {
+        sum += std::abs(x);
+    }
+    return sum;
+}
+
+/// Documented bound of Calculator::sum: eps * |s| + gamma(n)^2 * sum(|x|)
+double sumErrorBound(double exact, double absSum, std::size_t n) {
+    const double gamma = static_cast<double>(n) * kEps / (1.0 - static_cast<double>(n) * kEps);
+    return kEps * std::abs(exact) + gamma * gamma * absSum;
+}
+
+/// Mixed signs over 30 orders of magnitude: heavy cancellation
+std::vector<double> illConditioned(std::size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-50, 50);
+    std::vector<double> values(n);
+    for (double& x : values) {
+        x = std::ldexp(mantissa(rng), exponent(rng));
+    }
+    // Cancel most of the sum so the result is tiny next to sum(|x|).
+    const std::size_t half = n / 2;
+    for (std::size_t i = 0; i < half; ++i) {
+        values[half + i] = -values[i] * (1.0 + std::ldexp(mantissa(rng), -40));
+    }
+    return values;
+}
+
+} // namespace
+
+class ReductionTest : public ::testing::TestWithParam<Calculator::SimdLevel> {
+protected:
+    void SetUp() override {
+        Calculator::setSimdLevel(GetParam());
+    }
+
+    void TearDown() override {
+        Calculator::setSimdLevel(Calculator::detectedSimdLevel());
+    }
+};
+
+TEST_P(ReductionTest, SumOfIntegersIsExactForEveryTailLength) {
+    std::vector<double> values;
+    for (std::size_t n = 0; n <= 40; ++n) {
+        EXPECT_EQ(Calculator::sum(values), static_cast<double>(n * (n + 1) / 2)) << "n = " << n;
+        values.push_back(static_cast<double>(n + 1));
+    }
+}
+
+TEST_P(ReductionTest, SumKeepsSmallTermsNextToLargeOnes) {
+    // A plain loop loses every 1.0 against 1e16 and returns 0.
+    std::vector<double> values(10002, 1.0);
+    values.front() = 1e16;
+    values.back() = -1e16;
+    EXPECT_EQ(Calculator::sum(values), 10000.0);
+}
+
+TEST_P(ReductionTest, SumStaysWithinErrorBoundOnIllConditionedData) {
+    for (unsigned seed = 1; seed <= 5; ++seed) {
+        const std::vector<double> values = illConditioned(100003, seed);
+        const double exact = exactSum(values);
+        const double bound = sumErrorBound(exact, absoluteSum(values), values.size());
+        EXPECT_LE(std::abs(Calculator::sum(values) - exact), bound) << "seed = " << seed;
+    }
+}
+
+TEST_P(ReductionTest, DotStaysWithinErrorBound) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> value(-1e6, 1e6);
+    std::vector<double> a(50001);
+    std::vector<double> b(a.size());
+    std::vector<double> terms;
+    double absProducts = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        a[i] = value(rng);
+        b[i] = value(rng);
+        // The product and its exact rounding error.
+        const double product = a[i] * b[i];
+        terms.push_back(product);
+        terms.push_back(std::fma(a[i], b[i], -product));
+        absProducts += std::abs(product);
+    }
+    const double exact = exactSum(terms);
+    EXPECT_LE(std::abs(Calculator::dot(a, b) - exact), kEps * std::abs(exact) + 2 * kEps * absProducts);
+}
+
+TEST_P(ReductionTest, DotRejectsMismatchedSizes) {
+    const std::vector<double> a(3, 1.0);
+    const std::vector<double> b(4, 1.0);
+    EXPECT_THROW(Calculator::dot(a, b), std::invalid_argument);
+    EXPECT_EQ(Calculator::dot({}, {}), 0.0);
+}
+
+TEST_P(ReductionTest, MeanAndEmptyInput) {
+    const std::vector<double> values = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0};
+    EXPECT_EQ(Calculator::mean(values), 4.0);
+    EXPECT_THROW(Calculator::mean({}), std::invalid_argument);
+}
+
+TEST_P(ReductionTest, VarianceIsExactForSmallSpreadOnLargeOffset) {
+    // Arithmetic progression offset + k * h: variance h^2 (n^2 - 1) / 12.
+    const double offset = std::ldexp(1.0, 30);
+    const std::size_t n = 1001;
+    std::vector<double> values(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        values[k] = offset + 0.5 * static_cast<double>(k);
+    }
+    const double population = 0.25 * (static_cast<double>(n * n) - 1.0) / 12.0;
+    EXPECT_NEAR(Calculator::variance(values), population, population * 1e-14);
+    EXPECT_NEAR(Calculator::variance(values, true), population * n / (n - 1), population * 1e-14);
+}
+
+TEST_P(ReductionTest, VarianceNeedsEnoughValues) {
+    const std::vector<double> one = {3.0};
+    EXPECT_EQ(Calculator::variance(one), 0.0);
+    EXPECT_THROW(Calculator::variance(one, true), std::invalid_argument);
+    EXPECT_THROW(Calculator::variance({}), std::invalid_argument);
+}
+
+TEST_P(ReductionTest, MinMaxMatchesStdForEveryTailLength) {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> value(-1e3, 1e3);
+    for (std::size_t n = 1; n <= 40; ++n) {
+        std::vector<double> values(n);
+        for (double& x : values) {
+            x = value(rng);
+        }
+        const auto [lo, hi] = std::minmax_element(values.begin(), values.end());
+        const Calculator::MinMax result = Calculator::minMax(values);
+        EXPECT_EQ(result.min, *lo) << "n = " << n;
+        EXPECT_EQ(result.max, *hi) << "n = " << n;
+    }
+    EXPECT_THROW(Calculator::minMax({}), std::invalid_argument);
+}
+
+TEST_P(ReductionTest, MinMaxPropagatesNaN) {
+    std::vector<double> values(37, 1.0);
+    for (std::size_t position : {std::size_t{0}, std::size_t{5}, std::size_t{36}}) {
+        std::vector<double> copy = values;
+        copy[position] = std::numeric_limits<double>::quiet_NaN();
+        const Calculator::MinMax result = Calculator::minMax(copy);
+        EXPECT_TRUE(std::isnan(result.min)) << "position = " << position;
+        EXPECT_TRUE(std::isnan(result.max)) << "position = " << position;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, ReductionTest,
+                         ::testing::Values(Calculator::SimdLevel::Scalar, Calculator::SimdLevel::SSE2,
+                                           Calculator::SimdLevel::AVX2),
+                         [](const ::testing::TestParamInfo<Calculator::SimdLevel>& info) {
+                             return std::string(Calculator::simdLevelName(info.param));
+                         });
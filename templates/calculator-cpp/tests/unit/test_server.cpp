@@ -0,0 +1,163 @@
+/**
+ * @file test_server.cpp
+ * @brief Protocol, pipelining and error handling tests for CalculatorServer
+ */
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "calculator_client.h"
+#include "calculator_server.h"
+
+class ServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        socketPath_ = "/tmp/calculator_server_test." + std::to_string(::getpid()) + ".sock";
+        server_ = std::make_unique<CalculatorServer>(ServerOptions{socketPath_, 2});
+        thread_ = std::thread([this] { server_->run(); });
+    }
+
+    void TearDown() override {
+        server_->stop();
+        thread_.join();
+        server_.reset();
+    }
+
+    std::string socketPath_;
+    std::unique_ptr<CalculatorServer> server_;
+    std::thread thread_;
+};
+
+TEST_F(ServerTest, AnswersArithmeticAndExpressions) {
+    CalculatorClient client(socketPath_);
+    EXPECT_EQ(client.call(ServerOp::Add, 10.5, 3.25), 13.75);
+    EXPECT_EQ(client.call(ServerOp::Subtract, 10.5, 3.25), 7.25);
+    EXPECT_EQ(client.call(ServerOp::Multiply, 1.5, 4.0), 6.0);
+    EXPECT_EQ(client.call(ServerOp::Divide, 9.0, 4.0), 2.25);
+
+    const std::vector<double> values = {4.0, 2.0};
+    EXPECT_EQ(client.evaluate("(a + 2) * b", values), 12.0);
+    EXPECT_EQ(client.evaluate("1 + 2 * 3", {}), 7.0);
+}
+
+TEST_F(ServerTest, PipelinedResponsesKeepRequestOrder) {
+    CalculatorClient client(socketPath_);
+    constexpr std::size_t kRequests = 5000;
+    std::vector<std::uint32_t> ids;
+    for (std::size_t i = 0; i < kRequests; ++i) {
+        ids.push_back(client.send(ServerOp::Multiply, static_cast<double>(i), 2.0));
+    }
+    client.flush();
+    for (std::size_t i = 0; i < kRequests; ++i) {
+        const ServerResponse response = client.receive();
+        ASSERT_EQ(response.id, ids[i]);
+        ASSERT_EQ(response.status, ServerStatus::Ok);
+        ASSERT_EQ(response.value, 2.0 * static_cast<double>(i));
+    }
+    // Many requests arrived per read, so far fewer batches than requests.
+    const ServerStats stats = server_->stats();
+    EXPECT_EQ(stats.requests, kRequests);
+    EXPECT_LT(stats.batches, kRequests / 10);
+}
+
+TEST_F(ServerTest, ErrorsAreReportedPerRequest) {
+    CalculatorClient client(socketPath_);
+    client.send(ServerOp::Divide, 1.0, 0.0);
+    client.send(ServerOp::Evaluate, {}, "1 +");
+    const double one = 1.0;
+    client.send(ServerOp::Add, std::span<const double>(&one, 1));
+    client.send(static_cast<ServerOp>(42), 1.0, 2.0);
+    const std::uint32_t last = client.send(ServerOp::Add, 1.0, 2.0);
+
+    ServerResponse response = client.receive();
+    EXPECT_EQ(response.status, ServerStatus::Error);
+    EXPECT_EQ(response.error, "Division by zero is not allowed");
+    EXPECT_EQ(client.receive().status, ServerStatus::Error);
+    EXPECT_EQ(client.receive().status, ServerStatus::BadRequest);
+    response = client.receive();
+    EXPECT_EQ(response.status, ServerStatus::BadRequest);
+    EXPECT_EQ(response.error, "Unknown operation 42");
+
+    // The connection stays usable after errors.
+    response = client.receive();
+    EXPECT_EQ(response.id, last);
+    EXPECT_EQ(response.value, 3.0);
+    EXPECT_THROW(client.call(ServerOp::Divide, 1.0, 0.0), std::invalid_argument);
+}
+
+TEST_F(ServerTest, DeeplyNestedExpressionIsAnError) {
+    // Close to kMaxFrameBytes of parentheses: rejected, not a stack overflow
+    CalculatorClient client(socketPath_);
+    const std::size_t depth = ServerProtocol::kMaxFrameBytes / 2 - 64;
+    const std::string source = std::string(depth, '(') + "1" + std::string(depth, ')');
+    try {
+        client.evaluate(source, {});
+        FAIL() << "nesting not rejected";
+    } catch (const std::invalid_argument& e) {
+        EXPECT_NE(std::string(e.what()).find("nested too deeply"), std::string::npos);
+    }
+    EXPECT_EQ(client.call(ServerOp::Add, 2.0, 2.0), 4.0);
+}
+
+TEST_F(ServerTest, MalformedFrameClosesOnlyThatConnection) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(fd, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, socketPath_.c_str());
+    ASSERT_EQ(::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+
+    CalculatorClient healthy(socketPath_);
+    char header[ServerProtocol::kHeaderBytes] = {};
+    const std::uint32_t size = ServerProtocol::kMaxFrameBytes + 1;
+    std::memcpy(header, &size, sizeof(size));
+    ASSERT_EQ(::write(fd, header, sizeof(header)), static_cast<ssize_t>(sizeof(header)));
+    char byte = 0;
+    EXPECT_EQ(::read(fd, &byte, 1), 0);  // closed by the server
+    ::close(fd);
+
+    EXPECT_EQ(healthy.call(ServerOp::Add, 2.0, 2.0), 4.0);
+    EXPECT_EQ(server_->stats().protocolErrors, 1u);
+}
+
+TEST_F(ServerTest, ServesManyClientsConcurrently) {
+    constexpr std::size_t kClients = 8;
+    constexpr std::size_t kRequests = 500;
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> wrong(kClients, 0);
+    for (std::size_t c = 0; c < kClients; ++c) {
+        threads.emplace_back([&, c] {
+            CalculatorClient client(socketPath_);
+            for (std::size_t i = 0; i < kRequests; ++i) {
+                const double values[2] = {static_cast<double>(c), static_cast<double>(i)};
+                if (client.evaluate("a * 1000 + b", values) != static_cast<double>(c * 1000 + i)) {
+                    ++wrong[c];
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (std::size_t c = 0; c < kClients; ++c) {
+        EXPECT_EQ(wrong[c], 0u) << "client " << c;
+    }
+    EXPECT_EQ(server_->stats().connections, kClients);
+}
+
+TEST(ServerSetupTest, RefusesToReplaceRegularFile) {
+    const std::string path = "/tmp/calculator_server_test." + std::to_string(::getpid()) + ".file";
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    std::fclose(file);
+    EXPECT_THROW(CalculatorServer(ServerOptions{path, 1}), std::runtime_error);
+    std::remove(path.c_str());
+    EXPECT_THROW(CalculatorServer(ServerOptions{"", 1}), std::invalid_argument);
+}
@@ -0,0 +1,131 @@
+/**
+ * @file test_spreadsheet.cpp
+ * @brief Unit tests for incremental recalculation in Spreadsheet
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include "spreadsheet.h"
+
+TEST(SpreadsheetTest, RecomputesOnlyDownstreamCells) {
+    Spreadsheet sheet;
+    sheet.set("a", "1");
+    sheet.set("b", "2");
+    sheet.set("c", "a + b");
+    sheet.set("d", "c * 2");
+    sheet.set("e", "b * 10");
+    EXPECT_EQ(sheet.recalculate().cells, 5u);
+    EXPECT_EQ(sheet.value("d"), 6.0);
+
+    sheet.set("a", "5");
+    const Spreadsheet::RecalcStats stats = sheet.recalculate();
+    EXPECT_EQ(stats.cells, 3u);  // a, c, d
+    EXPECT_EQ(stats.levels, 3u);
+    EXPECT_EQ(sheet.value("c"), 7.0);
+    EXPECT_EQ(sheet.value("d"), 14.0);
+    EXPECT_EQ(sheet.value("e"), 20.0);
+
+    EXPECT_EQ(sheet.recalculate().cells, 0u);
+}
+
+TEST(SpreadsheetTest, RedefinedFormulaDropsOldDependencies) {
+    Spreadsheet sheet;
+    sheet.set("a", "1");
+    sheet.set("b", "2");
+    sheet.set("c", "a + b");
+    sheet.recalculate();
+
+    sheet.set("c", "b * 3");
+    sheet.recalculate();
+    EXPECT_EQ(sheet.value("c"), 6.0);
+
+    sheet.set("a", "100");
+    EXPECT_EQ(sheet.recalculate().cells, 1u);
+    EXPECT_EQ(sheet.value("c"), 6.0);
+}
+
+TEST(SpreadsheetTest, RejectsCyclesAndLeavesSheetUnchanged) {
+    Spreadsheet sheet;
+    sheet.set("a", "1");
+    sheet.set("b", "a + 1");
+    sheet.set("c", "b + 1");
+    sheet.recalculate();
+
+    try {
+        sheet.set("a", "c * 2 + fresh");
+        FAIL() << "cycle not detected";
+    } catch (const std::invalid_argument& e) {
+        EXPECT_EQ(std::string(e.what()), "Circular reference: a -> c -> b -> a");
+    }
+    EXPECT_FALSE(sheet.contains("fresh"));
+    EXPECT_EQ(sheet.recalculate().cells, 0u);
+    EXPECT_EQ(sheet.value("c"), 3.0);
+
+    EXPECT_THROW(sheet.set("x", "x + 1"), std::invalid_argument);
+    EXPECT_FALSE(sheet.contains("x"));
+}
+
+TEST(SpreadsheetTest, ReferencedCellStartsEmpty) {
+    Spreadsheet sheet;
+    sheet.set("total", "price * 2");
+    sheet.recalculate();
+    EXPECT_TRUE(sheet.contains("price"));
+    EXPECT_EQ(sheet.value("total"), 0.0);
+    EXPECT_TRUE(sheet.cell("price").formula.empty());
+
+    sheet.set("price", "21");
+    sheet.recalculate();
+    EXPECT_EQ(sheet.value("total"), 42.0);
+}
+
+TEST(SpreadsheetTest, ErrorsPropagateAndClear) {
+    Spreadsheet sheet;
+    sheet.set("a", "1");
+    sheet.set("b", "0");
+    sheet.set("q", "a / b");
+    sheet.set("r", "q + 1");
+    sheet.recalculate();
+
+    EXPECT_EQ(std::string(sheet.cell("q").error), "Division by zero is not allowed");
+    EXPECT_EQ(std::string(sheet.cell("r").error), "Error in q");
+    EXPECT_TRUE(std::isnan(sheet.cell("r").value));
+    EXPECT_THROW(sheet.value("r"), std::invalid_argument);
+
+    sheet.set("b", "4");
+    sheet.recalculate();
+    EXPECT_EQ(sheet.value("r"), 1.25);
+    EXPECT_TRUE(sheet.cell("r").error.empty());
+}
+
+TEST(SpreadsheetTest, RejectsInvalidNamesAndFormulas) {
+    Spreadsheet sheet;
+    EXPECT_THROW(sheet.set("1a", "1"), std::invalid_argument);
+    EXPECT_THROW(sheet.set("a b", "1"), std::invalid_argument);
+    EXPECT_THROW(sheet.set("a", "1 +"), std::invalid_argument);
+    EXPECT_EQ(sheet.size(), 0u);
+}
+
+TEST(SpreadsheetTest, WideLevelsEvaluateInParallel) {
+    // Two levels of independent cells, each wide enough to run on the pool.
+    Spreadsheet sheet(4);
+    const std::size_t width = 3 * Spreadsheet::kParallelLevelCells;
+    sheet.set("base", "2");
+    for (std::size_t i = 0; i < width; ++i) {
+        const std::string n = std::to_string(i);
+        sheet.set("x" + n, "base * " + n);
+        sheet.set("y" + n, "x" + n + " + 1");
+    }
+    Spreadsheet::RecalcStats stats = sheet.recalculate();
+    EXPECT_EQ(stats.cells, 2 * width + 1);
+    EXPECT_EQ(stats.levels, 3u);
+
+    sheet.set("base", "3");
+    stats = sheet.recalculate();
+    EXPECT_EQ(stats.cells, 2 * width + 1);
+    for (std::size_t i = 0; i < width; ++i) {
+        const std::string n = std::to_string(i);
+        ASSERT_EQ(sheet.value("y" + n), 3.0 * static_cast<double>(i) + 1.0) << "i = " << i;
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file arena_bench.cpp
+ * @brief Parse and teardown cost of nlohmann::json versus ArenaDocument
+ *
+ * For every size a document of that many megabytes is generated in memory
+ * and parsed once into nlohmann::json (one heap allocation per string,
+ * array and object) and once into an ArenaDocument. Reported per DOM: parse
+ * time, heap allocations made, growth of the resident set while the tree
+ * is alive and the time to free it.
+ *
+ * Usage: arena_bench [megabytes...]
+ *   e.g. arena_bench 16 256
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+#include <unistd.h>  // for sysconf
+#include <nlohmann/json.hpp>
+#include "arena_json.h"
+#include "bench_common.h"
+
+namespace {
+
+/// Resident set size from /proc/self/statm, or 0 where it is not available
+std::size_t residentBytes() {
+    std::FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (statm == nullptr) {
+        return 0;
+    }
+    unsigned long total = 0;
+    unsigned long resident = 0;
+    const int fields = std::fscanf(statm, "%lu %lu", &total, &resident);
+    std::fclose(statm);
+    return fields == 2 ? resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) : 0;
+}
+
+void printRow(const char* label, std::size_t bytes, double parseSeconds, std::size_t allocations, std::size_t resident,
+              double freeSeconds) {
+    std::cout << "  " << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << parseSeconds * 1e3 << " ms" << std::setw(9)
+              << static_cast<double>(bytes) / parseSeconds / 1e6 << " MB/s" << std::setw(12) << allocations
+              << " allocs" << std::setw(9) << static_cast<double>(resident) / 1e6 << " MB RSS" << std::setprecision(3)
+              << std::setw(11) << freeSeconds * 1e3 << " ms free" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {16, 128};
+    }
+
+    std::cout << "=== Arena DOM benchmark ===" << std::endl;
+    for (const std::size_t megabytes : sizes) {
+        const std::string text = bench::makeDocument(megabytes << 20);
+        std::cout << megabytes << " MB document (" << text.size() << " bytes)" << std::endl;
+
+        // Default allocator: one heap block per node, freed one by one.
+        std::optional<nlohmann::json> dom;
+        std::size_t residentBefore = residentBytes();
+        std::size_t allocationsBefore = bench::heapAllocations;
+        auto start = std::chrono::steady_clock::now();
+        dom.emplace(nlohmann::json::parse(text));
+        const double defaultParse = bench::secondsSince(start);
+        const std::size_t defaultAllocations = bench::heapAllocations - allocationsBefore;
+        const std::size_t defaultResident = residentBytes() - residentBefore;
+        const std::string expected = dom->dump();
+        start = std::chrono::steady_clock::now();
+        dom.reset();
+        printRow("default", text.size(), defaultParse, defaultAllocations, defaultResident, bench::secondsSince(start));
+
+        // Arena: nodes bump-allocated, released block by block.
+        std::optional<ArenaDocument> document;
+        residentBefore = residentBytes();
+        allocationsBefore = bench::heapAllocations;
+        start = std::chrono::steady_clock::now();
+        document.emplace(ArenaDocument::parse(text));
+        const double arenaParse = bench::secondsSince(start);
+        const std::size_t arenaAllocations =
+            bench::heapAllocations - allocationsBefore + document->arena().blockCount();
+        const std::size_t arenaResident = residentBytes() - residentBefore;
+        const ArenaString actual = document->root().dump();
+        const bool identical = std::string_view(actual.data(), actual.size()) == expected;
+        const std::size_t used = document->arena().bytesUsed();
+        const std::size_t blocks = document->arena().blockCount();
+        start = std::chrono::steady_clock::now();
+        document.reset();
+        printRow("arena", text.size(), arenaParse, arenaAllocations, arenaResident, bench::secondsSince(start));
+
+        std::cout << "  arena: " << blocks << " block(s), " << std::setprecision(1)
+                  << static_cast<double>(used) / 1e6 << " MB used; result "
+                  << (identical ? "identical" : "DIFFERENT") << std::endl;
+        if (!identical) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
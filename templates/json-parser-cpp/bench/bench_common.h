@@ -0,0 +1,82 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+// operator new is replaced below with a counting malloc(); GCC then flags
+// every inlined delete in the including file as mismatched.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>  // for malloc_usable_size
+#include <new>
+#include <string>
+
+/**
+ * @brief Heap accounting and documents shared by the standalone benchmarks
+ *
+ * Including this header replaces the global operator new and delete, so a
+ * benchmark must include it from its one translation unit only.
+ */
+namespace bench {
+
+inline std::size_t heapAllocations = 0;  ///< Calls to operator new so far
+inline std::size_t heapBytes = 0;        ///< Bytes in use, as sized by malloc
+inline std::size_t heapPeak = 0;         ///< Highest heapBytes; reset it to heapBytes before a run
+
+/**
+ * @brief Records shaped like data/sample.json inside a top-level array
+ * @param bytes Size to reach; the result is at most one record longer
+ */
+inline std::string makeDocument(std::size_t bytes) {
+    std::string text = "[";
+    text.reserve(bytes + 256);
+    char record[256];
+    for (std::size_t i = 0; text.size() < bytes; ++i) {
+        const int length = std::snprintf(
+            record, sizeof(record),
+            "%s{\"name\": \"User %zu\", \"age\": %zu, \"city\": \"City %zu\", \"skills\": [\"C++\", \"Python\"], "
+            "\"address\": {\"street\": \"%zu Main Street\", \"zipcode\": \"%05zu\"}, \"active\": %s, "
+            "\"salary\": %.2f}",
+            i == 0 ? "" : ", ", i, 20 + i % 50, i % 100, i % 1000, i % 100000, i % 2 == 0 ? "true" : "false",
+            50000.0 + static_cast<double>(i % 1000) * 10.25);
+        text.append(record, static_cast<std::size_t>(length));
+    }
+    text += "]";
+    return text;
+}
+
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace bench
+
+// Count every allocation and track the bytes in use through operator new.
+// operator new[] and delete[] forward to these by default.
+void* operator new(std::size_t size) {
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        ++bench::heapAllocations;
+        bench::heapBytes += malloc_usable_size(p);
+        bench::heapPeak = std::max(bench::heapPeak, bench::heapBytes);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    if (p != nullptr) {
+        bench::heapBytes -= malloc_usable_size(p);
+        std::free(p);
+    }
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    operator delete(p);
+}
+
+#endif // BENCH_COMMON_H
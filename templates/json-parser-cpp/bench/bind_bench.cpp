@@ -0,0 +1,108 @@
+/**
+ * @file bind_bench.cpp
+ * @brief Reading a known schema: DOM plus contains()/get() versus bindJson()
+ *
+ * Every iteration extracts the sample document's fields into a Person. The
+ * DOM path is what printJsonInfo() does: parse into nlohmann::json, then a
+ * contains() and an operator[] lookup plus a copy per field. The binding
+ * path feeds the SAX events straight into the struct's field table.
+ *
+ * Usage: bind_bench [iterations]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "json_bind.h"
+#include "person.h"
+
+namespace {
+
+using json = nlohmann::json;
+
+const std::string kDocument = R"({
+  "name": "John Doe",
+  "age": 30,
+  "city": "New York",
+  "skills": ["C++", "Python", "JavaScript", "Docker"],
+  "address": {
+    "street": "123 Main St",
+    "zipcode": "10001"
+  },
+  "active": true,
+  "salary": 75000.50
+})";
+
+Person fromDom(const json& j) {
+    Person person;
+    if (j.contains("name")) {
+        person.name = j["name"].get<std::string>();
+    }
+    if (j.contains("age")) {
+        person.age = j["age"].get<int>();
+    }
+    if (j.contains("city")) {
+        person.city = j["city"].get<std::string>();
+    }
+    if (j.contains("active")) {
+        person.active = j["active"].get<bool>();
+    }
+    if (j.contains("salary")) {
+        person.salary = j["salary"].get<double>();
+    }
+    if (j.contains("skills") && j["skills"].is_array()) {
+        for (const auto& skill : j["skills"]) {
+            person.skills.push_back(skill.get<std::string>());
+        }
+    }
+    if (j.contains("address") && j["address"].is_object()) {
+        const auto& address = j["address"];
+        if (address.contains("street")) {
+            person.address.street = address["street"].get<std::string>();
+        }
+        if (address.contains("zipcode")) {
+            person.address.zipcode = address["zipcode"].get<std::string>();
+        }
+    }
+    return person;
+}
+
+template <typename Fn>
+double timeIterations(std::size_t iterations, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+
+    std::size_t checksum = 0;
+    const double domSeconds = timeIterations(iterations, [&] {
+        const Person person = fromDom(json::parse(kDocument));
+        checksum += person.skills.size() + person.address.zipcode.size();
+    });
+    const double bindSeconds = timeIterations(iterations, [&] {
+        Person person;
+        if (!bindJson(kDocument, person).ok()) {
+            std::abort();
+        }
+        checksum += person.skills.size() + person.address.zipcode.size();
+    });
+
+    std::cout << "=== Typed binding benchmark (" << iterations << " documents of " << kDocument.size()
+              << " bytes) ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "DOM + contains/get  " << std::setw(8) << domSeconds * 1e9 / static_cast<double>(iterations)
+              << " ns/doc" << std::endl;
+    std::cout << "bindJson            " << std::setw(8) << bindSeconds * 1e9 / static_cast<double>(iterations)
+              << " ns/doc  (" << domSeconds / bindSeconds << "x)" << std::endl;
+    return checksum == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file cache_bench.cpp
+ * @brief Load time of a large JSON config: text parse versus JsonCache
+ *
+ * Writes a config-like document of the requested size, then times loading
+ * it from text and through the CBOR, MessagePack and tape caches: the first load
+ * (parse and write the cache), a hit (size and mtime match), and a
+ * revalidation after the source was touched (content hash compared). For
+ * the tape cache it also times a hit through loadTape(), which skips the DOM.
+ *
+ * Usage: cache_bench [megabytes] [--dir DIR]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utime.h>
+#include <nlohmann/json.hpp>
+#include "file_input.h"
+#include "json_cache.h"
+
+namespace {
+
+/// Nested service configuration with many small objects and numbers
+void writeConfig(const std::string& path, std::size_t bytes) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "Error: Could not create " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::fputs("{\"version\": 3, \"services\": [", file);
+    std::size_t written = 30;
+    for (std::size_t i = 0; written < bytes; ++i) {
+        written += static_cast<std::size_t>(std::fprintf(
+            file,
+            "%s{\"name\": \"service-%zu\", \"replicas\": %zu, \"cpu\": %.3f, \"memory_mb\": %zu, "
+            "\"ports\": [%zu, %zu], \"env\": {\"LOG_LEVEL\": \"info\", \"REGION\": \"eu-%zu\"}, \"enabled\": %s}",
+            i == 0 ? "" : ", ", i, 1 + i % 8, 0.25 * static_cast<double>(1 + i % 16), 256 * (1 + i % 32),
+            8000 + i % 1000, 9000 + i % 1000, i % 4, i % 5 == 0 ? "false" : "true"));
+    }
+    std::fputs("]}\n", file);
+    std::fclose(file);
+}
+
+template <typename Fn>
+double timeOnce(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printRow(const std::string& label, double seconds, double baseline) {
+    std::cout << "  " << std::left << std::setw(30) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << seconds * 1e3 << " ms" << std::setprecision(2) << std::setw(9)
+              << baseline / seconds << "x" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t megabytes = 64;
+    std::string dir = ".";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            megabytes = std::strtoull(argv[i], nullptr, 10);
+        }
+    }
+
+    const std::string path = dir + "/cache_bench.json";
+    writeConfig(path, megabytes << 20);
+    std::cout << "=== JSON cache benchmark (" << megabytes << " MB config) ===" << std::endl;
+
+    nlohmann::json expected;
+    const double textSeconds = timeOnce([&] {
+        const FileInput input(path);
+        expected = nlohmann::json::parse(input.view().begin(), input.view().end());
+    });
+    printRow("text parse", textSeconds, textSeconds);
+
+    bool identical = true;
+    for (const CacheFormat format : {CacheFormat::Cbor, CacheFormat::MessagePack, CacheFormat::Tape}) {
+        const JsonCache cache(format);
+        const std::string name =
+            format == CacheFormat::Cbor ? "cbor" : (format == CacheFormat::MessagePack ? "msgpack" : "tape");
+        std::remove(cache.cachePath(path).c_str());
+
+        CacheInfo info;
+        for (const char* step : {"first load", "hit", "touched"}) {
+            if (std::string(step) == "touched") {
+                ::utime(path.c_str(), nullptr);  // new mtime, same content
+            }
+            nlohmann::json document;
+            const double seconds = timeOnce([&] { document = cache.load(path, &info); });
+            identical = identical && document == expected;
+            printRow(name + " " + step + " (" + JsonCache::statusName(info.status) + ")", seconds, textSeconds);
+        }
+        if (format == CacheFormat::Tape) {
+            std::size_t words = 0;
+            const double seconds = timeOnce([&] { words = cache.loadTape(path, &info).size(); });
+            identical = identical && words > 0;
+            printRow(std::string("tape hit, no DOM (") + JsonCache::statusName(info.status) + ")", seconds, textSeconds);
+        }
+        std::cout << "  " << name << " cache: " << info.cacheBytes << " bytes (" << std::setprecision(0)
+                  << 100.0 * static_cast<double>(info.cacheBytes) / static_cast<double>(info.sourceBytes)
+                  << "% of the text)" << std::endl;
+        std::remove(cache.cachePath(path).c_str());
+    }
+    std::remove(path.c_str());
+
+    if (!identical) {
+        std::cerr << "Error: cached document differs from the text" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file columnar_bench.cpp
+ * @brief Aggregating NDJSON fields: parsing the text versus a ColumnarFile
+ *
+ * Writes records shaped like data/sample.json, then computes the sum, min
+ * and max of "salary" and "age", and the mean salary per "city", twice: by
+ * parsing every line with nlohmann::json, and by scanning the columns of
+ * a converted file. The one-off conversion is timed as well.
+ *
+ * Usage: columnar_bench [records] [--dir DIR]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "file_input.h"
+#include "json_columnar.h"
+
+namespace {
+
+/// Records shaped like data/sample.json; every 50th lacks a salary
+void writeRecords(const std::string& path, std::size_t count) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "Error: Could not create " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        std::fprintf(file,
+                     "{\"name\": \"User %zu\", \"age\": %zu, \"city\": \"City %zu\", \"skills\": [\"C++\", \"Python\"], "
+                     "\"address\": {\"street\": \"%zu Main St\", \"zipcode\": \"%05zu\"}, \"active\": %s",
+                     i, 20 + i % 50, i % 100, i % 1000, i % 100000, i % 2 == 0 ? "true" : "false");
+        if (i % 50 != 49) {
+            std::fprintf(file, ", \"salary\": %.2f", 50000.0 + static_cast<double>(i % 1000) * 10.25);
+        }
+        std::fputs("}\n", file);
+    }
+    std::fclose(file);
+}
+
+template <typename Fn>
+double timeOnce(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printRow(const std::string& label, double seconds, double baseline) {
+    std::cout << "  " << std::left << std::setw(30) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << seconds * 1e3 << " ms" << std::setprecision(1) << std::setw(10)
+              << baseline / seconds << "x" << std::endl;
+}
+
+void add(ColumnAggregate& aggregate, double value) {
+    aggregate.min = aggregate.count == 0 ? value : std::min(aggregate.min, value);
+    aggregate.max = aggregate.count == 0 ? value : std::max(aggregate.max, value);
+    ++aggregate.count;
+    aggregate.sum += value;
+}
+
+bool same(const ColumnAggregate& a, const ColumnAggregate& b) {
+    return a.count == b.count && a.min == b.min && a.max == b.max &&
+           std::abs(a.sum - b.sum) <= 1e-9 * std::max(1.0, std::abs(a.sum));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t count = 1000000;
+    std::string dir = ".";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            count = std::strtoull(argv[i], nullptr, 10);
+        }
+    }
+
+    const std::string path = dir + "/columnar_bench.ndjson";
+    const std::string columnar = ColumnarFile::defaultPath(path);
+    writeRecords(path, count);
+    std::cout << "=== Columnar benchmark (" << count << " records) ===" << std::endl;
+
+    // Text: parse every record for every query
+    ColumnAggregate textSalary;
+    ColumnAggregate textAge;
+    std::map<std::string, ColumnAggregate> textByCity;
+    const double textSeconds = timeOnce([&] {
+        const FileInput input(path);
+        const std::string_view text = input.view();
+        for (std::size_t pos = 0; pos < text.size();) {
+            const std::size_t end = text.find('\n', pos);
+            const nlohmann::json record = nlohmann::json::parse(text.substr(pos, end - pos));
+            pos = end + 1;
+            add(textAge, record["age"].get<double>());
+            ColumnAggregate& city = textByCity[record["city"].get<std::string>()];
+            if (record.contains("salary")) {
+                add(textSalary, record["salary"].get<double>());
+                add(city, record["salary"].get<double>());
+            }
+        }
+    });
+    printRow("text: parse and aggregate", textSeconds, textSeconds);
+
+    ColumnarStats stats;
+    const double convertSeconds = timeOnce([&] { stats = ColumnarFile::convert(path, columnar); });
+    printRow("convert to columns (once)", convertSeconds, textSeconds);
+
+    ColumnAggregate salary;
+    ColumnAggregate age;
+    std::map<std::string, ColumnAggregate> byCity;
+    double scanSeconds = 0.0;
+    double groupSeconds = 0.0;
+    {
+        const ColumnarFile file(columnar);
+        scanSeconds = timeOnce([&] {
+            salary = file.aggregate("salary");
+            age = file.aggregate("age");
+        });
+        groupSeconds = timeOnce([&] { byCity = file.aggregateBy("city", "salary"); });
+    }
+    printRow("columns: salary and age", scanSeconds, textSeconds);
+    printRow("columns: salary by city", groupSeconds, textSeconds);
+    std::cout << "  " << stats.columns << " columns, " << stats.rowGroups << " row groups, " << stats.bytesOut
+              << " bytes (" << std::setprecision(0)
+              << 100.0 * static_cast<double>(stats.bytesOut) / static_cast<double>(stats.bytesIn) << "% of the text)"
+              << std::endl;
+
+    std::remove(columnar.c_str());
+    std::remove(path.c_str());
+
+    bool identical = same(salary, textSalary) && same(age, textAge) && salary.nulls == count / 50 &&
+                     byCity.size() == textByCity.size();
+    for (const auto& [city, aggregate] : textByCity) {
+        identical = identical && byCity.count(city) > 0 && same(byCity[city], aggregate);
+    }
+    if (!identical) {
+        std::cerr << "Error: column aggregates differ from the text" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/**
+ * @file index_bench.cpp
+ * @brief Random access into a large NDJSON file: linear scan versus NdjsonIndex
+ *
+ * Writes records with a string primary key, then times a full index build,
+ * fetching random records by number (against counting newlines from the
+ * start of the file), looking records up by key, and updating the index
+ * after a small append (against rebuilding it).
+ *
+ * Usage: index_bench [records] [--dir DIR]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "file_input.h"
+#include "ndjson_index.h"
+
+namespace {
+
+constexpr std::size_t kLookups = 1000;
+
+/// Employee records, one per line, keyed by "id"
+void writeRecords(const std::string& path, std::size_t first, std::size_t count, const char* mode) {
+    std::FILE* file = std::fopen(path.c_str(), mode);
+    if (file == nullptr) {
+        std::cerr << "Error: Could not create " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    for (std::size_t i = first; i < first + count; ++i) {
+        std::fprintf(file,
+                     "{\"id\": \"emp-%zu\", \"name\": \"Employee %zu\", \"age\": %zu, \"salary\": %.2f, "
+                     "\"department\": \"dept-%zu\", \"skills\": [\"c++\", \"sql\"], \"active\": %s}\n",
+                     i, i, 20 + i % 45, 40000.0 + static_cast<double>(i % 5000) * 12.5, i % 20,
+                     i % 7 == 0 ? "false" : "true");
+    }
+    std::fclose(file);
+}
+
+template <typename Fn>
+double timeOnce(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printRow(const std::string& label, double seconds, double baseline) {
+    std::cout << "  " << std::left << std::setw(34) << label << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << seconds * 1e3 << " ms" << std::setprecision(1) << std::setw(10)
+              << baseline / seconds << "x" << std::endl;
+}
+
+/// Record number k by counting lines from the start, as without an index
+nlohmann::json scanTo(std::string_view text, std::size_t k) {
+    std::size_t pos = 0;
+    for (std::size_t line = 0; line < k; ++line) {
+        pos = static_cast<std::size_t>(static_cast<const char*>(std::memchr(text.data() + pos, '\n', text.size() - pos)) -
+                                       text.data()) + 1;
+    }
+    const std::size_t end = text.find('\n', pos);
+    return nlohmann::json::parse(text.substr(pos, end - pos));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t count = 2000000;
+    std::string dir = ".";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            count = std::strtoull(argv[i], nullptr, 10);
+        }
+    }
+
+    const std::string path = dir + "/index_bench.ndjson";
+    writeRecords(path, 0, count, "wb");
+    std::cout << "=== NDJSON index benchmark (" << count << " records) ===" << std::endl;
+
+    NdjsonIndexOptions options;
+    options.keyField = "id";
+    NdjsonIndexStats stats;
+    const double buildSeconds = timeOnce([&] { stats = NdjsonIndex::build(path, options); });
+    std::cout << "  build: " << stats.records << " records, " << stats.keys << " keys, " << std::setprecision(1)
+              << std::fixed << static_cast<double>(stats.bytesScanned) / buildSeconds / 1e6 << " MB/s" << std::endl;
+
+    std::mt19937_64 random(42);
+    std::vector<std::size_t> picks(kLookups);
+    for (std::size_t& pick : picks) {
+        pick = random() % count;
+    }
+
+    bool correct = stats.records == count && stats.keys == count;
+    const NdjsonIndex index(path);
+    {
+        // The baseline is slow: time a tenth of the lookups and scale up
+        const FileInput input(path);
+        const std::size_t sampled = kLookups / 10;
+        std::vector<nlohmann::json> scanned;
+        const double scanSeconds = timeOnce([&] {
+            for (std::size_t i = 0; i < sampled; ++i) {
+                scanned.push_back(scanTo(input.view(), picks[i]));
+            }
+        }) * static_cast<double>(kLookups / sampled);
+        printRow(std::to_string(kLookups) + " fetches, linear scan", scanSeconds, scanSeconds);
+
+        std::vector<nlohmann::json> fetched;
+        const double fetchSeconds = timeOnce([&] {
+            for (const std::size_t pick : picks) {
+                fetched.push_back(index.at(pick));
+            }
+        });
+        printRow(std::to_string(kLookups) + " fetches, index", fetchSeconds, scanSeconds);
+        for (std::size_t i = 0; i < sampled; ++i) {
+            correct = correct && fetched[i] == scanned[i];
+        }
+
+        const double findSeconds = timeOnce([&] {
+            for (const std::size_t pick : picks) {
+                correct = correct && index.find("emp-" + std::to_string(pick)) == pick;
+            }
+        });
+        printRow(std::to_string(kLookups) + " key lookups, index", findSeconds, scanSeconds);
+    }
+
+    // Append 1% more records: update() scans only the new bytes
+    const std::size_t appended = std::max<std::size_t>(1, count / 100);
+    writeRecords(path, count, appended, "ab");
+    const double updateSeconds = timeOnce([&] { stats = NdjsonIndex::update(path, options); });
+    correct = correct && stats.status == NdjsonIndexStatus::Appended && stats.newRecords == appended;
+    NdjsonIndexStats rebuilt;
+    const double rebuildSeconds = timeOnce([&] { rebuilt = NdjsonIndex::build(path, options); });
+    printRow("rebuild after a 1% append", rebuildSeconds, rebuildSeconds);
+    printRow("update after a 1% append", updateSeconds, rebuildSeconds);
+    {
+        const NdjsonIndex updated(path);
+        correct = correct && rebuilt.records == stats.records && updated.find("emp-" + std::to_string(count)) == count &&
+                  updated.at(count + appended - 1)["id"] == "emp-" + std::to_string(count + appended - 1);
+    }
+
+    std::remove(NdjsonIndex::defaultPath(path).c_str());
+    std::remove(path.c_str());
+    if (!correct) {
+        std::cerr << "Error: indexed records differ from the file" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
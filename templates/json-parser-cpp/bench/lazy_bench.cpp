@@ -0,0 +1,99 @@
+/**
+ * @file lazy_bench.cpp
+ * @brief Reading a few fields of a large document: full DOM versus LazyJson
+ *
+ * The document has the fields of data/sample.json at the top level plus a
+ * large "payload" array that is never read, like most of our inputs. Each
+ * row parses it and reads the same eight fields that printJsonInfo reads.
+ * Reported per row: total time, throughput, and heap bytes held by the
+ * document (counted in operator new/delete, so rows do not see each
+ * other's freed memory the way resident-set figures would).
+ *
+ * Usage: lazy_bench [megabytes]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "bench_common.h"
+#include "lazy_json.h"
+#include "parser_backend.h"
+
+namespace {
+
+/// Sample fields followed by a large unread payload
+std::string makeDocument(std::size_t bytes) {
+    std::string text =
+        "{\"name\": \"John Doe\", \"age\": 30, \"city\": \"New York\", \"active\": true, \"salary\": 75000.50, "
+        "\"skills\": [\"C++\", \"Python\", \"JavaScript\"], "
+        "\"address\": {\"street\": \"123 Main St\", \"zipcode\": \"10001\"}, \"payload\": [";
+    text.reserve(bytes + 256);
+    char record[256];
+    for (std::size_t i = 0; text.size() < bytes; ++i) {
+        const int length = std::snprintf(
+            record, sizeof(record),
+            "%s{\"id\": %zu, \"label\": \"item-%zu\", \"score\": %.3f, \"tags\": [\"a\", \"b\"], \"ok\": %s}",
+            i == 0 ? "" : ", ", i, i, static_cast<double>(i % 1000) / 7.0, i % 3 == 0 ? "false" : "true");
+        text.append(record, static_cast<std::size_t>(length));
+    }
+    text += "]}";
+    return text;
+}
+
+/// The fields printJsonInfo prints, folded into one string
+template <typename Json>
+std::string readFields(const Json& j) {
+    std::string out = j["name"].template get<std::string>();
+    out += std::to_string(j["age"].template get<int>());
+    out += j["city"].template get<std::string>();
+    out += j["active"].template get<bool>() ? "Yes" : "No";
+    out += std::to_string(j["salary"].template get<double>());
+    for (const auto& skill : j["skills"]) {
+        out += skill.template get<std::string>();
+    }
+    out += j["address"]["street"].template get<std::string>();
+    out += j["address"]["zipcode"].template get<std::string>();
+    return out;
+}
+
+void printRow(const char* label, std::size_t bytes, double seconds, std::size_t heap) {
+    std::cout << "  " << std::left << std::setw(14) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << seconds * 1e3 << " ms" << std::setw(10)
+              << static_cast<double>(bytes) / seconds / 1e6 << " MB/s" << std::setw(10)
+              << static_cast<double>(heap) / 1e6 << " MB heap" << std::endl;
+}
+
+template <typename Load>
+std::string measure(const char* label, std::size_t bytes, Load&& load) {
+    const std::size_t heapBefore = bench::heapBytes;
+    const auto start = std::chrono::steady_clock::now();
+    const auto document = load();
+    const std::string fields = readFields(document);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printRow(label, bytes, seconds, bench::heapBytes - heapBefore);
+    return fields;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    const std::string text = makeDocument(megabytes << 20);
+    std::cout << "=== Lazy DOM benchmark (" << text.size() << " bytes, 8 fields read) ===" << std::endl;
+
+    const std::string lazy = measure("lazy", text.size(), [&] { return LazyJson::parse(text); });
+    const std::string simd =
+        measure("simd DOM", text.size(), [&] { return parseJson(text, ParserBackend::Simd); });
+    const std::string nlohmann =
+        measure("nlohmann DOM", text.size(), [&] { return parseJson(text, ParserBackend::Nlohmann); });
+
+    if (lazy != nlohmann || simd != nlohmann) {
+        std::cerr << "Error: backends read different values" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file load_bench.cpp
+ * @brief Input path throughput: std::ifstream versus FileInput (mmap)
+ *
+ * For every size a document of that many megabytes is generated, then
+ * loaded as a DOM and summarized with SAX through both input paths. The
+ * ifstream DOM run is what loadJsonFromFile did before FileInput. DOM runs
+ * are skipped above --dom-limit megabytes, since the tree needs several
+ * times the file size in RAM.
+ *
+ * Usage: load_bench [megabytes...] [--dir DIR] [--dom-limit MB]
+ *   e.g. load_bench 10 1024 10240
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "file_input.h"
+#include "json_stream.h"
+
+namespace {
+
+using json = nlohmann::json;
+
+/// Person document whose "records" array pads it to the requested size
+void writeDocument(const std::string& path, std::size_t bytes) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        std::cerr << "Error: Could not create " << path << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+    std::fputs("{\"name\": \"John Doe\", \"age\": 30, \"city\": \"New York\", \"records\": [", file);
+    std::size_t written = 64;
+    for (std::size_t i = 0; written < bytes; ++i) {
+        written += static_cast<std::size_t>(std::fprintf(
+            file, "%s{\"id\": %zu, \"user\": \"user%zu@example.com\", \"score\": %.3f, \"tags\": [\"a\", \"b\"], "
+                  "\"active\": %s}",
+            i == 0 ? "" : ", ", i, i % 100000, static_cast<double>(i % 977) * 1.25, i % 3 == 0 ? "true" : "false"));
+    }
+    std::fputs("], \"skills\": [\"C++\", \"Python\"], \"address\": {\"street\": \"123 Main St\", \"zipcode\": "
+               "\"10001\"}, \"active\": true, \"salary\": 75000.50}\n",
+               file);
+    std::fclose(file);
+}
+
+template <typename Fn>
+void run(const std::string& label, std::size_t bytes, int repetitions, Fn&& fn) {
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::cout << std::left << std::setw(40) << label << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << best << " s" << std::setprecision(1) << std::setw(10)
+              << static_cast<double>(bytes) / 1e6 / best << " MB/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes;
+    std::string directory = "/tmp";
+    std::size_t domLimit = 1024;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            directory = argv[++i];
+        } else if (arg == "--dom-limit" && i + 1 < argc) {
+            domLimit = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            sizes.push_back(std::strtoull(arg.c_str(), nullptr, 10));
+        }
+    }
+    if (sizes.empty()) {
+        sizes.push_back(10);
+    }
+
+    for (std::size_t megabytes : sizes) {
+        const std::string path = directory + "/json_load_bench.json";
+        writeDocument(path, megabytes << 20);
+        const std::size_t bytes = FileInput(path).size();
+        const int repetitions = megabytes <= 100 ? 3 : 1;
+        std::cout << "=== " << megabytes << " MB (" << bytes << " bytes, page cache warm) ===" << std::endl;
+
+        if (megabytes <= domLimit) {
+            run("DOM: ifstream >> json", bytes, repetitions, [&] {
+                std::ifstream file(path);
+                json j;
+                file >> j;
+            });
+            run("DOM: FileInput + json::parse", bytes, repetitions, [&] {
+                const FileInput input(path);
+                json j = json::parse(input.begin(), input.end());
+            });
+        } else {
+            std::cout << "DOM runs skipped (above --dom-limit " << domLimit << " MB)" << std::endl;
+        }
+        run("SAX summary: ifstream", bytes, repetitions, [&] {
+            std::ifstream file(path);
+            summarizeJson(file);
+        });
+        run("SAX summary: FileInput", bytes, repetitions, [&] { summarizeJsonFile(path); });
+
+        std::remove(path.c_str());
+    }
+    return EXIT_SUCCESS;
+}
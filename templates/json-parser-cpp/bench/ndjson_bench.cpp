@@ -0,0 +1,76 @@
+/**
+ * @file ndjson_bench.cpp
+ * @brief Strong scaling of NdjsonProcessor from 1 to N worker threads
+ *
+ * Usage: ndjson_bench [megabytes] [max_workers] [--unordered]
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include "ndjson.h"
+
+namespace {
+
+/// Records shaped like data/sample.json, with a malformed line every 100000
+std::string makeInput(std::size_t bytes) {
+    std::string input;
+    input.reserve(bytes + 256);
+    char line[256];
+    for (std::size_t i = 0; input.size() < bytes; ++i) {
+        if (i % 100000 == 99999) {
+            input += "{\"name\": \"truncated\n";
+            continue;
+        }
+        const int length = std::snprintf(
+            line, sizeof(line),
+            "{\"name\": \"User %zu\", \"age\": %zu, \"city\": \"City %zu\", \"skills\": [\"C++\", \"Python\"], "
+            "\"address\": {\"street\": \"%zu Main St\", \"zipcode\": \"%05zu\"}, \"active\": %s, \"salary\": %.2f}\n",
+            i, 20 + i % 50, i % 100, i % 1000, i % 100000, i % 2 == 0 ? "true" : "false",
+            50000.0 + static_cast<double>(i % 1000) * 10.25);
+        input.append(line, static_cast<std::size_t>(length));
+    }
+    return input;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t maxWorkers = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : hardware;
+    const bool ordered = !(argc > 3 && std::string(argv[3]) == "--unordered");
+
+    const std::string input = makeInput(megabytes << 20);
+    std::cout << "=== NDJSON benchmark (" << input.size() << " bytes, " << hardware << " hardware threads, "
+              << (ordered ? "ordered" : "unordered") << ") ===" << std::endl;
+
+    double baseline = 0.0;
+    for (std::size_t workers = 1; workers <= maxWorkers; workers *= 2) {
+        NdjsonOptions options;
+        options.workers = workers;
+        options.ordered = ordered;
+        std::size_t outputBytes = 0;
+        const NdjsonResult result = NdjsonProcessor(options).run(
+            input,
+            [](nlohmann::json& record, std::string& out) {
+                out += record.dump();
+                out += '\n';
+            },
+            [&](std::string_view output) { outputBytes += output.size(); });
+        if (workers == 1) {
+            baseline = result.seconds;
+        }
+        std::cout << std::setw(3) << workers << " workers" << std::fixed << std::setprecision(1) << std::setw(10)
+                  << result.bytesPerSecond() / 1e6 << " MB/s" << std::setw(12)
+                  << static_cast<double>(result.records) / result.seconds / 1e6 << " M records/s"
+                  << std::setprecision(2) << std::setw(8) << baseline / result.seconds << "x  (" << result.failedRecords
+                  << " failed)" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
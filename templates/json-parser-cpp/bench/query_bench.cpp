@@ -0,0 +1,93 @@
+/**
+ * @file query_bench.cpp
+ * @brief Extracting a few paths per record: DOM lookups versus JsonQuery
+ *
+ * Generates JSON Lines records shaped like data/sample.json and pulls
+ * /address/zipcode and every /skills element out of each one, first by
+ * parsing the record into nlohmann::json and walking it, then with one
+ * precompiled JsonQuery that skips everything else.
+ *
+ * Usage: query_bench [records]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "json_query.h"
+
+namespace {
+
+using json = nlohmann::json;
+
+std::string makeRecords(std::size_t count) {
+    std::string input;
+    char line[512];
+    for (std::size_t i = 0; i < count; ++i) {
+        const int length = std::snprintf(
+            line, sizeof(line),
+            "{\"name\": \"User %zu\", \"age\": %zu, \"city\": \"City %zu\", \"history\": [{\"year\": 2020, "
+            "\"role\": \"dev\"}, {\"year\": 2022, \"role\": \"lead\"}], \"skills\": [\"C++\", \"Python\"], "
+            "\"address\": {\"street\": \"%zu Main St\", \"zipcode\": \"%05zu\"}, \"active\": %s, \"salary\": %.2f}\n",
+            i, 20 + i % 50, i % 100, i % 1000, i % 100000, i % 2 == 0 ? "true" : "false",
+            50000.0 + static_cast<double>(i % 1000) * 10.25);
+        input.append(line, static_cast<std::size_t>(length));
+    }
+    return input;
+}
+
+template <typename Fn>
+void forEachLine(std::string_view input, Fn&& fn) {
+    std::size_t pos = 0;
+    while (pos < input.size()) {
+        const void* newline = std::memchr(input.data() + pos, '\n', input.size() - pos);
+        const std::size_t end = newline != nullptr ? static_cast<std::size_t>(static_cast<const char*>(newline) - input.data())
+                                                   : input.size();
+        fn(input.substr(pos, end - pos));
+        pos = end + 1;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const std::string input = makeRecords(records);
+
+    std::size_t domBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    forEachLine(input, [&](std::string_view line) {
+        const json record = json::parse(line.begin(), line.end());
+        domBytes += record["address"]["zipcode"].get_ref<const std::string&>().size();
+        for (const json& skill : record["skills"]) {
+            domBytes += skill.get_ref<const std::string&>().size();
+        }
+    });
+    const double domSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const JsonQuery query({"/address/zipcode", "/skills/*"});
+    std::size_t queryBytes = 0;
+    start = std::chrono::steady_clock::now();
+    forEachLine(input, [&](std::string_view line) {
+        query.run(line, [&](const JsonQuery::Match& match) { queryBytes += match.text().size(); });
+    });
+    const double querySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "=== Path query benchmark (" << records << " records, " << input.size() << " bytes) ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "DOM + lookups   " << std::setw(8) << static_cast<double>(input.size()) / domSeconds / 1e6 << " MB/s"
+              << std::endl;
+    std::cout << "JsonQuery       " << std::setw(8) << static_cast<double>(input.size()) / querySeconds / 1e6
+              << " MB/s  (" << std::setprecision(2) << domSeconds / querySeconds << "x)" << std::endl;
+    if (domBytes != queryBytes) {
+        std::cerr << "Error: results differ" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
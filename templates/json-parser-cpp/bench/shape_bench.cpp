@@ -0,0 +1,126 @@
+/**
+ * @file shape_bench.cpp
+ * @brief Repetitive NDJSON records: nlohmann::json versus ShapedDocument
+ *
+ * Generates records that all carry the same 32 keys (two key orders, so
+ * two shapes), then parses every line and keeps all records alive, once as
+ * nlohmann::json values and once in a ShapedDocument. Reported per row:
+ * parse time, heap allocations, bytes held afterwards (heap plus arena
+ * blocks), and the time to scan every record and sum one numeric field.
+ *
+ * Usage: shape_bench [records]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "bench_common.h"
+#include "json_shape.h"
+
+namespace {
+
+constexpr std::size_t kKeys = 32;
+
+/// One record per line, kKeys fields of mixed types
+std::vector<std::string> makeRecords(std::size_t count) {
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    char field[96];
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string line = "{";
+        for (std::size_t k = 0; k < kKeys; ++k) {
+            // Every 4th record lists its keys in reverse: a second shape
+            const std::size_t key = i % 4 == 3 ? kKeys - 1 - k : k;
+            int length = 0;
+            switch (key % 4) {
+            case 0:
+                length = std::snprintf(field, sizeof(field), "\"field_%02zu\": %zu", key, i * key);
+                break;
+            case 1:
+                length = std::snprintf(field, sizeof(field), "\"field_%02zu\": %.3f", key,
+                                       static_cast<double>(i % 1000) / 8.0 + static_cast<double>(key));
+                break;
+            case 2:
+                length = std::snprintf(field, sizeof(field), "\"field_%02zu\": \"value-%zu\"", key, i % 97);
+                break;
+            default:
+                length = std::snprintf(field, sizeof(field), "\"field_%02zu\": %s", key, i % 2 ? "true" : "false");
+                break;
+            }
+            line += k == 0 ? "" : ", ";
+            line.append(field, static_cast<std::size_t>(length));
+        }
+        line += "}";
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+void printRow(const char* label, double parseSeconds, std::size_t allocations, std::size_t heap, double scanSeconds) {
+    std::cout << "  " << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << parseSeconds * 1e3 << " ms parse" << std::setw(12) << allocations << " allocs"
+              << std::setw(10) << static_cast<double>(heap) / 1e6 << " MB" << std::setprecision(2) << std::setw(10)
+              << scanSeconds * 1e3 << " ms scan" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const std::vector<std::string> lines = makeRecords(count);
+    std::cout << "=== Shape benchmark (" << count << " records, " << kKeys << " keys each) ===" << std::endl;
+
+    // nlohmann::json: a std::map node and a key string per member
+    std::size_t allocationsBefore = bench::heapAllocations;
+    std::size_t heapBefore = bench::heapBytes;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<nlohmann::json> records;
+    records.reserve(count);
+    for (const std::string& line : lines) {
+        records.push_back(nlohmann::json::parse(line));
+    }
+    const double domParse = bench::secondsSince(start);
+    const std::size_t domAllocations = bench::heapAllocations - allocationsBefore;
+    const std::size_t domHeap = bench::heapBytes - heapBefore;
+    start = std::chrono::steady_clock::now();
+    double domSum = 0.0;
+    for (const nlohmann::json& record : records) {
+        domSum += record["field_05"].get<double>();
+    }
+    printRow("nlohmann", domParse, domAllocations, domHeap, bench::secondsSince(start));
+
+    // ShapedDocument: interned keys, shared shapes, values in an arena
+    allocationsBefore = bench::heapAllocations;
+    heapBefore = bench::heapBytes;
+    start = std::chrono::steady_clock::now();
+    ShapedDocument document;
+    std::vector<const ShapedValue*> shaped;
+    shaped.reserve(count);
+    for (const std::string& line : lines) {
+        shaped.push_back(&document.parse(line));
+    }
+    const double shapedParse = bench::secondsSince(start);
+    const std::size_t shapedAllocations = bench::heapAllocations - allocationsBefore;
+    const std::size_t shapedHeap = bench::heapBytes - heapBefore + document.arena().bytesReserved();
+    start = std::chrono::steady_clock::now();
+    const Symbol field = SymbolTable::global().intern("field_05");
+    double shapedSum = 0.0;
+    for (const ShapedValue* record : shaped) {
+        shapedSum += record->find(field)->get<double>();
+    }
+    printRow("shaped", shapedParse, shapedAllocations, shapedHeap, bench::secondsSince(start));
+    std::cout << "  " << SymbolTable::global().size() << " symbols, " << ShapeTable::global().size() << " shapes, "
+              << document.arena().bytesUsed() << " arena bytes used" << std::endl;
+
+    if (domSum != shapedSum || shaped.front()->toJson() != records.front() || shaped.back()->toJson() != records.back()) {
+        std::cerr << "Error: shaped records differ from nlohmann::json" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file writer_bench.cpp
+ * @brief Serializing a large DOM: dump() plus write() versus JsonWriter
+ *
+ * A document of the requested size is generated and parsed once. It is
+ * then written compact and pretty (indent 2), first as dump() into a
+ * std::string sent with one write(), then through JsonWriter. Reported per
+ * row: time, output throughput, and peak heap bytes allocated during the
+ * write (counted in operator new/delete; the DOM itself is not included).
+ *
+ * Usage: writer_bench [megabytes] [--out FILE]
+ *   FILE defaults to /dev/null, which measures serialization alone.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+#include "bench_common.h"
+#include "json_writer.h"
+
+namespace {
+
+void writeString(int fd, const std::string& text) {
+    std::size_t done = 0;
+    while (done < text.size()) {
+        const ssize_t written = ::write(fd, text.data() + done, text.size() - done);
+        if (written <= 0) {
+            std::cerr << "Error: write failed" << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+        done += static_cast<std::size_t>(written);
+    }
+}
+
+template <typename Fn>
+void measure(const std::string& label, Fn&& fn) {
+    const std::size_t heapBefore = bench::heapBytes;
+    bench::heapPeak = bench::heapBytes;
+    const auto start = std::chrono::steady_clock::now();
+    const std::uint64_t bytes = fn();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << std::left << std::setw(20) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << seconds * 1e3 << " ms" << std::setw(10)
+              << static_cast<double>(bytes) / seconds / 1e6 << " MB/s" << std::setw(10)
+              << static_cast<double>(bench::heapPeak - heapBefore) / 1e6 << " MB peak heap" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t megabytes = 64;
+    std::string out = "/dev/null";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        } else {
+            megabytes = std::strtoull(argv[i], nullptr, 10);
+        }
+    }
+
+    const int fd = ::open(out.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open " << out << std::endl;
+        return EXIT_FAILURE;
+    }
+    const nlohmann::json document = nlohmann::json::parse(bench::makeDocument(megabytes << 20));
+    std::cout << "=== JSON writer benchmark (" << megabytes << " MB document, output " << out << ") ===" << std::endl;
+
+    for (const int indent : {-1, 2}) {
+        const std::string mode = indent < 0 ? "compact" : "pretty";
+        measure("dump() " + mode, [&] {
+            const std::string text = document.dump(indent);
+            writeString(fd, text);
+            return static_cast<std::uint64_t>(text.size());
+        });
+        measure("JsonWriter " + mode, [&] {
+            JsonWriter writer(fd, indent);
+            writer.write(document);
+            writer.flush();
+            return writer.bytes();
+        });
+    }
+    ::close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Monotonic bump allocator
+ *
+ * Hands out memory from large blocks by advancing a pointer. Individual
+ * allocations are never freed; all blocks are released together when the
+ * arena is destroyed or reset. Each block is twice the size of the
+ * previous one, so a sized first block usually serves a whole parse.
+ *
+ * Not thread-safe: use one arena per thread.
+ */
+class Arena {
+public:
+    /// First block size when none is given
+    static constexpr std::size_t kDefaultBlockBytes = 64 << 10;
+
+    /**
+     * @brief Create an empty arena
+     * @param firstBlockBytes Size of the first block, allocated lazily
+     */
+    explicit Arena(std::size_t firstBlockBytes = kDefaultBlockBytes);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Allocate uninitialized memory
+     * @param bytes Size in bytes
+     * @param alignment Power of two alignment
+     * @return Memory valid until the arena is reset or destroyed
+     * @throws std::bad_alloc if a new block cannot be allocated
+     */
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Whether memory came from this arena
+     * @param pointer Any pointer
+     * @return true if pointer lies in one of the arena's blocks
+     */
+    bool contains(const void* pointer) const;
+
+    /**
+     * @brief Release all blocks at once; previous allocations become invalid
+     */
+    void reset();
+
+    /// Bytes handed out by allocate(), including alignment padding
+    std::size_t bytesUsed() const { return used_; }
+
+    /// Bytes held in blocks
+    std::size_t bytesReserved() const { return reserved_; }
+
+    /// Number of blocks held
+    std::size_t blockCount() const { return blocks_.size(); }
+
+    /**
+     * @brief Arena that ArenaAllocator uses on this thread
+     * @return Innermost active ArenaScope's arena, or nullptr
+     */
+    static Arena* current();
+
+private:
+    friend class ArenaScope;
+
+    struct Block {
+        char* data;
+        std::size_t size;
+    };
+
+    void addBlock(std::size_t minBytes);
+
+    std::vector<Block> blocks_;
+    char* cursor_ = nullptr;
+    char* end_ = nullptr;
+    std::size_t firstBlockBytes_;
+    std::size_t nextBlockBytes_;
+    std::size_t used_ = 0;
+    std::size_t reserved_ = 0;
+};
+
+/**
+ * @brief Makes an arena current for ArenaAllocator on this thread
+ *
+ * Scopes nest; the previous arena becomes current again on destruction.
+ */
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* previous_;
+};
+
+/**
+ * @brief Stateless standard allocator backed by Arena::current()
+ *
+ * nlohmann::basic_json default-constructs its allocators, so the arena is
+ * found through the thread's ArenaScope rather than stored in the
+ * allocator. Without a current arena it falls back to the heap. Freeing
+ * arena memory is a no-op; freeing heap memory goes back to the heap.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() = default;
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>&) {}
+
+    T* allocate(std::size_t count) {
+        if (Arena* arena = Arena::current()) {
+            return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+        }
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* pointer, std::size_t count) {
+        const Arena* arena = Arena::current();
+        if (arena == nullptr || !arena->contains(pointer)) {
+            std::allocator<T>().deallocate(pointer, count);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>&) const {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>&) const {
+        return false;
+    }
+};
+
+#endif // ARENA_H
@@ -0,0 +1,62 @@
+#ifndef ARENA_JSON_H
+#define ARENA_JSON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "arena.h"
+
+/// String type of ArenaJson; its buffers come from the current arena
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+/**
+ * @brief nlohmann::basic_json whose nodes, containers and strings live in an Arena
+ *
+ * Same layout and API as nlohmann::json, except that strings are
+ * ArenaString. Values are only allocated in an arena while an ArenaScope is
+ * active; use ArenaDocument to parse into one.
+ */
+using ArenaJson = nlohmann::basic_json<std::map, std::vector, ArenaString, bool, std::int64_t, std::uint64_t, double,
+                                       ArenaAllocator>;
+
+/**
+ * @brief A parsed document whose whole DOM is held in one arena
+ *
+ * Parsing makes a single large allocation in the common case: the arena's
+ * first block is sized from the input. Destruction releases the arena's
+ * blocks without visiting the nodes, so teardown costs the same for any
+ * document size. The DOM is read-only, because modifying it outside an
+ * ArenaScope would mix arena and heap memory.
+ */
+class ArenaDocument {
+public:
+    /// First arena block size per input byte; untouched pages of the block never become resident
+    static constexpr std::size_t kBlockBytesPerInputByte = 8;
+
+    /**
+     * @brief Parse a JSON text into a new arena
+     * @param input Whole JSON text
+     * @return Document owning the arena
+     * @throws std::runtime_error if the text is not valid JSON
+     */
+    static ArenaDocument parse(std::string_view input);
+
+    /// Root value
+    const ArenaJson& root() const { return *root_; }
+
+    /// Arena holding the DOM, e.g. for Arena::bytesReserved()
+    const Arena& arena() const { return *arena_; }
+
+private:
+    ArenaDocument(std::unique_ptr<Arena> arena, const ArenaJson* root) : arena_(std::move(arena)), root_(root) {}
+
+    std::unique_ptr<Arena> arena_;
+    const ArenaJson* root_;  ///< Lives in arena_ and is never destroyed
+};
+
+#endif // ARENA_JSON_H
@@ -0,0 +1,129 @@
+#ifndef FILE_INPUT_H
+#define FILE_INPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Whole input file as one contiguous, read-only byte range
+ *
+ * Regular files are memory-mapped: no bytes are copied, and there is no
+ * iostream buffering or locale handling between the page cache and the
+ * parser. The mapping is advised for sequential access (the kernel reads
+ * ahead aggressively) and for transparent huge pages where the kernel
+ * supports them for file mappings. Pipes, stdin and other non-mappable
+ * inputs, and all input on Windows, are read with read() into one growing
+ * buffer instead.
+ *
+ * Iterating with begin()/end() drops the pages behind the iterator from
+ * the resident set every kReleaseBytes. A single sequential pass, such as
+ * one parse, therefore keeps a constant footprint, however large the file.
+ */
+class FileInput {
+public:
+    /// Mapped bytes consumed by an Iterator before they are released
+    static constexpr std::size_t kReleaseBytes = 64 << 20;
+
+    /**
+     * @brief Forward iterator over the bytes that releases consumed pages
+     *
+     * Works with any parser that accepts an iterator pair, e.g.
+     * nlohmann::json::parse(input.begin(), input.end()).
+     */
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char*;
+        using reference = const char&;
+
+        Iterator() = default;
+
+        reference operator*() const { return *pos_; }
+
+        Iterator& operator++() {
+            if (++pos_ == nextRelease_) {
+                releaseBehind();
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const { return pos_ == other.pos_; }
+        bool operator!=(const Iterator& other) const { return pos_ != other.pos_; }
+
+    private:
+        friend class FileInput;
+
+        Iterator(const char* pos, const FileInput* owner);
+        void releaseBehind();
+
+        const char* pos_ = nullptr;
+        const char* nextRelease_ = nullptr;  ///< Null if nothing is released
+        const FileInput* owner_ = nullptr;
+    };
+
+    /**
+     * @brief Map or read a file
+     * @param path File path, "-" for stdin
+     * @throws std::runtime_error if the file cannot be opened or read
+     */
+    explicit FileInput(const std::string& path);
+    ~FileInput();
+
+    FileInput(const FileInput&) = delete;
+    FileInput& operator=(const FileInput&) = delete;
+
+    /**
+     * @brief All bytes of the input
+     */
+    std::string_view view() const { return {data_, size_}; }
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    /**
+     * @brief Whether the input is memory-mapped (false for the read() fallback)
+     */
+    bool mapped() const { return mapping_ != nullptr; }
+
+    /**
+     * @brief Iterator at the first byte, releasing pages as it advances
+     */
+    Iterator begin() const { return Iterator(data_, this); }
+
+    /**
+     * @brief Iterator past the last byte
+     */
+    Iterator end() const { return Iterator(data_ + size_, nullptr); }
+
+    /**
+     * @brief Drop mapped pages before an offset from the resident set
+     *
+     * The bytes stay readable; touching them again reads them back from
+     * the page cache. Does nothing for read() input.
+     *
+     * @param offset Bytes before this offset are no longer needed
+     */
+    void release(std::size_t offset) const;
+
+private:
+    std::string path_;
+    char* mapping_ = nullptr;
+    std::vector<char> buffer_;  ///< read() fallback
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    mutable std::size_t released_ = 0;
+};
+
+#endif // FILE_INPUT_H
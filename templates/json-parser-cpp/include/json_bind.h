@@ -0,0 +1,523 @@
+#ifndef JSON_BIND_H
+#define JSON_BIND_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Field table of a bindable struct; specialize for each struct
+ *
+ * The specialization holds one jsonField() per bound member:
+ * @code
+ * template <>
+ * struct JsonSchema<Address> {
+ *     static constexpr auto fields = std::make_tuple(jsonField("street", &Address::street),
+ *                                                    jsonField("zipcode", &Address::zipcode));
+ * };
+ * @endcode
+ * Supported member types are std::string, bool, integral and floating
+ * point numbers, std::vector and std::optional of supported types, and
+ * other structs with a JsonSchema. Members that are std::optional may be
+ * absent (or null) without being reported.
+ */
+template <typename T>
+struct JsonSchema;
+
+/**
+ * @brief One entry of a JsonSchema field table
+ */
+template <typename Owner, typename Member>
+struct JsonField {
+    std::string_view name;
+    Member Owner::*member;
+};
+
+/**
+ * @brief Declare a bound member
+ * @param name JSON key
+ * @param member Pointer to the struct member
+ * @return Field table entry
+ */
+template <typename Owner, typename Member>
+constexpr JsonField<Owner, Member> jsonField(std::string_view name, Member Owner::*member) {
+    return {name, member};
+}
+
+/**
+ * @brief A field that could not be bound
+ */
+struct BindIssue {
+    enum class Kind {
+        Missing,  ///< Required field absent from its object
+        Mismatch  ///< Value of the wrong JSON type, or a number out of range
+    };
+
+    Kind kind;
+    std::string path;     ///< e.g. "address.zipcode" or "skills[2]"
+    std::string message;  ///< e.g. "expected string, got number"
+};
+
+/**
+ * @brief Outcome of bindJson()
+ */
+struct BindResult {
+    std::vector<BindIssue> issues;  ///< In document order; missing fields when their object closes
+    std::uint64_t events = 0;       ///< SAX events consumed
+
+    bool ok() const { return issues.empty(); }
+};
+
+class BindHandler;
+
+namespace json_bind_detail {
+
+/**
+ * @brief A scalar event from the parser
+ */
+struct Token {
+    enum class Kind { Null, Boolean, Integer, Unsigned, Float, String };
+
+    Kind kind;
+    bool boolean = false;
+    std::int64_t integer = 0;
+    std::uint64_t unsignedInteger = 0;
+    double floating = 0.0;
+    std::string* text = nullptr;  ///< Parser's buffer; may be moved from
+};
+
+const char* tokenName(const Token& token);
+
+class Frame;
+
+/**
+ * @brief Type-erased operations on a bound value of one C++ type
+ */
+struct TargetOps {
+    /// Assign a scalar; false on mismatch (already reported)
+    bool (*scalar)(void* target, Token& token, BindHandler& handler);
+    /// Frame for an object value, or null on mismatch (already reported)
+    std::unique_ptr<Frame> (*startObject)(void* target, BindHandler& handler);
+    /// Frame for an array value, or null on mismatch (already reported)
+    std::unique_ptr<Frame> (*startArray)(void* target, BindHandler& handler);
+};
+
+/**
+ * @brief Value the next event binds to; ops is null for ignored values
+ */
+struct Target {
+    void* object = nullptr;
+    const TargetOps* ops = nullptr;
+};
+
+/**
+ * @brief An open object or array that is being bound
+ */
+class Frame {
+public:
+    virtual ~Frame() = default;
+
+    /// Target of the value after a key (objects only)
+    virtual Target field(std::string_view /*key*/) { return {}; }
+
+    /// Target of the next element (arrays only)
+    virtual Target element() { return {}; }
+
+    /// Undo element() after its value was rejected (arrays only)
+    virtual void dropElement() {}
+
+    /// Called when the container closes, e.g. to report missing fields
+    virtual void finish(BindHandler& /*handler*/) {}
+
+    /// Append the path segment of the current child, e.g. ".name" or "[3]"
+    virtual void appendChildPath(std::string& path) const = 0;
+
+    virtual bool isArray() const = 0;
+};
+
+template <typename T>
+struct Binder;
+
+template <typename T>
+const TargetOps& opsFor();
+
+} // namespace json_bind_detail
+
+/**
+ * @brief SAX handler that writes events straight into a bound struct
+ *
+ * Keeps one frame per open object or array of the target. Keys are looked
+ * up in the struct's compile-time field table, values are converted to the
+ * member's type in place, and unknown keys or mismatched values are skipped
+ * without building anything. No DOM is created.
+ */
+class BindHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+    /**
+     * @brief Bind a document to a root value
+     * @param root Target of the top-level value
+     */
+    explicit BindHandler(json_bind_detail::Target root) : root_(root) {}
+
+    bool null() override;
+    bool boolean(bool value) override;
+    bool number_integer(number_integer_t value) override;
+    bool number_unsigned(number_unsigned_t value) override;
+    bool number_float(number_float_t value, const string_t& text) override;
+    bool string(string_t& value) override;
+    bool binary(binary_t& value) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& value) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string& lastToken,
+                     const nlohmann::detail::exception& error) override;
+
+    /**
+     * @brief Record a mismatch at the current value
+     * @param message Description, e.g. "expected string, got number"
+     */
+    void mismatch(const std::string& message);
+
+    /**
+     * @brief Record a missing field of the innermost object
+     * @param name Field name
+     */
+    void missing(std::string_view name);
+
+    /**
+     * @brief Issues and event count collected so far
+     */
+    BindResult& result() { return result_; }
+
+    /**
+     * @brief Message of the parse error, empty if there was none
+     */
+    const std::string& error() const { return error_; }
+
+private:
+    json_bind_detail::Target next();
+    bool scalar(json_bind_detail::Token token);
+    bool startContainer(bool isArray);
+    bool endContainer();
+    std::string currentPath() const;
+
+    json_bind_detail::Target root_;
+    json_bind_detail::Target pending_;  ///< Set by key()
+    std::vector<std::unique_ptr<json_bind_detail::Frame>> stack_;
+    std::size_t skipDepth_ = 0;  ///< Open containers of an ignored value
+    BindResult result_;
+    std::string error_;
+};
+
+/**
+ * @brief Parse a JSON text straight into a struct with a JsonSchema
+ *
+ * Fields present in the text overwrite the struct's members; others keep
+ * their values. Every required field that is absent and every value of the
+ * wrong type is reported, and binding continues past them.
+ *
+ * @param input Whole JSON text
+ * @param out Target; any type supported as a JsonSchema member
+ * @return Missing and mismatched fields
+ * @throws std::runtime_error if the text is not valid JSON
+ */
+template <typename T>
+BindResult bindJson(std::string_view input, T& out);
+
+// ---------------------------------------------------------------------------
+// Implementation
+
+namespace json_bind_detail {
+
+template <typename T>
+struct IsVector : std::false_type {};
+
+template <typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+
+template <typename T>
+struct IsOptional : std::false_type {};
+
+template <typename T>
+struct IsOptional<std::optional<T>> : std::true_type {};
+
+template <typename T, typename = void>
+struct HasSchema : std::false_type {};
+
+template <typename T>
+struct HasSchema<T, std::void_t<decltype(JsonSchema<T>::fields)>> : std::true_type {};
+
+/// Field names of a schema, in declaration order
+template <typename T>
+constexpr auto fieldNames() {
+    return std::apply([](const auto&... fields) { return std::array<std::string_view, sizeof...(fields)>{fields.name...}; },
+                      JsonSchema<T>::fields);
+}
+
+/// Target of a member
+template <typename Member>
+Target targetOf(Member& member) {
+    return {&member, &opsFor<Member>()};
+}
+
+/// Target of the index-th member of object
+template <typename T>
+Target memberTarget(T& object, std::size_t index) {
+    Target target;
+    std::size_t i = 0;
+    std::apply([&](const auto&... fields) { ((i++ == index ? void(target = targetOf(object.*fields.member)) : void()), ...); },
+               JsonSchema<T>::fields);
+    return target;
+}
+
+/// Bit mask of the schema's fields that must be present
+template <typename T>
+constexpr std::uint64_t requiredMask() {
+    std::uint64_t mask = 0;
+    std::size_t i = 0;
+    std::apply(
+        [&](const auto&... fields) {
+            ((IsOptional<std::decay_t<decltype(std::declval<T&>().*fields.member)>>::value
+                  ? void(++i)
+                  : void(mask |= std::uint64_t{1} << i++)),
+             ...);
+        },
+        JsonSchema<T>::fields);
+    return mask;
+}
+
+/// Whether an integer token is representable as T
+template <typename T>
+bool fitsInteger(const Token& token) {
+    constexpr auto kMax = static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+    if (token.kind == Token::Kind::Unsigned) {
+        return token.unsignedInteger <= kMax;
+    }
+    if (token.integer < 0) {
+        return std::is_signed_v<T> && token.integer >= static_cast<std::int64_t>(std::numeric_limits<T>::min());
+    }
+    return static_cast<std::uint64_t>(token.integer) <= kMax;
+}
+
+template <typename T>
+class ObjectFrame : public Frame {
+public:
+    static constexpr auto kNames = fieldNames<T>();
+    static_assert(kNames.size() <= 64, "JsonSchema supports at most 64 fields");
+
+    explicit ObjectFrame(T& object) : object_(object) {}
+
+    Target field(std::string_view key) override {
+        for (std::size_t i = 0; i < kNames.size(); ++i) {
+            if (kNames[i] == key) {
+                current_ = i;
+                seen_ |= std::uint64_t{1} << i;
+                return memberTarget(object_, i);
+            }
+        }
+        current_ = kNames.size();
+        return {};
+    }
+
+    void finish(BindHandler& handler) override {
+        const std::uint64_t absent = requiredMask<T>() & ~seen_;
+        for (std::size_t i = 0; i < kNames.size(); ++i) {
+            if ((absent >> i) & 1) {
+                handler.missing(kNames[i]);
+            }
+        }
+    }
+
+    void appendChildPath(std::string& path) const override {
+        if (current_ < kNames.size()) {
+            if (!path.empty()) {
+                path += '.';
+            }
+            path += kNames[current_];
+        }
+    }
+
+    bool isArray() const override { return false; }
+
+private:
+    T& object_;
+    std::size_t current_ = kNames.size();
+    std::uint64_t seen_ = 0;
+};
+
+template <typename T>
+class ArrayFrame : public Frame {
+public:
+    explicit ArrayFrame(std::vector<T>& elements) : elements_(elements) {}
+
+    Target element() override {
+        elements_.emplace_back();
+        ++index_;
+        return {&elements_.back(), &opsFor<T>()};
+    }
+
+    void dropElement() override { elements_.pop_back(); }
+
+    void appendChildPath(std::string& path) const override {
+        path += '[';
+        path += std::to_string(index_ - 1);
+        path += ']';
+    }
+
+    bool isArray() const override { return true; }
+
+private:
+    std::vector<T>& elements_;
+    std::size_t index_ = 0;  ///< Elements started, including dropped ones
+};
+
+template <typename T>
+struct Binder {
+    static constexpr bool kString = std::is_same_v<T, std::string>;
+    static constexpr bool kBool = std::is_same_v<T, bool>;
+    static constexpr bool kInteger = std::is_integral_v<T> && !kBool;
+    static constexpr bool kFloat = std::is_floating_point_v<T>;
+    static constexpr bool kArray = IsVector<T>::value;
+    static constexpr bool kObject = HasSchema<T>::value;
+
+    static_assert(kString || kBool || kInteger || kFloat || kArray || kObject,
+                  "Unsupported member type: specialize JsonSchema for it");
+
+    static const char* expected() {
+        return kString ? "string" : kBool ? "boolean" : kInteger ? "integer" : kFloat ? "number" : kArray ? "array" : "object";
+    }
+
+    static bool reject(const Token& token, BindHandler& handler) {
+        handler.mismatch(std::string("expected ") + expected() + ", got " + tokenName(token));
+        return false;
+    }
+
+    static bool scalar(void* target, Token& token, BindHandler& handler) {
+        T& out = *static_cast<T*>(target);
+        if constexpr (kString) {
+            if (token.kind == Token::Kind::String) {
+                // The parser reuses its token buffer, so the string can be taken over.
+                out = std::move(*token.text);
+                return true;
+            }
+        } else if constexpr (kBool) {
+            if (token.kind == Token::Kind::Boolean) {
+                out = token.boolean;
+                return true;
+            }
+        } else if constexpr (kInteger) {
+            if (token.kind == Token::Kind::Integer || token.kind == Token::Kind::Unsigned) {
+                if (!fitsInteger<T>(token)) {
+                    handler.mismatch("integer out of range");
+                    return false;
+                }
+                out = token.kind == Token::Kind::Integer ? static_cast<T>(token.integer)
+                                                         : static_cast<T>(token.unsignedInteger);
+                return true;
+            }
+        } else if constexpr (kFloat) {
+            if (token.kind == Token::Kind::Integer) {
+                out = static_cast<T>(token.integer);
+                return true;
+            }
+            if (token.kind == Token::Kind::Unsigned) {
+                out = static_cast<T>(token.unsignedInteger);
+                return true;
+            }
+            if (token.kind == Token::Kind::Float) {
+                out = static_cast<T>(token.floating);
+                return true;
+            }
+        }
+        return reject(token, handler);
+    }
+
+    static std::unique_ptr<Frame> startObject(void* target, BindHandler& handler) {
+        if constexpr (kObject) {
+            return std::make_unique<ObjectFrame<T>>(*static_cast<T*>(target));
+        } else {
+            handler.mismatch(std::string("expected ") + expected() + ", got object");
+            return nullptr;
+        }
+    }
+
+    static std::unique_ptr<Frame> startArray(void* target, BindHandler& handler) {
+        if constexpr (kArray) {
+            T& out = *static_cast<T*>(target);
+            out.clear();
+            return std::make_unique<ArrayFrame<typename T::value_type>>(out);
+        } else {
+            handler.mismatch(std::string("expected ") + expected() + ", got array");
+            return nullptr;
+        }
+    }
+};
+
+template <typename T>
+struct Binder<std::optional<T>> {
+    static bool scalar(void* target, Token& token, BindHandler& handler) {
+        auto& out = *static_cast<std::optional<T>*>(target);
+        if (token.kind == Token::Kind::Null) {
+            out.reset();
+            return true;
+        }
+        T value{};
+        if (!opsFor<T>().scalar(&value, token, handler)) {
+            return false;
+        }
+        out = std::move(value);
+        return true;
+    }
+
+    static std::unique_ptr<Frame> startObject(void* target, BindHandler& handler) {
+        auto& out = *static_cast<std::optional<T>*>(target);
+        out.emplace();
+        std::unique_ptr<Frame> frame = opsFor<T>().startObject(&*out, handler);
+        if (!frame) {
+            out.reset();
+        }
+        return frame;
+    }
+
+    static std::unique_ptr<Frame> startArray(void* target, BindHandler& handler) {
+        auto& out = *static_cast<std::optional<T>*>(target);
+        out.emplace();
+        std::unique_ptr<Frame> frame = opsFor<T>().startArray(&*out, handler);
+        if (!frame) {
+            out.reset();
+        }
+        return frame;
+    }
+};
+
+template <typename T>
+const TargetOps& opsFor() {
+    static constexpr TargetOps ops{&Binder<T>::scalar, &Binder<T>::startObject, &Binder<T>::startArray};
+    return ops;
+}
+
+} // namespace json_bind_detail
+
+template <typename T>
+BindResult bindJson(std::string_view input, T& out) {
+    BindHandler handler({&out, &json_bind_detail::opsFor<T>()});
+    if (!nlohmann::json::sax_parse(input.begin(), input.end(), &handler)) {
+        throw std::runtime_error("JSON parse error: " + handler.error());
+    }
+    return std::move(handler.result());
+}
+
+#endif // JSON_BIND_H
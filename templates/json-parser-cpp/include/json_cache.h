@@ -0,0 +1,123 @@
+#ifndef JSON_CACHE_H
+#define JSON_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+#include "json_tape.h"
+
+/**
+ * @brief Binary encoding used for cache files
+ */
+enum class CacheFormat {
+    Cbor,        ///< RFC 8949, "<source>.cbor"
+    MessagePack,  ///< "<source>.msgpack"
+    Tape          ///< JsonTape words and strings as laid out in memory, "<source>.tape"
+};
+
+/**
+ * @brief How JsonCache::load() obtained a document
+ */
+enum class CacheStatus {
+    Hit,          ///< Cache matched the source's size and modification time
+    Revalidated,  ///< Modification time changed but the content hash matched
+    Created,      ///< No cache yet; parsed the text and wrote one
+    Rebuilt,      ///< Cache was stale or unreadable; parsed the text and rewrote it
+    Unwritable    ///< Parsed the text; the cache file could not be written
+};
+
+/**
+ * @brief Details of one JsonCache::load()
+ */
+struct CacheInfo {
+    CacheStatus status = CacheStatus::Created;
+    std::string cachePath;
+    std::uint64_t sourceBytes = 0;
+    std::uint64_t cacheBytes = 0;  ///< Size of the cache file, 0 if none was written
+    double seconds = 0.0;
+};
+
+/**
+ * @brief Cache of parsed JSON files in a binary encoding next to the source
+ *
+ * The first load of "config.json" parses the text and writes
+ * "config.json.cbor" (or ".msgpack", ".tape"). The cache starts with a header that
+ * holds the source's size, modification time and a 64-bit content hash.
+ * Later loads compare size and modification time with a single stat(). If
+ * they match, the cache file is memory-mapped and decoded directly, which
+ * skips the text lexer and number parsing. If only the modification time
+ * differs (e.g. after a checkout or touch), the source is hashed: the cache
+ * is kept if the hash matches and rebuilt otherwise.
+ *
+ * CBOR and MessagePack are portable, but nlohmann decodes them byte by byte
+ * and on number-heavy configs that is no faster than parsing the text. The
+ * tape format stores the SIMD backend's JsonTape as-is: a hit is two
+ * memcpy()s and one validation pass, and loadTape() hands the tape to the
+ * caller without building a DOM at all. Tape files use the host's byte
+ * order and are not meant to be shared between machines.
+ *
+ * The cache is best effort. An unwritable directory or a corrupt cache file
+ * never fails a load; the text is parsed instead. Cache files are written
+ * to a temporary name and renamed, so concurrent readers never see a
+ * partial file.
+ */
+class JsonCache {
+public:
+    /// Changes whenever the header layout changes, invalidating old caches
+    static constexpr std::uint32_t kVersion = 1;
+
+    /**
+     * @brief Create a cache
+     * @param format Encoding of the cache files
+     * @param alwaysHash Compare content hashes even if size and time match
+     */
+    explicit JsonCache(CacheFormat format = CacheFormat::Cbor, bool alwaysHash = false);
+
+    /**
+     * @brief Load a JSON file through the cache
+     * @param path Source JSON file
+     * @param info Optional details: status, cache path, sizes, time
+     * @return Parsed document
+     * @throws std::runtime_error if the source cannot be read or is not valid JSON
+     */
+    nlohmann::json load(const std::string& path, CacheInfo* info = nullptr) const;
+
+    /**
+     * @brief Load a JSON file through a tape-format cache without building a DOM
+     * @param path Source JSON file
+     * @param info Optional details: status, cache path, sizes, time
+     * @return Tape of the document
+     * @throws std::invalid_argument if the cache's format is not CacheFormat::Tape
+     * @throws std::runtime_error if the source cannot be read or is not valid JSON
+     */
+    JsonTape loadTape(const std::string& path, CacheInfo* info = nullptr) const;
+
+    /**
+     * @brief Cache file that belongs to a source file
+     * @param path Source JSON file
+     * @return path with ".cbor", ".msgpack" or ".tape" appended
+     */
+    std::string cachePath(const std::string& path) const;
+
+    /**
+     * @brief Fast non-cryptographic 64-bit hash used to detect content changes
+     * @param bytes Data to hash
+     * @return Hash value
+     */
+    static std::uint64_t hashBytes(std::string_view bytes);
+
+    /**
+     * @brief Name of a status for messages
+     * @param status Cache status
+     * @return e.g. "hit" or "created"
+     */
+    static const char* statusName(CacheStatus status);
+
+private:
+    CacheFormat format_;
+    bool alwaysHash_;
+};
+
+#endif // JSON_CACHE_H
@@ -0,0 +1,218 @@
+#ifndef JSON_COLUMNAR_H
+#define JSON_COLUMNAR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ndjson.h"
+
+class FileInput;
+
+/**
+ * @brief Storage type of one column within one row group
+ */
+enum class ColumnType : std::uint32_t {
+    Null,     ///< Column absent from the row group, or null in every row
+    Int64,    ///< Integers
+    Double,   ///< Numbers, when at least one is not an integer
+    String,   ///< uint32 codes into a dictionary of distinct values
+    Boolean   ///< One byte per row, 0 or 1
+};
+
+/**
+ * @brief Configuration of a conversion
+ */
+struct ColumnarOptions {
+    std::size_t workers = 0;           ///< Threads, 0 for std::thread::hardware_concurrency()
+    std::size_t chunkBytes = 8 << 20;  ///< NDJSON text per row group; groups end at a newline
+    std::size_t maxErrors = 100;       ///< Record errors kept in the result (all are counted)
+};
+
+/**
+ * @brief Outcome of a conversion
+ */
+struct ColumnarStats {
+    std::uint64_t rows = 0;           ///< Records stored
+    std::uint64_t failedRecords = 0;  ///< Lines that were not valid JSON objects
+    std::uint64_t columns = 0;
+    std::uint64_t rowGroups = 0;
+    std::uint64_t bytesIn = 0;
+    std::uint64_t bytesOut = 0;
+    double seconds = 0.0;
+    std::vector<NdjsonError> errors;  ///< First ColumnarOptions::maxErrors failures, by line
+};
+
+/**
+ * @brief Result of aggregating one numeric column
+ *
+ * min and max are only meaningful when count > 0.
+ */
+struct ColumnAggregate {
+    std::uint64_t count = 0;    ///< Numeric values aggregated
+    std::uint64_t nulls = 0;    ///< Rows where the value is null or missing
+    std::uint64_t skipped = 0;  ///< Rows with a non-numeric value (strings, booleans, arrays, objects)
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+
+    double mean() const { return count > 0 ? sum / static_cast<double>(count) : 0.0; }
+};
+
+/**
+ * @brief View of one column in one row group, pointing into the mapped file
+ */
+struct ColumnChunk {
+    ColumnType type = ColumnType::Null;
+    std::uint64_t rows = 0;
+    std::uint64_t nulls = 0;
+    const std::uint64_t* validity = nullptr;  ///< Bit i of word i / 64 set if row i has a value; null if all do
+    const std::int64_t* integers = nullptr;   ///< Int64 values, 0 in null rows
+    const double* doubles = nullptr;          ///< Double values, 0 in null rows
+    const std::uint8_t* booleans = nullptr;   ///< Boolean values as 0 or 1, 0 in null rows
+    const std::uint32_t* codes = nullptr;     ///< String dictionary codes, 0 in null rows
+    std::uint64_t dictionarySize = 0;
+
+    /// Whether row i holds a value
+    bool valid(std::uint64_t row) const {
+        return type != ColumnType::Null && (validity == nullptr || (validity[row / 64] >> (row % 64) & 1) != 0);
+    }
+
+    /**
+     * @brief A string dictionary entry
+     * @param code Dictionary code, e.g. codes[row]
+     * @return View into the mapped file
+     * @throws std::out_of_range if code >= dictionarySize
+     */
+    std::string_view string(std::uint32_t code) const;
+
+private:
+    friend class ColumnarFile;
+
+    const std::uint64_t* dictionaryOffsets_ = nullptr;
+    const char* dictionaryBytes_ = nullptr;
+};
+
+/**
+ * @brief Columnar copy of an NDJSON file for repeated analytic scans
+ *
+ * convert() shreds every record into typed columns, one per top-level
+ * field. Nested objects become dotted names ("address.city"); arrays are
+ * stored as their compact JSON text. The input is cut into newline-aligned
+ * chunks (as in NdjsonProcessor), and each chunk becomes one row group,
+ * built on a thread pool and written in input order.
+ *
+ * Within a row group a column is Int64, Double, Boolean or String. The
+ * type is the narrowest one that holds every value in the group: a number
+ * that is not an integer makes the column Double, and any string, or
+ * booleans mixed with numbers, make it String (with numbers and booleans
+ * stored as their JSON text). Strings are dictionary-encoded. A validity
+ * bitmap is stored only when a column has nulls or missing values. The same
+ * column may have different types in different row groups.
+ *
+ * The file is a header, the row groups' arrays, and a footer that lists
+ * the columns and where every chunk lives. Every array is 8-byte aligned,
+ * so opening a file maps it and validates the footer; scans then read the
+ * arrays in place. Files use the host's byte order.
+ *
+ * aggregate() and aggregateBy() run over whole 64-row validity words with
+ * several independent accumulators, which the compiler turns into SIMD
+ * code. A word with every bit set skips the masking. In String chunks,
+ * dictionary entries that are JSON numbers are aggregated as numbers; each
+ * entry is parsed once per chunk.
+ */
+class ColumnarFile {
+public:
+    /// Changes whenever the file layout changes
+    static constexpr std::uint32_t kVersion = 2;
+
+    /**
+     * @brief File written when no output path is given
+     * @param source NDJSON file
+     * @return source + ".cols"
+     */
+    static std::string defaultPath(const std::string& source);
+
+    /**
+     * @brief Convert an NDJSON file
+     * @param source NDJSON file
+     * @param path Columnar file to write, replaced atomically
+     * @param options Workers, row group size and error limit
+     * @return Counters and the first record errors
+     * @throws std::runtime_error if the source cannot be read or the output cannot be written
+     */
+    static ColumnarStats convert(const std::string& source, const std::string& path,
+                                 const ColumnarOptions& options = {});
+
+    /**
+     * @brief Map a columnar file
+     * @param path File written by convert()
+     * @throws std::runtime_error if the file cannot be read or is corrupt
+     */
+    explicit ColumnarFile(const std::string& path);
+    ~ColumnarFile();
+
+    ColumnarFile(const ColumnarFile&) = delete;
+    ColumnarFile& operator=(const ColumnarFile&) = delete;
+
+    /// Number of records
+    std::uint64_t rows() const { return rows_; }
+
+    /// Column names, in order of first appearance
+    const std::vector<std::string>& columns() const { return columns_; }
+
+    /// Number of row groups
+    std::size_t rowGroups() const { return groups_.size(); }
+
+    /**
+     * @brief Position of a column
+     * @param name Column name
+     * @return Index into columns()
+     * @throws std::invalid_argument if there is no such column
+     */
+    std::size_t column(std::string_view name) const;
+
+    /**
+     * @brief One column of one row group
+     * @param group Row group index
+     * @param column Column index
+     * @return Chunk view; type Null if the group has no values for the column
+     * @throws std::out_of_range if either index is out of range
+     */
+    ColumnChunk chunk(std::size_t group, std::size_t column) const;
+
+    /**
+     * @brief Count, sum, min and max of a numeric column
+     * @param name Column name
+     * @return Aggregate over every row
+     * @throws std::invalid_argument if there is no such column
+     */
+    ColumnAggregate aggregate(std::string_view name) const;
+
+    /**
+     * @brief Aggregate a numeric column per distinct value of another column
+     * @param groupColumn Column whose values form the groups; rows where it is null are left out
+     * @param valueColumn Numeric column to aggregate
+     * @return Aggregate per group value, numbers keyed by their JSON text
+     * @throws std::invalid_argument if either column does not exist
+     */
+    std::map<std::string, ColumnAggregate> aggregateBy(std::string_view groupColumn,
+                                                       std::string_view valueColumn) const;
+
+private:
+    struct Group {
+        std::uint64_t rows;
+        std::vector<std::size_t> chunks;  ///< Per column: footer chunk index, or npos
+    };
+
+    std::unique_ptr<FileInput> file_;
+    std::uint64_t rows_ = 0;
+    std::vector<std::string> columns_;
+    std::vector<Group> groups_;
+    std::vector<ColumnChunk> chunks_;
+};
+
+#endif // JSON_COLUMNAR_H
@@ -0,0 +1,113 @@
+#ifndef JSON_QUERY_H
+#define JSON_QUERY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief A set of JSON Pointer / JSONPath expressions compiled into one matcher
+ *
+ * Expressions are compiled once and then run against any number of
+ * documents. Supported syntax:
+ * - JSON Pointer (RFC 6901): "/address/zipcode", "" for the whole document;
+ *   a segment that is just "*" matches every key or index
+ * - JSONPath subset: "$.address.zipcode", "$.skills[*]", "$.skills[0]",
+ *   "$['odd key']", "$.*"
+ *
+ * A run is a single pass over the text. All expressions advance together:
+ * at each nesting level a bitmask records which of them still match the
+ * current path, and a value that no expression can match is skipped by
+ * scanning for its closing bracket, without decoding anything inside it.
+ * Matches are reported as views of the raw value text in the input, so
+ * nothing is copied or materialized unless the caller asks for it.
+ *
+ * The scanner checks structure (brackets, separators, string ends) as far
+ * as it needs to walk the document; it does not fully validate skipped
+ * values or scalars. Run a validating parser first for untrusted input.
+ */
+class JsonQuery {
+public:
+    /// Most expressions in one query
+    static constexpr std::size_t kMaxExpressions = 64;
+
+    /**
+     * @brief A value matched by one expression
+     */
+    struct Match {
+        std::size_t expression;  ///< Index of the expression that matched
+        std::string_view value;  ///< Raw JSON text of the value, e.g. "\"10001\"", "42" or "[1, 2]"
+
+        /**
+         * @brief The value without its quotes if it is a string
+         *
+         * Escape sequences are left as they appear in the input.
+         */
+        std::string_view text() const;
+
+        /**
+         * @brief Parse the matched value into a DOM
+         * @return The value as nlohmann::json
+         */
+        nlohmann::json parse() const;
+    };
+
+    /// Called for every match, in the order the matched values end
+    using MatchFn = std::function<void(const Match& match)>;
+
+    /**
+     * @brief Compile a set of expressions
+     * @param expressions JSON Pointers or JSONPath expressions
+     * @throws std::invalid_argument for malformed or unsupported syntax, or
+     *         more than kMaxExpressions expressions
+     */
+    explicit JsonQuery(const std::vector<std::string>& expressions);
+
+    /**
+     * @brief Report every match in a document
+     * @param document Whole JSON text, e.g. FileInput::view() or one NDJSON line
+     * @param onMatch Callback for each match
+     * @throws std::runtime_error if the document's structure is broken
+     */
+    void run(std::string_view document, const MatchFn& onMatch) const;
+
+    /**
+     * @brief Collect every match in a document
+     * @param document Whole JSON text
+     * @return Matches, in the order the matched values end
+     * @throws std::runtime_error if the document's structure is broken
+     */
+    std::vector<Match> run(std::string_view document) const;
+
+    /// Number of compiled expressions
+    std::size_t size() const { return expressions_.size(); }
+
+    /**
+     * @brief Source text of an expression
+     * @param index Expression index
+     * @return Expression as given to the constructor
+     */
+    const std::string& expression(std::size_t index) const { return expressions_[index]; }
+
+private:
+    friend class QueryScanner;
+
+    /// One path step: an object key, an array index, or any child
+    struct Step {
+        std::string key;
+        std::int64_t index = -1;  ///< Array index the step also matches, -1 if none
+        bool wildcard = false;
+    };
+
+    static std::vector<Step> compile(const std::string& expression);
+
+    std::vector<std::string> expressions_;
+    std::vector<std::vector<Step>> steps_;
+    std::vector<std::uint64_t> endsAt_;  ///< Bit i of endsAt_[d]: expression i has d steps
+};
+
+#endif // JSON_QUERY_H
@@ -0,0 +1,300 @@
+#ifndef JSON_SHAPE_H
+#define JSON_SHAPE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "arena.h"
+
+/// Interned object key
+using Symbol = std::uint32_t;
+
+class ShapeBuilder;
+
+/**
+ * @brief Process-wide table of interned object keys
+ *
+ * Every distinct key is stored once and named by a small integer. Lookups
+ * go through a per-thread cache first, so the shared lock is only taken
+ * the first time a thread sees a key. Symbols and their names stay valid
+ * for the life of the process.
+ */
+class SymbolTable {
+public:
+    /// The table used by ShapedDocument
+    static SymbolTable& global();
+
+    /**
+     * @brief Symbol of a key, adding the key if it is new
+     * @param key Object key
+     * @return Stable symbol
+     */
+    Symbol intern(std::string_view key);
+
+    /**
+     * @brief Key of a symbol
+     * @param symbol Symbol returned by intern()
+     * @return View valid for the life of the table
+     */
+    std::string_view name(Symbol symbol) const;
+
+    /// Number of distinct keys
+    std::size_t size() const;
+
+private:
+    SymbolTable() = default;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string_view, Symbol> symbols_;
+    std::deque<std::string> names_;  ///< Deque: names never move
+};
+
+/**
+ * @brief The key set of an object, shared by every object with the same keys
+ *
+ * Objects store only a Shape pointer and their values in key order, so the
+ * keys of a million identical records are held once. Keys keep the order of
+ * their first appearance; when a key repeats in one object, the last value
+ * wins, as in nlohmann::json::parse.
+ */
+class Shape {
+public:
+    /// Number of distinct keys
+    std::size_t size() const { return keys_.size(); }
+
+    /// Symbol of the key at a position
+    Symbol key(std::size_t index) const { return keys_[index]; }
+
+    /// Name of the key at a position
+    std::string_view name(std::size_t index) const { return names_[index]; }
+
+    /**
+     * @brief Position of a key's value in objects of this shape
+     * @param symbol Key symbol
+     * @return Position, or -1 if objects of this shape lack the key
+     */
+    std::ptrdiff_t indexOf(Symbol symbol) const;
+
+private:
+    friend class ShapeTable;
+    friend class ShapeBuilder;
+
+    std::vector<Symbol> keys_;
+    std::vector<std::string_view> names_;
+    std::vector<std::uint32_t> slotOf_;  ///< Value position for each key as written, duplicates included
+    std::unordered_map<Symbol, std::uint32_t> index_;
+};
+
+/**
+ * @brief Process-wide registry of shapes, keyed by key-symbol sequence
+ *
+ * Backed by a shared lock plus a per-thread cache, like SymbolTable.
+ * Shapes are never freed.
+ */
+class ShapeTable {
+public:
+    /// The table used by ShapedDocument
+    static ShapeTable& global();
+
+    /**
+     * @brief Shape of an object whose keys appear in this order
+     * @param keys Key symbols as written, duplicates included
+     * @param count Number of keys
+     * @return Shared shape
+     */
+    const Shape& shapeOf(const Symbol* keys, std::size_t count);
+
+    /// Number of distinct shapes
+    std::size_t size() const;
+
+private:
+    ShapeTable() = default;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::u32string, std::unique_ptr<Shape>> shapes_;
+};
+
+/**
+ * @brief One value of a ShapedDocument: 16 bytes, children in the arena
+ */
+class ShapedValue {
+public:
+    /**
+     * @brief Stored type
+     */
+    enum class Type : std::uint8_t {
+        Null,
+        Boolean,
+        Integer,   ///< int64
+        Unsigned,  ///< uint64
+        Double,
+        String,
+        Array,
+        Object
+    };
+
+    Type type() const { return type_; }
+
+    bool is_null() const { return type_ == Type::Null; }
+    bool is_boolean() const { return type_ == Type::Boolean; }
+    bool is_number() const { return type_ == Type::Integer || type_ == Type::Unsigned || type_ == Type::Double; }
+    bool is_string() const { return type_ == Type::String; }
+    bool is_array() const { return type_ == Type::Array; }
+    bool is_object() const { return type_ == Type::Object; }
+
+    /// Elements of an array, members of an object, 0 for null, 1 for other scalars
+    std::size_t size() const;
+
+    /// Shape of an object, nullptr for other types
+    const Shape* shape() const { return type_ == Type::Object ? object_->shape : nullptr; }
+
+    /**
+     * @brief Member by symbol; the fast path for scans over many records
+     * @param symbol Key symbol from SymbolTable::global().intern()
+     * @return Member value, or nullptr if this is not an object or lacks the key
+     */
+    const ShapedValue* find(Symbol symbol) const;
+
+    /**
+     * @brief Whether this is an object with a member of that name
+     * @param key Member name
+     * @return false for a missing key or a value that is not an object
+     */
+    bool contains(std::string_view key) const;
+
+    /**
+     * @brief Member by name
+     * @param key Member name
+     * @return Member value
+     * @throws std::out_of_range if this is not an object or has no such key
+     */
+    const ShapedValue& operator[](std::string_view key) const;
+
+    /**
+     * @brief Element of an array, or member of an object by position
+     * @param index Zero-based position
+     * @return Element or member value
+     * @throws std::out_of_range if this is a scalar or index >= size()
+     */
+    const ShapedValue& operator[](std::size_t index) const;
+
+    /**
+     * @brief Convert a scalar as nlohmann::json::get<T>() would
+     * @return bool, any arithmetic type, std::string or std::string_view
+     * @throws std::invalid_argument if the value has another type
+     */
+    template <typename T>
+    T get() const {
+        if constexpr (std::is_same_v<T, bool>) {
+            requireType(type_ == Type::Boolean, "boolean");
+            return boolean_;
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            switch (type_) {
+            case Type::Integer:
+                return static_cast<T>(integer_);
+            case Type::Unsigned:
+                return static_cast<T>(unsigned_);
+            case Type::Double:
+                return static_cast<T>(number_);
+            default:
+                requireType(false, "number");
+                return T{};
+            }
+        } else {
+            static_assert(std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>,
+                          "get<T>() supports bool, arithmetic types, std::string and std::string_view");
+            requireType(type_ == Type::String, "string");
+            return T(string_, size_);
+        }
+    }
+
+    /// First element or member value
+    const ShapedValue* begin() const;
+
+    /// Past the last element or member value
+    const ShapedValue* end() const { return begin() + (is_array() || is_object() ? size_ : 0); }
+
+    /**
+     * @brief Build the equivalent nlohmann::json
+     * @return Deep copy of the value
+     */
+    nlohmann::json toJson() const;
+
+private:
+    friend class ShapeBuilder;
+
+    struct ObjectData {
+        const Shape* shape;
+        const ShapedValue* values;
+    };
+
+    void requireType(bool ok, const char* expected) const;
+
+    Type type_ = Type::Null;
+    std::uint32_t size_ = 0;  ///< String bytes, array elements or object members
+    union {
+        std::uint64_t bits_ = 0;
+        bool boolean_;
+        std::int64_t integer_;
+        std::uint64_t unsigned_;
+        double number_;
+        const char* string_;
+        const ShapedValue* elements_;
+        const ObjectData* object_;
+    };
+};
+
+/**
+ * @brief Arena of records with interned keys and shared object shapes
+ *
+ * parse() reads one JSON text (e.g. one NDJSON line) with nlohmann's SAX
+ * parser and appends it to the document's arena. Keys are interned in
+ * SymbolTable::global(). Each object stores its Shape, found by its
+ * sequence of key symbols, plus a flat array of values. Strings, arrays
+ * and objects are bump-allocated next to each other. A parse therefore
+ * makes no heap allocation per key, member or node. Once the working
+ * buffers have grown, the only allocations left are the few buffers
+ * nlohmann's parser sets up per call, new arena blocks, and the first
+ * sighting of a key or shape.
+ *
+ * Shapes are shared process-wide (see ShapeTable), so records parsed into
+ * different documents, even on different threads, use the same Shape
+ * objects. A document is not thread-safe; use one per thread.
+ */
+class ShapedDocument {
+public:
+    /**
+     * @brief Create an empty document
+     * @param firstBlockBytes Size of the arena's first block
+     */
+    explicit ShapedDocument(std::size_t firstBlockBytes = Arena::kDefaultBlockBytes);
+    ~ShapedDocument();
+
+    ShapedDocument(const ShapedDocument&) = delete;
+    ShapedDocument& operator=(const ShapedDocument&) = delete;
+
+    /**
+     * @brief Parse a JSON text and keep it in the document
+     * @param text One JSON value
+     * @return Root value, valid as long as the document
+     * @throws std::runtime_error if the text is not valid JSON
+     */
+    const ShapedValue& parse(std::string_view text);
+
+    /// Arena holding all parsed values
+    const Arena& arena() const { return arena_; }
+
+private:
+    Arena arena_;
+    std::unique_ptr<ShapeBuilder> builder_;
+};
+
+#endif // JSON_SHAPE_H
@@ -0,0 +1,134 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+class FileInput;
+
+/**
+ * @brief Fields of a person document, as read by printJsonInfo()
+ *
+ * A field is empty if the document does not contain it, or contains it with
+ * a type that does not match (e.g. "skills" that is not an array).
+ */
+struct JsonSummary {
+    std::optional<std::string> name;
+    std::optional<std::int64_t> age;
+    std::optional<std::string> city;
+    std::optional<bool> active;
+    std::optional<double> salary;
+    std::optional<std::vector<std::string>> skills;  ///< String elements of the "skills" array
+    bool hasAddress = false;                         ///< "address" is an object
+    std::optional<std::string> street;               ///< address.street
+    std::optional<std::string> zipcode;              ///< address.zipcode
+};
+
+/**
+ * @brief Counters of one streaming parse
+ */
+struct StreamStats {
+    std::uint64_t bytes = 0;   ///< Input bytes consumed
+    std::uint64_t events = 0;  ///< SAX events (values, keys, container starts and ends)
+    double seconds = 0.0;
+
+    double bytesPerSecond() const { return seconds > 0.0 ? static_cast<double>(bytes) / seconds : 0.0; }
+};
+
+/**
+ * @brief SAX handler that fills a JsonSummary without building a DOM
+ *
+ * Only the root object's name, age, city, active, salary, skills and
+ * address fields are kept; every other value is dropped as soon as the
+ * parser reports it. Memory use therefore does not depend on the size of
+ * the document, only on the size of the extracted fields.
+ */
+class SummaryHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+    bool null() override;
+    bool boolean(bool value) override;
+    bool number_integer(number_integer_t value) override;
+    bool number_unsigned(number_unsigned_t value) override;
+    bool number_float(number_float_t value, const string_t& text) override;
+    bool string(string_t& value) override;
+    bool binary(binary_t& value) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& value) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string& lastToken,
+                     const nlohmann::detail::exception& error) override;
+
+    /**
+     * @brief Fields collected so far
+     */
+    const JsonSummary& summary() const { return summary_; }
+
+    /**
+     * @brief Number of SAX events seen
+     */
+    std::uint64_t events() const { return events_; }
+
+    /**
+     * @brief Message of the parse error, empty if there was none
+     */
+    const std::string& error() const { return error_; }
+
+private:
+    /// Field of the root object, or address field, the next value belongs to
+    enum class Field { None, Name, Age, City, Active, Salary, Skills, Address, Street, Zipcode };
+
+    bool number(double value, std::optional<std::int64_t> integer);
+    bool text(std::string& value);
+    bool startContainer(bool isArray);
+    bool endContainer();
+
+    JsonSummary summary_;
+    std::size_t depth_ = 0;     ///< Open objects and arrays
+    bool rootObject_ = false;   ///< The document is an object
+    Field field_ = Field::None; ///< Set by key() at depth 1 and 2
+    bool inSkills_ = false;     ///< Directly inside the root's "skills" array
+    bool inAddress_ = false;    ///< Directly inside the root's "address" object
+    std::uint64_t events_ = 0;
+    std::string error_;
+};
+
+/**
+ * @brief Extract the summary fields from a stream with nlohmann::json::sax_parse
+ * @param input Stream positioned at the start of one JSON document
+ * @param stats Optional counters; bytes is only known for seekable streams
+ * @return Extracted fields
+ * @throws std::runtime_error if the document is not valid JSON
+ */
+JsonSummary summarizeJson(std::istream& input, StreamStats* stats = nullptr);
+
+/**
+ * @brief Extract the summary fields from a mapped or read file
+ * @param input Whole input; mapped pages are released as the parse advances
+ * @param stats Optional counters
+ * @return Extracted fields
+ * @throws std::runtime_error if the input is not valid JSON
+ */
+JsonSummary summarizeJson(const FileInput& input, StreamStats* stats = nullptr);
+
+/**
+ * @brief Extract the summary fields from a file without building a DOM
+ *
+ * The file is memory-mapped (see FileInput) and consumed pages are dropped
+ * during the parse, so peak memory stays flat for files of any size. Use
+ * "-" to read stdin.
+ *
+ * @param path JSON file
+ * @param stats Optional counters
+ * @return Extracted fields
+ * @throws std::runtime_error if the file cannot be opened or is not valid JSON
+ */
+JsonSummary summarizeJsonFile(const std::string& path, StreamStats* stats = nullptr);
+
+#endif // JSON_STREAM_H
@@ -0,0 +1,140 @@
+#ifndef JSON_TAPE_H
+#define JSON_TAPE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Stage 2 of the SIMD parser: a validated document as a flat tape
+ *
+ * Walks the offsets produced by StructuralIndex and records the document as
+ * one 64-bit word per value: the value type in the high byte and a payload
+ * in the low 56 bits. Containers get a begin and an end word that point at
+ * each other, so a whole subtree can be skipped in one step; object members
+ * are stored as alternating key and value. Numbers are followed by a second
+ * word holding the int64, uint64 or double bits, and strings point into a
+ * separate buffer of unescaped bytes prefixed with their 32-bit length.
+ *
+ * Parsing validates the full grammar (literals, the JSON number syntax,
+ * escapes and surrogate pairs, control characters and UTF-8) so the backend
+ * accepts what nlohmann::json accepts, including a leading UTF-8 byte order
+ * mark, except for documents nested deeper than kMaxDepth.
+ */
+class JsonTape {
+public:
+    /**
+     * @brief Type tag stored in the high byte of a tape word
+     */
+    enum class Type : std::uint8_t {
+        Null = 'n',
+        True = 't',
+        False = 'f',
+        Int64 = 'l',
+        Uint64 = 'u',
+        Double = 'd',
+        String = '"',
+        ArrayBegin = '[',
+        ArrayEnd = ']',
+        ObjectBegin = '{',
+        ObjectEnd = '}'
+    };
+
+    /// Deepest nesting of arrays and objects accepted
+    static constexpr std::size_t kMaxDepth = 1024;
+
+    /**
+     * @brief Parse a JSON text (stage 1 and stage 2)
+     * @param input Whole JSON text
+     * @return Tape of the document
+     * @throws std::runtime_error if the text is not valid JSON
+     */
+    static JsonTape parse(std::string_view input);
+
+    /**
+     * @brief Build the tape from an existing structural index (stage 2 only)
+     * @param input Whole JSON text
+     * @param structurals Offsets from StructuralIndex::build(input)
+     * @return Tape of the document
+     * @throws std::runtime_error if the text is not valid JSON
+     */
+    static JsonTape parse(std::string_view input, const std::vector<std::uint32_t>& structurals);
+
+    /**
+     * @brief Append the tape's binary layout to a buffer
+     *
+     * Layout: word count and string buffer size (uint64 each, native byte
+     * order), the tape words, then the string buffer. Used by JsonCache.
+     *
+     * @param out Buffer to append to
+     */
+    void serialize(std::vector<std::uint8_t>& out) const;
+
+    /**
+     * @brief Rebuild a tape from serialize() output
+     *
+     * The words are checked for consistency (types, container links, key
+     * positions, string bounds), so a damaged buffer is rejected rather than
+     * read out of bounds later.
+     *
+     * @param bytes Serialized tape
+     * @return Tape equal to the serialized one
+     * @throws std::runtime_error if the buffer is truncated or inconsistent
+     */
+    static JsonTape deserialize(std::string_view bytes);
+
+    /**
+     * @brief Convert the tape to a DOM
+     *
+     * As with nlohmann::json::parse, the last of several equal keys wins.
+     *
+     * @return Equivalent nlohmann::json value
+     */
+    nlohmann::json toJson() const;
+
+    /**
+     * @brief Type of the tape word at an index
+     * @param index Tape index
+     * @return Type tag
+     */
+    Type type(std::size_t index) const { return static_cast<Type>(tape_[index] >> 56); }
+
+    /**
+     * @brief Payload of the tape word at an index
+     *
+     * For a container begin word: index just past its end word. For an end
+     * word: index of its begin word. For a string: offset in the string buffer.
+     *
+     * @param index Tape index
+     * @return Low 56 bits of the word
+     */
+    std::uint64_t payload(std::size_t index) const { return tape_[index] & kPayloadMask; }
+
+    /**
+     * @brief Unescaped contents of the string at a tape index
+     * @param index Tape index of a String word
+     * @return View into the tape's string buffer
+     */
+    std::string_view string(std::size_t index) const;
+
+    /// Number of tape words
+    std::size_t size() const { return tape_.size(); }
+
+    /// Bytes held by the tape and its string buffer
+    std::size_t memoryBytes() const { return tape_.capacity() * sizeof(std::uint64_t) + strings_.capacity(); }
+
+private:
+    static constexpr std::uint64_t kPayloadMask = (std::uint64_t{1} << 56) - 1;
+
+    friend class TapeBuilder;
+
+    nlohmann::json valueToJson(std::size_t& index) const;
+
+    std::vector<std::uint64_t> tape_;
+    std::string strings_;
+};
+
+#endif // JSON_TAPE_H
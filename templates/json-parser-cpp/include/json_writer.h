@@ -0,0 +1,84 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Serializes a DOM straight to a file descriptor, without a full string
+ *
+ * nlohmann::json::dump() builds the whole text in one std::string before
+ * anything is written, which doubles peak memory for large documents.
+ * JsonWriter walks the tree and appends to one fixed kBufferBytes buffer,
+ * written out with write() whenever it fills. A string too large for the
+ * buffer goes out together with the buffered bytes in one writev(), without
+ * being copied.
+ *
+ * The output is the same as dump(indent): the same spacing, key order and
+ * string escapes (non-ASCII bytes are written as they are). Doubles use
+ * std::to_chars shortest round-trip digits laid out as dump() lays them
+ * out. dump()'s Grisu2 can occasionally emit a longer digit string, so the
+ * two may differ in such rare cases; both parse back to the same value.
+ * Non-finite doubles are written as null.
+ */
+class JsonWriter {
+public:
+    /// Size of the output buffer
+    static constexpr std::size_t kBufferBytes = 64 << 10;
+
+    /**
+     * @brief Create a writer
+     * @param fd Open file descriptor, e.g. STDOUT_FILENO; not closed by the writer
+     * @param indent Spaces per nesting level; negative for compact output, as with dump()
+     */
+    explicit JsonWriter(int fd, int indent = -1);
+
+    /**
+     * @brief Flush what is buffered; errors are ignored here, call flush() to see them
+     */
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    /**
+     * @brief Serialize a value; output is flushed as the buffer fills
+     * @param value Value to write
+     * @throws std::invalid_argument for binary values, which have no JSON text
+     * @throws std::runtime_error if writing to the descriptor fails
+     */
+    void write(const nlohmann::json& value);
+
+    /**
+     * @brief Write out everything still buffered
+     * @throws std::runtime_error if writing to the descriptor fails
+     */
+    void flush();
+
+    /// Bytes serialized so far, buffered or written
+    std::uint64_t bytes() const { return flushed_ + used_; }
+
+private:
+    void writeValue(const nlohmann::json& value, std::size_t depth);
+    void writeString(std::string_view text);
+    void writeDouble(double value);
+    void newline(std::size_t depth);
+    void append(const char* data, std::size_t size);
+    void put(char c) {
+        if (used_ == kBufferBytes) {
+            flush();
+        }
+        buffer_[used_++] = c;
+    }
+
+    int fd_;
+    int indent_;
+    std::unique_ptr<char[]> buffer_;
+    std::size_t used_ = 0;
+    std::uint64_t flushed_ = 0;
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,198 @@
+#ifndef LAZY_JSON_H
+#define LAZY_JSON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Read-only JSON document that decodes values only when accessed
+ *
+ * parse() runs stage 1 of the SIMD backend (StructuralIndex) and one
+ * bracket-matching pass over its offsets. Nothing is decoded and no tree is
+ * built. A LazyJson is a handle to one value of that document:
+ * - The first access to an object or array lists its direct children from
+ *   the structural offsets and caches the list.
+ * - get<T>() decodes a value with nlohmann::json the first time it is
+ *   called and caches the result.
+ * A subtree that is never touched costs only its share of the index.
+ *
+ * The interface mirrors the read-only part of nlohmann::json (contains,
+ * operator[], get<T>, size, is_*, range-for), so code written against a
+ * const json& usually compiles unchanged. Differences: operator[] throws
+ * std::out_of_range for a missing key or index, like at(), and iterating
+ * a scalar yields nothing.
+ *
+ * Validation is lazy as well. parse() checks bracket nesting and that there
+ * is a single root value. Separators are checked when a container is
+ * listed, scalars and strings when they are decoded. Use a validating
+ * backend first if the whole input must be known to be valid.
+ *
+ * Handles share the document (input, index and caches) and keep it alive.
+ * The caches are not synchronized: use one document per thread.
+ */
+class LazyJson {
+private:
+    struct Document;
+
+    /// A direct child: structural indices of its key (objects) and value
+    struct Child {
+        std::uint32_t key;
+        std::uint32_t value;
+        std::uint32_t end;  ///< Structural index just past the value
+    };
+
+public:
+    /**
+     * @brief Forward iterator over the values of an array or object
+     */
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = LazyJson;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = LazyJson;
+
+        Iterator() = default;
+
+        LazyJson operator*() const { return LazyJson(document_, pos_->value, pos_->end); }
+
+        /**
+         * @brief Key of the current member when iterating an object
+         * @throws std::invalid_argument when iterating an array
+         * @throws std::runtime_error if the key is not a valid JSON string
+         */
+        std::string key() const;
+
+        Iterator& operator++() {
+            ++pos_;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            ++pos_;
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const { return pos_ == other.pos_; }
+        bool operator!=(const Iterator& other) const { return pos_ != other.pos_; }
+
+    private:
+        friend class LazyJson;
+
+        Iterator(std::shared_ptr<Document> document, const Child* pos) : document_(std::move(document)), pos_(pos) {}
+
+        std::shared_ptr<Document> document_;
+        const Child* pos_ = nullptr;
+    };
+
+    /**
+     * @brief Index a JSON text without decoding it
+     * @param input Whole JSON text; must outlive every handle to the document
+     * @return Handle to the root value
+     * @throws std::runtime_error if brackets do not match, there is not
+     *         exactly one root value, or a string is not closed
+     */
+    static LazyJson parse(std::string_view input);
+
+    /**
+     * @brief Map a file and index it; the document keeps the mapping
+     * @param path File path, "-" for stdin
+     * @return Handle to the root value
+     * @throws std::runtime_error if the file cannot be read or parse() fails
+     */
+    static LazyJson load(const std::string& path);
+
+    /// Type of the value, from its first character (and a number's own text)
+    nlohmann::json::value_t type() const;
+
+    bool is_null() const { return type() == nlohmann::json::value_t::null; }
+    bool is_boolean() const { return type() == nlohmann::json::value_t::boolean; }
+    bool is_number() const {
+        const nlohmann::json::value_t t = type();
+        return t == nlohmann::json::value_t::number_integer || t == nlohmann::json::value_t::number_unsigned ||
+               t == nlohmann::json::value_t::number_float;
+    }
+    bool is_string() const { return type() == nlohmann::json::value_t::string; }
+    bool is_array() const { return type() == nlohmann::json::value_t::array; }
+    bool is_object() const { return type() == nlohmann::json::value_t::object; }
+
+    /**
+     * @brief Whether this is an object with a member of that name
+     * @param key Member name
+     * @return false for a missing key or a value that is not an object
+     * @throws std::runtime_error if the object's separators are malformed
+     */
+    bool contains(std::string_view key) const;
+
+    /**
+     * @brief Member of an object; the last one wins if the key repeats
+     * @param key Member name
+     * @return Handle to the member's value
+     * @throws std::out_of_range if this is not an object or has no such key
+     * @throws std::runtime_error if the object's separators are malformed
+     */
+    LazyJson operator[](std::string_view key) const;
+
+    /**
+     * @brief Element of an array
+     * @param index Zero-based element index
+     * @return Handle to the element
+     * @throws std::out_of_range if this is not an array or index >= size()
+     * @throws std::runtime_error if the array's separators are malformed
+     */
+    LazyJson operator[](std::size_t index) const;
+
+    /// Number of elements or members; 0 for null, 1 for other scalars
+    std::size_t size() const;
+
+    /// Whether size() is 0
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Decode the value as nlohmann::json::get<T>() would
+     * @return The value converted to T
+     * @throws std::runtime_error if the value's text is not valid JSON
+     * @throws nlohmann::json::type_error if the value cannot convert to T
+     */
+    template <typename T>
+    T get() const {
+        return materialize().template get<T>();
+    }
+
+    /**
+     * @brief Decode the value (a whole subtree for containers) and cache it
+     * @return Cached DOM of the value, valid as long as the document
+     * @throws std::runtime_error if the value's text is not valid JSON
+     */
+    const nlohmann::json& materialize() const;
+
+    /// Raw JSON text of the value in the input
+    std::string_view raw() const;
+
+    /// First child value of an array or object; equals end() for scalars
+    Iterator begin() const;
+
+    /// Past the last child value
+    Iterator end() const;
+
+private:
+    LazyJson(std::shared_ptr<Document> document, std::uint32_t index, std::uint32_t end)
+        : document_(std::move(document)), index_(index), end_(end) {}
+
+    const std::vector<Child>& children() const;
+    const Child* findKey(std::string_view key) const;
+
+    std::shared_ptr<Document> document_;
+    std::uint32_t index_ = 0;  ///< Structural index of the value's first character
+    std::uint32_t end_ = 0;    ///< Structural index just past the value
+};
+
+#endif // LAZY_JSON_H
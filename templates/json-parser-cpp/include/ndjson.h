@@ -0,0 +1,108 @@
+#ifndef NDJSON_H
+#define NDJSON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Configuration of an NdjsonProcessor run
+ */
+struct NdjsonOptions {
+    std::size_t workers = 0;           ///< Threads, 0 for std::thread::hardware_concurrency()
+    bool ordered = true;               ///< Emit output in input order (false: as chunks finish)
+    std::size_t chunkBytes = 1 << 20;  ///< Target chunk size; chunks end at a newline
+    std::size_t maxErrors = 100;       ///< Record errors kept in the result (all are counted)
+};
+
+/**
+ * @brief A record that could not be parsed or processed
+ */
+struct NdjsonError {
+    std::uint64_t line = 0;  ///< 1-based line number in the input
+    std::string message;
+};
+
+/**
+ * @brief Outcome of an NdjsonProcessor run
+ */
+struct NdjsonResult {
+    std::uint64_t records = 0;        ///< Records parsed and processed
+    std::uint64_t failedRecords = 0;  ///< Records that failed
+    std::uint64_t lines = 0;          ///< Lines in the input, including blank ones
+    std::uint64_t bytes = 0;
+    std::uint64_t chunks = 0;
+    std::size_t workers = 0;
+    double seconds = 0.0;
+    std::vector<NdjsonError> errors;  ///< First NdjsonOptions::maxErrors failures, by line
+
+    double bytesPerSecond() const { return seconds > 0.0 ? static_cast<double>(bytes) / seconds : 0.0; }
+};
+
+/**
+ * @brief Parses newline-delimited JSON (JSON Lines) on a thread pool
+ *
+ * The input is cut into chunks of about chunkBytes that end at a newline,
+ * so every record lies in exactly one chunk. Workers claim chunks from a
+ * shared counter, parse each line with nlohmann::json and pass the record
+ * to a callback that appends its output for the record to the chunk's
+ * output buffer. A finished chunk's output goes to the sink either in input
+ * order or as soon as it is done. In ordered mode workers stay at most a few
+ * chunks per thread ahead of the oldest unfinished chunk, so buffered output
+ * stays bounded.
+ *
+ * A record that fails to parse, or whose callback throws, is counted and
+ * reported with its line number; the run continues. Blank lines are skipped.
+ */
+class NdjsonProcessor {
+public:
+    /**
+     * @brief Per-record callback
+     *
+     * Called concurrently from several workers, each time with a different
+     * record and output buffer. May throw to mark the record as failed.
+     */
+    using RecordFn = std::function<void(nlohmann::json& record, std::string& out)>;
+
+    /**
+     * @brief Receives the output of one chunk
+     *
+     * Never called concurrently. Runs on a worker thread and must not throw.
+     */
+    using SinkFn = std::function<void(std::string_view output)>;
+
+    /// Chunks a worker may run ahead of the oldest unfinished one, in ordered mode
+    static constexpr std::size_t kChunksAheadPerWorker = 4;
+
+    /**
+     * @brief Create a processor
+     * @param options Worker count, ordering, chunk size and error limit
+     */
+    explicit NdjsonProcessor(NdjsonOptions options = {});
+
+    /**
+     * @brief Process every record of an input
+     * @param input Whole NDJSON input, e.g. FileInput::view()
+     * @param record Callback for each record
+     * @param sink Callback for each chunk's output
+     * @return Counters and the first errors
+     */
+    NdjsonResult run(std::string_view input, const RecordFn& record, const SinkFn& sink) const;
+
+    /**
+     * @brief Cut an input into chunks that end at a newline
+     * @param input Whole input
+     * @param chunkBytes Target chunk size; a chunk is longer if a line is
+     * @return Chunks covering input in order
+     */
+    static std::vector<std::string_view> split(std::string_view input, std::size_t chunkBytes);
+
+private:
+    NdjsonOptions options_;
+};
+
+#endif // NDJSON_H
@@ -0,0 +1,219 @@
+#ifndef NDJSON_INDEX_H
+#define NDJSON_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+class FileInput;
+class JsonQuery;
+
+/**
+ * @brief Configuration of an index build
+ */
+struct NdjsonIndexOptions {
+    std::string keyField;              ///< Top-level field used as primary key, empty for none
+    std::size_t workers = 0;           ///< Threads, 0 for std::thread::hardware_concurrency()
+    std::size_t chunkBytes = 4 << 20;  ///< Input scanned per task; chunks end at a newline
+};
+
+/**
+ * @brief How NdjsonIndex::update() brought an index up to date
+ */
+enum class NdjsonIndexStatus {
+    Built,     ///< Indexed the whole file (no usable index, or the file was rewritten)
+    Appended,  ///< Indexed only the bytes added since the last update
+    UpToDate   ///< Nothing changed; at most a new modification time was recorded
+};
+
+/**
+ * @brief Outcome of an index build or update
+ */
+struct NdjsonIndexStats {
+    NdjsonIndexStatus status = NdjsonIndexStatus::Built;
+    std::uint64_t records = 0;       ///< Records in the index
+    std::uint64_t keys = 0;          ///< Records with a primary key
+    std::uint64_t newRecords = 0;    ///< Records found by this run
+    std::uint64_t bytesScanned = 0;  ///< Source bytes read by this run
+    double seconds = 0.0;
+};
+
+/**
+ * @brief Random access to the records of a large NDJSON file
+ *
+ * A side file ("<source>.idx" by default) holds the byte offset of every
+ * record and, optionally, a table of primary-key hashes sorted for binary
+ * search. Its layout is a fixed header followed by flat uint64 arrays, so
+ * opening an index maps it and reads nothing else. Fetching a record takes
+ * one pread() of exactly that record's bytes, and only that record is
+ * parsed.
+ *
+ * build() cuts the source into newline-aligned chunks (as
+ * NdjsonProcessor::split does) and scans them on a thread pool. Record
+ * starts are found with memchr. Key values are extracted with a
+ * JsonQuery, which skips the rest of each record. update() checks that the
+ * indexed prefix is unchanged and then indexes only the appended bytes. If
+ * the size and modification time still match it trusts them, as JsonCache
+ * does; otherwise it hashes the whole prefix. If the prefix changed, it
+ * rebuilds. Opening an index only compares the size and hashes of the
+ * prefix's first and last 4 KiB. Index files use the host's byte order.
+ *
+ * An open index stays usable while the file is appended to. Records added
+ * since the last update() are not visible until the next one. A last line
+ * without a newline is indexed, and update() rescans it in case it was
+ * still being written.
+ *
+ * A key is the field's string value, or the raw JSON text for any other
+ * type ("42", "true"). When several records share a key, find() returns
+ * the last one, so in an append-only log the newest version wins.
+ */
+class NdjsonIndex {
+public:
+    /// Changes whenever the file layout changes; older files are rebuilt
+    static constexpr std::uint32_t kVersion = 2;
+
+    /**
+     * @brief Side file used when no index path is given
+     * @param source NDJSON file
+     * @return source + ".idx"
+     */
+    static std::string defaultPath(const std::string& source);
+
+    /**
+     * @brief Index a whole file, replacing any existing index
+     * @param source NDJSON file
+     * @param options Key field, worker count and chunk size
+     * @param indexPath Side file, empty for defaultPath(source)
+     * @return Counters of the build
+     * @throws std::runtime_error if the source cannot be read or the index cannot be written
+     */
+    static NdjsonIndexStats build(const std::string& source, const NdjsonIndexOptions& options,
+                                  const std::string& indexPath = "");
+
+    /**
+     * @brief Bring an index up to date, appending if the file only grew
+     * @param source NDJSON file
+     * @param options Key field, worker count and chunk size; a different
+     *        key field than the existing index's forces a rebuild
+     * @param indexPath Side file, empty for defaultPath(source)
+     * @return Counters of the update
+     * @throws std::runtime_error if the source cannot be read or the index cannot be written
+     */
+    static NdjsonIndexStats update(const std::string& source, const NdjsonIndexOptions& options,
+                                   const std::string& indexPath = "");
+
+    /**
+     * @brief Key field of an existing index, even if the source has changed since
+     * @param source NDJSON file
+     * @param indexPath Side file, empty for defaultPath(source)
+     * @return Primary-key field, empty if the index has none
+     * @throws std::runtime_error if the index cannot be opened or is corrupt
+     */
+    static std::string readKeyField(const std::string& source, const std::string& indexPath = "");
+
+    /**
+     * @brief Open an index for lookups
+     * @param source NDJSON file
+     * @param indexPath Side file, empty for defaultPath(source)
+     * @throws std::runtime_error if either file cannot be opened, the index
+     *         is corrupt, or the source no longer matches it (run update())
+     */
+    explicit NdjsonIndex(const std::string& source, const std::string& indexPath = "");
+    ~NdjsonIndex();
+
+    NdjsonIndex(const NdjsonIndex&) = delete;
+    NdjsonIndex& operator=(const NdjsonIndex&) = delete;
+
+    /// Number of indexed records
+    std::uint64_t size() const { return records_; }
+
+    /// Primary-key field, empty if the index has none
+    const std::string& keyField() const { return keyField_; }
+
+    /**
+     * @brief Byte offset of a record in the source
+     * @param index Record number, 0-based, blank lines not counted
+     * @return Offset of the record's first byte
+     * @throws std::out_of_range if index >= size()
+     */
+    std::uint64_t offset(std::uint64_t index) const;
+
+    /**
+     * @brief Raw text of one record, without its line ending
+     * @param index Record number
+     * @return Record text, read with a single pread()
+     * @throws std::out_of_range if index >= size()
+     * @throws std::runtime_error if the source cannot be read
+     */
+    std::string record(std::uint64_t index) const;
+
+    /**
+     * @brief Parse one record
+     * @param index Record number
+     * @return The record as nlohmann::json
+     * @throws std::out_of_range if index >= size()
+     * @throws std::runtime_error if the record cannot be read or is not valid JSON
+     */
+    nlohmann::json at(std::uint64_t index) const;
+
+    /**
+     * @brief Record number of a primary key
+     * @param key Key as a string value, or raw JSON text for other types
+     * @return Last record with that key, or std::nullopt
+     * @throws std::invalid_argument if the index has no key field
+     * @throws std::runtime_error if a candidate record cannot be read
+     */
+    std::optional<std::uint64_t> find(std::string_view key) const;
+
+private:
+    /// One row of the sorted key table
+    struct KeyEntry {
+        std::uint64_t hash;
+        std::uint64_t record;
+
+        bool operator<(const KeyEntry& other) const {
+            return hash != other.hash ? hash < other.hash : record < other.record;
+        }
+    };
+
+    /**
+     * @brief Index one region of the source on the thread pool
+     * @param region Bytes to scan, starting at a record boundary
+     * @param base Offset of region in the source
+     * @param firstRecord Record number of the region's first record
+     * @param options Key field, workers and chunk size
+     * @param offsets Receives the record offsets, in order
+     * @param keys Receives the key entries, unsorted
+     */
+    static void scan(std::string_view region, std::uint64_t base, std::uint64_t firstRecord,
+                     const NdjsonIndexOptions& options, std::vector<std::uint64_t>& offsets,
+                     std::vector<KeyEntry>& keys);
+
+    /**
+     * @brief Shared body of build() and update()
+     * @param source NDJSON file
+     * @param options Key field, workers and chunk size
+     * @param path Index file
+     * @param incremental Whether an existing index may be extended
+     * @return Counters of the run
+     */
+    static NdjsonIndexStats write(const std::string& source, const NdjsonIndexOptions& options,
+                                  const std::string& path, bool incremental);
+
+    std::unique_ptr<FileInput> file_;       ///< Mapped index file
+    std::unique_ptr<JsonQuery> keyQuery_;  ///< Extracts the key when verifying a hash match
+    int source_ = -1;                       ///< Source file, read with pread()
+    std::uint64_t sourceBytes_ = 0;         ///< Indexed length of the source
+    std::uint64_t records_ = 0;
+    std::uint64_t keyCount_ = 0;
+    std::string keyField_;
+    const std::uint64_t* offsets_ = nullptr;
+    const KeyEntry* keys_ = nullptr;
+};
+
+#endif // NDJSON_INDEX_H
@@ -0,0 +1,41 @@
+#ifndef PARSER_BACKEND_H
+#define PARSER_BACKEND_H
+
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+/**
+ * @brief Parser used to turn JSON text into a DOM
+ */
+enum class ParserBackend {
+    Nlohmann,  ///< nlohmann::json::parse, byte by byte
+    Simd       ///< StructuralIndex + JsonTape, converted with JsonTape::toJson()
+};
+
+/**
+ * @brief Parse a JSON text with the selected backend
+ * @param input Whole JSON text
+ * @param backend Parser to use
+ * @return Parsed document
+ * @throws std::runtime_error if the text is not valid JSON, or has a number out of
+ *         the double range (either backend), or nests deeper than JsonTape::kMaxDepth (simd)
+ */
+nlohmann::json parseJson(std::string_view input, ParserBackend backend);
+
+/**
+ * @brief Name of a backend as accepted by parserBackendFromName()
+ * @param backend Parser backend
+ * @return "nlohmann" or "simd"
+ */
+const char* parserBackendName(ParserBackend backend);
+
+/**
+ * @brief Look up a backend by name
+ * @param name "nlohmann" or "simd"
+ * @return Matching backend
+ * @throws std::invalid_argument for any other name
+ */
+ParserBackend parserBackendFromName(const std::string& name);
+
+#endif // PARSER_BACKEND_H
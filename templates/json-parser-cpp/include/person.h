@@ -0,0 +1,44 @@
+#ifndef PERSON_H
+#define PERSON_H
+
+#include <string>
+#include <tuple>
+#include <vector>
+#include "json_bind.h"
+
+/**
+ * @brief Postal address of a Person
+ */
+struct Address {
+    std::string street;
+    std::string zipcode;
+};
+
+/**
+ * @brief Person document as in data/sample.json
+ */
+struct Person {
+    std::string name;
+    int age = 0;
+    std::string city;
+    std::vector<std::string> skills;
+    Address address;
+    bool active = false;
+    double salary = 0.0;
+};
+
+template <>
+struct JsonSchema<Address> {
+    static constexpr auto fields = std::make_tuple(jsonField("street", &Address::street),
+                                                   jsonField("zipcode", &Address::zipcode));
+};
+
+template <>
+struct JsonSchema<Person> {
+    static constexpr auto fields = std::make_tuple(
+        jsonField("name", &Person::name), jsonField("age", &Person::age), jsonField("city", &Person::city),
+        jsonField("skills", &Person::skills), jsonField("address", &Person::address),
+        jsonField("active", &Person::active), jsonField("salary", &Person::salary));
+};
+
+#endif // PERSON_H
@@ -0,0 +1,75 @@
+#ifndef STRUCTURAL_INDEX_H
+#define STRUCTURAL_INDEX_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Stage 1 of the SIMD parser: positions of all structural characters
+ *
+ * The input is classified 64 bytes at a time into bitmaps of quotes,
+ * backslashes, operators ({ } [ ] : ,) and whitespace, using AVX2 or SSE2
+ * compares selected at runtime (with a portable scalar fallback). From the
+ * bitmaps, plain 64-bit arithmetic derives which quotes are escaped, which
+ * bytes lie inside strings (a prefix XOR over the unescaped quotes), and
+ * where each number or literal starts. The result is the byte offset of
+ * every operator outside strings, every opening quote and every scalar
+ * start, in input order: everything stage 2 (JsonTape) needs to walk the
+ * document without looking at the bytes in between.
+ */
+class StructuralIndex {
+public:
+    /**
+     * @brief Instruction set used to classify input blocks
+     */
+    enum class SimdLevel {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    /// Largest input whose offsets fit the 32-bit index
+    static constexpr std::uint64_t kMaxInputBytes = UINT32_MAX;
+
+    /**
+     * @brief Index a JSON text
+     * @param input Whole JSON text
+     * @return Offsets of the structural characters, ascending
+     * @throws std::runtime_error if a string is not closed or the input is
+     *         larger than kMaxInputBytes
+     */
+    static std::vector<std::uint32_t> build(std::string_view input);
+
+    /**
+     * @brief Instruction set currently used by build()
+     * @return Active SIMD level
+     */
+    static SimdLevel simdLevel();
+
+    /**
+     * @brief Best instruction set supported by the running CPU
+     * @return Highest available SIMD level
+     */
+    static SimdLevel detectedSimdLevel();
+
+    /**
+     * @brief Force build() to a given instruction set
+     *
+     * Requests above detectedSimdLevel() are clamped to it. Mainly useful for
+     * benchmarking and for comparing kernels against the scalar fallback.
+     *
+     * @param level Requested SIMD level
+     * @return SIMD level actually selected
+     */
+    static SimdLevel setSimdLevel(SimdLevel level);
+
+    /**
+     * @brief Human readable name of a SIMD level
+     * @param level SIMD level
+     * @return "scalar", "sse2" or "avx2"
+     */
+    static const char* simdLevelName(SimdLevel level);
+};
+
+#endif // STRUCTURAL_INDEX_H
@@ -0,0 +1,78 @@
+#include "arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local Arena* currentArena = nullptr;
+
+} // namespace
+
+Arena::Arena(std::size_t firstBlockBytes)
+    : firstBlockBytes_(std::max<std::size_t>(firstBlockBytes, 64)), nextBlockBytes_(firstBlockBytes_) {}
+
+Arena::~Arena() {
+    reset();
+}
+
+void* Arena::allocate(std::size_t bytes, std::size_t alignment) {
+    std::uintptr_t address = (reinterpret_cast<std::uintptr_t>(cursor_) + alignment - 1) & ~(alignment - 1);
+    if (cursor_ == nullptr || address + bytes > reinterpret_cast<std::uintptr_t>(end_)) {
+        addBlock(bytes + alignment);
+        address = (reinterpret_cast<std::uintptr_t>(cursor_) + alignment - 1) & ~(alignment - 1);
+    }
+    char* const result = reinterpret_cast<char*>(address);
+    used_ += static_cast<std::size_t>(result + bytes - cursor_);
+    cursor_ = result + bytes;
+    return result;
+}
+
+bool Arena::contains(const void* pointer) const {
+    const char* p = static_cast<const char*>(pointer);
+    // The newest block is the largest and the most likely owner.
+    for (auto block = blocks_.rbegin(); block != blocks_.rend(); ++block) {
+        if (p >= block->data && p < block->data + block->size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Arena::reset() {
+    for (const Block& block : blocks_) {
+        std::free(block.data);
+    }
+    blocks_.clear();
+    cursor_ = nullptr;
+    end_ = nullptr;
+    nextBlockBytes_ = firstBlockBytes_;
+    used_ = 0;
+    reserved_ = 0;
+}
+
+void Arena::addBlock(std::size_t minBytes) {
+    const std::size_t size = std::max(nextBlockBytes_, minBytes);
+    char* data = static_cast<char*>(std::malloc(size));
+    if (data == nullptr) {
+        throw std::bad_alloc();
+    }
+    blocks_.push_back({data, size});
+    cursor_ = data;
+    end_ = data + size;
+    reserved_ += size;
+    nextBlockBytes_ = size * 2;
+}
+
+Arena* Arena::current() {
+    return currentArena;
+}
+
+ArenaScope::ArenaScope(Arena& arena) : previous_(currentArena) {
+    currentArena = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    currentArena = previous_;
+}
@@ -0,0 +1,16 @@
+#include "arena_json.h"
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+ArenaDocument ArenaDocument::parse(std::string_view input) {
+    auto arena = std::make_unique<Arena>(std::max(Arena::kDefaultBlockBytes, input.size() * kBlockBytesPerInputByte));
+    ArenaScope scope(*arena);
+    try {
+        void* memory = arena->allocate(sizeof(ArenaJson), alignof(ArenaJson));
+        const ArenaJson* root = new (memory) ArenaJson(ArenaJson::parse(input.begin(), input.end()));
+        return ArenaDocument(std::move(arena), root);
+    } catch (const ArenaJson::exception& e) {
+        throw std::runtime_error(e.what());
+    }
+}
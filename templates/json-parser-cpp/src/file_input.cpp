@@ -0,0 +1,161 @@
+#include "file_input.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::size_t kReadChunkBytes = 1 << 20;
+
+// Descriptor I/O. The CRT on Windows has the same calls with an underscore
+// but no memory mapping, so there every input takes the read() path.
+#ifdef _WIN32
+constexpr int kStdin = 0;
+constexpr int kLastStandardFd = 2;
+
+int openInput(const std::string& path) {
+    return ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+}
+
+long long readSome(int fd, char* data, std::size_t bytes) {
+    return ::_read(fd, data, static_cast<unsigned>(std::min<std::size_t>(bytes, INT_MAX)));
+}
+
+void closeFile(int fd) {
+    ::_close(fd);
+}
+#else
+constexpr int kStdin = STDIN_FILENO;
+constexpr int kLastStandardFd = STDERR_FILENO;
+
+int openInput(const std::string& path) {
+    return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+long long readSome(int fd, char* data, std::size_t bytes) {
+    return ::read(fd, data, std::min<std::size_t>(bytes, INT_MAX));
+}
+
+void closeFile(int fd) {
+    ::close(fd);
+}
+#endif
+
+[[noreturn]] void throwSystemError(const std::string& what, const std::string& path) {
+    throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+#ifndef _WIN32
+std::size_t pageSize() {
+    static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+#endif
+
+} // namespace
+
+FileInput::Iterator::Iterator(const char* pos, const FileInput* owner) : pos_(pos), owner_(owner) {
+    if (owner_ != nullptr && owner_->mapped() && owner_->size_ > kReleaseBytes) {
+        nextRelease_ = owner_->data_ + kReleaseBytes;
+        while (nextRelease_ <= pos_) {
+            nextRelease_ += kReleaseBytes;
+        }
+    }
+}
+
+void FileInput::Iterator::releaseBehind() {
+    owner_->release(static_cast<std::size_t>(pos_ - owner_->data_));
+    const std::size_t remaining = static_cast<std::size_t>(owner_->data_ + owner_->size_ - nextRelease_);
+    nextRelease_ = remaining > kReleaseBytes ? nextRelease_ + kReleaseBytes : nullptr;
+}
+
+FileInput::FileInput(const std::string& path) : path_(path) {
+    const int fd = path == "-" ? kStdin : openInput(path);
+    if (fd < 0) {
+        throwSystemError("Could not open", path);
+    }
+
+#ifndef _WIN32
+    struct stat info {};
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        const auto size = static_cast<std::size_t>(info.st_size);
+        void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            // Hints only; failures are harmless.
+            ::madvise(mapping, size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+            ::madvise(mapping, size, MADV_HUGEPAGE);
+#endif
+            mapping_ = static_cast<char*>(mapping);
+            data_ = mapping_;
+            size_ = size;
+            if (fd > kLastStandardFd) {
+                closeFile(fd);
+            }
+            return;
+        }
+    }
+#endif
+
+    // Pipes, stdin, special files: the parser needs one contiguous buffer.
+    std::size_t used = 0;
+    while (true) {
+        if (buffer_.size() - used < kReadChunkBytes) {
+            buffer_.resize(std::max(buffer_.size() * 2, used + kReadChunkBytes));
+        }
+        const long long count = readSome(fd, buffer_.data() + used, buffer_.size() - used);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            const int error = errno;
+            if (fd > kLastStandardFd) {
+                closeFile(fd);
+            }
+            errno = error;
+            throwSystemError("Could not read", path);
+        }
+        if (count == 0) {
+            break;
+        }
+        used += static_cast<std::size_t>(count);
+    }
+    if (fd > kLastStandardFd) {
+        closeFile(fd);
+    }
+    buffer_.resize(used);
+    buffer_.shrink_to_fit();
+    data_ = buffer_.data();
+    size_ = used;
+}
+
+FileInput::~FileInput() {
+#ifndef _WIN32
+    if (mapping_ != nullptr) {
+        ::munmap(mapping_, size_);
+    }
+#endif
+}
+
+void FileInput::release([[maybe_unused]] std::size_t offset) const {
+#ifndef _WIN32
+    if (mapping_ == nullptr) {
+        return;
+    }
+    const std::size_t upTo = std::min(offset, size_) / pageSize() * pageSize();
+    if (upTo > released_) {
+        ::madvise(mapping_ + released_, upTo - released_, MADV_DONTNEED);
+        released_ = upTo;
+    }
+#endif
+}
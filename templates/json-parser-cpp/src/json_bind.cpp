@@ -0,0 +1,180 @@
+#include "json_bind.h"
+
+namespace json_bind_detail {
+
+const char* tokenName(const Token& token) {
+    switch (token.kind) {
+    case Token::Kind::Null:
+        return "null";
+    case Token::Kind::Boolean:
+        return "boolean";
+    case Token::Kind::Integer:
+    case Token::Kind::Unsigned:
+    case Token::Kind::Float:
+        return "number";
+    case Token::Kind::String:
+        break;
+    }
+    return "string";
+}
+
+} // namespace json_bind_detail
+
+using json_bind_detail::Target;
+using json_bind_detail::Token;
+
+bool BindHandler::null() {
+    return scalar({Token::Kind::Null});
+}
+
+bool BindHandler::boolean(bool value) {
+    Token token{Token::Kind::Boolean};
+    token.boolean = value;
+    return scalar(token);
+}
+
+bool BindHandler::number_integer(number_integer_t value) {
+    Token token{Token::Kind::Integer};
+    token.integer = value;
+    return scalar(token);
+}
+
+bool BindHandler::number_unsigned(number_unsigned_t value) {
+    Token token{Token::Kind::Unsigned};
+    token.unsignedInteger = value;
+    return scalar(token);
+}
+
+bool BindHandler::number_float(number_float_t value, const string_t& /*text*/) {
+    Token token{Token::Kind::Float};
+    token.floating = value;
+    return scalar(token);
+}
+
+bool BindHandler::string(string_t& value) {
+    Token token{Token::Kind::String};
+    token.text = &value;
+    return scalar(token);
+}
+
+bool BindHandler::binary(binary_t& /*value*/) {
+    ++result_.events;
+    return true;
+}
+
+bool BindHandler::start_object(std::size_t /*elements*/) {
+    return startContainer(false);
+}
+
+bool BindHandler::key(string_t& value) {
+    ++result_.events;
+    if (skipDepth_ == 0) {
+        pending_ = stack_.back()->field(value);
+    }
+    return true;
+}
+
+bool BindHandler::end_object() {
+    return endContainer();
+}
+
+bool BindHandler::start_array(std::size_t /*elements*/) {
+    return startContainer(true);
+}
+
+bool BindHandler::end_array() {
+    return endContainer();
+}
+
+bool BindHandler::parse_error(std::size_t /*position*/, const std::string& /*lastToken*/,
+                              const nlohmann::detail::exception& error) {
+    error_ = error.what();
+    return false;
+}
+
+void BindHandler::mismatch(const std::string& message) {
+    result_.issues.push_back({BindIssue::Kind::Mismatch, currentPath(), message});
+}
+
+void BindHandler::missing(std::string_view name) {
+    // Called from the object's own finish(), so it is still on the stack.
+    std::string path;
+    for (std::size_t i = 0; i + 1 < stack_.size(); ++i) {
+        stack_[i]->appendChildPath(path);
+    }
+    if (!path.empty()) {
+        path += '.';
+    }
+    path += name;
+    result_.issues.push_back({BindIssue::Kind::Missing, std::move(path), "missing"});
+}
+
+Target BindHandler::next() {
+    if (stack_.empty()) {
+        // The root is bound once; anything after it is a parse error anyway.
+        const Target root = root_;
+        root_ = {};
+        return root;
+    }
+    if (stack_.back()->isArray()) {
+        return stack_.back()->element();
+    }
+    const Target target = pending_;
+    pending_ = {};
+    return target;
+}
+
+bool BindHandler::scalar(Token token) {
+    ++result_.events;
+    if (skipDepth_ > 0) {
+        return true;
+    }
+    const Target target = next();
+    if (target.ops != nullptr && !target.ops->scalar(target.object, token, *this) && !stack_.empty() &&
+        stack_.back()->isArray()) {
+        stack_.back()->dropElement();
+    }
+    return true;
+}
+
+bool BindHandler::startContainer(bool isArray) {
+    ++result_.events;
+    if (skipDepth_ > 0) {
+        ++skipDepth_;
+        return true;
+    }
+    const Target target = next();
+    std::unique_ptr<json_bind_detail::Frame> frame;
+    if (target.ops != nullptr) {
+        frame = isArray ? target.ops->startArray(target.object, *this) : target.ops->startObject(target.object, *this);
+        if (!frame && !stack_.empty() && stack_.back()->isArray()) {
+            stack_.back()->dropElement();
+        }
+    }
+    if (!frame) {
+        // Unknown key or wrong type: skip the whole value.
+        skipDepth_ = 1;
+        return true;
+    }
+    stack_.push_back(std::move(frame));
+    return true;
+}
+
+bool BindHandler::endContainer() {
+    ++result_.events;
+    if (skipDepth_ > 0) {
+        --skipDepth_;
+        return true;
+    }
+    stack_.back()->finish(*this);
+    stack_.pop_back();
+    return true;
+}
+
+std::string BindHandler::currentPath() const {
+    std::string path;
+    for (const auto& frame : stack_) {
+        frame->appendChildPath(path);
+    }
+    return path.empty() ? "(root)" : path;
+}
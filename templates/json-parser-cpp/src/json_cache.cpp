@@ -0,0 +1,271 @@
+#include "json_cache.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "file_input.h"
+
+namespace {
+
+constexpr char kMagic[8] = {'J', 'S', 'O', 'N', 'B', 'I', 'N', '\0'};
+
+/**
+ * @brief Fixed header in front of the encoded document
+ */
+struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t format;
+    std::uint64_t sourceSize;
+    std::int64_t sourceMtimeNs;
+    std::uint64_t sourceHash;
+    std::uint64_t payloadSize;
+};
+
+struct SourceStat {
+    std::uint64_t size = 0;
+    std::int64_t mtimeNs = 0;
+};
+
+SourceStat statSource(const std::string& path) {
+    struct stat info {};
+    if (::stat(path.c_str(), &info) != 0) {
+        throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+    }
+    SourceStat result;
+    result.size = static_cast<std::uint64_t>(info.st_size);
+#if defined(__APPLE__)
+    result.mtimeNs = static_cast<std::int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    result.mtimeNs = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    return result;
+}
+
+bool writeAll(int fd, const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+/// Write header and payload to a temporary file and rename it into place
+bool writeCache(const std::string& path, const CacheHeader& header, const std::vector<std::uint8_t>& payload) {
+    const std::string temporary = path + ".tmp." + std::to_string(::getpid());
+    const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    const bool written = writeAll(fd, &header, sizeof(header)) && writeAll(fd, payload.data(), payload.size());
+    if (::close(fd) != 0 || !written || ::rename(temporary.c_str(), path.c_str()) != 0) {
+        ::unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+/// Store a new source modification time in an existing cache's header
+void updateMtime(const std::string& path, CacheHeader header, std::int64_t mtimeNs) {
+    header.sourceMtimeNs = mtimeNs;
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        // Best effort: a failure only means the next load hashes again.
+        [[maybe_unused]] const ssize_t written = ::pwrite(fd, &header, sizeof(header), 0);
+        ::close(fd);
+    }
+}
+
+/**
+ * @brief Shared load path for every format
+ *
+ * decode turns a fresh cache payload into a result, parse turns the source
+ * text into one, and encode produces the payload to store.
+ */
+template <typename Decode, typename Parse, typename Encode>
+auto loadThroughCache(const std::string& path, const std::string& cachePath, CacheFormat format, bool alwaysHash,
+                      CacheInfo* info, Decode decode, Parse parse, Encode encode) -> decltype(parse(std::string_view{})) {
+    const auto start = std::chrono::steady_clock::now();
+    CacheInfo details;
+    details.cachePath = cachePath;
+    const SourceStat source = statSource(path);
+    details.sourceBytes = source.size;
+
+    const auto finish = [&](auto result) {
+        details.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (info != nullptr) {
+            *info = details;
+        }
+        return result;
+    };
+
+    bool hadCache = false;
+    std::uint64_t sourceHash = 0;
+    bool hashed = false;
+    struct stat cacheStat {};
+    if (::stat(cachePath.c_str(), &cacheStat) == 0) {
+        hadCache = true;
+        try {
+            const FileInput cache(cachePath);
+            CacheHeader header{};
+            if (cache.size() >= sizeof(header)) {
+                std::memcpy(&header, cache.data(), sizeof(header));
+            }
+            const bool valid = cache.size() >= sizeof(header) && std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+                               header.version == JsonCache::kVersion &&
+                               header.format == static_cast<std::uint32_t>(format) &&
+                               header.payloadSize == cache.size() - sizeof(header) && header.sourceSize == source.size;
+            if (valid) {
+                CacheStatus status = CacheStatus::Hit;
+                bool fresh = header.sourceMtimeNs == source.mtimeNs && !alwaysHash;
+                if (!fresh) {
+                    const FileInput text(path);
+                    sourceHash = JsonCache::hashBytes(text.view());
+                    hashed = true;
+                    fresh = sourceHash == header.sourceHash;
+                    if (fresh && header.sourceMtimeNs != source.mtimeNs) {
+                        status = CacheStatus::Revalidated;
+                        updateMtime(cachePath, header, source.mtimeNs);
+                    }
+                }
+                if (fresh) {
+                    auto result = decode(cache.view().substr(sizeof(header)));
+                    details.status = status;
+                    details.cacheBytes = cache.size();
+                    return finish(std::move(result));
+                }
+            }
+        } catch (const std::exception&) {
+            // Unreadable or corrupt cache: fall through and rebuild it.
+        }
+    }
+
+    const FileInput text(path);
+    auto result = parse(text.view());
+    if (!hashed) {
+        sourceHash = JsonCache::hashBytes(text.view());
+    }
+
+    const std::vector<std::uint8_t> payload = encode(result);
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = JsonCache::kVersion;
+    header.format = static_cast<std::uint32_t>(format);
+    header.sourceSize = source.size;
+    header.sourceMtimeNs = source.mtimeNs;
+    header.sourceHash = sourceHash;
+    header.payloadSize = payload.size();
+    if (writeCache(cachePath, header, payload)) {
+        details.status = hadCache ? CacheStatus::Rebuilt : CacheStatus::Created;
+        details.cacheBytes = sizeof(header) + payload.size();
+    } else {
+        details.status = CacheStatus::Unwritable;
+    }
+    return finish(std::move(result));
+}
+
+} // namespace
+
+JsonCache::JsonCache(CacheFormat format, bool alwaysHash) : format_(format), alwaysHash_(alwaysHash) {}
+
+std::string JsonCache::cachePath(const std::string& path) const {
+    switch (format_) {
+    case CacheFormat::Cbor:
+        return path + ".cbor";
+    case CacheFormat::MessagePack:
+        return path + ".msgpack";
+    case CacheFormat::Tape:
+        break;
+    }
+    return path + ".tape";
+}
+
+nlohmann::json JsonCache::load(const std::string& path, CacheInfo* info) const {
+    if (format_ == CacheFormat::Tape) {
+        const auto start = std::chrono::steady_clock::now();
+        nlohmann::json document = loadTape(path, info).toJson();
+        if (info != nullptr) {
+            info->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        return document;
+    }
+    const bool cbor = format_ == CacheFormat::Cbor;
+    return loadThroughCache(
+        path, cachePath(path), format_, alwaysHash_, info,
+        [cbor](std::string_view payload) {
+            return cbor ? nlohmann::json::from_cbor(payload.begin(), payload.end())
+                        : nlohmann::json::from_msgpack(payload.begin(), payload.end());
+        },
+        [](std::string_view text) {
+            try {
+                return nlohmann::json::parse(text.begin(), text.end());
+            } catch (const nlohmann::json::exception& e) {
+                throw std::runtime_error(e.what());
+            }
+        },
+        [cbor](const nlohmann::json& document) {
+            return cbor ? nlohmann::json::to_cbor(document) : nlohmann::json::to_msgpack(document);
+        });
+}
+
+JsonTape JsonCache::loadTape(const std::string& path, CacheInfo* info) const {
+    if (format_ != CacheFormat::Tape) {
+        throw std::invalid_argument("loadTape() needs a cache in the tape format");
+    }
+    return loadThroughCache(
+        path, cachePath(path), format_, alwaysHash_, info,
+        [](std::string_view payload) { return JsonTape::deserialize(payload); },
+        [](std::string_view text) { return JsonTape::parse(text); },
+        [](const JsonTape& tape) {
+            std::vector<std::uint8_t> payload;
+            tape.serialize(payload);
+            return payload;
+        });
+}
+
+std::uint64_t JsonCache::hashBytes(std::string_view bytes) {
+    constexpr std::uint64_t kMultiplier = 0xff51afd7ed558ccdULL;
+    std::uint64_t hash = 0x9e3779b97f4a7c15ULL ^ bytes.size();
+    std::size_t pos = 0;
+    for (; pos + 8 <= bytes.size(); pos += 8) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, bytes.data() + pos, sizeof(word));
+        hash = (hash ^ word) * kMultiplier;
+        hash ^= hash >> 29;
+    }
+    std::uint64_t tail = 0;
+    if (pos < bytes.size()) {
+        std::memcpy(&tail, bytes.data() + pos, bytes.size() - pos);
+    }
+    hash = (hash ^ tail) * kMultiplier;
+    hash ^= hash >> 32;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    return hash ^ (hash >> 29);
+}
+
+const char* JsonCache::statusName(CacheStatus status) {
+    switch (status) {
+    case CacheStatus::Hit:
+        return "hit";
+    case CacheStatus::Revalidated:
+        return "revalidated";
+    case CacheStatus::Created:
+        return "created";
+    case CacheStatus::Rebuilt:
+        return "rebuilt";
+    case CacheStatus::Unwritable:
+        break;
+    }
+    return "unwritable";
+}
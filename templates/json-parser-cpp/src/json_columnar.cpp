@@ -0,0 +1,1269 @@
+#include "json_columnar.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+#include "file_input.h"
+
+namespace {
+
+constexpr char kMagic[8] = {'J', 'S', 'O', 'N', 'C', 'O', 'L', 'S'};
+constexpr std::size_t kNoChunk = static_cast<std::size_t>(-1);
+
+/**
+ * @brief Fixed header at the start of a columnar file
+ *
+ * The footer holds GroupEntry[rowGroups], ChunkEntry[chunks], then
+ * uint64 name offsets[columns + 1] and the name bytes.
+ */
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t columns;
+    std::uint64_t rows;
+    std::uint64_t rowGroups;
+    std::uint64_t chunks;
+    std::uint64_t footer;  ///< Offset of the footer
+};
+
+struct GroupEntry {
+    std::uint64_t rows;
+    std::uint64_t firstChunk;
+    std::uint64_t chunkCount;
+};
+
+/// Where one column of one row group lives; offsets are from the file start
+struct ChunkEntry {
+    std::uint32_t column;
+    std::uint32_t type;  ///< ColumnType, never Null
+    std::uint64_t nulls;
+    std::uint64_t validity;    ///< uint64 words, 0 if nulls == 0
+    std::uint64_t values;      ///< int64, double, uint32 or uint8 (Boolean) per row
+    std::uint64_t dictionary;  ///< uint64 offsets[dictionarySize + 1], then the bytes; String only
+    std::uint64_t dictionarySize;
+};
+
+std::uint64_t popcount(std::uint64_t x) {
+    return static_cast<std::uint64_t>(__builtin_popcountll(x));
+}
+
+/// Validity bits of rows [begin, begin + 64), clipped to the chunk
+std::uint64_t validWord(const ColumnChunk& chunk, std::uint64_t begin) {
+    if (chunk.type == ColumnType::Null) {
+        return 0;
+    }
+    const std::uint64_t n = std::min<std::uint64_t>(64, chunk.rows - begin);
+    std::uint64_t mask = n == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << n) - 1;
+    if (chunk.validity != nullptr) {
+        mask &= chunk.validity[begin / 64];
+    }
+    return mask;
+}
+
+// ---------------------------------------------------------------------------
+// Conversion
+// ---------------------------------------------------------------------------
+
+/// One value as read from a record, before the column's type is chosen
+struct Cell {
+    enum Kind : std::uint8_t { Null, Boolean, Integer, Unsigned, Double, String };
+
+    Kind kind = Null;
+    union {
+        std::int64_t integer = 0;
+        std::uint64_t unsignedInteger;  ///< Above INT64_MAX
+        double number;
+        std::uint32_t string;  ///< Index into ColumnBuilder::strings
+    };
+};
+
+/// Values of one column in one row group
+struct ColumnBuilder {
+    std::vector<Cell> cells;
+    std::deque<std::string> strings;  ///< Distinct strings in order of first use; a deque, so views stay valid
+    std::unordered_map<std::string_view, std::uint32_t> dictionary;
+    std::uint64_t kinds[6] = {};      ///< Cells per Cell::Kind
+
+    void set(std::uint64_t row, const Cell& cell) {
+        if (cells.size() > row) {
+            --kinds[cells[row].kind];
+            cells[row] = cell;  // "a.b" given both nested and dotted: the later one wins
+        } else {
+            cells.resize(row);
+            cells.push_back(cell);
+        }
+        ++kinds[cell.kind];
+    }
+
+    std::uint32_t intern(std::string_view text) {
+        const auto found = dictionary.find(text);
+        if (found != dictionary.end()) {
+            return found->second;
+        }
+        strings.emplace_back(text);
+        const auto code = static_cast<std::uint32_t>(strings.size() - 1);
+        dictionary.emplace(strings.back(), code);
+        return code;
+    }
+};
+
+/// One column of one row group, encoded and ready to write
+struct EncodedChunk {
+    std::string name;
+    ColumnType type = ColumnType::Null;
+    std::uint64_t nulls = 0;
+    std::vector<std::uint64_t> validity;
+    std::vector<char> values;
+    std::vector<std::uint64_t> dictionaryOffsets;
+    std::string dictionaryBytes;
+};
+
+/// Everything a worker produces for one input chunk
+struct EncodedGroup {
+    std::uint64_t rows = 0;
+    std::uint64_t lines = 0;
+    std::uint64_t failedRecords = 0;
+    std::vector<NdjsonError> errors;  ///< Line numbers relative to the chunk, 1-based
+    std::vector<EncodedChunk> chunks;
+};
+
+/**
+ * @brief SAX handler that shreds the records of one row group into columns
+ *
+ * Fields of a record are staged and only stored once the record has
+ * parsed, so a malformed line leaves no partial row behind. Records of one
+ * feed usually list their fields in the same order, so the column of the
+ * k-th field is first guessed from the previous record.
+ */
+class GroupBuilder {
+public:
+    /**
+     * @brief Parse one line and add it as a row
+     * @throws std::runtime_error if the line is not valid JSON or not an object
+     */
+    void add(std::string_view line) {
+        parse(line);
+        std::sort(keys_.begin(), keys_.end());
+        if (std::adjacent_find(keys_.begin(), keys_.end()) != keys_.end()) {
+            // A repeated key: let nlohmann::json keep the last value, as a DOM parse does
+            parse(nlohmann::json::parse(line).dump());
+        }
+        for (const Staged& field : staged_) {
+            Cell cell = field.cell;
+            ColumnBuilder& column = columns_[field.column];
+            if (cell.kind == Cell::String) {
+                cell.string = column.intern(std::string_view(text_).substr(field.text, field.length));
+            }
+            column.set(rows_, cell);
+        }
+        ++rows_;
+    }
+
+    void finish(EncodedGroup& group) {
+        group.rows = rows_;
+        for (std::size_t i = 0; i < names_.size(); ++i) {
+            EncodedChunk chunk;
+            chunk.name = names_[i];
+            if (encode(columns_[i], chunk)) {
+                group.chunks.push_back(std::move(chunk));
+            }
+        }
+    }
+
+    // nlohmann::json SAX interface
+    bool null() {
+        if (capturing()) {
+            captureValue("null");
+        } else {
+            stage(Cell{});
+        }
+        return true;
+    }
+
+    bool boolean(bool value) {
+        if (capturing()) {
+            captureValue(value ? "true" : "false");
+            return true;
+        }
+        Cell cell;
+        cell.kind = Cell::Boolean;
+        cell.integer = value ? 1 : 0;
+        stage(cell);
+        return true;
+    }
+
+    bool number_integer(std::int64_t value) {
+        if (capturing()) {
+            captureValue(std::to_string(value));
+            return true;
+        }
+        Cell cell;
+        cell.kind = Cell::Integer;
+        cell.integer = value;
+        stage(cell);
+        return true;
+    }
+
+    bool number_unsigned(std::uint64_t value) {
+        if (capturing()) {
+            captureValue(std::to_string(value));
+            return true;
+        }
+        Cell cell;
+        if (value <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+            cell.kind = Cell::Integer;
+            cell.integer = static_cast<std::int64_t>(value);
+        } else {
+            cell.kind = Cell::Unsigned;
+            cell.unsignedInteger = value;
+        }
+        stage(cell);
+        return true;
+    }
+
+    bool number_float(double value, const std::string&) {
+        if (capturing()) {
+            captureValue(nlohmann::json(value).dump());
+            return true;
+        }
+        Cell cell;
+        cell.kind = Cell::Double;
+        cell.number = value;
+        stage(cell);
+        return true;
+    }
+
+    bool string(std::string& value) {
+        if (capturing()) {
+            captureValue(nlohmann::json(value).dump());
+        } else {
+            stageText(value);
+        }
+        return true;
+    }
+
+    bool binary(nlohmann::json::binary_t&) {
+        throw std::runtime_error("Binary values are not supported");
+    }
+
+    bool start_object(std::size_t) {
+        if (capturing()) {
+            captureValue("{");
+            captures_.push_back({true, true});
+        } else {
+            // The record itself, or a nested object whose fields get dotted names
+            prefixes_.push_back({prefixes_.empty() ? 0 : name_.size(), fields_});
+            fields_ = 0;
+        }
+        return true;
+    }
+
+    bool key(std::string& key) {
+        if (capturing()) {
+            if (!captures_.back().first) {
+                capture_ += ',';
+            }
+            captures_.back().first = false;
+            capture_ += nlohmann::json(key).dump();
+            capture_ += ':';
+            captures_.back().afterKey = true;
+            return true;
+        }
+        name_.resize(prefixes_.back().name);
+        if (!name_.empty()) {
+            name_ += '.';
+        }
+        name_ += key;
+        keys_.push_back(std::hash<std::string>()(name_));
+        ++fields_;
+        return true;
+    }
+
+    bool end_object() {
+        if (capturing()) {
+            closeCapture('}');
+            return true;
+        }
+        const Prefix prefix = prefixes_.back();
+        prefixes_.pop_back();
+        const bool empty = fields_ == 0;
+        fields_ = prefix.fields;
+        if (!prefixes_.empty()) {
+            name_.resize(prefix.name);
+            if (empty) {
+                stageText("{}");
+            }
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        // Arrays are kept as their compact JSON text
+        if (capturing()) {
+            captureValue("[");
+        } else {
+            capture_ = "[";
+        }
+        captures_.push_back({true, false});
+        return true;
+    }
+
+    bool end_array() {
+        closeCapture(']');
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::json::exception& e) {
+        throw std::runtime_error(e.what());
+    }
+
+private:
+    /// A field read from the current record, not yet stored
+    struct Staged {
+        std::size_t column;
+        Cell cell;
+        std::size_t text;    ///< String value: offset in text_
+        std::size_t length;  ///< String value: bytes
+    };
+
+    /// An open object of the record
+    struct Prefix {
+        std::size_t name;    ///< Length of its dotted name
+        std::size_t fields;  ///< Fields already read in the enclosing object
+    };
+
+    /// An open container inside a captured array
+    struct Capture {
+        bool first;     ///< Nothing written into it yet
+        bool afterKey;  ///< An object whose next value follows a key
+    };
+
+    void parse(std::string_view line) {
+        staged_.clear();
+        text_.clear();
+        prefixes_.clear();
+        captures_.clear();
+        capture_.clear();
+        name_.clear();
+        keys_.clear();
+        fields_ = 0;
+        nlohmann::json::sax_parse(line.begin(), line.end(), this);
+    }
+
+    bool capturing() const { return !captures_.empty(); }
+
+    void captureValue(std::string_view text) {
+        Capture& open = captures_.back();
+        if (open.afterKey) {
+            open.afterKey = false;
+        } else {
+            if (!open.first) {
+                capture_ += ',';
+            }
+            open.first = false;
+        }
+        capture_ += text;
+    }
+
+    void closeCapture(char bracket) {
+        capture_ += bracket;
+        captures_.pop_back();
+        if (!capturing()) {
+            stageText(capture_);
+        }
+    }
+
+    void stage(const Cell& cell) {
+        if (prefixes_.empty()) {
+            throw std::runtime_error("Record is not an object");
+        }
+        staged_.push_back({columnNamed(), cell, 0, 0});
+    }
+
+    void stageText(std::string_view value) {
+        Cell cell;
+        cell.kind = Cell::String;
+        stage(cell);
+        staged_.back().text = text_.size();
+        staged_.back().length = value.size();
+        text_ += value;
+    }
+
+    /// Column of name_, guessed from the field's position in the previous record
+    std::size_t columnNamed() {
+        const std::size_t position = staged_.size();
+        if (position < order_.size() && names_[order_[position]] == name_) {
+            return order_[position];
+        }
+        std::size_t column = names_.size();
+        const auto [found, added] = index_.emplace(name_, column);
+        if (added) {
+            names_.push_back(name_);
+            columns_.emplace_back();
+        } else {
+            column = found->second;
+        }
+        order_.resize(std::max(order_.size(), position + 1));
+        order_[position] = column;
+        return column;
+    }
+
+    /// Choose the column's type and lay out its arrays; false if every row is null
+    bool encode(ColumnBuilder& column, EncodedChunk& chunk) const {
+        column.cells.resize(rows_);
+        const std::uint64_t* kinds = column.kinds;
+        const std::uint64_t numbers = kinds[Cell::Integer] + kinds[Cell::Unsigned] + kinds[Cell::Double];
+        if (kinds[Cell::String] > 0 || (kinds[Cell::Boolean] > 0 && numbers > 0)) {
+            chunk.type = ColumnType::String;
+        } else if (kinds[Cell::Double] > 0 || kinds[Cell::Unsigned] > 0) {
+            chunk.type = ColumnType::Double;
+        } else if (kinds[Cell::Integer] > 0) {
+            chunk.type = ColumnType::Int64;
+        } else if (kinds[Cell::Boolean] > 0) {
+            chunk.type = ColumnType::Boolean;
+        } else {
+            return false;
+        }
+
+        chunk.nulls = rows_ - kinds[Cell::Boolean] - kinds[Cell::Integer] - kinds[Cell::Unsigned] -
+                      kinds[Cell::Double] - kinds[Cell::String];
+        if (chunk.nulls > 0) {
+            chunk.validity.assign((rows_ + 63) / 64, 0);
+            for (std::uint64_t row = 0; row < rows_; ++row) {
+                if (column.cells[row].kind != Cell::Null) {
+                    chunk.validity[row / 64] |= std::uint64_t{1} << (row % 64);
+                }
+            }
+        }
+
+        switch (chunk.type) {
+        case ColumnType::Boolean: {
+            chunk.values.resize(rows_);
+            for (std::uint64_t row = 0; row < rows_; ++row) {
+                chunk.values[row] = column.cells[row].kind == Cell::Null ? 0 : static_cast<char>(column.cells[row].integer);
+            }
+            break;
+        }
+        case ColumnType::Int64: {
+            chunk.values.resize(rows_ * sizeof(std::int64_t));
+            auto* out = reinterpret_cast<std::int64_t*>(chunk.values.data());
+            for (std::uint64_t row = 0; row < rows_; ++row) {
+                out[row] = column.cells[row].kind == Cell::Null ? 0 : column.cells[row].integer;
+            }
+            break;
+        }
+        case ColumnType::Double: {
+            chunk.values.resize(rows_ * sizeof(double));
+            auto* out = reinterpret_cast<double*>(chunk.values.data());
+            for (std::uint64_t row = 0; row < rows_; ++row) {
+                const Cell& cell = column.cells[row];
+                switch (cell.kind) {
+                case Cell::Null:
+                    out[row] = 0.0;
+                    break;
+                case Cell::Unsigned:
+                    out[row] = static_cast<double>(cell.unsignedInteger);
+                    break;
+                case Cell::Double:
+                    out[row] = cell.number;
+                    break;
+                default:
+                    out[row] = static_cast<double>(cell.integer);
+                    break;
+                }
+            }
+            break;
+        }
+        default: {
+            chunk.values.resize(rows_ * sizeof(std::uint32_t));
+            auto* out = reinterpret_cast<std::uint32_t*>(chunk.values.data());
+            for (std::uint64_t row = 0; row < rows_; ++row) {
+                const Cell& cell = column.cells[row];
+                switch (cell.kind) {
+                case Cell::Null:
+                    out[row] = 0;
+                    break;
+                case Cell::String:
+                    out[row] = cell.string;
+                    break;
+                case Cell::Boolean:
+                    out[row] = column.intern(cell.integer != 0 ? "true" : "false");
+                    break;
+                case Cell::Integer:
+                    out[row] = column.intern(std::to_string(cell.integer));
+                    break;
+                case Cell::Unsigned:
+                    out[row] = column.intern(std::to_string(cell.unsignedInteger));
+                    break;
+                case Cell::Double:
+                    out[row] = column.intern(nlohmann::json(cell.number).dump());
+                    break;
+                }
+            }
+            chunk.dictionaryOffsets.reserve(column.strings.size() + 1);
+            chunk.dictionaryOffsets.push_back(0);
+            for (const std::string& text : column.strings) {
+                chunk.dictionaryBytes += text;
+                chunk.dictionaryOffsets.push_back(chunk.dictionaryBytes.size());
+            }
+            break;
+        }
+        }
+        return true;
+    }
+
+    std::uint64_t rows_ = 0;
+    std::unordered_map<std::string, std::size_t> index_;
+    std::vector<std::string> names_;
+    std::deque<ColumnBuilder> columns_;
+    std::vector<std::size_t> order_;  ///< Column of each field position in the last record
+
+    // State of the record being parsed
+    std::vector<Staged> staged_;
+    std::string text_;   ///< String values of staged_
+    std::string name_;   ///< Dotted name of the current field
+    std::vector<std::size_t> keys_;  ///< Hashes of every dotted name, to spot repeated keys
+    std::size_t fields_ = 0;
+    std::vector<Prefix> prefixes_;
+    std::vector<Capture> captures_;
+    std::string capture_;  ///< Text of the array being captured
+};
+
+bool isBlank(std::string_view line) {
+    return std::all_of(line.begin(), line.end(), [](char c) { return c == ' ' || c == '\t' || c == '\r'; });
+}
+
+void shred(std::string_view chunk, std::size_t maxErrors, EncodedGroup& group) {
+    GroupBuilder builder;
+    std::size_t pos = 0;
+    while (pos < chunk.size()) {
+        const void* newline = std::memchr(chunk.data() + pos, '\n', chunk.size() - pos);
+        const std::size_t end = newline != nullptr ? static_cast<std::size_t>(static_cast<const char*>(newline) - chunk.data())
+                                                   : chunk.size();
+        const std::string_view line = chunk.substr(pos, end - pos);
+        pos = end + 1;
+        ++group.lines;
+        if (isBlank(line)) {
+            continue;
+        }
+        try {
+            builder.add(line);
+        } catch (const std::exception& e) {
+            ++group.failedRecords;
+            if (group.errors.size() < maxErrors) {
+                group.errors.push_back({group.lines, e.what()});
+            }
+        }
+    }
+    builder.finish(group);
+}
+
+/**
+ * @brief Appends row groups to a temporary file, then writes the footer
+ */
+class ColumnarWriter {
+public:
+    ColumnarWriter(const std::string& path, std::size_t maxErrors)
+        : temporary_(path + ".tmp." + std::to_string(::getpid())), maxErrors_(maxErrors) {
+        fd_ = ::open(temporary_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            fail();
+        }
+        const FileHeader placeholder{};
+        write(&placeholder, sizeof(placeholder));
+    }
+
+    ~ColumnarWriter() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            ::unlink(temporary_.c_str());
+        }
+    }
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    void append(EncodedGroup& group) {
+        stats_.failedRecords += group.failedRecords;
+        for (NdjsonError& error : group.errors) {
+            if (stats_.errors.size() < maxErrors_) {
+                error.line += lines_;
+                stats_.errors.push_back(std::move(error));
+            }
+        }
+        lines_ += group.lines;
+        if (group.rows == 0) {
+            return;
+        }
+
+        groups_.push_back({group.rows, chunks_.size(), group.chunks.size()});
+        for (const EncodedChunk& chunk : group.chunks) {
+            ChunkEntry entry{};
+            auto [found, added] = columns_.emplace(chunk.name, static_cast<std::uint32_t>(names_.size()));
+            if (added) {
+                names_.push_back(chunk.name);
+            }
+            entry.column = found->second;
+            entry.type = static_cast<std::uint32_t>(chunk.type);
+            entry.nulls = chunk.nulls;
+            if (!chunk.validity.empty()) {
+                entry.validity = write(chunk.validity.data(), chunk.validity.size() * sizeof(std::uint64_t));
+            }
+            entry.values = write(chunk.values.data(), chunk.values.size());
+            if (chunk.type == ColumnType::String) {
+                entry.dictionary =
+                    write(chunk.dictionaryOffsets.data(), chunk.dictionaryOffsets.size() * sizeof(std::uint64_t));
+                write(chunk.dictionaryBytes.data(), chunk.dictionaryBytes.size());
+                entry.dictionarySize = chunk.dictionaryOffsets.size() - 1;
+            }
+            chunks_.push_back(entry);
+        }
+        stats_.rows += group.rows;
+    }
+
+    ColumnarStats finish(const std::string& path) {
+        FileHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = ColumnarFile::kVersion;
+        header.columns = static_cast<std::uint32_t>(names_.size());
+        header.rows = stats_.rows;
+        header.rowGroups = groups_.size();
+        header.chunks = chunks_.size();
+        header.footer = write(groups_.data(), groups_.size() * sizeof(GroupEntry));
+        write(chunks_.data(), chunks_.size() * sizeof(ChunkEntry));
+        std::vector<std::uint64_t> nameOffsets{0};
+        std::string nameBytes;
+        for (const std::string& name : names_) {
+            nameBytes += name;
+            nameOffsets.push_back(nameBytes.size());
+        }
+        write(nameOffsets.data(), nameOffsets.size() * sizeof(std::uint64_t));
+        write(nameBytes.data(), nameBytes.size());
+        if (::pwrite(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            fail();
+        }
+        const int fd = fd_;
+        fd_ = -1;
+        if (::close(fd) != 0 || ::rename(temporary_.c_str(), path.c_str()) != 0) {
+            const std::string reason = std::strerror(errno);
+            ::unlink(temporary_.c_str());
+            throw std::runtime_error("Could not write " + path + ": " + reason);
+        }
+        stats_.columns = names_.size();
+        stats_.rowGroups = groups_.size();
+        stats_.bytesOut = offset_;
+        return std::move(stats_);
+    }
+
+private:
+    /// Write bytes padded to 8; returns their offset
+    std::uint64_t write(const void* data, std::size_t size) {
+        static const char kZeros[8] = {};
+        const std::uint64_t at = offset_;
+        writeAll(data, size);
+        writeAll(kZeros, (8 - size % 8) % 8);
+        return at;
+    }
+
+    void writeAll(const void* data, std::size_t size) {
+        const char* p = static_cast<const char*>(data);
+        offset_ += size;
+        while (size > 0) {
+            const ssize_t written = ::write(fd_, p, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fail();
+            }
+            p += written;
+            size -= static_cast<std::size_t>(written);
+        }
+    }
+
+    [[noreturn]] void fail() const {
+        throw std::runtime_error("Could not write " + temporary_ + ": " + std::strerror(errno));
+    }
+
+    std::string temporary_;
+    std::size_t maxErrors_;
+    int fd_ = -1;
+    std::uint64_t offset_ = 0;
+    std::uint64_t lines_ = 0;
+    ColumnarStats stats_;
+    std::vector<GroupEntry> groups_;
+    std::vector<ChunkEntry> chunks_;
+    std::unordered_map<std::string, std::uint32_t> columns_;
+    std::vector<std::string> names_;
+};
+
+// ---------------------------------------------------------------------------
+// Scans
+// ---------------------------------------------------------------------------
+
+/// Count, sum, min and max of one chunk; integer sums are exact in 128 bits
+template <typename T>
+struct Totals {
+    using Sum = std::conditional_t<std::is_integral_v<T>, __int128, T>;
+
+    std::uint64_t count = 0;
+    Sum sum = 0;
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+};
+
+/**
+ * @brief Reduce the valid values of a chunk, one validity word at a time
+ *
+ * Full words run a branch-free loop over kLanes independent accumulators,
+ * which GCC and Clang vectorize. Partial words mask each value instead.
+ */
+template <typename T>
+Totals<T> reduce(const ColumnChunk& chunk, const T* values) {
+    constexpr std::size_t kLanes = 8;
+    using Sum = typename Totals<T>::Sum;
+    Sum sum[kLanes] = {};
+    T low[kLanes];
+    T high[kLanes];
+    std::fill(low, low + kLanes, std::numeric_limits<T>::max());
+    std::fill(high, high + kLanes, std::numeric_limits<T>::lowest());
+    Totals<T> totals;
+    for (std::uint64_t begin = 0; begin < chunk.rows; begin += 64) {
+        const std::uint64_t mask = validWord(chunk, begin);
+        totals.count += popcount(mask);
+        const T* v = values + begin;
+        if (mask == ~std::uint64_t{0}) {
+            for (std::size_t i = 0; i < 64; i += kLanes) {
+                for (std::size_t j = 0; j < kLanes; ++j) {
+                    sum[j] += static_cast<Sum>(v[i + j]);
+                    low[j] = v[i + j] < low[j] ? v[i + j] : low[j];
+                    high[j] = v[i + j] > high[j] ? v[i + j] : high[j];
+                }
+            }
+        } else if (mask != 0) {
+            const std::uint64_t n = std::min<std::uint64_t>(64, chunk.rows - begin);
+            for (std::size_t i = 0; i < n; ++i) {
+                const bool valid = (mask >> i & 1) != 0;
+                const std::size_t j = i % kLanes;
+                sum[j] += valid ? static_cast<Sum>(v[i]) : Sum(0);
+                low[j] = valid && v[i] < low[j] ? v[i] : low[j];
+                high[j] = valid && v[i] > high[j] ? v[i] : high[j];
+            }
+        }
+    }
+    for (std::size_t j = 0; j < kLanes; ++j) {
+        totals.sum += sum[j];
+        totals.min = std::min(totals.min, low[j]);
+        totals.max = std::max(totals.max, high[j]);
+    }
+    return totals;
+}
+
+void addTotals(ColumnAggregate& aggregate, std::uint64_t count, double sum, double min, double max) {
+    if (count == 0) {
+        return;
+    }
+    aggregate.min = aggregate.count == 0 ? min : std::min(aggregate.min, min);
+    aggregate.max = aggregate.count == 0 ? max : std::max(aggregate.max, max);
+    aggregate.count += count;
+    aggregate.sum += sum;
+}
+
+template <typename T>
+void addTotals(ColumnAggregate& aggregate, const Totals<T>& totals) {
+    addTotals(aggregate, totals.count, static_cast<double>(totals.sum), static_cast<double>(totals.min),
+              static_cast<double>(totals.max));
+}
+
+/// Aggregate of one group in one row group
+struct GroupSlot {
+    std::uint64_t count = 0;
+    std::uint64_t nulls = 0;
+    std::uint64_t skipped = 0;
+    double sum = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+};
+
+/// A String dictionary entry read as a number
+struct DictionaryNumber {
+    enum Kind : std::uint8_t { None, Integer, Real };
+
+    Kind kind = None;
+    std::int64_t integer = 0;
+    double real = 0.0;
+};
+
+/**
+ * @brief Parse every dictionary entry of a String chunk once
+ *
+ * Numbers in a String chunk are stored as their JSON text, so entries that
+ * are JSON numbers count as numbers; the rest are Kind::None.
+ */
+std::vector<DictionaryNumber> dictionaryNumbers(const ColumnChunk& chunk) {
+    std::vector<DictionaryNumber> numbers(chunk.dictionarySize);
+    for (std::uint32_t code = 0; code < chunk.dictionarySize; ++code) {
+        const std::string_view text = chunk.string(code);
+        // A JSON number starts with '-' or a digit and ends with a digit; this also rules out padding
+        if (text.empty() || !(text.front() == '-' || (text.front() >= '0' && text.front() <= '9')) ||
+            !(text.back() >= '0' && text.back() <= '9')) {
+            continue;
+        }
+        const nlohmann::json value = nlohmann::json::parse(text, nullptr, false);
+        DictionaryNumber& number = numbers[code];
+        if (value.is_number_unsigned() &&
+            value.get<std::uint64_t>() > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+            number.kind = DictionaryNumber::Real;
+            number.real = value.get<double>();
+        } else if (value.is_number_integer()) {
+            number.kind = DictionaryNumber::Integer;
+            number.integer = value.get<std::int64_t>();
+        } else if (value.is_number_float()) {
+            number.kind = DictionaryNumber::Real;
+            number.real = value.get<double>();
+        }
+    }
+    return numbers;
+}
+
+/// Throw unless every code of a String chunk is inside its dictionary
+void checkCodes(const ColumnChunk& chunk, std::size_t group) {
+    std::uint32_t highest = 0;
+    for (std::uint64_t row = 0; row < chunk.rows; ++row) {
+        highest = std::max(highest, chunk.codes[row]);
+    }
+    if (chunk.rows > 0 && highest >= chunk.dictionarySize) {
+        throw std::runtime_error("Dictionary code out of range in row group " + std::to_string(group));
+    }
+}
+
+/// Aggregate the numbers of a String chunk; every other value is skipped
+void addNumbers(ColumnAggregate& aggregate, const ColumnChunk& chunk, const std::vector<DictionaryNumber>& numbers) {
+    Totals<std::int64_t> integers;
+    Totals<double> reals;
+    for (std::uint64_t begin = 0; begin < chunk.rows; begin += 64) {
+        std::uint64_t mask = validWord(chunk, begin);
+        while (mask != 0) {
+            const std::uint64_t row = begin + static_cast<unsigned>(__builtin_ctzll(mask));
+            mask &= mask - 1;
+            const DictionaryNumber& number = numbers[chunk.codes[row]];
+            if (number.kind == DictionaryNumber::Integer) {
+                ++integers.count;
+                integers.sum += number.integer;
+                integers.min = std::min(integers.min, number.integer);
+                integers.max = std::max(integers.max, number.integer);
+            } else if (number.kind == DictionaryNumber::Real) {
+                ++reals.count;
+                reals.sum += number.real;
+                reals.min = std::min(reals.min, number.real);
+                reals.max = std::max(reals.max, number.real);
+            } else {
+                ++aggregate.skipped;
+            }
+        }
+    }
+    addTotals(aggregate, integers);
+    addTotals(aggregate, reals);
+}
+
+/**
+ * @brief Add each row with a group key to its slot
+ *
+ * slotOf maps a row to its slot; valueOf stores a valid row's number and
+ * returns false if the value is not numeric.
+ */
+template <typename SlotOf, typename ValueOf>
+void accumulateValues(const ColumnChunk& keys, const ColumnChunk& values, std::vector<GroupSlot>& slots,
+                      SlotOf slotOf, ValueOf valueOf) {
+    for (std::uint64_t begin = 0; begin < keys.rows; begin += 64) {
+        std::uint64_t keyMask = validWord(keys, begin);
+        const std::uint64_t valueMask = validWord(values, begin);
+        while (keyMask != 0) {
+            const unsigned i = static_cast<unsigned>(__builtin_ctzll(keyMask));
+            keyMask &= keyMask - 1;
+            const std::uint64_t row = begin + i;
+            const std::size_t index = slotOf(row);
+            GroupSlot& slot = slots[index];
+            double x = 0.0;
+            if ((valueMask >> i & 1) == 0) {
+                ++slot.nulls;
+            } else if (!valueOf(row, x)) {
+                ++slot.skipped;
+            } else {
+                ++slot.count;
+                slot.sum += x;
+                slot.min = x < slot.min ? x : slot.min;
+                slot.max = x > slot.max ? x : slot.max;
+            }
+        }
+    }
+}
+
+template <typename SlotOf>
+void accumulateGroups(const ColumnChunk& keys, const ColumnChunk& values, std::size_t group,
+                      std::vector<GroupSlot>& slots, SlotOf slotOf) {
+    switch (values.type) {
+    case ColumnType::Int64:
+        accumulateValues(keys, values, slots, slotOf, [&](std::uint64_t row, double& x) {
+            x = static_cast<double>(values.integers[row]);
+            return true;
+        });
+        break;
+    case ColumnType::Double:
+        accumulateValues(keys, values, slots, slotOf, [&](std::uint64_t row, double& x) {
+            x = values.doubles[row];
+            return true;
+        });
+        break;
+    case ColumnType::String: {
+        checkCodes(values, group);
+        const std::vector<DictionaryNumber> numbers = dictionaryNumbers(values);
+        accumulateValues(keys, values, slots, slotOf, [&](std::uint64_t row, double& x) {
+            const DictionaryNumber& number = numbers[values.codes[row]];
+            x = number.kind == DictionaryNumber::Integer ? static_cast<double>(number.integer) : number.real;
+            return number.kind != DictionaryNumber::None;
+        });
+        break;
+    }
+    default:
+        accumulateValues(keys, values, slots, slotOf, [](std::uint64_t, double&) { return false; });
+        break;
+    }
+}
+
+/// Slots for the distinct numbers of a numeric key chunk, keyed by JSON text
+template <typename T>
+std::vector<std::string> numericGroups(const ColumnChunk& keys, const ColumnChunk& values, const T* data,
+                                       std::size_t group, std::vector<GroupSlot>& slots) {
+    std::unordered_map<T, std::size_t> index;
+    std::vector<std::string> names;
+    accumulateGroups(keys, values, group, slots, [&](std::uint64_t row) {
+        const auto [found, added] = index.emplace(data[row], slots.size());
+        if (added) {
+            slots.emplace_back();
+            names.push_back(nlohmann::json(data[row]).dump());
+        }
+        return found->second;
+    });
+    return names;
+}
+
+} // namespace
+
+std::string_view ColumnChunk::string(std::uint32_t code) const {
+    if (code >= dictionarySize) {
+        throw std::out_of_range("Dictionary code " + std::to_string(code) + " is out of range");
+    }
+    return {dictionaryBytes_ + dictionaryOffsets_[code],
+            static_cast<std::size_t>(dictionaryOffsets_[code + 1] - dictionaryOffsets_[code])};
+}
+
+std::string ColumnarFile::defaultPath(const std::string& source) {
+    return source + ".cols";
+}
+
+ColumnarStats ColumnarFile::convert(const std::string& source, const std::string& path,
+                                    const ColumnarOptions& options) {
+    const auto start = std::chrono::steady_clock::now();
+    const FileInput input(source);
+    const std::vector<std::string_view> chunks =
+        NdjsonProcessor::split(input.view(), std::max<std::size_t>(1, options.chunkBytes));
+    std::size_t workers = options.workers;
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers = std::max<std::size_t>(1, std::min(workers, chunks.size()));
+    // Row groups are written in input order; workers stay a few chunks ahead
+    const std::size_t window = workers * NdjsonProcessor::kChunksAheadPerWorker;
+
+    ColumnarWriter writer(path, options.maxErrors);
+    std::vector<std::unique_ptr<EncodedGroup>> results(chunks.size());
+    std::atomic<std::size_t> nextChunk{0};
+    std::mutex mutex;
+    std::condition_variable written;
+    std::size_t nextWrite = 0;
+    std::exception_ptr failure;
+
+    const auto work = [&] {
+        while (true) {
+            const std::size_t index = nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (index >= chunks.size()) {
+                return;
+            }
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                written.wait(lock, [&] { return failure || index < nextWrite + window; });
+                if (failure) {
+                    return;
+                }
+            }
+
+            auto group = std::make_unique<EncodedGroup>();
+            std::exception_ptr error;
+            try {
+                shred(chunks[index], options.maxErrors, *group);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            results[index] = std::move(group);
+            if (error && !failure) {
+                failure = error;
+            }
+            bool progress = false;
+            while (!failure && nextWrite < chunks.size() && results[nextWrite]) {
+                try {
+                    writer.append(*results[nextWrite]);
+                } catch (...) {
+                    failure = std::current_exception();
+                }
+                results[nextWrite].reset();
+                ++nextWrite;
+                progress = true;
+            }
+            if (progress || failure) {
+                written.notify_all();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    ColumnarStats stats = writer.finish(path);
+    stats.bytesIn = input.size();
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+ColumnarFile::ColumnarFile(const std::string& path) : file_(std::make_unique<FileInput>(path)) {
+    const std::string_view bytes = file_->view();
+    const auto corrupt = [&] { return std::runtime_error("Columnar file " + path + " is corrupt"); };
+    if (bytes.size() < sizeof(FileHeader)) {
+        throw corrupt();
+    }
+    FileHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+        throw std::runtime_error(path + " is not a columnar file of this version");
+    }
+
+    // Arrays live between the header and the footer, 8-byte aligned
+    const std::uint64_t footer = header.footer;
+    if (footer < sizeof(FileHeader) || footer > bytes.size() || footer % 8 != 0) {
+        throw corrupt();
+    }
+    const auto array = [&](std::uint64_t offset, std::uint64_t count, std::size_t size, std::uint64_t end) {
+        if (offset % 8 != 0 || offset < sizeof(FileHeader) || offset > end || count > (end - offset) / size) {
+            throw corrupt();
+        }
+        return bytes.data() + offset;
+    };
+
+    const std::uint64_t size = bytes.size();
+    const auto* groups = reinterpret_cast<const GroupEntry*>(array(footer, header.rowGroups, sizeof(GroupEntry), size));
+    const std::uint64_t chunkTable = footer + header.rowGroups * sizeof(GroupEntry);
+    const auto* entries = reinterpret_cast<const ChunkEntry*>(array(chunkTable, header.chunks, sizeof(ChunkEntry), size));
+    const std::uint64_t nameTable = chunkTable + header.chunks * sizeof(ChunkEntry);
+    const auto* nameOffsets =
+        reinterpret_cast<const std::uint64_t*>(array(nameTable, std::uint64_t{header.columns} + 1, 8, size));
+    const std::uint64_t nameBytes = nameTable + (std::uint64_t{header.columns} + 1) * 8;
+    const char* names = array(nameBytes, nameOffsets[header.columns], 1, size);
+    // Check the whole table first: the last offset bounds the names only if none is larger
+    if (nameOffsets[0] != 0 || !std::is_sorted(nameOffsets, nameOffsets + header.columns + 1)) {
+        throw corrupt();
+    }
+    for (std::uint32_t i = 0; i < header.columns; ++i) {
+        columns_.emplace_back(names + nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]);
+    }
+
+    std::uint64_t rows = 0;
+    for (std::uint64_t g = 0; g < header.rowGroups; ++g) {
+        const GroupEntry& entry = groups[g];
+        if (entry.firstChunk > header.chunks || entry.chunkCount > header.chunks - entry.firstChunk ||
+            entry.rows > size * 8) {
+            throw corrupt();
+        }
+        Group group{entry.rows, std::vector<std::size_t>(header.columns, kNoChunk)};
+        for (std::uint64_t c = entry.firstChunk; c < entry.firstChunk + entry.chunkCount; ++c) {
+            const ChunkEntry& e = entries[c];
+            if (e.column >= header.columns || group.chunks[e.column] != kNoChunk || e.nulls > entry.rows) {
+                throw corrupt();
+            }
+            ColumnChunk chunk;
+            chunk.type = static_cast<ColumnType>(e.type);
+            chunk.rows = entry.rows;
+            chunk.nulls = e.nulls;
+            if (e.nulls > 0) {
+                chunk.validity = reinterpret_cast<const std::uint64_t*>(array(e.validity, (entry.rows + 63) / 64, 8, footer));
+            }
+            switch (chunk.type) {
+            case ColumnType::Boolean:
+                chunk.booleans = reinterpret_cast<const std::uint8_t*>(array(e.values, entry.rows, 1, footer));
+                break;
+            case ColumnType::Int64:
+                chunk.integers = reinterpret_cast<const std::int64_t*>(array(e.values, entry.rows, 8, footer));
+                break;
+            case ColumnType::Double:
+                chunk.doubles = reinterpret_cast<const double*>(array(e.values, entry.rows, 8, footer));
+                break;
+            case ColumnType::String: {
+                chunk.codes = reinterpret_cast<const std::uint32_t*>(array(e.values, entry.rows, 4, footer));
+                if (e.dictionarySize >= footer / 8) {
+                    throw corrupt();
+                }
+                const auto* offsets =
+                    reinterpret_cast<const std::uint64_t*>(array(e.dictionary, e.dictionarySize + 1, 8, footer));
+                if (offsets[0] != 0) {
+                    throw corrupt();
+                }
+                for (std::uint64_t i = 0; i < e.dictionarySize; ++i) {
+                    if (offsets[i] > offsets[i + 1]) {
+                        throw corrupt();
+                    }
+                }
+                chunk.dictionarySize = e.dictionarySize;
+                chunk.dictionaryOffsets_ = offsets;
+                chunk.dictionaryBytes_ =
+                    array(e.dictionary + (e.dictionarySize + 1) * 8, offsets[e.dictionarySize], 1, footer);
+                break;
+            }
+            default:
+                throw corrupt();
+            }
+            group.chunks[e.column] = chunks_.size();
+            chunks_.push_back(chunk);
+        }
+        rows += entry.rows;
+        groups_.push_back(std::move(group));
+    }
+    if (rows != header.rows) {
+        throw corrupt();
+    }
+    rows_ = rows;
+}
+
+ColumnarFile::~ColumnarFile() = default;
+
+std::size_t ColumnarFile::column(std::string_view name) const {
+    const auto found = std::find(columns_.begin(), columns_.end(), name);
+    if (found == columns_.end()) {
+        throw std::invalid_argument("No column '" + std::string(name) + "'");
+    }
+    return static_cast<std::size_t>(found - columns_.begin());
+}
+
+ColumnChunk ColumnarFile::chunk(std::size_t group, std::size_t column) const {
+    if (group >= groups_.size() || column >= columns_.size()) {
+        throw std::out_of_range("Chunk " + std::to_string(group) + "/" + std::to_string(column) + " is out of range");
+    }
+    const std::size_t index = groups_[group].chunks[column];
+    if (index == kNoChunk) {
+        ColumnChunk absent;
+        absent.rows = groups_[group].rows;
+        absent.nulls = absent.rows;
+        return absent;
+    }
+    return chunks_[index];
+}
+
+ColumnAggregate ColumnarFile::aggregate(std::string_view name) const {
+    const std::size_t c = column(name);
+    ColumnAggregate result;
+    for (std::size_t g = 0; g < groups_.size(); ++g) {
+        const ColumnChunk data = chunk(g, c);
+        result.nulls += data.nulls;
+        switch (data.type) {
+        case ColumnType::Int64:
+            addTotals(result, reduce(data, data.integers));
+            break;
+        case ColumnType::Double:
+            addTotals(result, reduce(data, data.doubles));
+            break;
+        case ColumnType::String:
+            checkCodes(data, g);
+            addNumbers(result, data, dictionaryNumbers(data));
+            break;
+        case ColumnType::Boolean:
+            result.skipped += data.rows - data.nulls;
+            break;
+        case ColumnType::Null:
+            break;
+        }
+    }
+    return result;
+}
+
+std::map<std::string, ColumnAggregate> ColumnarFile::aggregateBy(std::string_view groupColumn,
+                                                                 std::string_view valueColumn) const {
+    const std::size_t k = column(groupColumn);
+    const std::size_t v = column(valueColumn);
+    std::map<std::string, ColumnAggregate> result;
+    std::vector<GroupSlot> slots;
+    for (std::size_t g = 0; g < groups_.size(); ++g) {
+        const ColumnChunk keys = chunk(g, k);
+        const ColumnChunk values = chunk(g, v);
+        slots.clear();
+        std::vector<std::string> names;
+        switch (keys.type) {
+        case ColumnType::String: {
+            // Dictionary codes index the slots directly
+            checkCodes(keys, g);
+            slots.resize(keys.dictionarySize);
+            accumulateGroups(keys, values, g, slots, [&](std::uint64_t row) { return keys.codes[row]; });
+            for (std::uint32_t code = 0; code < keys.dictionarySize; ++code) {
+                names.emplace_back(keys.string(code));
+            }
+            break;
+        }
+        case ColumnType::Boolean:
+            slots.resize(2);
+            accumulateGroups(keys, values, g, slots, [&](std::uint64_t row) { return keys.booleans[row] != 0 ? 1 : 0; });
+            names = {"false", "true"};
+            break;
+        case ColumnType::Int64:
+            names = numericGroups(keys, values, keys.integers, g, slots);
+            break;
+        case ColumnType::Double:
+            names = numericGroups(keys, values, keys.doubles, g, slots);
+            break;
+        case ColumnType::Null:
+            break;
+        }
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            const GroupSlot& slot = slots[i];
+            if (slot.count + slot.nulls + slot.skipped == 0) {
+                continue;
+            }
+            ColumnAggregate& aggregate = result[names[i]];
+            aggregate.nulls += slot.nulls;
+            aggregate.skipped += slot.skipped;
+            addTotals(aggregate, slot.count, slot.sum, slot.min, slot.max);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,367 @@
+#include "json_query.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+int countTrailingZeros(std::uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/// Array index named by a step, or -1 ("0", "12"; no sign or leading zero)
+std::int64_t parseIndex(const std::string& text) {
+    if (text.empty() || text.size() > 18 || (text.size() > 1 && text[0] == '0')) {
+        return -1;
+    }
+    std::int64_t index = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        index = index * 10 + (c - '0');
+    }
+    return index;
+}
+
+} // namespace
+
+/**
+ * @brief One pass over a document for a compiled JsonQuery
+ */
+class QueryScanner {
+public:
+    QueryScanner(const JsonQuery& query, std::string_view input, const JsonQuery::MatchFn& onMatch)
+        : query_(query), input_(input), onMatch_(onMatch) {}
+
+    void run() {
+        std::uint64_t all = query_.size() == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << query_.size()) - 1;
+        value(all, 0);
+        skipWhitespace();
+        if (pos_ != input_.size()) {
+            fail("unexpected content after document");
+        }
+    }
+
+private:
+    [[noreturn]] void fail(const char* message) const {
+        throw std::runtime_error("JSON query error at byte " + std::to_string(pos_) + ": " + message);
+    }
+
+    void skipWhitespace() {
+        while (pos_ < input_.size() && isWhitespace(input_[pos_])) {
+            ++pos_;
+        }
+    }
+
+    char peek() {
+        skipWhitespace();
+        if (pos_ >= input_.size()) {
+            fail("unexpected end of input");
+        }
+        return input_[pos_];
+    }
+
+    void expect(char c) {
+        if (peek() != c) {
+            fail(c == ':' ? "expected ':'" : "unexpected character");
+        }
+        ++pos_;
+    }
+
+    /// Raw contents of the string at pos_; leaves pos_ after the closing quote
+    std::string_view string() {
+        const std::size_t begin = ++pos_;
+        while (true) {
+            const void* quote = std::memchr(input_.data() + pos_, '"', input_.size() - pos_);
+            if (quote == nullptr) {
+                pos_ = input_.size();
+                fail("unterminated string");
+            }
+            pos_ = static_cast<std::size_t>(static_cast<const char*>(quote) - input_.data());
+            std::size_t backslashes = 0;
+            while (pos_ - backslashes > begin && input_[pos_ - backslashes - 1] == '\\') {
+                ++backslashes;
+            }
+            ++pos_;
+            if (backslashes % 2 == 0) {
+                return input_.substr(begin, pos_ - 1 - begin);
+            }
+        }
+    }
+
+    /// Skip a value without looking inside strings beyond their end
+    void skip() {
+        const char c = peek();
+        if (c == '"') {
+            string();
+            return;
+        }
+        if (c != '{' && c != '[') {
+            scalar();
+            return;
+        }
+        std::size_t depth = 0;
+        while (pos_ < input_.size()) {
+            switch (input_[pos_]) {
+            case '"':
+                string();
+                continue;
+            case '{':
+            case '[':
+                ++depth;
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0) {
+                    ++pos_;
+                    return;
+                }
+                break;
+            default:
+                break;
+            }
+            ++pos_;
+        }
+        fail("unterminated container");
+    }
+
+    void scalar() {
+        const std::size_t begin = pos_;
+        while (pos_ < input_.size()) {
+            const char c = input_[pos_];
+            if (c == ',' || c == '}' || c == ']' || c == ':' || c == '"' || c == '{' || c == '[' || isWhitespace(c)) {
+                break;
+            }
+            ++pos_;
+        }
+        if (pos_ == begin) {
+            fail("expected value");
+        }
+    }
+
+    static bool keyMatches(const JsonQuery::Step& step, std::string_view key) {
+        if (key.find('\\') == std::string_view::npos) {
+            return key == step.key;
+        }
+        // Escaped keys are rare; decode them the slow way.
+        const nlohmann::json decoded = nlohmann::json::parse("\"" + std::string(key) + "\"", nullptr, false);
+        return decoded.is_string() && decoded.get_ref<const std::string&>() == step.key;
+    }
+
+    void value(std::uint64_t active, std::size_t depth) {
+        const char c = peek();
+        const std::size_t begin = pos_;
+        const std::uint64_t complete = depth < query_.endsAt_.size() ? active & query_.endsAt_[depth] : 0;
+        const std::uint64_t descend = active & ~complete;
+        if (descend != 0 && c == '{') {
+            object(descend, depth);
+        } else if (descend != 0 && c == '[') {
+            array(descend, depth);
+        } else {
+            skip();
+        }
+        for (std::uint64_t bits = complete; bits != 0; bits &= bits - 1) {
+            onMatch_({static_cast<std::size_t>(countTrailingZeros(bits)), input_.substr(begin, pos_ - begin)});
+        }
+    }
+
+    void object(std::uint64_t active, std::size_t depth) {
+        ++pos_;
+        if (peek() == '}') {
+            ++pos_;
+            return;
+        }
+        while (true) {
+            if (peek() != '"') {
+                fail("expected string key");
+            }
+            const std::string_view key = string();
+            expect(':');
+            std::uint64_t child = 0;
+            for (std::uint64_t bits = active; bits != 0; bits &= bits - 1) {
+                const int i = countTrailingZeros(bits);
+                const JsonQuery::Step& step = query_.steps_[static_cast<std::size_t>(i)][depth];
+                if (step.wildcard || keyMatches(step, key)) {
+                    child |= std::uint64_t{1} << i;
+                }
+            }
+            if (child != 0) {
+                value(child, depth + 1);
+            } else {
+                skip();
+            }
+            const char next = peek();
+            ++pos_;
+            if (next == '}') {
+                return;
+            }
+            if (next != ',') {
+                fail("expected ',' or '}'");
+            }
+        }
+    }
+
+    void array(std::uint64_t active, std::size_t depth) {
+        ++pos_;
+        if (peek() == ']') {
+            ++pos_;
+            return;
+        }
+        for (std::int64_t index = 0;; ++index) {
+            std::uint64_t child = 0;
+            for (std::uint64_t bits = active; bits != 0; bits &= bits - 1) {
+                const int i = countTrailingZeros(bits);
+                const JsonQuery::Step& step = query_.steps_[static_cast<std::size_t>(i)][depth];
+                if (step.wildcard || step.index == index) {
+                    child |= std::uint64_t{1} << i;
+                }
+            }
+            if (child != 0) {
+                value(child, depth + 1);
+            } else {
+                skip();
+            }
+            const char next = peek();
+            ++pos_;
+            if (next == ']') {
+                return;
+            }
+            if (next != ',') {
+                fail("expected ',' or ']'");
+            }
+        }
+    }
+
+    const JsonQuery& query_;
+    std::string_view input_;
+    const JsonQuery::MatchFn& onMatch_;
+    std::size_t pos_ = 0;
+};
+
+std::string_view JsonQuery::Match::text() const {
+    if (value.size() >= 2 && value.front() == '"') {
+        return value.substr(1, value.size() - 2);
+    }
+    return value;
+}
+
+nlohmann::json JsonQuery::Match::parse() const {
+    return nlohmann::json::parse(value.begin(), value.end());
+}
+
+JsonQuery::JsonQuery(const std::vector<std::string>& expressions) : expressions_(expressions) {
+    if (expressions_.size() > kMaxExpressions) {
+        throw std::invalid_argument("At most 64 expressions per query");
+    }
+    for (std::size_t i = 0; i < expressions_.size(); ++i) {
+        steps_.push_back(compile(expressions_[i]));
+        const std::size_t length = steps_.back().size();
+        if (endsAt_.size() <= length) {
+            endsAt_.resize(length + 1, 0);
+        }
+        endsAt_[length] |= std::uint64_t{1} << i;
+    }
+}
+
+std::vector<JsonQuery::Step> JsonQuery::compile(const std::string& expression) {
+    std::vector<Step> steps;
+    const auto addStep = [&](std::string key, bool wildcard) {
+        Step step;
+        step.wildcard = wildcard;
+        step.index = wildcard ? -1 : parseIndex(key);
+        step.key = std::move(key);
+        steps.push_back(std::move(step));
+    };
+
+    if (expression.empty() || expression[0] == '/') {
+        // JSON Pointer: "/a/b", with ~1 for '/' and ~0 for '~'
+        std::size_t pos = 0;
+        while (pos < expression.size()) {
+            const std::size_t end = std::min(expression.find('/', pos + 1), expression.size());
+            std::string segment;
+            for (std::size_t i = pos + 1; i < end; ++i) {
+                if (expression[i] == '~') {
+                    if (i + 1 >= end || (expression[i + 1] != '0' && expression[i + 1] != '1')) {
+                        throw std::invalid_argument("Invalid escape in JSON Pointer: " + expression);
+                    }
+                    segment += expression[++i] == '0' ? '~' : '/';
+                } else {
+                    segment += expression[i];
+                }
+            }
+            const bool wildcard = segment == "*";
+            addStep(std::move(segment), wildcard);
+            pos = end;
+        }
+        return steps;
+    }
+
+    if (expression[0] != '$') {
+        throw std::invalid_argument("Expression must start with '/' or '$': " + expression);
+    }
+    // JSONPath: $.name, $.*, $[n], $[*], $['name'], $["name"]
+    std::size_t pos = 1;
+    while (pos < expression.size()) {
+        if (expression[pos] == '.') {
+            if (pos + 1 < expression.size() && expression[pos + 1] == '.') {
+                throw std::invalid_argument("Recursive descent (..) is not supported: " + expression);
+            }
+            const std::size_t begin = pos + 1;
+            std::size_t end = begin;
+            while (end < expression.size() && expression[end] != '.' && expression[end] != '[') {
+                ++end;
+            }
+            if (end == begin) {
+                throw std::invalid_argument("Empty name in JSONPath: " + expression);
+            }
+            std::string name = expression.substr(begin, end - begin);
+            const bool wildcard = name == "*";
+            addStep(std::move(name), wildcard);
+            pos = end;
+        } else if (expression[pos] == '[') {
+            const std::size_t close = expression.find(']', pos);
+            if (close == std::string::npos) {
+                throw std::invalid_argument("Unclosed '[' in JSONPath: " + expression);
+            }
+            std::string inner = expression.substr(pos + 1, close - pos - 1);
+            if (inner == "*") {
+                addStep(std::move(inner), true);
+            } else if (inner.size() >= 2 && (inner.front() == '\'' || inner.front() == '"') &&
+                       inner.back() == inner.front()) {
+                addStep(inner.substr(1, inner.size() - 2), false);
+            } else if (parseIndex(inner) >= 0) {
+                addStep(std::move(inner), false);
+            } else {
+                throw std::invalid_argument("Unsupported JSONPath selector [" + inner + "]: " + expression);
+            }
+            pos = close + 1;
+        } else {
+            throw std::invalid_argument("Unexpected character in JSONPath: " + expression);
+        }
+    }
+    return steps;
+}
+
+void JsonQuery::run(std::string_view document, const MatchFn& onMatch) const {
+    QueryScanner(*this, document, onMatch).run();
+}
+
+std::vector<JsonQuery::Match> JsonQuery::run(std::string_view document) const {
+    std::vector<Match> matches;
+    run(document, [&](const Match& match) { matches.push_back(match); });
+    return matches;
+}
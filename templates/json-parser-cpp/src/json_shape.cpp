@@ -0,0 +1,375 @@
+#include "json_shape.h"
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+
+SymbolTable& SymbolTable::global() {
+    static SymbolTable table;
+    return table;
+}
+
+Symbol SymbolTable::intern(std::string_view key) {
+    // Views in the cache point at names_, which never move
+    thread_local std::unordered_map<std::string_view, Symbol> cache;
+    const auto cached = cache.find(key);
+    if (cached != cache.end()) {
+        return cached->second;
+    }
+
+    Symbol symbol = 0;
+    std::string_view name;
+    {
+        std::shared_lock<std::shared_mutex> read(mutex_);
+        const auto found = symbols_.find(key);
+        if (found != symbols_.end()) {
+            name = found->first;
+            symbol = found->second;
+        }
+    }
+    if (name.data() == nullptr) {
+        std::unique_lock<std::shared_mutex> write(mutex_);
+        const auto found = symbols_.find(key);
+        if (found != symbols_.end()) {
+            name = found->first;
+            symbol = found->second;
+        } else {
+            names_.emplace_back(key);
+            name = names_.back();
+            symbol = static_cast<Symbol>(names_.size() - 1);
+            symbols_.emplace(name, symbol);
+        }
+    }
+    cache.emplace(name, symbol);
+    return symbol;
+}
+
+std::string_view SymbolTable::name(Symbol symbol) const {
+    std::shared_lock<std::shared_mutex> read(mutex_);
+    return names_.at(symbol);
+}
+
+std::size_t SymbolTable::size() const {
+    std::shared_lock<std::shared_mutex> read(mutex_);
+    return names_.size();
+}
+
+std::ptrdiff_t Shape::indexOf(Symbol symbol) const {
+    const auto found = index_.find(symbol);
+    return found == index_.end() ? -1 : static_cast<std::ptrdiff_t>(found->second);
+}
+
+ShapeTable& ShapeTable::global() {
+    static ShapeTable table;
+    return table;
+}
+
+const Shape& ShapeTable::shapeOf(const Symbol* keys, std::size_t count) {
+    // Symbols as a string of char32_t: hashable with the standard library
+    thread_local std::u32string sequence;
+    thread_local std::unordered_map<std::u32string, const Shape*> cache;
+    sequence.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        sequence[i] = static_cast<char32_t>(keys[i]);
+    }
+    const auto cached = cache.find(sequence);
+    if (cached != cache.end()) {
+        return *cached->second;
+    }
+
+    const Shape* shape = nullptr;
+    {
+        std::shared_lock<std::shared_mutex> read(mutex_);
+        const auto found = shapes_.find(sequence);
+        if (found != shapes_.end()) {
+            shape = found->second.get();
+        }
+    }
+    if (shape == nullptr) {
+        std::unique_lock<std::shared_mutex> write(mutex_);
+        std::unique_ptr<Shape>& slot = shapes_[sequence];
+        if (!slot) {
+            auto created = std::make_unique<Shape>();
+            SymbolTable& symbols = SymbolTable::global();
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto inserted = created->index_.emplace(keys[i], static_cast<std::uint32_t>(created->keys_.size()));
+                if (inserted.second) {
+                    created->keys_.push_back(keys[i]);
+                    created->names_.push_back(symbols.name(keys[i]));
+                }
+                created->slotOf_.push_back(inserted.first->second);
+            }
+            slot = std::move(created);
+        }
+        shape = slot.get();
+    }
+    cache.emplace(sequence, shape);
+    return *shape;
+}
+
+std::size_t ShapeTable::size() const {
+    std::shared_lock<std::shared_mutex> read(mutex_);
+    return shapes_.size();
+}
+
+std::size_t ShapedValue::size() const {
+    switch (type_) {
+    case Type::Null:
+        return 0;
+    case Type::Array:
+    case Type::Object:
+        return size_;
+    default:
+        return 1;
+    }
+}
+
+const ShapedValue* ShapedValue::find(Symbol symbol) const {
+    if (type_ != Type::Object) {
+        return nullptr;
+    }
+    const std::ptrdiff_t index = object_->shape->indexOf(symbol);
+    return index < 0 ? nullptr : &object_->values[index];
+}
+
+bool ShapedValue::contains(std::string_view key) const {
+    if (type_ != Type::Object) {
+        return false;
+    }
+    const Shape& shape = *object_->shape;
+    for (std::size_t i = 0; i < shape.size(); ++i) {
+        if (shape.name(i) == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const ShapedValue& ShapedValue::operator[](std::string_view key) const {
+    if (type_ == Type::Object) {
+        const Shape& shape = *object_->shape;
+        for (std::size_t i = 0; i < shape.size(); ++i) {
+            if (shape.name(i) == key) {
+                return object_->values[i];
+            }
+        }
+    }
+    throw std::out_of_range("key '" + std::string(key) + "' not found");
+}
+
+const ShapedValue& ShapedValue::operator[](std::size_t index) const {
+    if ((type_ != Type::Array && type_ != Type::Object) || index >= size_) {
+        throw std::out_of_range("index " + std::to_string(index) + " is out of range");
+    }
+    return begin()[index];
+}
+
+const ShapedValue* ShapedValue::begin() const {
+    switch (type_) {
+    case Type::Array:
+        return elements_;
+    case Type::Object:
+        return object_->values;
+    default:
+        return nullptr;
+    }
+}
+
+nlohmann::json ShapedValue::toJson() const {
+    switch (type_) {
+    case Type::Null:
+        return nullptr;
+    case Type::Boolean:
+        return boolean_;
+    case Type::Integer:
+        return integer_;
+    case Type::Unsigned:
+        return unsigned_;
+    case Type::Double:
+        return number_;
+    case Type::String:
+        return std::string(string_, size_);
+    case Type::Array: {
+        nlohmann::json array = nlohmann::json::array();
+        for (const ShapedValue& element : *this) {
+            array.push_back(element.toJson());
+        }
+        return array;
+    }
+    case Type::Object:
+        break;
+    }
+    nlohmann::json object = nlohmann::json::object();
+    const Shape& shape = *object_->shape;
+    for (std::size_t i = 0; i < shape.size(); ++i) {
+        object[std::string(shape.name(i))] = object_->values[i].toJson();
+    }
+    return object;
+}
+
+void ShapedValue::requireType(bool ok, const char* expected) const {
+    if (!ok) {
+        throw std::invalid_argument(std::string("Value is not a ") + expected);
+    }
+}
+
+/**
+ * @brief SAX handler that builds ShapedValues in an arena
+ *
+ * Children of open containers wait on one value stack and one key stack,
+ * both reused across parses. A closed container is copied into the arena
+ * in one allocation.
+ */
+class ShapeBuilder {
+public:
+    explicit ShapeBuilder(Arena& arena) : arena_(arena) {}
+
+    const ShapedValue& parse(std::string_view text) {
+        values_.clear();
+        keys_.clear();
+        frames_.clear();
+        nlohmann::json::sax_parse(text.begin(), text.end(), this);
+        auto* root = static_cast<ShapedValue*>(arena_.allocate(sizeof(ShapedValue), alignof(ShapedValue)));
+        return *new (root) ShapedValue(values_.back());
+    }
+
+    // nlohmann::json SAX interface
+    bool null() {
+        values_.emplace_back();
+        return true;
+    }
+
+    bool boolean(bool value) {
+        ShapedValue& v = values_.emplace_back();
+        v.type_ = ShapedValue::Type::Boolean;
+        v.boolean_ = value;
+        return true;
+    }
+
+    bool number_integer(std::int64_t value) {
+        ShapedValue& v = values_.emplace_back();
+        v.type_ = ShapedValue::Type::Integer;
+        v.integer_ = value;
+        return true;
+    }
+
+    bool number_unsigned(std::uint64_t value) {
+        ShapedValue& v = values_.emplace_back();
+        v.type_ = ShapedValue::Type::Unsigned;
+        v.unsigned_ = value;
+        return true;
+    }
+
+    bool number_float(double value, const std::string&) {
+        ShapedValue& v = values_.emplace_back();
+        v.type_ = ShapedValue::Type::Double;
+        v.number_ = value;
+        return true;
+    }
+
+    bool string(std::string& value) {
+        if (value.size() > UINT32_MAX) {
+            throw std::runtime_error("String longer than 4 GiB");
+        }
+        char* copy = static_cast<char*>(arena_.allocate(value.size() + 1, 1));
+        std::memcpy(copy, value.data(), value.size());
+        copy[value.size()] = '\0';
+        ShapedValue& v = values_.emplace_back();
+        v.type_ = ShapedValue::Type::String;
+        v.size_ = static_cast<std::uint32_t>(value.size());
+        v.string_ = copy;
+        return true;
+    }
+
+    bool binary(nlohmann::json::binary_t&) {
+        throw std::runtime_error("Binary values are not supported");
+    }
+
+    bool start_object(std::size_t) {
+        frames_.push_back({values_.size(), keys_.size()});
+        return true;
+    }
+
+    bool key(std::string& name) {
+        keys_.push_back(SymbolTable::global().intern(name));
+        return true;
+    }
+
+    bool end_object() {
+        const Frame frame = frames_.back();
+        frames_.pop_back();
+        const std::size_t count = values_.size() - frame.values;
+        const Shape& shape = ShapeTable::global().shapeOf(keys_.data() + frame.keys, count);
+
+        // ObjectData and the values in one block
+        constexpr std::size_t kHeader = sizeof(ShapedValue::ObjectData);
+        static_assert(kHeader % alignof(ShapedValue) == 0, "values must follow the header aligned");
+        char* block = static_cast<char*>(
+            arena_.allocate(kHeader + shape.size() * sizeof(ShapedValue), alignof(ShapedValue::ObjectData)));
+        auto* values = reinterpret_cast<ShapedValue*>(block + kHeader);
+        for (std::size_t i = 0; i < shape.size(); ++i) {
+            new (&values[i]) ShapedValue();
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            values[shape.slotOf_[i]] = values_[frame.values + i];  // last duplicate wins
+        }
+        auto* data = new (block) ShapedValue::ObjectData{&shape, values};
+
+        values_.resize(frame.values);
+        keys_.resize(frame.keys);
+        ShapedValue& v = values_.emplace_back();
+        v.type_ = ShapedValue::Type::Object;
+        v.size_ = static_cast<std::uint32_t>(shape.size());
+        v.object_ = data;
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        frames_.push_back({values_.size(), keys_.size()});
+        return true;
+    }
+
+    bool end_array() {
+        const Frame frame = frames_.back();
+        frames_.pop_back();
+        const std::size_t count = values_.size() - frame.values;
+        if (count > UINT32_MAX) {
+            throw std::runtime_error("Array with more than 2^32 elements");
+        }
+        ShapedValue* elements = nullptr;
+        if (count > 0) {
+            elements = static_cast<ShapedValue*>(arena_.allocate(count * sizeof(ShapedValue), alignof(ShapedValue)));
+            std::memcpy(static_cast<void*>(elements), values_.data() + frame.values, count * sizeof(ShapedValue));
+        }
+        values_.resize(frame.values);
+        ShapedValue& v = values_.emplace_back();
+        v.type_ = ShapedValue::Type::Array;
+        v.size_ = static_cast<std::uint32_t>(count);
+        v.elements_ = elements;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::json::exception& e) {
+        throw std::runtime_error(e.what());
+    }
+
+private:
+    struct Frame {
+        std::size_t values;  ///< First value of this container on the value stack
+        std::size_t keys;    ///< First key of this object on the key stack
+    };
+
+    Arena& arena_;
+    std::vector<ShapedValue> values_;
+    std::vector<Symbol> keys_;
+    std::vector<Frame> frames_;
+};
+
+ShapedDocument::ShapedDocument(std::size_t firstBlockBytes)
+    : arena_(firstBlockBytes), builder_(std::make_unique<ShapeBuilder>(arena_)) {}
+
+ShapedDocument::~ShapedDocument() = default;
+
+const ShapedValue& ShapedDocument::parse(std::string_view text) {
+    return builder_->parse(text);
+}
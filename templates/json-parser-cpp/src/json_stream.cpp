@@ -0,0 +1,189 @@
+#include "json_stream.h"
+#include <chrono>
+#include <istream>
+#include <stdexcept>
+#include "file_input.h"
+
+bool SummaryHandler::null() {
+    ++events_;
+    return true;
+}
+
+bool SummaryHandler::boolean(bool value) {
+    ++events_;
+    if (depth_ == 1 && field_ == Field::Active) {
+        summary_.active = value;
+    }
+    return true;
+}
+
+bool SummaryHandler::number_integer(number_integer_t value) {
+    return number(static_cast<double>(value), value);
+}
+
+bool SummaryHandler::number_unsigned(number_unsigned_t value) {
+    return number(static_cast<double>(value),
+                  value <= static_cast<number_unsigned_t>(INT64_MAX) ? std::optional<std::int64_t>(value) : std::nullopt);
+}
+
+bool SummaryHandler::number_float(number_float_t value, const string_t& /*text*/) {
+    return number(value, std::nullopt);
+}
+
+bool SummaryHandler::string(string_t& value) {
+    return text(value);
+}
+
+bool SummaryHandler::binary(binary_t& /*value*/) {
+    ++events_;
+    return true;
+}
+
+bool SummaryHandler::start_object(std::size_t /*elements*/) {
+    return startContainer(false);
+}
+
+bool SummaryHandler::key(string_t& value) {
+    ++events_;
+    if (depth_ == 1) {
+        if (value == "name") {
+            field_ = Field::Name;
+        } else if (value == "age") {
+            field_ = Field::Age;
+        } else if (value == "city") {
+            field_ = Field::City;
+        } else if (value == "active") {
+            field_ = Field::Active;
+        } else if (value == "salary") {
+            field_ = Field::Salary;
+        } else if (value == "skills") {
+            field_ = Field::Skills;
+        } else if (value == "address") {
+            field_ = Field::Address;
+        } else {
+            field_ = Field::None;
+        }
+    } else if (depth_ == 2 && inAddress_) {
+        field_ = value == "street" ? Field::Street : value == "zipcode" ? Field::Zipcode : Field::None;
+    }
+    return true;
+}
+
+bool SummaryHandler::end_object() {
+    return endContainer();
+}
+
+bool SummaryHandler::start_array(std::size_t /*elements*/) {
+    return startContainer(true);
+}
+
+bool SummaryHandler::end_array() {
+    return endContainer();
+}
+
+bool SummaryHandler::parse_error(std::size_t /*position*/, const std::string& /*lastToken*/,
+                                 const nlohmann::detail::exception& error) {
+    error_ = error.what();
+    return false;
+}
+
+bool SummaryHandler::number(double value, std::optional<std::int64_t> integer) {
+    ++events_;
+    if (depth_ == 1) {
+        if (field_ == Field::Age && integer) {
+            summary_.age = *integer;
+        } else if (field_ == Field::Salary) {
+            summary_.salary = value;
+        }
+    }
+    return true;
+}
+
+bool SummaryHandler::text(std::string& value) {
+    ++events_;
+    if (depth_ == 1) {
+        // The parser reuses its token buffer, so the string can be taken over.
+        if (field_ == Field::Name) {
+            summary_.name = std::move(value);
+        } else if (field_ == Field::City) {
+            summary_.city = std::move(value);
+        }
+    } else if (depth_ == 2) {
+        if (inSkills_) {
+            summary_.skills->push_back(std::move(value));
+        } else if (inAddress_ && field_ == Field::Street) {
+            summary_.street = std::move(value);
+        } else if (inAddress_ && field_ == Field::Zipcode) {
+            summary_.zipcode = std::move(value);
+        }
+    }
+    return true;
+}
+
+bool SummaryHandler::startContainer(bool isArray) {
+    ++events_;
+    ++depth_;
+    if (depth_ == 1) {
+        rootObject_ = !isArray;
+    } else if (depth_ == 2 && rootObject_) {
+        if (isArray && field_ == Field::Skills) {
+            inSkills_ = true;
+            summary_.skills.emplace();
+        } else if (!isArray && field_ == Field::Address) {
+            inAddress_ = true;
+            summary_.hasAddress = true;
+        }
+    }
+    return true;
+}
+
+bool SummaryHandler::endContainer() {
+    ++events_;
+    if (depth_ == 2) {
+        inSkills_ = false;
+        inAddress_ = false;
+        field_ = Field::None;
+    }
+    --depth_;
+    return true;
+}
+
+JsonSummary summarizeJson(std::istream& input, StreamStats* stats) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::istream::pos_type begin = input.tellg();
+
+    SummaryHandler handler;
+    if (!nlohmann::json::sax_parse(input, &handler)) {
+        throw std::runtime_error("JSON parse error: " + handler.error());
+    }
+
+    if (stats != nullptr) {
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats->events = handler.events();
+        input.clear();
+        const std::istream::pos_type end = input.tellg();
+        stats->bytes = begin != std::istream::pos_type(-1) && end != std::istream::pos_type(-1)
+                           ? static_cast<std::uint64_t>(end - begin)
+                           : 0;
+    }
+    return handler.summary();
+}
+
+JsonSummary summarizeJson(const FileInput& input, StreamStats* stats) {
+    const auto start = std::chrono::steady_clock::now();
+    SummaryHandler handler;
+    if (!nlohmann::json::sax_parse(input.begin(), input.end(), &handler)) {
+        throw std::runtime_error("JSON parse error: " + handler.error());
+    }
+    if (stats != nullptr) {
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats->events = handler.events();
+        stats->bytes = input.size();
+    }
+    return handler.summary();
+}
+
+JsonSummary summarizeJsonFile(const std::string& path, StreamStats* stats) {
+    const FileInput input(path);
+    return summarizeJson(input, stats);
+}
@@ -0,0 +1,653 @@
+#include "json_tape.h"
+#include "structural_index.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+bool isDelimiter(char c) {
+    switch (c) {
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+    case ',':
+    case ':':
+    case '[':
+    case ']':
+    case '{':
+    case '}':
+    case '"':
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void appendUtf8(std::string& out, std::uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+/// Length of the well-formed UTF-8 sequence at data[0], or 0 (RFC 3629)
+std::size_t utf8SequenceLength(const unsigned char* data, std::size_t available) {
+    const unsigned char lead = data[0];
+    std::size_t length = 0;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        low = lead == 0xE0 ? 0xA0 : 0x80;
+        high = lead == 0xED ? 0x9F : 0xBF;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        low = lead == 0xF0 ? 0x90 : 0x80;
+        high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+        return 0;
+    }
+    if (available < length || data[1] < low || data[1] > high) {
+        return 0;
+    }
+    for (std::size_t i = 2; i < length; ++i) {
+        if (data[i] < 0x80 || data[i] > 0xBF) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+} // namespace
+
+/**
+ * @brief Stage 2 state machine over the structural offsets
+ */
+class TapeBuilder {
+public:
+    TapeBuilder(std::string_view input, const std::vector<std::uint32_t>& structurals, JsonTape& tape)
+        : input_(input), structurals_(structurals), tape_(tape.tape_), strings_(tape.strings_) {}
+
+    void build() {
+        // Each structural yields at most two words (numbers); strings hold
+        // at most the input's bytes plus their length prefixes.
+        tape_.reserve(structurals_.size() * 2);
+        strings_.reserve(input_.size());
+        skipByteOrderMark();
+
+        enum class State { Value, ObjectFirst, ObjectKey, ArrayFirst, AfterValue };
+        State state = State::Value;
+        while (true) {
+            switch (state) {
+            case State::Value: {
+                const std::size_t at = next("unexpected end of input; expected value");
+                switch (input_[at]) {
+                case '{':
+                    open(JsonTape::Type::ObjectBegin, at);
+                    state = State::ObjectFirst;
+                    continue;
+                case '[':
+                    open(JsonTape::Type::ArrayBegin, at);
+                    state = State::ArrayFirst;
+                    continue;
+                case '"':
+                    parseString(at);
+                    break;
+                case 't':
+                    parseLiteral(at, "true", JsonTape::Type::True);
+                    break;
+                case 'f':
+                    parseLiteral(at, "false", JsonTape::Type::False);
+                    break;
+                case 'n':
+                    parseLiteral(at, "null", JsonTape::Type::Null);
+                    break;
+                default:
+                    if (input_[at] == '-' || isDigit(input_[at])) {
+                        parseNumber(at);
+                        break;
+                    }
+                    fail(at, "unexpected character; expected value");
+                }
+                state = State::AfterValue;
+                continue;
+            }
+            case State::ObjectFirst:
+                if (peek() == '}') {
+                    ++index_;
+                    close();
+                    state = State::AfterValue;
+                    continue;
+                }
+                [[fallthrough]];
+            case State::ObjectKey: {
+                const std::size_t at = next("unexpected end of input; expected string key");
+                if (input_[at] != '"') {
+                    fail(at, "expected string key");
+                }
+                parseString(at);
+                const std::size_t colon = next("unexpected end of input; expected ':'");
+                if (input_[colon] != ':') {
+                    fail(colon, "expected ':' after object key");
+                }
+                state = State::Value;
+                continue;
+            }
+            case State::ArrayFirst:
+                if (peek() == ']') {
+                    ++index_;
+                    close();
+                    state = State::AfterValue;
+                    continue;
+                }
+                state = State::Value;
+                continue;
+            case State::AfterValue: {
+                if (stack_.empty()) {
+                    if (index_ != structurals_.size()) {
+                        fail(structurals_[index_], "unexpected content after document");
+                    }
+                    return;
+                }
+                const bool inObject = stack_.back().isObject;
+                const std::size_t at = next(inObject ? "unexpected end of input; expected ',' or '}'"
+                                                     : "unexpected end of input; expected ',' or ']'");
+                const char c = input_[at];
+                if (c == ',') {
+                    state = inObject ? State::ObjectKey : State::Value;
+                } else if (c == (inObject ? '}' : ']')) {
+                    close();
+                } else {
+                    fail(at, inObject ? "expected ',' or '}'" : "expected ',' or ']'");
+                }
+                continue;
+            }
+            }
+        }
+    }
+
+private:
+    struct Frame {
+        bool isObject;
+        std::size_t begin;  ///< Tape index of the begin word
+    };
+
+    [[noreturn]] void fail(std::size_t at, const char* message) const {
+        throw std::runtime_error("JSON parse error at byte " + std::to_string(at) + ": " + message);
+    }
+
+    /// A leading UTF-8 byte order mark is ignored, as nlohmann::json does
+    void skipByteOrderMark() {
+        constexpr std::string_view kBom = "\xEF\xBB\xBF";
+        if (input_.substr(0, kBom.size()) != kBom) {
+            return;
+        }
+        start_ = kBom.size();
+        // Stage 1 sees the mark as the start of a scalar. When the mark ends
+        // that scalar, drop its offset; otherwise next() moves it past the mark.
+        const bool ownScalar = input_.size() == start_ || isDelimiter(input_[start_]);
+        if (index_ < structurals_.size() && structurals_[index_] < start_ && ownScalar) {
+            ++index_;
+        }
+    }
+
+    std::size_t next(const char* endMessage) {
+        if (index_ >= structurals_.size()) {
+            fail(input_.size(), endMessage);
+        }
+        const std::size_t at = std::max<std::size_t>(structurals_[index_++], start_);
+        if (at >= input_.size()) {
+            fail(input_.size(), "structural index out of range");
+        }
+        return at;
+    }
+
+    char peek() const {
+        return index_ < structurals_.size() && structurals_[index_] < input_.size() ? input_[structurals_[index_]]
+                                                                                    : '\0';
+    }
+
+    void push(JsonTape::Type type, std::uint64_t payload) {
+        tape_.push_back(static_cast<std::uint64_t>(type) << 56 | payload);
+    }
+
+    void open(JsonTape::Type type, std::size_t at) {
+        if (stack_.size() >= JsonTape::kMaxDepth) {
+            fail(at, "nesting too deep");
+        }
+        stack_.push_back({type == JsonTape::Type::ObjectBegin, tape_.size()});
+        push(type, 0);  // patched by close()
+    }
+
+    void close() {
+        const Frame frame = stack_.back();
+        stack_.pop_back();
+        push(frame.isObject ? JsonTape::Type::ObjectEnd : JsonTape::Type::ArrayEnd, frame.begin);
+        tape_[frame.begin] |= tape_.size();
+    }
+
+    void parseLiteral(std::size_t at, std::string_view literal, JsonTape::Type type) {
+        const std::size_t end = at + literal.size();
+        if (input_.compare(at, literal.size(), literal) != 0 || (end < input_.size() && !isDelimiter(input_[end]))) {
+            fail(at, "invalid literal");
+        }
+        push(type, 0);
+    }
+
+    void parseNumber(std::size_t at) {
+        const char* const begin = input_.data() + at;
+        const char* const limit = input_.data() + input_.size();
+        const char* p = begin;
+        const bool negative = *p == '-';
+        if (negative) {
+            ++p;
+        }
+        if (p == limit || !isDigit(*p)) {
+            fail(at, "invalid number; expected digit");
+        }
+        if (*p == '0') {
+            ++p;
+        } else {
+            while (p != limit && isDigit(*p)) {
+                ++p;
+            }
+        }
+        bool integral = true;
+        if (p != limit && *p == '.') {
+            integral = false;
+            ++p;
+            if (p == limit || !isDigit(*p)) {
+                fail(at, "invalid number; expected digit after '.'");
+            }
+            while (p != limit && isDigit(*p)) {
+                ++p;
+            }
+        }
+        if (p != limit && (*p == 'e' || *p == 'E')) {
+            integral = false;
+            ++p;
+            if (p != limit && (*p == '+' || *p == '-')) {
+                ++p;
+            }
+            if (p == limit || !isDigit(*p)) {
+                fail(at, "invalid number; expected digit in exponent");
+            }
+            while (p != limit && isDigit(*p)) {
+                ++p;
+            }
+        }
+        if (p != limit && !isDelimiter(*p)) {
+            fail(at, "invalid number");
+        }
+
+        // Like nlohmann::json: non-negative integers are unsigned, negative
+        // ones signed, and integers out of 64-bit range become doubles.
+        if (integral) {
+            if (negative) {
+                std::int64_t value = 0;
+                if (std::from_chars(begin, p, value).ec == std::errc()) {
+                    push(JsonTape::Type::Int64, 0);
+                    tape_.push_back(static_cast<std::uint64_t>(value));
+                    return;
+                }
+            } else {
+                std::uint64_t value = 0;
+                if (std::from_chars(begin, p, value).ec == std::errc()) {
+                    push(JsonTape::Type::Uint64, 0);
+                    tape_.push_back(value);
+                    return;
+                }
+            }
+        }
+        double value = 0.0;
+        if (std::from_chars(begin, p, value).ec != std::errc()) {
+            // Out of range: strtod rounds underflow to zero or a denormal.
+            value = std::strtod(std::string(begin, p).c_str(), nullptr);
+        }
+        if (!std::isfinite(value)) {
+            fail(at, "number overflow");
+        }
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        push(JsonTape::Type::Double, 0);
+        tape_.push_back(bits);
+    }
+
+    std::uint32_t parseHex4(std::size_t at) const {
+        if (at + 4 > input_.size()) {
+            fail(at, "invalid \\u escape");
+        }
+        std::uint32_t value = 0;
+        for (std::size_t i = 0; i < 4; ++i) {
+            const int digit = hexValue(input_[at + i]);
+            if (digit < 0) {
+                fail(at, "invalid \\u escape");
+            }
+            value = value << 4 | static_cast<std::uint32_t>(digit);
+        }
+        return value;
+    }
+
+    void parseString(std::size_t at) {
+        push(JsonTape::Type::String, strings_.size());
+        const std::size_t lengthOffset = strings_.size();
+        strings_.append(sizeof(std::uint32_t), '\0');
+        const std::size_t contentOffset = strings_.size();
+
+        std::size_t p = at + 1;
+        while (true) {
+            // Copy the longest run of plain ASCII in one go.
+            std::size_t run = p;
+            while (run < input_.size()) {
+                const unsigned char c = static_cast<unsigned char>(input_[run]);
+                if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80) {
+                    break;
+                }
+                ++run;
+            }
+            strings_.append(input_.data() + p, run - p);
+            p = run;
+            if (p >= input_.size()) {
+                fail(at, "unterminated string");
+            }
+
+            const unsigned char c = static_cast<unsigned char>(input_[p]);
+            if (c == '"') {
+                break;
+            }
+            if (c < 0x20) {
+                fail(p, "control character in string must be escaped");
+            }
+            if (c >= 0x80) {
+                const std::size_t length = utf8SequenceLength(reinterpret_cast<const unsigned char*>(input_.data() + p),
+                                                              input_.size() - p);
+                if (length == 0) {
+                    fail(p, "invalid UTF-8 in string");
+                }
+                strings_.append(input_.data() + p, length);
+                p += length;
+                continue;
+            }
+
+            // Escape sequence
+            if (p + 1 >= input_.size()) {
+                fail(p, "unterminated string");
+            }
+            const char escape = input_[p + 1];
+            p += 2;
+            switch (escape) {
+            case '"':
+            case '\\':
+            case '/':
+                strings_ += escape;
+                break;
+            case 'b':
+                strings_ += '\b';
+                break;
+            case 'f':
+                strings_ += '\f';
+                break;
+            case 'n':
+                strings_ += '\n';
+                break;
+            case 'r':
+                strings_ += '\r';
+                break;
+            case 't':
+                strings_ += '\t';
+                break;
+            case 'u': {
+                std::uint32_t codepoint = parseHex4(p);
+                p += 4;
+                if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                    if (p + 2 > input_.size() || input_[p] != '\\' || input_[p + 1] != 'u') {
+                        fail(p, "high surrogate must be followed by a low surrogate");
+                    }
+                    const std::uint32_t low = parseHex4(p + 2);
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        fail(p, "high surrogate must be followed by a low surrogate");
+                    }
+                    p += 6;
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                } else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+                    fail(p, "low surrogate without a high surrogate");
+                }
+                appendUtf8(strings_, codepoint);
+                break;
+            }
+            default:
+                fail(p - 2, "invalid escape sequence");
+            }
+        }
+
+        const std::uint32_t length = static_cast<std::uint32_t>(strings_.size() - contentOffset);
+        std::memcpy(&strings_[lengthOffset], &length, sizeof(length));
+    }
+
+    std::string_view input_;
+    const std::vector<std::uint32_t>& structurals_;
+    std::vector<std::uint64_t>& tape_;
+    std::string& strings_;
+    std::vector<Frame> stack_;
+    std::size_t index_ = 0;
+    std::size_t start_ = 0;  ///< Offset of the text after a byte order mark
+};
+
+JsonTape JsonTape::parse(std::string_view input) {
+    return parse(input, StructuralIndex::build(input));
+}
+
+JsonTape JsonTape::parse(std::string_view input, const std::vector<std::uint32_t>& structurals) {
+    JsonTape tape;
+    TapeBuilder(input, structurals, tape).build();
+    return tape;
+}
+
+void JsonTape::serialize(std::vector<std::uint8_t>& out) const {
+    const std::uint64_t counts[2] = {tape_.size(), strings_.size()};
+    const std::size_t begin = out.size();
+    out.resize(begin + sizeof(counts) + tape_.size() * sizeof(std::uint64_t) + strings_.size());
+    std::uint8_t* p = out.data() + begin;
+    std::memcpy(p, counts, sizeof(counts));
+    p += sizeof(counts);
+    if (!tape_.empty()) {
+        std::memcpy(p, tape_.data(), tape_.size() * sizeof(std::uint64_t));
+        p += tape_.size() * sizeof(std::uint64_t);
+    }
+    if (!strings_.empty()) {
+        std::memcpy(p, strings_.data(), strings_.size());
+    }
+}
+
+JsonTape JsonTape::deserialize(std::string_view bytes) {
+    const auto corrupt = [](const char* message) { return std::runtime_error(std::string("Corrupt JSON tape: ") + message); };
+    std::uint64_t counts[2] = {0, 0};
+    if (bytes.size() < sizeof(counts)) {
+        throw corrupt("truncated header");
+    }
+    std::memcpy(counts, bytes.data(), sizeof(counts));
+    const std::uint64_t words = counts[0];
+    const std::uint64_t stringBytes = counts[1];
+    const std::uint64_t available = bytes.size() - sizeof(counts);
+    if (words > available / sizeof(std::uint64_t) || stringBytes != available - words * sizeof(std::uint64_t)) {
+        throw corrupt("size mismatch");
+    }
+
+    JsonTape tape;
+    tape.tape_.resize(static_cast<std::size_t>(words));
+    if (words > 0) {
+        std::memcpy(tape.tape_.data(), bytes.data() + sizeof(counts), static_cast<std::size_t>(words) * sizeof(std::uint64_t));
+    }
+    tape.strings_.assign(bytes.data() + sizeof(counts) + words * sizeof(std::uint64_t), static_cast<std::size_t>(stringBytes));
+
+    // One pass over the words: everything toJson() and string() rely on.
+    struct Open {
+        std::size_t begin;
+        bool isObject;
+        bool expectKey;
+    };
+    std::vector<Open> open;
+    bool haveRoot = false;
+    for (std::size_t i = 0; i < tape.tape_.size(); ++i) {
+        const Type type = tape.type(i);
+        const std::uint64_t payload = tape.payload(i);
+        const bool isEnd = type == Type::ArrayEnd || type == Type::ObjectEnd;
+        if (open.empty() && (haveRoot || isEnd)) {
+            throw corrupt("content outside the root value");
+        }
+        if (!open.empty() && open.back().isObject && !isEnd) {
+            if (open.back().expectKey && type != Type::String) {
+                throw corrupt("object key is not a string");
+            }
+            const bool wasKey = open.back().expectKey;
+            open.back().expectKey = !wasKey;
+            if (wasKey) {
+                if (payload + sizeof(std::uint32_t) > stringBytes) {
+                    throw corrupt("string out of bounds");
+                }
+                if (tape.string(i).size() > stringBytes - payload - sizeof(std::uint32_t)) {
+                    throw corrupt("string out of bounds");
+                }
+                continue;
+            }
+        }
+        if (open.empty()) {
+            haveRoot = true;
+        }
+        switch (type) {
+        case Type::Null:
+        case Type::True:
+        case Type::False:
+            break;
+        case Type::Int64:
+        case Type::Uint64:
+        case Type::Double:
+            if (++i >= tape.tape_.size()) {
+                throw corrupt("number without value");
+            }
+            break;
+        case Type::String:
+            if (payload + sizeof(std::uint32_t) > stringBytes ||
+                tape.string(i).size() > stringBytes - payload - sizeof(std::uint32_t)) {
+                throw corrupt("string out of bounds");
+            }
+            break;
+        case Type::ArrayBegin:
+        case Type::ObjectBegin:
+            if (payload <= i + 1 || payload > tape.tape_.size() || open.size() >= kMaxDepth) {
+                throw corrupt("bad container link");
+            }
+            open.push_back({i, type == Type::ObjectBegin, type == Type::ObjectBegin});
+            break;
+        case Type::ArrayEnd:
+        case Type::ObjectEnd:
+            if (payload != open.back().begin || open.back().isObject != (type == Type::ObjectEnd) ||
+                (open.back().isObject && !open.back().expectKey) || tape.payload(open.back().begin) != i + 1) {
+                throw corrupt("bad container link");
+            }
+            open.pop_back();
+            break;
+        default:
+            throw corrupt("unknown word type");
+        }
+    }
+    if (!open.empty() || (!haveRoot && words > 0)) {
+        throw corrupt("unclosed container");
+    }
+    return tape;
+}
+
+std::string_view JsonTape::string(std::size_t index) const {
+    const std::size_t offset = static_cast<std::size_t>(payload(index));
+    std::uint32_t length = 0;
+    std::memcpy(&length, strings_.data() + offset, sizeof(length));
+    return std::string_view(strings_.data() + offset + sizeof(length), length);
+}
+
+nlohmann::json JsonTape::toJson() const {
+    std::size_t index = 0;
+    return tape_.empty() ? nlohmann::json() : valueToJson(index);
+}
+
+nlohmann::json JsonTape::valueToJson(std::size_t& index) const {
+    const std::size_t at = index++;
+    switch (type(at)) {
+    case Type::Null:
+        return nullptr;
+    case Type::True:
+        return true;
+    case Type::False:
+        return false;
+    case Type::Int64:
+        return static_cast<std::int64_t>(tape_[index++]);
+    case Type::Uint64:
+        return tape_[index++];
+    case Type::Double: {
+        double value = 0.0;
+        std::memcpy(&value, &tape_[index++], sizeof(value));
+        return value;
+    }
+    case Type::String: {
+        const std::string_view value = string(at);
+        return std::string(value);
+    }
+    case Type::ArrayBegin: {
+        nlohmann::json array = nlohmann::json::array();
+        const std::size_t end = static_cast<std::size_t>(payload(at)) - 1;
+        while (index < end) {
+            array.push_back(valueToJson(index));
+        }
+        index = end + 1;
+        return array;
+    }
+    case Type::ObjectBegin: {
+        nlohmann::json object = nlohmann::json::object();
+        const std::size_t end = static_cast<std::size_t>(payload(at)) - 1;
+        while (index < end) {
+            const std::string_view key = string(index++);
+            object[std::string(key)] = valueToJson(index);
+        }
+        index = end + 1;
+        return object;
+    }
+    case Type::ArrayEnd:
+    case Type::ObjectEnd:
+        break;
+    }
+    throw std::logic_error("Corrupt JSON tape");
+}
@@ -0,0 +1,321 @@
+#include "json_writer.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+[[noreturn]] void failWrite() {
+    throw std::runtime_error(std::string("Could not write output: ") + std::strerror(errno));
+}
+
+/// write() or writev() until every byte of the vectors is out
+void writeAll(int fd, iovec* parts, int count) {
+    while (count > 0) {
+        const ssize_t written = ::writev(fd, parts, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            failWrite();
+        }
+        std::size_t remaining = static_cast<std::size_t>(written);
+        while (count > 0 && remaining >= parts->iov_len) {
+            remaining -= parts->iov_len;
+            ++parts;
+            --count;
+        }
+        if (count > 0) {
+            parts->iov_base = static_cast<char*>(parts->iov_base) + remaining;
+            parts->iov_len -= remaining;
+        }
+    }
+}
+
+/**
+ * @brief Lay out shortest digits the way nlohmann::json::dump() does
+ *
+ * digits/count hold the significant digits, exponent is the power of ten
+ * of the first digit. Plain notation for exponents -4 to 14, with ".0"
+ * added to whole numbers; otherwise d.ddde+XX with at least two exponent
+ * digits.
+ */
+std::size_t formatDigits(char* out, const char* digits, std::size_t count, int exponent) {
+    constexpr int kMinExp = -4;
+    constexpr int kMaxExp = 15;
+    const int k = static_cast<int>(count);
+    const int n = exponent + 1;  // position of the decimal point
+    char* p = out;
+    if (k <= n && n <= kMaxExp) {
+        std::memcpy(p, digits, count);
+        p += count;
+        std::memset(p, '0', static_cast<std::size_t>(n - k));
+        p += n - k;
+        *p++ = '.';
+        *p++ = '0';
+    } else if (0 < n && n <= kMaxExp) {
+        std::memcpy(p, digits, static_cast<std::size_t>(n));
+        p += n;
+        *p++ = '.';
+        std::memcpy(p, digits + n, static_cast<std::size_t>(k - n));
+        p += k - n;
+    } else if (kMinExp < n && n <= 0) {
+        *p++ = '0';
+        *p++ = '.';
+        std::memset(p, '0', static_cast<std::size_t>(-n));
+        p += -n;
+        std::memcpy(p, digits, count);
+        p += count;
+    } else {
+        *p++ = digits[0];
+        if (k > 1) {
+            *p++ = '.';
+            std::memcpy(p, digits + 1, count - 1);
+            p += count - 1;
+        }
+        *p++ = 'e';
+        *p++ = exponent < 0 ? '-' : '+';
+        const int magnitude = exponent < 0 ? -exponent : exponent;
+        if (magnitude >= 100) {
+            *p++ = static_cast<char>('0' + magnitude / 100);
+        }
+        *p++ = static_cast<char>('0' + magnitude / 10 % 10);
+        *p++ = static_cast<char>('0' + magnitude % 10);
+    }
+    return static_cast<std::size_t>(p - out);
+}
+
+} // namespace
+
+JsonWriter::JsonWriter(int fd, int indent) : fd_(fd), indent_(indent), buffer_(new char[kBufferBytes]) {}
+
+JsonWriter::~JsonWriter() {
+    try {
+        flush();
+    } catch (const std::runtime_error&) {
+        // Reported only through an explicit flush()
+    }
+}
+
+void JsonWriter::write(const nlohmann::json& value) {
+    writeValue(value, 0);
+}
+
+void JsonWriter::flush() {
+    if (used_ == 0) {
+        return;
+    }
+    iovec part{buffer_.get(), used_};
+    flushed_ += used_;
+    used_ = 0;
+    writeAll(fd_, &part, 1);
+}
+
+void JsonWriter::append(const char* data, std::size_t size) {
+    if (size <= kBufferBytes - used_) {
+        std::memcpy(buffer_.get() + used_, data, size);
+        used_ += size;
+        return;
+    }
+    if (size < kBufferBytes) {
+        flush();
+        std::memcpy(buffer_.get(), data, size);
+        used_ = size;
+        return;
+    }
+    // Too large to buffer: send the buffer and the data in one call
+    iovec parts[2] = {{buffer_.get(), used_}, {const_cast<char*>(data), size}};
+    flushed_ += used_ + size;
+    used_ = 0;
+    writeAll(fd_, parts, 2);
+}
+
+void JsonWriter::newline(std::size_t depth) {
+    static const char kSpaces[] = "                                                                ";
+    put('\n');
+    std::size_t spaces = depth * static_cast<std::size_t>(indent_);
+    while (spaces > 0) {
+        const std::size_t chunk = std::min(spaces, sizeof(kSpaces) - 1);
+        append(kSpaces, chunk);
+        spaces -= chunk;
+    }
+}
+
+void JsonWriter::writeValue(const nlohmann::json& value, std::size_t depth) {
+    using value_t = nlohmann::json::value_t;
+    const bool pretty = indent_ >= 0;
+    switch (value.type()) {
+    case value_t::object: {
+        if (value.empty()) {
+            append("{}", 2);
+            return;
+        }
+        put('{');
+        bool first = true;
+        for (auto it = value.begin(); it != value.end(); ++it) {
+            if (!first) {
+                put(',');
+            }
+            first = false;
+            if (pretty) {
+                newline(depth + 1);
+            }
+            writeString(it.key());
+            if (pretty) {
+                append(": ", 2);
+            } else {
+                put(':');
+            }
+            writeValue(it.value(), depth + 1);
+        }
+        if (pretty) {
+            newline(depth);
+        }
+        put('}');
+        return;
+    }
+    case value_t::array: {
+        if (value.empty()) {
+            append("[]", 2);
+            return;
+        }
+        put('[');
+        bool first = true;
+        for (const nlohmann::json& element : value) {
+            if (!first) {
+                put(',');
+            }
+            first = false;
+            if (pretty) {
+                newline(depth + 1);
+            }
+            writeValue(element, depth + 1);
+        }
+        if (pretty) {
+            newline(depth);
+        }
+        put(']');
+        return;
+    }
+    case value_t::string:
+        writeString(value.get_ref<const std::string&>());
+        return;
+    case value_t::boolean:
+        if (value.get<bool>()) {
+            append("true", 4);
+        } else {
+            append("false", 5);
+        }
+        return;
+    case value_t::number_integer:
+    case value_t::number_unsigned: {
+        char text[24];
+        const auto result = value.is_number_unsigned()
+                                ? std::to_chars(text, text + sizeof(text), value.get<std::uint64_t>())
+                                : std::to_chars(text, text + sizeof(text), value.get<std::int64_t>());
+        append(text, static_cast<std::size_t>(result.ptr - text));
+        return;
+    }
+    case value_t::number_float:
+        writeDouble(value.get<double>());
+        return;
+    case value_t::null:
+        append("null", 4);
+        return;
+    case value_t::discarded:
+        append("<discarded>", 11);
+        return;
+    case value_t::binary:
+        break;
+    }
+    throw std::invalid_argument("Binary values cannot be written as JSON text");
+}
+
+void JsonWriter::writeString(std::string_view text) {
+    static const char kHex[] = "0123456789abcdef";
+    put('"');
+    std::size_t run = 0;  // start of the bytes that need no escaping
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        append(text.data() + run, i - run);
+        run = i + 1;
+        char escape[6] = {'\\', 0, 0, 0, 0, 0};
+        std::size_t length = 2;
+        switch (c) {
+        case '"':
+            escape[1] = '"';
+            break;
+        case '\\':
+            escape[1] = '\\';
+            break;
+        case '\b':
+            escape[1] = 'b';
+            break;
+        case '\f':
+            escape[1] = 'f';
+            break;
+        case '\n':
+            escape[1] = 'n';
+            break;
+        case '\r':
+            escape[1] = 'r';
+            break;
+        case '\t':
+            escape[1] = 't';
+            break;
+        default:
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[3] = '0';
+            escape[4] = kHex[c >> 4];
+            escape[5] = kHex[c & 0xF];
+            length = 6;
+            break;
+        }
+        append(escape, length);
+    }
+    append(text.data() + run, text.size() - run);
+    put('"');
+}
+
+void JsonWriter::writeDouble(double value) {
+    if (!std::isfinite(value)) {
+        append("null", 4);
+        return;
+    }
+    char text[40];
+    char* p = text;
+    if (std::signbit(value)) {
+        *p++ = '-';
+        value = -value;
+    }
+    if (value == 0) {
+        std::memcpy(p, "0.0", 3);
+        append(text, static_cast<std::size_t>(p + 3 - text));
+        return;
+    }
+    // Shortest round-trip digits in the form d.ddde+XX
+    char scientific[32];
+    const auto result = std::to_chars(scientific, scientific + sizeof(scientific), value, std::chars_format::scientific);
+    const char* e = std::find(scientific, result.ptr, 'e');
+    char digits[20];
+    std::size_t count = 0;
+    for (const char* q = scientific; q < e; ++q) {
+        if (*q != '.') {
+            digits[count++] = *q;
+        }
+    }
+    int exponent = 0;
+    std::from_chars(*(e + 1) == '+' ? e + 2 : e + 1, result.ptr, exponent);
+    p += formatDigits(p, digits, count, exponent);
+    append(text, static_cast<std::size_t>(p - text));
+}
@@ -0,0 +1,279 @@
+#include "lazy_json.h"
+#include <stdexcept>
+#include <unordered_map>
+#include "file_input.h"
+#include "json_tape.h"
+#include "structural_index.h"
+
+namespace {
+
+constexpr std::uint32_t kNoKey = UINT32_MAX;
+
+bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+[[noreturn]] void fail(std::size_t at, const char* message) {
+    throw std::runtime_error("JSON parse error at byte " + std::to_string(at) + ": " + message);
+}
+
+nlohmann::json decode(std::string_view text) {
+    try {
+        return nlohmann::json::parse(text.begin(), text.end());
+    } catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error(e.what());
+    }
+}
+
+} // namespace
+
+/**
+ * @brief State shared by all handles into one document
+ */
+struct LazyJson::Document {
+    std::unique_ptr<FileInput> file;  ///< Set when the document was loaded from a path
+    std::string_view input;
+    std::vector<std::uint32_t> structurals;
+    std::unordered_map<std::uint32_t, std::vector<Child>> children;  ///< By container's structural index
+    std::unordered_map<std::uint32_t, nlohmann::json> values;        ///< Decoded values, by structural index
+
+    char at(std::uint32_t index) const { return input[structurals[index]]; }
+
+    /// Text from a structural to just before the next one, without trailing whitespace
+    std::string_view token(std::uint32_t index) const {
+        const std::size_t begin = structurals[index];
+        std::size_t end = index + 1 < structurals.size() ? structurals[index + 1] : input.size();
+        while (end > begin && isWhitespace(input[end - 1])) {
+            --end;
+        }
+        return input.substr(begin, end - begin);
+    }
+
+    /// Structural index just past the value that starts at index
+    std::uint32_t skip(std::uint32_t index) const {
+        const char c = at(index);
+        if (c != '{' && c != '[') {
+            return index + 1;
+        }
+        // parse() checked the nesting, so the first return to depth 0 is
+        // the matching bracket.
+        std::size_t depth = 0;
+        for (;; ++index) {
+            const char d = at(index);
+            if (d == '{' || d == '[') {
+                ++depth;
+            } else if ((d == '}' || d == ']') && --depth == 0) {
+                return index + 1;
+            }
+        }
+    }
+};
+
+LazyJson LazyJson::parse(std::string_view input) {
+    auto document = std::make_shared<Document>();
+    document->input = input;
+    document->structurals = StructuralIndex::build(input);
+    const std::vector<std::uint32_t>& structurals = document->structurals;
+    if (structurals.empty()) {
+        fail(input.size(), "unexpected end of input; expected value");
+    }
+
+    // Bracket nesting and a single root: enough for handles to find the end
+    // of any value without further checks.
+    std::vector<char> open;
+    for (std::size_t i = 0; i < structurals.size(); ++i) {
+        const char c = input[structurals[i]];
+        if (c == '{' || c == '[') {
+            if (open.size() >= JsonTape::kMaxDepth) {
+                fail(structurals[i], "nesting too deep");
+            }
+            open.push_back(c == '{' ? '}' : ']');
+        } else if (c == '}' || c == ']') {
+            if (open.empty() || open.back() != c) {
+                fail(structurals[i], "unexpected closing bracket");
+            }
+            open.pop_back();
+        }
+        if (open.empty() && i + 1 < structurals.size()) {
+            fail(structurals[i + 1], "unexpected content after document");
+        }
+    }
+    if (!open.empty()) {
+        fail(input.size(), open.back() == '}' ? "unexpected end of input; expected ',' or '}'"
+                                              : "unexpected end of input; expected ',' or ']'");
+    }
+    return LazyJson(std::move(document), 0, static_cast<std::uint32_t>(structurals.size()));
+}
+
+LazyJson LazyJson::load(const std::string& path) {
+    auto file = std::make_unique<FileInput>(path);
+    LazyJson root = parse(file->view());
+    root.document_->file = std::move(file);
+    return root;
+}
+
+nlohmann::json::value_t LazyJson::type() const {
+    using value_t = nlohmann::json::value_t;
+    switch (document_->at(index_)) {
+    case '{':
+        return value_t::object;
+    case '[':
+        return value_t::array;
+    case '"':
+        return value_t::string;
+    case 't':
+    case 'f':
+        return value_t::boolean;
+    case 'n':
+        return value_t::null;
+    default:
+        break;
+    }
+    const std::string_view text = document_->token(index_);
+    if (text.find_first_of(".eE") != std::string_view::npos) {
+        return value_t::number_float;
+    }
+    return text.front() == '-' ? value_t::number_integer : value_t::number_unsigned;
+}
+
+const std::vector<LazyJson::Child>& LazyJson::children() const {
+    static const std::vector<Child> kNone;
+    const char open = document_->at(index_);
+    if (open != '{' && open != '[') {
+        return kNone;
+    }
+    const auto cached = document_->children.find(index_);
+    if (cached != document_->children.end()) {
+        return cached->second;
+    }
+
+    const Document& document = *document_;
+    const bool isObject = open == '{';
+    const std::uint32_t close = end_ - 1;
+    std::vector<Child> list;
+    std::uint32_t i = index_ + 1;
+    while (i < close) {
+        Child child{kNoKey, i, 0};
+        if (isObject) {
+            if (document.at(i) != '"') {
+                fail(document.structurals[i], "expected string key");
+            }
+            if (i + 1 >= close || document.at(i + 1) != ':') {
+                fail(document.structurals[i + 1], "expected ':' after object key");
+            }
+            child.key = i;
+            child.value = i + 2;
+            if (child.value >= close) {
+                fail(document.structurals[close], "unexpected character; expected value");
+            }
+        }
+        const char c = document.at(child.value);
+        if (c == ',' || c == ':' || c == '}' || c == ']') {
+            fail(document.structurals[child.value], "unexpected character; expected value");
+        }
+        child.end = document.skip(child.value);
+        list.push_back(child);
+        i = child.end;
+        if (i < close) {
+            if (document.at(i) != ',') {
+                fail(document.structurals[i], isObject ? "expected ',' or '}'" : "expected ',' or ']'");
+            }
+            if (++i == close) {
+                fail(document.structurals[close], isObject ? "expected string key" : "unexpected character; expected value");
+            }
+        }
+    }
+    return document_->children.emplace(index_, std::move(list)).first->second;
+}
+
+const LazyJson::Child* LazyJson::findKey(std::string_view key) const {
+    if (document_->at(index_) != '{') {
+        return nullptr;
+    }
+    const std::vector<Child>& members = children();
+    // Last match wins, as in nlohmann::json::parse
+    for (auto it = members.rbegin(); it != members.rend(); ++it) {
+        std::string_view name = document_->token(it->key);
+        if (name.size() < 2 || name.back() != '"') {
+            fail(document_->structurals[it->key], "invalid string key");
+        }
+        name = name.substr(1, name.size() - 2);
+        if (name.find('\\') == std::string_view::npos) {
+            if (name == key) {
+                return &*it;
+            }
+        } else if (decode(document_->token(it->key)).get_ref<const std::string&>() == key) {
+            // Escaped keys are rare; decode them the slow way.
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+bool LazyJson::contains(std::string_view key) const {
+    return findKey(key) != nullptr;
+}
+
+LazyJson LazyJson::operator[](std::string_view key) const {
+    const Child* child = findKey(key);
+    if (child == nullptr) {
+        throw std::out_of_range("key '" + std::string(key) + "' not found");
+    }
+    return LazyJson(document_, child->value, child->end);
+}
+
+LazyJson LazyJson::operator[](std::size_t index) const {
+    if (document_->at(index_) != '[') {
+        throw std::out_of_range("cannot use an index with a value that is not an array");
+    }
+    const std::vector<Child>& elements = children();
+    if (index >= elements.size()) {
+        throw std::out_of_range("array index " + std::to_string(index) + " is out of range");
+    }
+    return LazyJson(document_, elements[index].value, elements[index].end);
+}
+
+std::size_t LazyJson::size() const {
+    switch (document_->at(index_)) {
+    case '{':
+    case '[':
+        return children().size();
+    case 'n':
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+const nlohmann::json& LazyJson::materialize() const {
+    const auto cached = document_->values.find(index_);
+    if (cached != document_->values.end()) {
+        return cached->second;
+    }
+    return document_->values.emplace(index_, decode(raw())).first->second;
+}
+
+std::string_view LazyJson::raw() const {
+    const char c = document_->at(index_);
+    if (c != '{' && c != '[') {
+        return document_->token(index_);
+    }
+    const std::size_t begin = document_->structurals[index_];
+    return document_->input.substr(begin, document_->structurals[end_ - 1] + 1 - begin);
+}
+
+LazyJson::Iterator LazyJson::begin() const {
+    return Iterator(document_, children().data());
+}
+
+LazyJson::Iterator LazyJson::end() const {
+    const std::vector<Child>& list = children();
+    return Iterator(document_, list.data() + list.size());
+}
+
+std::string LazyJson::Iterator::key() const {
+    if (pos_->key == kNoKey) {
+        throw std::invalid_argument("key() is only available when iterating an object");
+    }
+    return decode(document_->token(pos_->key)).get<std::string>();
+}
@@ -1,44 +1,69 @@
 #include <iostream>
+#include <iomanip>
 #include <fstream>
+#include <limits>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <optional>
 #include <string>
-#include <unistd.h>  // for isatty
+#include <string_view>
+#include <vector>
+#include <sys/resource.h>  // for getrusage
+#include <unistd.h>  // for isatty, STDOUT_FILENO
 #include <nlohmann/json.hpp>
+#include "file_input.h"
+#include "json_bind.h"
+#include "json_cache.h"
+#include "json_columnar.h"
+#include "json_query.h"
+#include "json_shape.h"
+#include "json_stream.h"
+#include "json_tape.h"
+#include "json_writer.h"
+#include "lazy_json.h"
+#include "ndjson.h"
+#include "ndjson_index.h"
+#include "parser_backend.h"
+#include "person.h"
+#include "structural_index.h"
 
 using json = nlohmann::json;
 
-void printJsonInfo(const json& j) {
-    std::cout << "\n=== JSON Content ===" << std::endl;
-    std::cout << "Pretty printed JSON:" << std::endl;
-    std::cout << j.dump(2) << std::endl;
-    
+/**
+ * @brief Print the sample fields; works with json and LazyJson alike
+ */
+template <typename Json>
+void printParsedValues(const Json& j) {
     std::cout << "\n=== Parsed Values ===" << std::endl;
     
     // Access individual values
     if (j.contains("name")) {
-        std::cout << "Name: " << j["name"].get<std::string>() << std::endl;
+        std::cout << "Name: " << j["name"].template get<std::string>() << std::endl;
     }
     
     if (j.contains("age")) {
-        std::cout << "Age: " << j["age"].get<int>() << std::endl;
+        std::cout << "Age: " << j["age"].template get<int>() << std::endl;
     }
     
     if (j.contains("city")) {
-        std::cout << "City: " << j["city"].get<std::string>() << std::endl;
+        std::cout << "City: " << j["city"].template get<std::string>() << std::endl;
     }
     
     if (j.contains("active")) {
-        std::cout << "Active: " << (j["active"].get<bool>() ? "Yes" : "No") << std::endl;
+        std::cout << "Active: " << (j["active"].template get<bool>() ? "Yes" : "No") << std::endl;
     }
     
     if (j.contains("salary")) {
-        std::cout << "Salary: $" << j["salary"].get<double>() << std::endl;
+        std::cout << "Salary: $" << j["salary"].template get<double>() << std::endl;
     }
     
     // Access array
     if (j.contains("skills") && j["skills"].is_array()) {
         std::cout << "Skills: ";
         for (const auto& skill : j["skills"]) {
-            std::cout << skill.get<std::string>() << " ";
+            std::cout << skill.template get<std::string>() << " ";
         }
         std::cout << std::endl;
     }
@@ -48,40 +73,610 @@ void printJsonInfo(const json& j) {
         const auto& address = j["address"];
         std::cout << "Address: ";
         if (address.contains("street")) {
-            std::cout << address["street"].get<std::string>();
+            std::cout << address["street"].template get<std::string>();
         }
         if (address.contains("zipcode")) {
-            std::cout << ", " << address["zipcode"].get<std::string>();
+            std::cout << ", " << address["zipcode"].template get<std::string>();
         }
         std::cout << std::endl;
     }
 }
 
-bool loadJsonFromFile(const std::string& filename, json& j) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
-        return false;
+void printJsonInfo(const json& j) {
+    std::cout << "\n=== JSON Content ===" << std::endl;
+    std::cout << "Pretty printed JSON:" << std::endl;
+    try {
+        // Stream the text to stdout instead of building it with dump(2);
+        // std::endl above has flushed std::cout, so the output stays in order.
+        JsonWriter writer(STDOUT_FILENO, 2);
+        writer.write(j);
+        writer.flush();
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
     }
-    
+    std::cout << std::endl;
+    printParsedValues(j);
+}
+
+bool loadJsonFromFile(const std::string& filename, json& j, ParserBackend backend = ParserBackend::Nlohmann,
+                      const JsonCache* cache = nullptr) {
     try {
-        file >> j;
+        if (cache != nullptr) {
+            CacheInfo info;
+            j = cache->load(filename, &info);
+            std::cout << "Cache " << JsonCache::statusName(info.status) << ": " << info.cachePath << " ("
+                      << info.cacheBytes << " bytes, " << std::fixed << std::setprecision(3) << info.seconds * 1e3
+                      << " ms)" << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+            return true;
+        }
+        // Parse straight from the mapped file, no iostream in between
+        const FileInput input(filename);
+        j = parseJson(input.view(), backend);
         return true;
-    } catch (const json::parse_error& e) {
-        std::cerr << "JSON parse error: " << e.what() << std::endl;
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
         return false;
     }
 }
 
+void printJsonSummary(const JsonSummary& summary) {
+    std::cout << "\n=== Streamed Values ===" << std::endl;
+
+    // Same fields and order as printJsonInfo, without a DOM
+    if (summary.name) {
+        std::cout << "Name: " << *summary.name << std::endl;
+    }
+    if (summary.age) {
+        std::cout << "Age: " << *summary.age << std::endl;
+    }
+    if (summary.city) {
+        std::cout << "City: " << *summary.city << std::endl;
+    }
+    if (summary.active) {
+        std::cout << "Active: " << (*summary.active ? "Yes" : "No") << std::endl;
+    }
+    if (summary.salary) {
+        std::cout << "Salary: $" << *summary.salary << std::endl;
+    }
+    if (summary.skills) {
+        std::cout << "Skills: ";
+        for (const std::string& skill : *summary.skills) {
+            std::cout << skill << " ";
+        }
+        std::cout << std::endl;
+    }
+    if (summary.hasAddress) {
+        std::cout << "Address: ";
+        if (summary.street) {
+            std::cout << *summary.street;
+        }
+        if (summary.zipcode) {
+            std::cout << ", " << *summary.zipcode;
+        }
+        std::cout << std::endl;
+    }
+}
+
+int runStream(const std::string& filename) {
+    try {
+        StreamStats stats;
+        const JsonSummary summary = summarizeJsonFile(filename, &stats);
+        printJsonSummary(summary);
+
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        std::cout << "\nStreamed " << stats.bytes << " bytes (" << stats.events << " events) in " << std::fixed
+                  << std::setprecision(3) << stats.seconds << " s, " << std::setprecision(1)
+                  << stats.bytesPerSecond() / 1e6 << " MB/s, peak RSS " << usage.ru_maxrss / 1024 << " MB"
+                  << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int runBind(const std::string& filename) {
+    try {
+        // Typed binding: fields go straight from the token stream into Person
+        const FileInput input(filename);
+        Person person;
+        const BindResult result = bindJson(input.view(), person);
+
+        std::cout << "\n=== Bound Person ===" << std::endl;
+        std::cout << "Name: " << person.name << std::endl;
+        std::cout << "Age: " << person.age << std::endl;
+        std::cout << "City: " << person.city << std::endl;
+        std::cout << "Active: " << (person.active ? "Yes" : "No") << std::endl;
+        std::cout << "Salary: $" << person.salary << std::endl;
+        std::cout << "Skills: ";
+        for (const std::string& skill : person.skills) {
+            std::cout << skill << " ";
+        }
+        std::cout << std::endl;
+        std::cout << "Address: " << person.address.street << ", " << person.address.zipcode << std::endl;
+
+        for (const BindIssue& issue : result.issues) {
+            std::cerr << "Field " << issue.path << ": " << issue.message << std::endl;
+        }
+        return result.ok() ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int runLazy(const std::string& filename) {
+    try {
+        // Only the fields printParsedValues reads are ever decoded
+        const LazyJson document = LazyJson::load(filename);
+        printParsedValues(document);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int runQuery(int argc, char* argv[]) {
+    // --query <file> <expression>...
+    try {
+        const JsonQuery query(std::vector<std::string>(argv + 3, argv + argc));
+        const FileInput input(argv[2]);
+        std::size_t matches = 0;
+        query.run(input.view(), [&](const JsonQuery::Match& match) {
+            std::cout << query.expression(match.expression) << '\t' << match.value << '\n';
+            ++matches;
+        });
+        std::cout.flush();
+        return matches > 0 ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int runNdjsonShapes(const std::string& filename) {
+    try {
+        // Every record is kept, with interned keys and shared shapes
+        const FileInput input(filename);
+        const auto start = std::chrono::steady_clock::now();
+        ShapedDocument document;
+        const std::string_view text = input.view();
+        std::uint64_t records = 0;
+        std::uint64_t failed = 0;
+        std::uint64_t line = 0;
+        for (std::size_t pos = 0; pos < text.size();) {
+            const std::size_t end = std::min(text.find('\n', pos), text.size());
+            const std::string_view record = text.substr(pos, end - pos);
+            pos = end + 1;
+            ++line;
+            if (record.find_first_not_of(" \t\r") == std::string_view::npos) {
+                continue;
+            }
+            try {
+                document.parse(record);
+                ++records;
+            } catch (const std::runtime_error& e) {
+                std::cerr << "line " << line << ": " << e.what() << std::endl;
+                ++failed;
+            }
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Shapes: " << records << " records, " << failed << " failed, "
+                  << SymbolTable::global().size() << " keys, " << ShapeTable::global().size() << " shapes, "
+                  << document.arena().bytesUsed() << " arena bytes in " << std::fixed << std::setprecision(3)
+                  << seconds << " s" << std::endl;
+        return failed == 0 ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+/// Parse text that is a whole non-negative number; false for anything else
+template <typename T>
+bool parseCount(std::string_view text, T& value) {
+    const char* end = text.data() + text.size();
+    const auto [next, ec] = std::from_chars(text.data(), end, value);
+    return !text.empty() && ec == std::errc() && next == end;
+}
+
+int runNdjson(int argc, char* argv[]) {
+    // --ndjson <file> [--workers N] [--unordered] [--shapes]
+    NdjsonOptions options;
+    for (int i = 3; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--workers") {
+            if (!parseCount(i + 1 < argc ? argv[++i] : "", options.workers)) {
+                std::cerr << "Error: --workers must be a number of threads" << std::endl;
+                return 1;
+            }
+        } else if (flag == "--unordered") {
+            options.ordered = false;
+        } else if (flag == "--shapes") {
+            return runNdjsonShapes(argv[2]);
+        } else {
+            std::cerr << "Error: Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        const FileInput input(argv[2]);
+        NdjsonProcessor processor(options);
+        // Every valid record is written back compact, one per line.
+        const NdjsonResult result = processor.run(
+            input.view(),
+            [](json& record, std::string& out) {
+                out += record.dump();
+                out += '\n';
+            },
+            [](std::string_view output) { std::fwrite(output.data(), 1, output.size(), stdout); });
+        std::fflush(stdout);
+
+        // Records go to stdout, so the summary goes to stderr.
+        for (const NdjsonError& error : result.errors) {
+            std::cerr << "line " << error.line << ": " << error.message << std::endl;
+        }
+        std::cerr << "NDJSON: " << result.records << " records, " << result.failedRecords << " failed, "
+                  << result.bytes << " bytes in " << std::fixed << std::setprecision(3) << result.seconds << " s ("
+                  << std::setprecision(1) << result.bytesPerSecond() / 1e6 << " MB/s, " << result.workers
+                  << " workers)" << std::endl;
+        return result.failedRecords == 0 ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int runIndex(int argc, char* argv[]) {
+    // --index <file> [--key FIELD] [--workers N] [--rebuild] [--get N]... [--find KEY]...
+    NdjsonIndexOptions options;
+    bool rebuild = false;
+    std::vector<std::pair<bool, std::string>> lookups;  // (by key, argument)
+    for (int i = 3; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--key" && i + 1 < argc) {
+            options.keyField = argv[++i];
+        } else if (flag == "--workers") {
+            if (!parseCount(i + 1 < argc ? argv[++i] : "", options.workers)) {
+                std::cerr << "Error: --workers must be a number of threads" << std::endl;
+                return 1;
+            }
+        } else if (flag == "--rebuild") {
+            rebuild = true;
+        } else if ((flag == "--get" || flag == "--find") && i + 1 < argc) {
+            lookups.emplace_back(flag == "--find", argv[++i]);
+            if (std::uint64_t number = 0; flag == "--get" && !parseCount(lookups.back().second, number)) {
+                std::cerr << "Error: --get must be a record number" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        if (options.keyField.empty()) {
+            // Keep the key field of an existing index unless --key names another
+            try {
+                options.keyField = NdjsonIndex::readKeyField(argv[2]);
+            } catch (const std::runtime_error&) {
+                // No usable index: build one without keys
+            }
+        }
+        const NdjsonIndexStats stats =
+            rebuild ? NdjsonIndex::build(argv[2], options) : NdjsonIndex::update(argv[2], options);
+        static const char* const kStatus[] = {"built", "appended", "up to date"};
+        std::cerr << "Index " << NdjsonIndex::defaultPath(argv[2]) << ": "
+                  << kStatus[static_cast<int>(stats.status)] << ", " << stats.records << " records ("
+                  << stats.newRecords << " new), " << stats.keys << " keys, " << stats.bytesScanned
+                  << " bytes scanned in " << std::fixed << std::setprecision(3) << stats.seconds << " s"
+                  << std::endl;
+
+        // Each lookup prints one record, found by number or by key
+        const NdjsonIndex index(argv[2]);
+        int status = 0;
+        for (const auto& [byKey, argument] : lookups) {
+            std::optional<std::uint64_t> record;
+            if (byKey) {
+                record = index.find(argument);
+            } else if (std::uint64_t number = 0; parseCount(argument, number) && number < index.size()) {
+                record = number;
+            }
+            if (!record) {
+                std::cerr << "No record " << argument << std::endl;
+                status = 2;
+                continue;
+            }
+            std::cout << index.at(*record).dump() << '\n';
+        }
+        std::cout.flush();
+        return status;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int runColumnar(int argc, char* argv[]) {
+    // --columnar <file> [--out PATH] [--workers N]
+    ColumnarOptions options;
+    std::string out = ColumnarFile::defaultPath(argv[2]);
+    for (int i = 3; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--out" && i + 1 < argc) {
+            out = argv[++i];
+        } else if (flag == "--workers") {
+            if (!parseCount(i + 1 < argc ? argv[++i] : "", options.workers)) {
+                std::cerr << "Error: --workers must be a number of threads" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        const ColumnarStats stats = ColumnarFile::convert(argv[2], out, options);
+        for (const NdjsonError& error : stats.errors) {
+            std::cerr << "line " << error.line << ": " << error.message << std::endl;
+        }
+        std::cout << "\nColumnar: " << out << ": " << stats.rows << " rows, " << stats.failedRecords << " failed, "
+                  << stats.columns << " columns, " << stats.rowGroups << " row groups, " << stats.bytesIn << " -> "
+                  << stats.bytesOut << " bytes in " << std::fixed << std::setprecision(3) << stats.seconds << " s"
+                  << std::endl;
+        return stats.failedRecords == 0 ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int runAggregate(int argc, char* argv[]) {
+    // --aggregate <file.cols> <column>... [--by COLUMN]
+    std::vector<std::string> columns;
+    std::optional<std::string> by;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--by" && i + 1 < argc) {
+            by = argv[++i];
+        } else {
+            columns.push_back(arg);
+        }
+    }
+
+    try {
+        const ColumnarFile file(argv[2]);
+        std::cout << std::setprecision(std::numeric_limits<double>::max_digits10 - 2);
+        const auto print = [&by](const std::string& group, const std::string& column, const ColumnAggregate& result) {
+            std::cout << (by ? group + '\t' : std::string()) << column << '\t' << result.count << '\t'
+                      << result.nulls << '\t' << result.skipped << '\t' << result.sum << '\t' << result.min << '\t'
+                      << result.max << '\t' << result.mean() << '\n';
+            if (result.skipped > 0) {
+                std::cerr << "Warning: " << result.skipped << " non-numeric values of " << column
+                          << (by ? " in group " + group : std::string()) << " are not aggregated" << std::endl;
+            }
+        };
+        // One line per column (and group): count, nulls, skipped, sum, min, max, mean
+        for (const std::string& column : columns) {
+            if (by) {
+                for (const auto& [group, result] : file.aggregateBy(*by, column)) {
+                    print(group, column, result);
+                }
+            } else {
+                print("", column, file.aggregate(column));
+            }
+        }
+        std::cout.flush();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+/// Best wall time of a few runs of fn, in seconds
+template <typename Fn>
+double bestSeconds(Fn&& fn) {
+    constexpr int kRounds = 3;
+    double best = 0.0;
+    for (int round = 0; round < kRounds; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = round == 0 ? seconds : std::min(best, seconds);
+    }
+    return best;
+}
+
+void printTiming(const char* label, std::size_t bytes, double seconds) {
+    std::cout << "  " << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << seconds * 1e3 << " ms" << std::setprecision(1) << std::setw(10)
+              << static_cast<double>(bytes) / seconds / 1e6 << " MB/s" << std::endl;
+}
+
+int runCompare(int argc, char* argv[]) {
+    // --compare [--simd-level scalar|sse2|avx2] <file>...
+    std::vector<std::string> files;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--simd-level" && i + 1 < argc) {
+            const std::string name = argv[++i];
+            StructuralIndex::SimdLevel level = StructuralIndex::SimdLevel::Scalar;
+            if (name == "avx2") {
+                level = StructuralIndex::SimdLevel::AVX2;
+            } else if (name == "sse2") {
+                level = StructuralIndex::SimdLevel::SSE2;
+            } else if (name != "scalar") {
+                std::cerr << "Error: Unknown SIMD level " << name << std::endl;
+                return 1;
+            }
+            StructuralIndex::setSimdLevel(level);
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    std::cout << "\n=== Parser backend comparison (stage 1: "
+              << StructuralIndex::simdLevelName(StructuralIndex::simdLevel()) << ", detected "
+              << StructuralIndex::simdLevelName(StructuralIndex::detectedSimdLevel()) << ") ===" << std::endl;
+    int mismatches = 0;
+    std::size_t totalBytes = 0;
+    double totalNlohmann = 0.0;
+    double totalSimd = 0.0;
+    for (const std::string& file : files) {
+        try {
+            const FileInput input(file);
+            const std::string_view text = input.view();
+            std::cout << file << ": " << text.size() << " bytes" << std::endl;
+
+            // Both backends must agree on whether the text is valid at all.
+            std::string nlohmannError;
+            std::string simdError;
+            json expected;
+            json actual;
+            try {
+                expected = parseJson(text, ParserBackend::Nlohmann);
+            } catch (const std::runtime_error& e) {
+                nlohmannError = e.what();
+            }
+            try {
+                actual = parseJson(text, ParserBackend::Simd);
+            } catch (const std::runtime_error& e) {
+                simdError = e.what();
+            }
+            if (!nlohmannError.empty() || !simdError.empty()) {
+                const bool agree = !nlohmannError.empty() && !simdError.empty();
+                std::cout << "  nlohmann: " << (nlohmannError.empty() ? "accepted" : nlohmannError) << std::endl;
+                std::cout << "  simd:     " << (simdError.empty() ? "accepted" : simdError) << std::endl;
+                std::cout << "  result:   " << (agree ? "both rejected" : "MISMATCH") << std::endl;
+                mismatches += agree ? 0 : 1;
+                continue;
+            }
+
+            std::vector<std::uint32_t> structurals;
+            JsonTape tape;
+            const double nlohmannSeconds = bestSeconds([&] { expected = parseJson(text, ParserBackend::Nlohmann); });
+            const double stage1Seconds = bestSeconds([&] { structurals = StructuralIndex::build(text); });
+            const double stage2Seconds = bestSeconds([&] { tape = JsonTape::parse(text, structurals); });
+            const double domSeconds = bestSeconds([&] { actual = tape.toJson(); });
+            const double simdSeconds = stage1Seconds + stage2Seconds + domSeconds;
+
+            printTiming("nlohmann", text.size(), nlohmannSeconds);
+            printTiming("simd stage 1 (index)", text.size(), stage1Seconds);
+            printTiming("simd stage 2 (tape)", text.size(), stage2Seconds);
+            printTiming("simd tape -> json", text.size(), domSeconds);
+            printTiming("simd total", text.size(), simdSeconds);
+            printTiming("simd to tape only", text.size(), stage1Seconds + stage2Seconds);
+            const bool identical = expected == actual;
+            std::cout << "  result:   " << (identical ? "identical" : "MISMATCH") << " (" << structurals.size()
+                      << " structurals, " << tape.size() << " tape words)" << std::endl;
+            mismatches += identical ? 0 : 1;
+            totalBytes += text.size();
+            totalNlohmann += nlohmannSeconds;
+            totalSimd += simdSeconds;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << file << ": " << e.what() << std::endl;
+            ++mismatches;
+        }
+    }
+
+    if (totalBytes > 0) {
+        std::cout << "corpus: " << totalBytes << " bytes" << std::endl;
+        printTiming("nlohmann", totalBytes, totalNlohmann);
+        printTiming("simd total", totalBytes, totalSimd);
+    }
+    std::cout << mismatches << " mismatch(es)" << std::endl;
+    return mismatches == 0 ? 0 : 2;
+}
+
 int main(int argc, char* argv[]) {
+    // NDJSON mode writes records to stdout, so it prints no banner.
+    if (argc > 2 && std::string(argv[1]) == "--ndjson") {
+        return runNdjson(argc, argv);
+    }
+
+    // Query mode prints one "expression<TAB>value" line per match, no banner.
+    if (argc > 3 && std::string(argv[1]) == "--query") {
+        return runQuery(argc, argv);
+    }
+
+    // Index mode: build or update the offset index, then print looked-up records
+    if (argc > 2 && std::string(argv[1]) == "--index") {
+        return runIndex(argc, argv);
+    }
+
+    // Aggregate mode prints one tab-separated line per column and group, no banner.
+    if (argc > 3 && std::string(argv[1]) == "--aggregate") {
+        return runAggregate(argc, argv);
+    }
+
     std::cout << "JSON Parser Demo" << std::endl;
+
+    // Streaming mode: extract the summary fields without building a DOM
+    if (argc > 2 && std::string(argv[1]) == "--stream") {
+        return runStream(argv[2]);
+    }
+
+    // Typed binding into Person, reporting missing and mismatched fields
+    if (argc > 2 && std::string(argv[1]) == "--bind") {
+        return runBind(argv[2]);
+    }
+
+    // Lazy DOM: index the file, decode only the fields that are read
+    if (argc > 2 && std::string(argv[1]) == "--lazy") {
+        return runLazy(argv[2]);
+    }
+
+    // Shred NDJSON records into a columnar file for aggregate scans
+    if (argc > 2 && std::string(argv[1]) == "--columnar") {
+        return runColumnar(argc, argv);
+    }
+
+    // Run both parser backends over a corpus and compare results and speed
+    if (argc > 2 && std::string(argv[1]) == "--compare") {
+        return runCompare(argc, argv);
+    }
+
+    // --backend nlohmann|simd selects the parser for the demo file,
+    // --cache cbor|msgpack|tape loads it through a binary cache instead
+    ParserBackend backend = ParserBackend::Nlohmann;
+    std::optional<JsonCache> cache;
+    for (int i = 1; i + 1 < argc; ++i) {
+        const std::string option = argv[i];
+        const std::string value = argv[i + 1];
+        if (option == "--backend") {
+            try {
+                backend = parserBackendFromName(value);
+            } catch (const std::invalid_argument& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (option == "--cache") {
+            if (value == "cbor") {
+                cache.emplace(CacheFormat::Cbor);
+            } else if (value == "msgpack") {
+                cache.emplace(CacheFormat::MessagePack);
+            } else if (value == "tape") {
+                cache.emplace(CacheFormat::Tape);
+            } else {
+                std::cerr << "Error: Unknown cache format " << value << " (expected cbor, msgpack or tape)" << std::endl;
+                return 1;
+            }
+        }
+    }
     
     // CI/CD friendly: Skip interactive mode if --ci flag is provided
     bool ciMode = (argc > 1 && std::string(argv[1]) == "--ci");
     
     // Try to load sample JSON file
     json j;
-    if (loadJsonFromFile("data/sample.json", j)) {
+    if (loadJsonFromFile("data/sample.json", j, backend, cache ? &*cache : nullptr)) {
         printJsonInfo(j);
     } else {
         std::cout << "Failed to load sample.json, creating sample JSON in memory..." << std::endl;
@@ -126,7 +721,7 @@ int main(int argc, char* argv[]) {
                 json userJson = json::parse(input);
                 std::cout << "Parsed JSON:" << std::endl;
                 std::cout << userJson.dump(2) << std::endl;
-            } catch (const json::parse_error& e) {
+            } catch (const json::exception& e) {
                 std::cout << "Invalid JSON: " << e.what() << std::endl;
             }
             
@@ -0,0 +1,171 @@
+#include "ndjson.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Everything a worker produces for one chunk
+ */
+struct ChunkResult {
+    std::string output;
+    std::vector<NdjsonError> errors;  ///< Line numbers relative to the chunk, 1-based
+    std::uint64_t records = 0;
+    std::uint64_t failedRecords = 0;
+    std::uint64_t lines = 0;
+};
+
+bool isBlank(std::string_view line) {
+    return std::all_of(line.begin(), line.end(), [](char c) { return c == ' ' || c == '\t' || c == '\r'; });
+}
+
+void processChunk(std::string_view chunk, const NdjsonProcessor::RecordFn& recordFn, std::size_t maxErrors,
+                  ChunkResult& result) {
+    nlohmann::json record;
+    std::size_t pos = 0;
+    while (pos < chunk.size()) {
+        const void* newline = std::memchr(chunk.data() + pos, '\n', chunk.size() - pos);
+        const std::size_t end = newline != nullptr ? static_cast<std::size_t>(static_cast<const char*>(newline) - chunk.data())
+                                                   : chunk.size();
+        const std::string_view line = chunk.substr(pos, end - pos);
+        pos = end + 1;
+        ++result.lines;
+        if (isBlank(line)) {
+            continue;
+        }
+        try {
+            record = nlohmann::json::parse(line.begin(), line.end());
+            recordFn(record, result.output);
+            ++result.records;
+        } catch (const std::exception& e) {
+            ++result.failedRecords;
+            if (result.errors.size() < maxErrors) {
+                result.errors.push_back({result.lines, e.what()});
+            }
+        }
+    }
+}
+
+} // namespace
+
+NdjsonProcessor::NdjsonProcessor(NdjsonOptions options) : options_(options) {
+    if (options_.workers == 0) {
+        options_.workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options_.chunkBytes = std::max<std::size_t>(options_.chunkBytes, 1);
+}
+
+std::vector<std::string_view> NdjsonProcessor::split(std::string_view input, std::size_t chunkBytes) {
+    std::vector<std::string_view> chunks;
+    std::size_t begin = 0;
+    while (begin < input.size()) {
+        std::size_t end = begin + chunkBytes;
+        if (end >= input.size()) {
+            end = input.size();
+        } else {
+            const void* newline = std::memchr(input.data() + end - 1, '\n', input.size() - end + 1);
+            end = newline != nullptr ? static_cast<std::size_t>(static_cast<const char*>(newline) - input.data()) + 1
+                                     : input.size();
+        }
+        chunks.push_back(input.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+NdjsonResult NdjsonProcessor::run(std::string_view input, const RecordFn& record, const SinkFn& sink) const {
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<std::string_view> chunks = split(input, options_.chunkBytes);
+    const std::size_t workers = std::max<std::size_t>(1, std::min(options_.workers, chunks.size()));
+    const std::size_t window = workers * kChunksAheadPerWorker;
+
+    // Per chunk: line count (for absolute line numbers) and errors, kept until
+    // the end. Output is only held until it has been emitted.
+    std::vector<ChunkResult> results(chunks.size());
+    std::vector<char> finished(chunks.size(), 0);
+    std::atomic<std::size_t> nextChunk{0};
+    std::mutex mutex;
+    std::condition_variable emitted;
+    std::size_t nextEmit = 0;
+    bool emitting = false;  // one worker at a time drains ready chunks into the sink
+    std::mutex sinkMutex;   // unordered mode only
+
+    const auto work = [&] {
+        while (true) {
+            const std::size_t index = nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (index >= chunks.size()) {
+                return;
+            }
+            if (options_.ordered) {
+                // The oldest unfinished chunk is always below this bound, so
+                // whoever holds it never waits here.
+                std::unique_lock<std::mutex> lock(mutex);
+                emitted.wait(lock, [&] { return index < nextEmit + window; });
+            }
+
+            ChunkResult& result = results[index];
+            processChunk(chunks[index], record, options_.maxErrors, result);
+
+            if (!options_.ordered) {
+                std::lock_guard<std::mutex> lock(sinkMutex);
+                sink(result.output);
+                std::string().swap(result.output);
+                continue;
+            }
+
+            // The sink runs outside the lock, so other workers can record
+            // their chunks meanwhile; the emitting worker picks them up.
+            std::unique_lock<std::mutex> lock(mutex);
+            finished[index] = 1;
+            if (emitting) {
+                continue;
+            }
+            emitting = true;
+            while (nextEmit < chunks.size() && finished[nextEmit]) {
+                ChunkResult& ready = results[nextEmit];
+                lock.unlock();
+                sink(ready.output);
+                std::string().swap(ready.output);
+                lock.lock();
+                ++nextEmit;
+                emitted.notify_all();
+            }
+            emitting = false;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    NdjsonResult total;
+    total.bytes = input.size();
+    total.chunks = chunks.size();
+    total.workers = workers;
+    std::uint64_t firstLine = 0;
+    for (ChunkResult& result : results) {
+        total.records += result.records;
+        total.failedRecords += result.failedRecords;
+        for (NdjsonError& error : result.errors) {
+            if (total.errors.size() < options_.maxErrors) {
+                error.line += firstLine;
+                total.errors.push_back(std::move(error));
+            }
+        }
+        firstLine += result.lines;
+    }
+    total.lines = firstLine;
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total;
+}
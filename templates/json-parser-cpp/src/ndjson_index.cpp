@@ -0,0 +1,522 @@
+#include "ndjson_index.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "file_input.h"
+#include "json_cache.h"
+#include "json_query.h"
+#include "ndjson.h"
+
+namespace {
+
+constexpr char kMagic[8] = {'N', 'D', 'J', 'S', 'O', 'N', 'I', 'X'};
+
+/// Source bytes hashed at each end of the indexed prefix
+constexpr std::uint64_t kHashedBytes = 4096;
+
+/**
+ * @brief Fixed header of an index file
+ *
+ * Followed by the key field name padded to 8 bytes, records uint64
+ * offsets, and keys (hash, record) pairs sorted by hash, then record.
+ */
+struct IndexHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t keyFieldBytes;
+    std::uint64_t sourceBytes;   ///< Length of the indexed prefix
+    std::uint64_t coveredBytes;  ///< Past the last newline; later bytes are rescanned on update
+    std::int64_t sourceMtimeNs;  ///< Source modification time when the prefix was checked
+    std::uint64_t sourceHash;    ///< Hash of the whole prefix
+    std::uint64_t headHash;      ///< Hash of the prefix's first kHashedBytes
+    std::uint64_t tailHash;      ///< Hash of the prefix's last kHashedBytes
+    std::uint64_t records;
+    std::uint64_t keys;
+};
+
+/// Modification time of a file in nanoseconds, or 0 if it cannot be read
+std::int64_t mtimeNs(const std::string& path) {
+    struct stat info {};
+    if (::stat(path.c_str(), &info) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<std::int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    return static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+}
+
+std::uint64_t padded(std::uint64_t bytes) {
+    return (bytes + 7) & ~std::uint64_t{7};
+}
+
+/// Head and tail hashes of the first bytes of a source
+std::pair<std::uint64_t, std::uint64_t> prefixHashes(std::string_view source, std::uint64_t bytes) {
+    const std::size_t hashed = static_cast<std::size_t>(std::min(bytes, kHashedBytes));
+    return {JsonCache::hashBytes(source.substr(0, hashed)),
+            JsonCache::hashBytes(source.substr(static_cast<std::size_t>(bytes) - hashed, hashed))};
+}
+
+bool isBlank(std::string_view line) {
+    return std::all_of(line.begin(), line.end(), [](char c) { return c == ' ' || c == '\t' || c == '\r'; });
+}
+
+/// JSON Pointer to a top-level field
+std::string pointerTo(const std::string& field) {
+    std::string pointer = "/";
+    for (const char c : field) {
+        if (c == '~') {
+            pointer += "~0";
+        } else if (c == '/') {
+            pointer += "~1";
+        } else {
+            pointer += c;
+        }
+    }
+    return pointer;
+}
+
+/**
+ * @brief Key of one record: the decoded string value or the raw JSON text
+ * @return false if the record lacks the field
+ */
+bool extractKey(const JsonQuery& query, std::string_view line, std::string& key) {
+    bool found = false;
+    query.run(line, [&](const JsonQuery::Match& match) {
+        // A repeated field: the last value wins, as in nlohmann::json::parse
+        found = true;
+        const std::string_view text = match.text();
+        if (match.value.front() == '"' && text.find('\\') != std::string_view::npos) {
+            key = match.parse().get<std::string>();
+        } else {
+            key.assign(text.data(), text.size());
+        }
+    });
+    return found;
+}
+
+/// Everything a worker produces for one chunk
+struct ChunkIndex {
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> keys;  ///< (hash, record within the chunk)
+};
+
+void writeAll(int fd, const void* data, std::size_t size, const std::string& path) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = ::write(fd, p, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Could not write " + path + ": " + std::strerror(errno));
+        }
+        p += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+/// A mapped index file with its sections located and sizes checked
+struct IndexFile {
+    std::unique_ptr<FileInput> file;
+    IndexHeader header{};
+    std::string keyField;
+    const std::uint64_t* offsets = nullptr;
+    const std::uint64_t* keys = nullptr;  ///< header.keys (hash, record) pairs
+};
+
+IndexFile openIndex(const std::string& path) {
+    IndexFile index;
+    index.file = std::make_unique<FileInput>(path);
+    const std::string_view bytes = index.file->view();
+    if (bytes.size() < sizeof(IndexHeader)) {
+        throw std::runtime_error("Index " + path + " is truncated");
+    }
+    std::memcpy(&index.header, bytes.data(), sizeof(IndexHeader));
+    const IndexHeader& header = index.header;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != NdjsonIndex::kVersion) {
+        throw std::runtime_error(path + " is not an NDJSON index of this version");
+    }
+    const std::uint64_t fieldBytes = padded(header.keyFieldBytes);
+    const std::uint64_t limit = bytes.size();
+    if (fieldBytes > limit || header.records > limit / 8 || header.keys > limit / 16 ||
+        sizeof(IndexHeader) + fieldBytes + header.records * 8 + header.keys * 16 != limit ||
+        header.coveredBytes > header.sourceBytes || header.keys > header.records) {
+        throw std::runtime_error("Index " + path + " is corrupt");
+    }
+    const char* p = bytes.data() + sizeof(IndexHeader);
+    index.keyField.assign(p, header.keyFieldBytes);
+    p += fieldBytes;
+    // The mapping is page-aligned and every section is a multiple of 8 bytes
+    index.offsets = reinterpret_cast<const std::uint64_t*>(p);
+    index.keys = index.offsets + header.records;
+    return index;
+}
+
+/**
+ * @brief Whether a source still starts with the prefix an index was built from
+ *
+ * The end hashes reject most rewrites cheaply. An unchanged size and
+ * modification time are trusted, as in JsonCache; otherwise the whole
+ * prefix is hashed, so an edit in the middle is found too.
+ */
+bool prefixMatches(const IndexHeader& header, std::string_view source, std::int64_t sourceMtimeNs) {
+    if (source.size() < header.sourceBytes) {
+        return false;
+    }
+    const auto hashes = prefixHashes(source, header.sourceBytes);
+    if (hashes.first != header.headHash || hashes.second != header.tailHash) {
+        return false;
+    }
+    if (source.size() == header.sourceBytes && sourceMtimeNs == header.sourceMtimeNs) {
+        return true;
+    }
+    return JsonCache::hashBytes(source.substr(0, static_cast<std::size_t>(header.sourceBytes))) == header.sourceHash;
+}
+
+/// Store a new source modification time in an existing index's header
+void updateMtime(const std::string& path, IndexHeader header, std::int64_t sourceMtimeNs) {
+    header.sourceMtimeNs = sourceMtimeNs;
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        // Best effort: a failure only means the next update hashes again.
+        [[maybe_unused]] const ssize_t written = ::pwrite(fd, &header, sizeof(header), 0);
+        ::close(fd);
+    }
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+std::string NdjsonIndex::defaultPath(const std::string& source) {
+    return source + ".idx";
+}
+
+void NdjsonIndex::scan(std::string_view region, std::uint64_t base, std::uint64_t firstRecord,
+                       const NdjsonIndexOptions& options, std::vector<std::uint64_t>& offsets,
+                       std::vector<KeyEntry>& keys) {
+    const std::vector<std::string_view> chunks = NdjsonProcessor::split(region, std::max<std::size_t>(1, options.chunkBytes));
+    std::size_t workers = options.workers;
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers = std::max<std::size_t>(1, std::min(workers, chunks.size()));
+
+    std::unique_ptr<JsonQuery> query;
+    if (!options.keyField.empty()) {
+        query = std::make_unique<JsonQuery>(std::vector<std::string>{pointerTo(options.keyField)});
+    }
+    std::vector<ChunkIndex> results(chunks.size());
+    std::atomic<std::size_t> nextChunk{0};
+    std::exception_ptr failure;
+    std::atomic<bool> failed{false};
+
+    const auto work = [&] {
+        std::string key;
+        while (!failed.load(std::memory_order_relaxed)) {
+            const std::size_t index = nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (index >= chunks.size()) {
+                return;
+            }
+            const std::string_view chunk = chunks[index];
+            const std::uint64_t chunkBase = base + static_cast<std::uint64_t>(chunk.data() - region.data());
+            ChunkIndex& result = results[index];
+            std::size_t pos = 0;
+            while (pos < chunk.size()) {
+                const void* newline = std::memchr(chunk.data() + pos, '\n', chunk.size() - pos);
+                const std::size_t end = newline != nullptr
+                                            ? static_cast<std::size_t>(static_cast<const char*>(newline) - chunk.data())
+                                            : chunk.size();
+                const std::string_view line = chunk.substr(pos, end - pos);
+                const std::size_t start = pos;
+                pos = end + 1;
+                if (isBlank(line)) {
+                    continue;
+                }
+                if (query) {
+                    try {
+                        if (extractKey(*query, line, key)) {
+                            result.keys.emplace_back(JsonCache::hashBytes(key), result.offsets.size());
+                        }
+                    } catch (const std::exception&) {
+                        // A malformed record stays reachable by number, just not by key
+                    }
+                }
+                result.offsets.push_back(chunkBase + start);
+            }
+        }
+    };
+
+    const auto guarded = [&] {
+        try {
+            work();
+        } catch (...) {
+            if (!failed.exchange(true)) {
+                failure = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(guarded);
+    }
+    guarded();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    std::uint64_t record = firstRecord;
+    for (const ChunkIndex& result : results) {
+        for (const auto& [hash, local] : result.keys) {
+            keys.push_back({hash, record + local});
+        }
+        offsets.insert(offsets.end(), result.offsets.begin(), result.offsets.end());
+        record += result.offsets.size();
+    }
+}
+
+NdjsonIndexStats NdjsonIndex::build(const std::string& source, const NdjsonIndexOptions& options,
+                                    const std::string& indexPath) {
+    return write(source, options, indexPath.empty() ? defaultPath(source) : indexPath, false);
+}
+
+NdjsonIndexStats NdjsonIndex::update(const std::string& source, const NdjsonIndexOptions& options,
+                                     const std::string& indexPath) {
+    return write(source, options, indexPath.empty() ? defaultPath(source) : indexPath, true);
+}
+
+std::string NdjsonIndex::readKeyField(const std::string& source, const std::string& indexPath) {
+    return openIndex(indexPath.empty() ? defaultPath(source) : indexPath).keyField;
+}
+
+NdjsonIndexStats NdjsonIndex::write(const std::string& source, const NdjsonIndexOptions& options,
+                                    const std::string& path, bool incremental) {
+    const auto start = std::chrono::steady_clock::now();
+    // Taken before reading, so a change during the run makes the next update hash
+    const std::int64_t sourceMtimeNs = mtimeNs(source);
+    const FileInput input(source);
+    const std::string_view text = input.view();
+
+    NdjsonIndexStats stats;
+    std::vector<std::uint64_t> offsets;
+    std::vector<KeyEntry> keys;
+    std::uint64_t scanFrom = 0;
+
+    struct stat existing {};
+    if (incremental && ::stat(path.c_str(), &existing) == 0) {
+        try {
+            const IndexFile index = openIndex(path);
+            if (index.keyField == options.keyField && prefixMatches(index.header, text, sourceMtimeNs)) {
+                if (text.size() == index.header.sourceBytes) {
+                    if (index.header.sourceMtimeNs != sourceMtimeNs) {
+                        updateMtime(path, index.header, sourceMtimeNs);
+                    }
+                    stats.status = NdjsonIndexStatus::UpToDate;
+                    stats.records = index.header.records;
+                    stats.keys = index.header.keys;
+                    stats.seconds = secondsSince(start);
+                    return stats;
+                }
+                // Keep every record before the last newline; rescan the rest
+                scanFrom = index.header.coveredBytes;
+                const std::uint64_t* end = index.offsets + index.header.records;
+                const std::uint64_t kept =
+                    static_cast<std::uint64_t>(std::lower_bound(index.offsets, end, scanFrom) - index.offsets);
+                offsets.assign(index.offsets, index.offsets + kept);
+                const auto* entries = reinterpret_cast<const KeyEntry*>(index.keys);
+                for (std::uint64_t i = 0; i < index.header.keys; ++i) {
+                    if (entries[i].record < kept) {
+                        keys.push_back(entries[i]);
+                    }
+                }
+                stats.status = NdjsonIndexStatus::Appended;
+            }
+        } catch (const std::exception&) {
+            // Unreadable or corrupt index: rebuild it.
+        }
+    }
+
+    const std::uint64_t kept = offsets.size();
+    const std::size_t oldKeys = keys.size();
+    scan(text.substr(static_cast<std::size_t>(scanFrom)), scanFrom, kept, options, offsets, keys);
+    std::sort(keys.begin() + static_cast<std::ptrdiff_t>(oldKeys), keys.end());
+    std::inplace_merge(keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(oldKeys), keys.end());
+
+    IndexHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.keyFieldBytes = static_cast<std::uint32_t>(options.keyField.size());
+    header.sourceBytes = text.size();
+    const std::size_t lastNewline = text.rfind('\n');
+    header.coveredBytes = lastNewline == std::string_view::npos ? 0 : lastNewline + 1;
+    header.sourceMtimeNs = sourceMtimeNs;
+    header.sourceHash = JsonCache::hashBytes(text);
+    std::tie(header.headHash, header.tailHash) = prefixHashes(text, header.sourceBytes);
+    header.records = offsets.size();
+    header.keys = keys.size();
+
+    const std::string temporary = path + ".tmp." + std::to_string(::getpid());
+    const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Could not write " + temporary + ": " + std::strerror(errno));
+    }
+    try {
+        std::string field = options.keyField;
+        field.resize(padded(field.size()), '\0');
+        writeAll(fd, &header, sizeof(header), temporary);
+        writeAll(fd, field.data(), field.size(), temporary);
+        writeAll(fd, offsets.data(), offsets.size() * sizeof(std::uint64_t), temporary);
+        writeAll(fd, keys.data(), keys.size() * sizeof(KeyEntry), temporary);
+    } catch (...) {
+        ::close(fd);
+        ::unlink(temporary.c_str());
+        throw;
+    }
+    if (::close(fd) != 0 || ::rename(temporary.c_str(), path.c_str()) != 0) {
+        const std::string reason = std::strerror(errno);
+        ::unlink(temporary.c_str());
+        throw std::runtime_error("Could not write " + path + ": " + reason);
+    }
+
+    stats.records = header.records;
+    stats.keys = header.keys;
+    stats.newRecords = header.records - kept;
+    stats.bytesScanned = text.size() - scanFrom;
+    stats.seconds = secondsSince(start);
+    return stats;
+}
+
+NdjsonIndex::NdjsonIndex(const std::string& source, const std::string& indexPath) {
+    const std::string path = indexPath.empty() ? defaultPath(source) : indexPath;
+    IndexFile index = openIndex(path);
+    const IndexHeader& header = index.header;
+
+    source_ = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (source_ < 0) {
+        throw std::runtime_error("Could not open " + source + ": " + std::strerror(errno));
+    }
+    try {
+        struct stat info {};
+        if (::fstat(source_, &info) != 0) {
+            throw std::runtime_error("Could not open " + source + ": " + std::strerror(errno));
+        }
+        const std::uint64_t size = static_cast<std::uint64_t>(info.st_size);
+        // Hash the prefix ends with two small reads instead of mapping the source
+        bool matches = size == header.sourceBytes || (size > header.sourceBytes && header.coveredBytes == header.sourceBytes);
+        if (matches) {
+            const std::uint64_t hashed = std::min(header.sourceBytes, kHashedBytes);
+            std::string bytes(static_cast<std::size_t>(hashed), '\0');
+            for (const auto& [from, expected] : {std::make_pair(std::uint64_t{0}, header.headHash),
+                                                 std::make_pair(header.sourceBytes - hashed, header.tailHash)}) {
+                matches = matches && ::pread(source_, bytes.data(), bytes.size(), static_cast<off_t>(from)) ==
+                                         static_cast<ssize_t>(bytes.size()) &&
+                          JsonCache::hashBytes(bytes) == expected;
+            }
+        }
+        if (!matches) {
+            throw std::runtime_error("Index " + path + " does not match " + source + "; update it");
+        }
+        if (!index.keyField.empty()) {
+            keyQuery_ = std::make_unique<JsonQuery>(std::vector<std::string>{pointerTo(index.keyField)});
+        }
+    } catch (...) {
+        ::close(source_);
+        throw;
+    }
+
+    file_ = std::move(index.file);
+    sourceBytes_ = header.sourceBytes;
+    records_ = header.records;
+    keyCount_ = header.keys;
+    keyField_ = std::move(index.keyField);
+    offsets_ = index.offsets;
+    keys_ = reinterpret_cast<const KeyEntry*>(index.keys);
+}
+
+NdjsonIndex::~NdjsonIndex() {
+    if (source_ >= 0) {
+        ::close(source_);
+    }
+}
+
+std::uint64_t NdjsonIndex::offset(std::uint64_t index) const {
+    if (index >= records_) {
+        throw std::out_of_range("Record " + std::to_string(index) + " is out of range");
+    }
+    return offsets_[index];
+}
+
+std::string NdjsonIndex::record(std::uint64_t index) const {
+    const std::uint64_t begin = offset(index);
+    const std::uint64_t end = index + 1 < records_ ? offsets_[index + 1] : sourceBytes_;
+    if (begin >= end || end > sourceBytes_) {
+        throw std::runtime_error("Index is corrupt at record " + std::to_string(index));
+    }
+    // The span may include blank lines after the record; they are cut below
+    std::string text(static_cast<std::size_t>(end - begin), '\0');
+    std::size_t done = 0;
+    while (done < text.size()) {
+        const ssize_t read = ::pread(source_, text.data() + done, text.size() - done, static_cast<off_t>(begin + done));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            throw std::runtime_error(std::string("Could not read record: ") +
+                                     (read < 0 ? std::strerror(errno) : "file was truncated"));
+        }
+        done += static_cast<std::size_t>(read);
+    }
+    const std::size_t newline = text.find('\n');
+    if (newline != std::string::npos) {
+        text.resize(newline);
+    }
+    if (!text.empty() && text.back() == '\r') {
+        text.pop_back();
+    }
+    return text;
+}
+
+nlohmann::json NdjsonIndex::at(std::uint64_t index) const {
+    const std::string text = record(index);
+    try {
+        return nlohmann::json::parse(text);
+    } catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error("Record " + std::to_string(index) + ": " + e.what());
+    }
+}
+
+std::optional<std::uint64_t> NdjsonIndex::find(std::string_view key) const {
+    if (!keyQuery_) {
+        throw std::invalid_argument("Index has no key field");
+    }
+    const std::uint64_t hash = JsonCache::hashBytes(key);
+    const KeyEntry* end = keys_ + keyCount_;
+    const KeyEntry* first = std::partition_point(keys_, end, [&](const KeyEntry& e) { return e.hash < hash; });
+    const KeyEntry* last = std::partition_point(first, end, [&](const KeyEntry& e) { return e.hash == hash; });
+    // Newest record first; a hash collision is ruled out by reading the key back
+    std::string found;
+    while (last != first) {
+        --last;
+        if (last->record >= records_) {
+            continue;
+        }
+        if (extractKey(*keyQuery_, record(last->record), found) && found == key) {
+            return last->record;
+        }
+    }
+    return std::nullopt;
+}
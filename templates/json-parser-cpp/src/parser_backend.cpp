@@ -0,0 +1,29 @@
+#include "parser_backend.h"
+#include "json_tape.h"
+#include <stdexcept>
+
+nlohmann::json parseJson(std::string_view input, ParserBackend backend) {
+    if (backend == ParserBackend::Simd) {
+        return JsonTape::parse(input).toJson();
+    }
+    try {
+        return nlohmann::json::parse(input.begin(), input.end());
+    } catch (const nlohmann::json::exception& e) {
+        // parse_error, and out_of_range for numbers such as 1e400
+        throw std::runtime_error(e.what());
+    }
+}
+
+const char* parserBackendName(ParserBackend backend) {
+    return backend == ParserBackend::Simd ? "simd" : "nlohmann";
+}
+
+ParserBackend parserBackendFromName(const std::string& name) {
+    if (name == "nlohmann") {
+        return ParserBackend::Nlohmann;
+    }
+    if (name == "simd") {
+        return ParserBackend::Simd;
+    }
+    throw std::invalid_argument("Unknown parser backend: " + name + " (expected nlohmann or simd)");
+}
@@ -0,0 +1,317 @@
+#include "structural_index.h"
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define JSON_HAS_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define JSON_HAS_X86_SIMD 0
+#endif
+
+// GCC and Clang only emit AVX2 instructions inside functions that opt in,
+// which lets the AVX2 kernel live next to the baseline ones without
+// compiling the whole library with -mavx2.
+#if JSON_HAS_X86_SIMD && (defined(__GNUC__) || defined(__clang__))
+#define JSON_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define JSON_TARGET_AVX2
+#endif
+
+namespace {
+
+constexpr std::size_t kBlockBytes = 64;
+
+/**
+ * @brief Character classes of one 64-byte block, bit i = byte i
+ */
+struct BlockMasks {
+    std::uint64_t backslash = 0;
+    std::uint64_t quote = 0;
+    std::uint64_t op = 0;          ///< { } [ ] : ,
+    std::uint64_t whitespace = 0;  ///< space, tab, newline, carriage return
+};
+
+/**
+ * @brief State carried from one block to the next
+ */
+struct IndexState {
+    std::uint64_t escapeCarry = 0;  ///< 1 if the next block's first byte is escaped
+    std::uint64_t inString = 0;     ///< All ones if the previous block ended inside a string
+    std::uint64_t prevScalar = 0;   ///< 1 if the previous block ended inside a scalar
+};
+
+inline int countTrailingZeros(std::uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+/// Bit i of the result is the XOR of bits 0..i of x
+inline std::uint64_t prefixXor(std::uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/// Bytes preceded by an odd run of backslashes. Backslashes are rare, so
+/// walking their bits one at a time costs nothing on typical input.
+inline std::uint64_t findEscaped(std::uint64_t backslash, std::uint64_t& carry) {
+    std::uint64_t escaped = carry;
+    std::uint64_t nextCarry = 0;
+    while (backslash != 0) {
+        const int i = countTrailingZeros(backslash);
+        backslash &= backslash - 1;
+        if (((escaped >> i) & 1) == 0) {
+            if (i == 63) {
+                nextCarry = 1;
+            } else {
+                escaped |= std::uint64_t{1} << (i + 1);
+            }
+        }
+    }
+    carry = nextCarry;
+    return escaped;
+}
+
+/// Turn a block's masks into structural offsets; returns the number written
+inline std::size_t finishBlock(const BlockMasks& masks, IndexState& state, std::uint32_t base, std::uint32_t* out) {
+    const std::uint64_t escaped = masks.backslash != 0 || state.escapeCarry != 0
+                                      ? findEscaped(masks.backslash, state.escapeCarry)
+                                      : 0;
+    const std::uint64_t quotes = masks.quote & ~escaped;
+    // Opening quotes and string contents are set, closing quotes are not.
+    const std::uint64_t inString = prefixXor(quotes) ^ state.inString;
+    state.inString = static_cast<std::uint64_t>(static_cast<std::int64_t>(inString) >> 63);
+
+    const std::uint64_t scalar = ~(masks.op | masks.whitespace | masks.quote) & ~inString;
+    const std::uint64_t scalarStarts = scalar & ~((scalar << 1) | state.prevScalar);
+    state.prevScalar = scalar >> 63;
+
+    std::uint64_t structural = (masks.op & ~inString) | (quotes & inString) | scalarStarts;
+    std::size_t count = 0;
+    while (structural != 0) {
+        out[count++] = base + static_cast<std::uint32_t>(countTrailingZeros(structural));
+        structural &= structural - 1;
+    }
+    return count;
+}
+
+BlockMasks classifyScalar(const char* block) {
+    BlockMasks masks;
+    for (std::size_t i = 0; i < kBlockBytes; ++i) {
+        const std::uint64_t bit = std::uint64_t{1} << i;
+        switch (block[i]) {
+        case '\\':
+            masks.backslash |= bit;
+            break;
+        case '"':
+            masks.quote |= bit;
+            break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case ':':
+        case ',':
+            masks.op |= bit;
+            break;
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            masks.whitespace |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+    return masks;
+}
+
+#if JSON_HAS_X86_SIMD
+BlockMasks classifySse2(const char* block) {
+    BlockMasks masks;
+    for (int part = 0; part < 4; ++part) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * part));
+        // '[' | 0x20 == '{' and ']' | 0x20 == '}', so two compares cover four brackets.
+        const __m128i folded = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+        const __m128i op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(':')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8(','))));
+        const __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r'))));
+        const int shift = 16 * part;
+        masks.backslash |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(
+                               _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\')))))
+                           << shift;
+        masks.quote |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(
+                           _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')))))
+                       << shift;
+        masks.op |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(op))) << shift;
+        masks.whitespace |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(whitespace)))
+                            << shift;
+    }
+    return masks;
+}
+
+JSON_TARGET_AVX2 BlockMasks classifyAvx2(const char* block) {
+    BlockMasks masks;
+    for (int half = 0; half < 2; ++half) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * half));
+        const __m256i folded = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+        const __m256i op = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                            _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(':')),
+                            _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(','))));
+        const __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')),
+                            _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r'))));
+        const int shift = 32 * half;
+        masks.backslash |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(
+                               _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\\')))))
+                           << shift;
+        masks.quote |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(
+                           _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('"')))))
+                       << shift;
+        masks.op |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(op))) << shift;
+        masks.whitespace |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(whitespace)))
+                            << shift;
+    }
+    return masks;
+}
+#endif
+
+/**
+ * @brief Index all blocks with one classifier; the last partial block is
+ *        padded with spaces, which are whitespace and never structural
+ */
+template <BlockMasks (*Classify)(const char*)>
+std::size_t indexWith(std::string_view input, std::uint32_t* out, IndexState& state) {
+    std::size_t count = 0;
+    std::size_t offset = 0;
+    for (; offset + kBlockBytes <= input.size(); offset += kBlockBytes) {
+        count += finishBlock(Classify(input.data() + offset), state, static_cast<std::uint32_t>(offset), out + count);
+    }
+    if (offset < input.size()) {
+        char tail[kBlockBytes];
+        std::memset(tail, ' ', sizeof(tail));
+        std::memcpy(tail, input.data() + offset, input.size() - offset);
+        count += finishBlock(Classify(tail), state, static_cast<std::uint32_t>(offset), out + count);
+    }
+    return count;
+}
+
+std::size_t indexScalar(std::string_view input, std::uint32_t* out, IndexState& state) {
+    return indexWith<classifyScalar>(input, out, state);
+}
+
+#if JSON_HAS_X86_SIMD
+std::size_t indexSse2(std::string_view input, std::uint32_t* out, IndexState& state) {
+    return indexWith<classifySse2>(input, out, state);
+}
+
+JSON_TARGET_AVX2 std::size_t indexAvx2(std::string_view input, std::uint32_t* out, IndexState& state) {
+    return indexWith<classifyAvx2>(input, out, state);
+}
+#endif
+
+bool cpuSupportsAvx2() {
+#if JSON_HAS_X86_SIMD && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+StructuralIndex::SimdLevel detectLevel() {
+#if JSON_HAS_X86_SIMD
+    return cpuSupportsAvx2() ? StructuralIndex::SimdLevel::AVX2 : StructuralIndex::SimdLevel::SSE2;
+#else
+    return StructuralIndex::SimdLevel::Scalar;
+#endif
+}
+
+std::atomic<StructuralIndex::SimdLevel>& activeLevel() {
+    static std::atomic<StructuralIndex::SimdLevel> level{StructuralIndex::detectedSimdLevel()};
+    return level;
+}
+
+} // namespace
+
+std::vector<std::uint32_t> StructuralIndex::build(std::string_view input) {
+    if (input.size() > kMaxInputBytes) {
+        throw std::runtime_error("Input larger than 4 GiB cannot be indexed");
+    }
+    // At most one structural per byte; the slack absorbs the padded tail block.
+    // Left uninitialized so that only the pages actually written get
+    // committed, and copied out at the exact size below.
+    const std::unique_ptr<std::uint32_t[]> positions(new std::uint32_t[input.size() + kBlockBytes]);
+    IndexState state;
+    std::size_t count = 0;
+    switch (simdLevel()) {
+#if JSON_HAS_X86_SIMD
+    case SimdLevel::AVX2:
+        count = indexAvx2(input, positions.get(), state);
+        break;
+    case SimdLevel::SSE2:
+        count = indexSse2(input, positions.get(), state);
+        break;
+#endif
+    default:
+        count = indexScalar(input, positions.get(), state);
+        break;
+    }
+    if (state.inString != 0) {
+        throw std::runtime_error("JSON parse error: unterminated string");
+    }
+    return std::vector<std::uint32_t>(positions.get(), positions.get() + count);
+}
+
+StructuralIndex::SimdLevel StructuralIndex::simdLevel() {
+    return activeLevel().load(std::memory_order_relaxed);
+}
+
+StructuralIndex::SimdLevel StructuralIndex::detectedSimdLevel() {
+    static const SimdLevel detected = detectLevel();
+    return detected;
+}
+
+StructuralIndex::SimdLevel StructuralIndex::setSimdLevel(SimdLevel level) {
+    const SimdLevel supported = detectedSimdLevel();
+    if (static_cast<int>(level) > static_cast<int>(supported)) {
+        level = supported;
+    }
+    activeLevel().store(level, std::memory_order_relaxed);
+    return level;
+}
+
+const char* StructuralIndex::simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::SSE2:
+        return "sse2";
+    case SimdLevel::Scalar:
+        break;
+    }
+    return "scalar";
+}
@@ -0,0 +1,72 @@
+/**
+ * @file test_arena_json.cpp
+ * @brief ArenaDocument parsing and the Arena it allocates from
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+#include "arena.h"
+#include "arena_json.h"
+
+namespace {
+
+const std::string kText = R"({"name": "John Doe", "age": 30, "skills": ["C++", "Python", "a string longer than SSO"],
+                              "address": {"zipcode": "10001"}, "big": 18446744073709551615, "salary": 75000.5})";
+
+} // namespace
+
+TEST(ArenaDocumentTest, ParsesLikeNlohmann) {
+    const ArenaDocument document = ArenaDocument::parse(kText);
+    const ArenaJson& root = document.root();
+    EXPECT_EQ(root["age"].get<int>(), 30);
+    EXPECT_EQ(root["skills"][2].get<ArenaString>(), "a string longer than SSO");
+    EXPECT_EQ(root["big"].get<std::uint64_t>(), 18446744073709551615u);
+    const ArenaString dump = root.dump();
+    EXPECT_EQ(std::string_view(dump.data(), dump.size()), nlohmann::json::parse(kText).dump());
+
+    // The whole tree lives in the arena, in the single block sized from the input
+    EXPECT_TRUE(document.arena().contains(&root));
+    EXPECT_TRUE(document.arena().contains(root["skills"][2].get_ref<const ArenaString&>().data()));
+    EXPECT_EQ(document.arena().blockCount(), 1u);
+    EXPECT_GT(document.arena().bytesUsed(), 0u);
+}
+
+TEST(ArenaDocumentTest, InvalidTextIsAnError) {
+    EXPECT_THROW(ArenaDocument::parse("{\"a\": }"), std::runtime_error);
+    EXPECT_THROW(ArenaDocument::parse("[1e400]"), std::runtime_error);
+}
+
+TEST(ArenaTest, AllocationsAreAlignedAndGrowTheArena) {
+    Arena arena(256);
+    void* first = arena.allocate(3, 1);
+    void* aligned = arena.allocate(8, 64);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 64, 0u);
+    EXPECT_TRUE(arena.contains(first));
+    EXPECT_EQ(arena.blockCount(), 1u);
+    arena.allocate(1000);  // larger than the block
+    EXPECT_GE(arena.blockCount(), 2u);
+    EXPECT_GE(arena.bytesReserved(), 1256u);
+
+    arena.reset();
+    EXPECT_EQ(arena.bytesUsed(), 0u);
+    int outside = 0;
+    EXPECT_FALSE(arena.contains(&outside));
+}
+
+TEST(ArenaTest, ScopeRoutesTheAllocator) {
+    Arena arena;
+    EXPECT_EQ(Arena::current(), nullptr);
+    {
+        ArenaScope scope(arena);
+        EXPECT_EQ(Arena::current(), &arena);
+        const ArenaString text(100, 'x');
+        EXPECT_TRUE(arena.contains(text.data()));
+    }
+    EXPECT_EQ(Arena::current(), nullptr);
+    const ArenaString heap(100, 'y');
+    EXPECT_FALSE(arena.contains(heap.data()));
+}
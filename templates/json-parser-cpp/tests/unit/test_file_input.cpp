@@ -0,0 +1,136 @@
+/**
+ * @file test_file_input.cpp
+ * @brief Mapped and read() input of FileInput, and page release while iterating
+ */
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include <unistd.h>
+#include "file_input.h"
+#include "test_files.h"
+
+namespace {
+
+/// Read FileInput("-") from a pipe that a second thread fills with bytes
+std::string readPipe(const std::string& bytes, bool* mapped) {
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        throw std::runtime_error("pipe failed");
+    }
+    const int savedStdin = ::dup(STDIN_FILENO);
+    ::dup2(fds[0], STDIN_FILENO);
+    ::close(fds[0]);
+
+    std::thread writer([&] {
+        for (std::size_t done = 0; done < bytes.size();) {
+            const ssize_t count = ::write(fds[1], bytes.data() + done, bytes.size() - done);
+            if (count <= 0) {
+                break;
+            }
+            done += static_cast<std::size_t>(count);
+        }
+        ::close(fds[1]);
+    });
+    std::string result;
+    {
+        const FileInput input("-");
+        *mapped = input.mapped();
+        result.assign(input.view());
+    }
+    writer.join();
+    ::dup2(savedStdin, STDIN_FILENO);
+    ::close(savedStdin);
+    return result;
+}
+
+} // namespace
+
+class FileInputTest : public TestFiles {};
+
+TEST_F(FileInputTest, RegularFilesAreMapped) {
+    const std::string file = path("data.json");
+    write(file, R"({"a": [1, 2, 3]})");
+    const FileInput input(file);
+    EXPECT_TRUE(input.mapped());
+    EXPECT_EQ(input.view(), R"({"a": [1, 2, 3]})");
+    EXPECT_EQ(input.size(), input.view().size());
+    EXPECT_EQ(std::string(input.begin(), input.end()), input.view());
+    EXPECT_EQ(nlohmann::json::parse(input.begin(), input.end())["a"][2], 3);
+
+    input.release(input.size());  // bytes stay readable after release
+    EXPECT_EQ(input.view(), R"({"a": [1, 2, 3]})");
+}
+
+TEST_F(FileInputTest, EmptyAndSpecialFilesAreRead) {
+    const std::string file = path("empty.json");
+    write(file, "");
+    const FileInput empty(file);
+    EXPECT_FALSE(empty.mapped());
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT_TRUE(empty.begin() == empty.end());
+
+    const FileInput null("/dev/null");
+    EXPECT_FALSE(null.mapped());
+    EXPECT_EQ(null.size(), 0u);
+    null.release(100);  // nothing to release
+}
+
+TEST_F(FileInputTest, StdinPipeIsReadWhole) {
+    bool mapped = true;
+    EXPECT_EQ(readPipe("[1, 2]", &mapped), "[1, 2]");
+    EXPECT_FALSE(mapped);
+
+    // Several read() chunks, so the buffer has to grow
+    std::string large;
+    for (int i = 0; large.size() < (3u << 20); ++i) {
+        large += std::to_string(i) + ',';
+    }
+    EXPECT_EQ(readPipe(large, &mapped), large);
+}
+
+TEST_F(FileInputTest, MissingFileIsAnError) {
+    EXPECT_THROW(FileInput{path("missing.json")}, std::runtime_error);
+    EXPECT_THROW(FileInput{path("")}, std::runtime_error);  // a directory cannot be read
+}
+
+TEST_F(FileInputTest, IteratorReleasesPagesAcrossTheWholeFile) {
+    // Sparse, so the file costs no disk space; marks at both ends and at the release points
+    const std::string file = path("large.bin");
+    const std::size_t size = 2 * FileInput::kReleaseBytes + 4096 + 7;
+    write(file, "");
+    std::filesystem::resize_file(file, size);
+    {
+        std::fstream marks(file, std::ios::in | std::ios::out | std::ios::binary);
+        for (const std::size_t at : {std::size_t{0}, FileInput::kReleaseBytes - 1, FileInput::kReleaseBytes,
+                                     2 * FileInput::kReleaseBytes, size - 1}) {
+            marks.seekp(static_cast<std::streamoff>(at));
+            marks.put('x');
+        }
+    }
+
+    const FileInput input(file);
+    ASSERT_TRUE(input.mapped());
+    ASSERT_EQ(input.size(), size);
+    std::size_t bytes = 0;
+    std::size_t marks = 0;
+    for (const char c : input) {
+        ++bytes;
+        marks += c == 'x';
+    }
+    EXPECT_EQ(bytes, size);
+    EXPECT_EQ(marks, 5u);
+
+    // Released pages are read back on access, and an iterator can start past a release point
+    EXPECT_EQ(input.data()[0], 'x');
+    EXPECT_EQ(input.data()[FileInput::kReleaseBytes], 'x');
+    FileInput::Iterator middle = input.begin();
+    std::advance(middle, FileInput::kReleaseBytes + 1);
+    EXPECT_EQ(std::distance(middle, input.end()), static_cast<std::ptrdiff_t>(size - FileInput::kReleaseBytes - 1));
+}
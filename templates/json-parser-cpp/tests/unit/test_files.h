@@ -0,0 +1,58 @@
+#ifndef TEST_FILES_H
+#define TEST_FILES_H
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+/**
+ * @brief Fixture that gives each test an empty directory, removed afterwards
+ *
+ * Side files the code under test writes next to its input (".idx",
+ * ".cols", ".cbor", temporaries) land in the same directory and go with it.
+ */
+class TestFiles : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const ::testing::TestInfo* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        std::string name = std::string(test->test_suite_name()) + "." + test->name();
+        std::replace(name.begin(), name.end(), '/', '_');  // parameterized tests
+        dir_ = std::filesystem::temp_directory_path() / ("json_parser_test." + std::to_string(::getpid()) + "." + name);
+        std::filesystem::remove_all(dir_);
+        std::filesystem::create_directories(dir_);
+    }
+
+    void TearDown() override {
+        std::error_code ignored;
+        std::filesystem::remove_all(dir_, ignored);
+    }
+
+    /// Path of a file in the test's directory
+    std::string path(const std::string& name) const {
+        return (dir_ / name).string();
+    }
+
+    static void write(const std::string& path, const std::string& bytes) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+    }
+
+    static void append(const std::string& path, const std::string& bytes) {
+        std::ofstream(path, std::ios::binary | std::ios::app) << bytes;
+    }
+
+    static std::string read(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream bytes;
+        bytes << file.rdbuf();
+        return bytes.str();
+    }
+
+private:
+    std::filesystem::path dir_;
+};
+
+#endif // TEST_FILES_H
@@ -0,0 +1,80 @@
+/**
+ * @file test_json_bind.cpp
+ * @brief Binding JSON text straight into structs with bindJson
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "json_bind.h"
+#include "person.h"
+
+namespace {
+
+struct Reading {
+    std::uint8_t sensor = 0;
+    std::optional<double> value;
+    std::vector<int> samples;
+};
+
+} // namespace
+
+template <>
+struct JsonSchema<Reading> {
+    static constexpr auto fields = std::make_tuple(jsonField("sensor", &Reading::sensor),
+                                                   jsonField("value", &Reading::value),
+                                                   jsonField("samples", &Reading::samples));
+};
+
+TEST(JsonBindTest, BindsTheSampleDocument) {
+    Person person;
+    const BindResult result = bindJson(R"({"name": "John Doe", "age": 30, "city": "New York",
+        "skills": ["C++", "Python"], "address": {"street": "123 Main St", "zipcode": "10001"},
+        "active": true, "salary": 75000.50, "unknown": {"ignored": [1, 2]}})",
+                                       person);
+    EXPECT_TRUE(result.ok());
+    EXPECT_GT(result.events, 0u);
+    EXPECT_EQ(person.name, "John Doe");
+    EXPECT_EQ(person.age, 30);
+    EXPECT_EQ(person.skills, (std::vector<std::string>{"C++", "Python"}));
+    EXPECT_EQ(person.address.zipcode, "10001");
+    EXPECT_TRUE(person.active);
+    EXPECT_EQ(person.salary, 75000.5);
+}
+
+TEST(JsonBindTest, ReportsMissingAndMismatchedFields) {
+    Person person;
+    person.city = "kept";
+    const BindResult result =
+        bindJson(R"({"name": 5, "age": 3000000000, "skills": ["a", 1], "address": {"street": "x"}})", person);
+    ASSERT_EQ(result.issues.size(), 7u);
+    EXPECT_EQ(result.issues[0].kind, BindIssue::Kind::Mismatch);
+    EXPECT_EQ(result.issues[0].path, "name");
+    EXPECT_EQ(result.issues[1].path, "age");  // out of range for int
+    EXPECT_EQ(result.issues[2].path, "skills[1]");
+    EXPECT_EQ(result.issues[3].kind, BindIssue::Kind::Missing);
+    EXPECT_EQ(result.issues[3].path, "address.zipcode");
+    EXPECT_EQ(result.issues[4].path, "city");
+    EXPECT_EQ(person.city, "kept");
+    EXPECT_EQ(person.skills, (std::vector<std::string>{"a"}));
+    EXPECT_EQ(person.address.street, "x");
+}
+
+TEST(JsonBindTest, OptionalsIntegersAndErrors) {
+    Reading reading;
+    EXPECT_TRUE(bindJson(R"({"sensor": 255, "value": null, "samples": [1, -2]})", reading).ok());
+    EXPECT_EQ(reading.sensor, 255);
+    EXPECT_FALSE(reading.value);
+    EXPECT_EQ(reading.samples, (std::vector<int>{1, -2}));
+    EXPECT_TRUE(bindJson(R"({"sensor": 1, "value": 2.5, "samples": []})", reading).ok());
+    EXPECT_EQ(reading.value, 2.5);
+
+    EXPECT_FALSE(bindJson(R"({"sensor": 256, "value": 1, "samples": []})", reading).ok());
+    EXPECT_FALSE(bindJson(R"({"sensor": -1, "value": 1, "samples": []})", reading).ok());
+    EXPECT_FALSE(bindJson(R"({"sensor": 1.5, "value": 1, "samples": []})", reading).ok());
+    EXPECT_THROW(bindJson("{\"sensor\": ", reading), std::runtime_error);
+    EXPECT_THROW(bindJson("{\"value\": 1e400}", reading), std::runtime_error);
+}
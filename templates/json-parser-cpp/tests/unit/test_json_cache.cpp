@@ -0,0 +1,166 @@
+/**
+ * @file test_json_cache.cpp
+ * @brief Hits, revalidation and rebuilds of JsonCache in every format
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "json_cache.h"
+#include "test_files.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+const std::string kText = R"({"name": "John Doe", "age": 30, "salary": 75000.5, "skills": ["C++", "Python"],
+                              "address": {"street": "123 Main St", "zipcode": "10001"}, "big": 18446744073709551615})";
+
+/// Move a file's modification time, as a checkout or touch would
+void touch(const std::string& path, int seconds) {
+    const auto time = std::filesystem::last_write_time(path);
+    std::filesystem::last_write_time(path, time + std::chrono::seconds(seconds));
+}
+
+const char* formatName(CacheFormat format) {
+    switch (format) {
+    case CacheFormat::Cbor:
+        return "cbor";
+    case CacheFormat::MessagePack:
+        return "msgpack";
+    case CacheFormat::Tape:
+        break;
+    }
+    return "tape";
+}
+
+} // namespace
+
+class JsonCacheTest : public TestFiles, public ::testing::WithParamInterface<CacheFormat> {
+protected:
+    /// Load through the cache and return how it was loaded
+    CacheStatus load(const std::string& source, const JsonCache& cache, json* document = nullptr) {
+        CacheInfo info;
+        const json loaded = cache.load(source, &info);
+        EXPECT_EQ(info.cachePath, cache.cachePath(source));
+        EXPECT_EQ(info.sourceBytes, read(source).size());
+        EXPECT_EQ(loaded, json::parse(read(source)));
+        if (document != nullptr) {
+            *document = loaded;
+        }
+        return info.status;
+    }
+};
+
+TEST_P(JsonCacheTest, SecondLoadIsAHit) {
+    const std::string source = path("config.json");
+    write(source, kText);
+    const JsonCache cache(GetParam());
+    EXPECT_EQ(cache.cachePath(source), source + "." + formatName(GetParam()));
+
+    EXPECT_EQ(load(source, cache), CacheStatus::Created);
+    EXPECT_TRUE(std::filesystem::exists(cache.cachePath(source)));
+    EXPECT_EQ(load(source, cache), CacheStatus::Hit);
+    EXPECT_EQ(load(source, JsonCache(GetParam(), true)), CacheStatus::Hit);
+}
+
+TEST_P(JsonCacheTest, ChangedTimeIsRevalidatedByHash) {
+    const std::string source = path("config.json");
+    write(source, kText);
+    const JsonCache cache(GetParam());
+    load(source, cache);
+
+    touch(source, 10);
+    EXPECT_EQ(load(source, cache), CacheStatus::Revalidated);
+    EXPECT_EQ(load(source, cache), CacheStatus::Hit);  // the new time was recorded
+}
+
+TEST_P(JsonCacheTest, ChangedContentIsRebuilt) {
+    const std::string source = path("config.json");
+    write(source, kText);
+    const JsonCache cache(GetParam());
+    load(source, cache);
+
+    // Same size and, after the touch, a different time: only the hash can tell
+    std::string edited = kText;
+    edited[edited.find("30")] = '4';
+    write(source, edited);
+    touch(source, 20);
+    json document;
+    EXPECT_EQ(load(source, cache, &document), CacheStatus::Rebuilt);
+    EXPECT_EQ(document["age"], 40);
+    EXPECT_EQ(load(source, cache), CacheStatus::Hit);
+
+    write(source, R"({"age": 50})");
+    EXPECT_EQ(load(source, cache), CacheStatus::Rebuilt);
+}
+
+TEST_P(JsonCacheTest, DamagedCacheIsRebuilt) {
+    const std::string source = path("config.json");
+    write(source, kText);
+    const JsonCache cache(GetParam());
+    load(source, cache);
+    const std::string good = read(cache.cachePath(source));
+
+    // A damaged header field (magic, version, format, sizes) is always noticed
+    for (const std::size_t i : {0u, 9u, 13u, 17u, 41u}) {
+        std::string damaged = good;
+        damaged[i] = static_cast<char>(damaged[i] ^ 0x5A);
+        write(cache.cachePath(source), damaged);
+        EXPECT_EQ(load(source, cache), CacheStatus::Rebuilt) << "byte " << i;
+    }
+    // The payload has no checksum: damage either fails to decode, or decodes to some document
+    for (std::size_t i = 48; i < good.size(); ++i) {
+        std::string damaged = good;
+        damaged[i] = static_cast<char>(damaged[i] ^ 0x5A);
+        write(cache.cachePath(source), damaged);
+        CacheInfo info;
+        cache.load(source, &info);
+        EXPECT_TRUE(info.status == CacheStatus::Hit || info.status == CacheStatus::Rebuilt) << "byte " << i;
+    }
+    write(cache.cachePath(source), good.substr(0, good.size() / 2));
+    EXPECT_EQ(load(source, cache), CacheStatus::Rebuilt);
+    write(cache.cachePath(source), "");
+    EXPECT_EQ(load(source, cache), CacheStatus::Rebuilt);
+}
+
+TEST_P(JsonCacheTest, SourceErrorsAreReported) {
+    const JsonCache cache(GetParam());
+    EXPECT_THROW(cache.load(path("missing.json")), std::runtime_error);
+    const std::string source = path("broken.json");
+    write(source, "{\"a\": ");
+    EXPECT_THROW(cache.load(source), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists(cache.cachePath(source)));
+}
+
+INSTANTIATE_TEST_SUITE_P(Formats, JsonCacheTest,
+                         ::testing::Values(CacheFormat::Cbor, CacheFormat::MessagePack, CacheFormat::Tape),
+                         [](const ::testing::TestParamInfo<CacheFormat>& info) {
+                             return std::string(formatName(info.param));
+                         });
+
+class JsonCacheTapeTest : public TestFiles {};
+
+TEST_F(JsonCacheTapeTest, LoadTapeSkipsTheDom) {
+    const std::string source = path("config.json");
+    write(source, kText);
+    const JsonCache cache(CacheFormat::Tape);
+    CacheInfo info;
+    EXPECT_EQ(cache.loadTape(source, &info).toJson(), json::parse(kText));
+    EXPECT_EQ(info.status, CacheStatus::Created);
+    EXPECT_GT(info.cacheBytes, 0u);
+    EXPECT_EQ(cache.loadTape(source, &info).toJson(), json::parse(kText));
+    EXPECT_EQ(info.status, CacheStatus::Hit);
+
+    EXPECT_THROW(JsonCache(CacheFormat::Cbor).loadTape(source), std::invalid_argument);
+}
+
+TEST(JsonCacheHashTest, HashesDependOnEveryByte) {
+    EXPECT_EQ(JsonCache::hashBytes("abc"), JsonCache::hashBytes("abc"));
+    EXPECT_NE(JsonCache::hashBytes("abc"), JsonCache::hashBytes("abd"));
+    EXPECT_NE(JsonCache::hashBytes(std::string(100, 'a')), JsonCache::hashBytes(std::string(101, 'a')));
+    EXPECT_STREQ(JsonCache::statusName(CacheStatus::Hit), "hit");
+}
@@ -0,0 +1,276 @@
+/**
+ * @file test_json_columnar.cpp
+ * @brief Conversion to ColumnarFile, aggregates, and rejection of corrupt files
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include "json_columnar.h"
+#include "test_files.h"
+
+namespace {
+
+/// Records with int, double, string, bool, nested and array fields; some missing or null
+std::string people(int count) {
+    std::string text;
+    for (int i = 0; i < count; ++i) {
+        text += R"({"id": )" + std::to_string(i) + R"(, "city": ")" + (i % 3 == 0 ? "Oslo" : "Rome") + '"';
+        if (i % 5 != 0) {
+            text += R"(, "score": )" + std::to_string(i) + ".5";
+        } else if (i % 10 == 0) {
+            text += R"(, "score": null)";
+        }
+        text += R"(, "active": )" + std::string(i % 2 == 0 ? "true" : "false");
+        text += R"(, "address": {"zip": )" + std::to_string(1000 + i % 4) + R"(}, "tags": [1, "a"]})" "\n";
+    }
+    return text;
+}
+
+ColumnarOptions smallGroups() {
+    ColumnarOptions options;
+    options.workers = 3;
+    options.chunkBytes = 1024;  // many row groups
+    return options;
+}
+
+} // namespace
+
+class ColumnarFileTest : public TestFiles {
+protected:
+    /// Convert text and open the result
+    std::unique_ptr<ColumnarFile> convert(const std::string& text, const ColumnarOptions& options = smallGroups()) {
+        const std::string source = path("data.ndjson");
+        write(source, text);
+        stats_ = ColumnarFile::convert(source, ColumnarFile::defaultPath(source), options);
+        return std::make_unique<ColumnarFile>(ColumnarFile::defaultPath(source));
+    }
+
+    ColumnarStats stats_;
+};
+
+TEST_F(ColumnarFileTest, ColumnsAndChunks) {
+    const auto file = convert(people(200));
+    EXPECT_EQ(stats_.rows, 200u);
+    EXPECT_EQ(stats_.failedRecords, 0u);
+    EXPECT_GT(stats_.rowGroups, 1u);
+    EXPECT_EQ(file->rows(), 200u);
+    EXPECT_EQ(file->rowGroups(), stats_.rowGroups);
+    EXPECT_EQ(file->columns(),
+              (std::vector<std::string>{"id", "city", "score", "active", "address.zip", "tags"}));
+    EXPECT_THROW(file->column("missing"), std::invalid_argument);
+
+    const ColumnChunk ids = file->chunk(0, file->column("id"));
+    ASSERT_EQ(ids.type, ColumnType::Int64);
+    EXPECT_EQ(ids.nulls, 0u);
+    EXPECT_EQ(ids.integers[1], 1);
+
+    const ColumnChunk cities = file->chunk(0, file->column("city"));
+    ASSERT_EQ(cities.type, ColumnType::String);
+    EXPECT_EQ(cities.dictionarySize, 2u);
+    EXPECT_EQ(cities.string(cities.codes[0]), "Oslo");
+    EXPECT_EQ(cities.string(cities.codes[1]), "Rome");
+    EXPECT_THROW(cities.string(2), std::out_of_range);
+
+    const ColumnChunk scores = file->chunk(0, file->column("score"));
+    ASSERT_EQ(scores.type, ColumnType::Double);
+    EXPECT_FALSE(scores.valid(0));
+    EXPECT_TRUE(scores.valid(1));
+    EXPECT_EQ(scores.doubles[1], 1.5);
+
+    const ColumnChunk tags = file->chunk(0, file->column("tags"));
+    ASSERT_EQ(tags.type, ColumnType::String);
+    EXPECT_EQ(tags.string(tags.codes[0]), R"([1,"a"])");
+    const ColumnChunk active = file->chunk(0, file->column("active"));
+    ASSERT_EQ(active.type, ColumnType::Boolean);
+    EXPECT_EQ(active.booleans[0], 1);
+    EXPECT_EQ(active.booleans[1], 0);
+    EXPECT_THROW(file->chunk(file->rowGroups(), 0), std::out_of_range);
+}
+
+TEST_F(ColumnarFileTest, AggregatesMatchTheRecords) {
+    const auto file = convert(people(200));
+    const ColumnAggregate ids = file->aggregate("id");
+    EXPECT_EQ(ids.count, 200u);
+    EXPECT_EQ(ids.sum, 199.0 * 200.0 / 2.0);
+    EXPECT_EQ(ids.min, 0.0);
+    EXPECT_EQ(ids.max, 199.0);
+
+    double expected = 0.0;
+    for (int i = 0; i < 200; ++i) {
+        expected += i % 5 != 0 ? i + 0.5 : 0.0;
+    }
+    const ColumnAggregate scores = file->aggregate("score");
+    EXPECT_EQ(scores.count, 160u);
+    EXPECT_EQ(scores.nulls, 40u);  // null and missing alike
+    EXPECT_DOUBLE_EQ(scores.sum, expected);
+    EXPECT_EQ(scores.min, 1.5);
+    EXPECT_EQ(scores.max, 199.5);
+    EXPECT_DOUBLE_EQ(scores.mean(), expected / 160.0);
+
+    const ColumnAggregate cities = file->aggregate("city");
+    EXPECT_EQ(cities.count, 0u);
+    EXPECT_EQ(cities.skipped, 200u);
+
+    const std::map<std::string, ColumnAggregate> byCity = file->aggregateBy("city", "id");
+    ASSERT_EQ(byCity.size(), 2u);
+    EXPECT_EQ(byCity.at("Oslo").count, 67u);
+    EXPECT_EQ(byCity.at("Oslo").sum + byCity.at("Rome").sum, ids.sum);
+    const std::map<std::string, ColumnAggregate> byZip = file->aggregateBy("address.zip", "score");
+    ASSERT_EQ(byZip.size(), 4u);
+    EXPECT_EQ(byZip.at("1001").count + byZip.at("1001").nulls, 50u);
+    EXPECT_THROW(file->aggregateBy("city", "missing"), std::invalid_argument);
+}
+
+TEST_F(ColumnarFileTest, IntegerSumsDoNotWrap) {
+    const std::int64_t max = std::numeric_limits<std::int64_t>::max();
+    const std::int64_t min = std::numeric_limits<std::int64_t>::min();
+    std::string text;
+    for (int i = 0; i < 100; ++i) {  // more than one full validity word
+        text += R"({"x": )" + std::to_string(max) + "}\n";
+    }
+    text += R"({"x": )" + std::to_string(min) + "}\n{\"x\": -1}\n";
+    const ColumnAggregate x = convert(text, {})->aggregate("x");
+    EXPECT_EQ(x.count, 102u);
+    EXPECT_DOUBLE_EQ(x.sum, 100.0 * static_cast<double>(max) + static_cast<double>(min) - 1.0);
+    EXPECT_GT(x.sum, 0.0);
+    EXPECT_EQ(x.min, static_cast<double>(min));
+    EXPECT_EQ(x.max, static_cast<double>(max));
+
+    const ColumnAggregate pair = convert(R"({"x": 9223372036854775807})" "\n" R"({"x": 1})" "\n", {})->aggregate("x");
+    EXPECT_EQ(pair.sum, 9223372036854775808.0);
+}
+
+TEST_F(ColumnarFileTest, TypesAreChosenPerRowGroup) {
+    ColumnarOptions options = smallGroups();
+    options.chunkBytes = 1;  // one record per row group
+    const auto file = convert("{\"v\": 1}\n{\"v\": 2.5}\n{\"v\": \"three\"}\n{\"v\": null}\n{\"w\": 1}\n", options);
+    ASSERT_EQ(file->rowGroups(), 5u);
+    const std::size_t v = file->column("v");
+    EXPECT_EQ(file->chunk(0, v).type, ColumnType::Int64);
+    EXPECT_EQ(file->chunk(1, v).type, ColumnType::Double);
+    EXPECT_EQ(file->chunk(2, v).type, ColumnType::String);
+    EXPECT_EQ(file->chunk(3, v).type, ColumnType::Null);
+    EXPECT_EQ(file->chunk(4, v).type, ColumnType::Null);
+
+    const ColumnAggregate aggregate = file->aggregate("v");
+    EXPECT_EQ(aggregate.count, 2u);
+    EXPECT_EQ(aggregate.sum, 3.5);
+    EXPECT_EQ(aggregate.nulls, 2u);
+    EXPECT_EQ(aggregate.skipped, 1u);
+}
+
+TEST_F(ColumnarFileTest, NumbersMixedWithOtherValuesAreAggregated) {
+    // One default-sized row group, so each column is stored as String
+    const auto file = convert("{\"salary\": 100, \"active\": true}\n"
+                              "{\"salary\": 200.5, \"active\": 1}\n"
+                              "{\"salary\": \"N/A\", \"active\": false}\n"
+                              "{\"salary\": 300, \"active\": true}\n"
+                              "{\"salary\": null, \"active\": 1}\n",
+                              {});
+    ASSERT_EQ(file->rowGroups(), 1u);
+    EXPECT_EQ(file->chunk(0, file->column("salary")).type, ColumnType::String);
+    EXPECT_EQ(file->chunk(0, file->column("active")).type, ColumnType::String);
+
+    const ColumnAggregate salary = file->aggregate("salary");
+    EXPECT_EQ(salary.count, 3u);
+    EXPECT_EQ(salary.sum, 600.5);
+    EXPECT_EQ(salary.min, 100.0);
+    EXPECT_EQ(salary.max, 300.0);
+    EXPECT_EQ(salary.nulls, 1u);
+    EXPECT_EQ(salary.skipped, 1u);
+
+    // Booleans stay apart from the number 1 and are not summed
+    const std::map<std::string, ColumnAggregate> byActive = file->aggregateBy("active", "salary");
+    ASSERT_EQ(byActive.size(), 3u);
+    EXPECT_EQ(byActive.at("true").count, 2u);
+    EXPECT_EQ(byActive.at("true").sum, 400.0);
+    EXPECT_EQ(byActive.at("1").count, 1u);
+    EXPECT_EQ(byActive.at("1").nulls, 1u);
+    EXPECT_EQ(byActive.at("false").skipped, 1u);
+    EXPECT_EQ(file->aggregate("active").skipped, 3u);  // only the booleans; 1 is a number
+}
+
+TEST_F(ColumnarFileTest, BooleanColumnsGroupByTrueAndFalse) {
+    const auto file = convert(people(200));
+    const std::map<std::string, ColumnAggregate> byActive = file->aggregateBy("active", "id");
+    ASSERT_EQ(byActive.size(), 2u);
+    EXPECT_EQ(byActive.at("true").count, 100u);
+    EXPECT_EQ(byActive.at("true").sum, 99.0 * 100.0);  // the even ids
+    EXPECT_EQ(byActive.at("false").count, 100u);
+    const ColumnAggregate active = file->aggregate("active");
+    EXPECT_EQ(active.count, 0u);
+    EXPECT_EQ(active.skipped, 200u);
+}
+
+TEST_F(ColumnarFileTest, InvalidRecordsAreCountedAndSkipped) {
+    const auto file = convert("{\"a\": 1}\nnot json\n[1, 2]\n{\"a\": 1e400}\n\n{\"a\": 3}\n", {});
+    EXPECT_EQ(stats_.rows, 2u);
+    EXPECT_EQ(stats_.failedRecords, 3u);
+    ASSERT_EQ(stats_.errors.size(), 3u);
+    EXPECT_EQ(stats_.errors[0].line, 2u);
+    EXPECT_EQ(stats_.errors[2].line, 4u);
+    EXPECT_EQ(file->aggregate("a").sum, 4.0);
+}
+
+TEST_F(ColumnarFileTest, CorruptFilesAreRejected) {
+    convert(people(100));
+    const std::string cols = ColumnarFile::defaultPath(path("data.ndjson"));
+    const std::string good = read(cols);
+
+    for (std::size_t size = 0; size < good.size(); size += 8) {
+        write(cols, good.substr(0, size));
+        EXPECT_THROW(ColumnarFile{cols}, std::runtime_error) << "size " << size;
+    }
+    std::string badMagic = good;
+    badMagic[0] = 'X';
+    write(cols, badMagic);
+    EXPECT_THROW(ColumnarFile{cols}, std::runtime_error);
+
+    // Any damaged byte is rejected on open, or every scan stays within the mapping
+    for (std::size_t i = 0; i < good.size(); ++i) {
+        for (const unsigned char flip : {0x01, 0x40, 0xFF}) {
+            std::string damaged = good;
+            damaged[i] = static_cast<char>(damaged[i] ^ flip);
+            write(cols, damaged);
+            try {
+                const ColumnarFile file(cols);
+                for (const std::string& column : file.columns()) {
+                    file.aggregate(column);
+                    file.aggregateBy(column, "id");
+                }
+            } catch (const std::runtime_error&) {
+            } catch (const std::invalid_argument&) {  // a damaged name no longer matches "id"
+            }
+        }
+    }
+}
+
+TEST_F(ColumnarFileTest, CorruptNameTableIsRejected) {
+    convert("{\"alpha\": 1, \"beta\": 2, \"gamma\": 3}\n", {});
+    const std::string cols = ColumnarFile::defaultPath(path("data.ndjson"));
+    const std::string good = read(cols);
+    // The file ends with 4 uint64 name offsets, then 14 name bytes padded to 16
+    const std::size_t table = good.size() - 16 - 4 * 8;
+    ASSERT_EQ(good.substr(table + 4 * 8, 14), "alphabetagamma");
+
+    const auto withOffset = [&](std::size_t index, std::uint64_t value) {
+        std::string damaged = good;
+        std::memcpy(&damaged[table + index * 8], &value, sizeof(value));
+        write(cols, damaged);
+    };
+    withOffset(1, 1u << 30);  // past the end, but below the last offset's check
+    EXPECT_THROW(ColumnarFile{cols}, std::runtime_error);
+    withOffset(2, 3);  // not ascending
+    EXPECT_THROW(ColumnarFile{cols}, std::runtime_error);
+    withOffset(0, 1);
+    EXPECT_THROW(ColumnarFile{cols}, std::runtime_error);
+    withOffset(3, 4096);  // names past the end of the file
+    EXPECT_THROW(ColumnarFile{cols}, std::runtime_error);
+    write(cols, good);
+    EXPECT_EQ(ColumnarFile(cols).columns(), (std::vector<std::string>{"alpha", "beta", "gamma"}));
+}
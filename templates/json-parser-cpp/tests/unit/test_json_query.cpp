@@ -0,0 +1,94 @@
+/**
+ * @file test_json_query.cpp
+ * @brief JSON Pointer and JSONPath matching with JsonQuery
+ */
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "json_query.h"
+
+namespace {
+
+const std::string kDocument = R"({
+    "name": "John Doe",
+    "age": 30,
+    "skills": ["C++", "Python", "JavaScript"],
+    "address": {"street": "123 Main St", "zipcode": "10001"},
+    "odd key": {"a/b": 1, "m~n": 2},
+    "nested": [[1, 2], {"skills": "not these"}],
+    "escaped": "say \"hi\" ]}",
+    "active": true
+})";
+
+/// Raw text of every match, with the expression index
+std::vector<std::pair<std::size_t, std::string>> matches(const std::vector<std::string>& expressions,
+                                                         const std::string& document = kDocument) {
+    std::vector<std::pair<std::size_t, std::string>> result;
+    for (const JsonQuery::Match& match : JsonQuery(expressions).run(document)) {
+        result.emplace_back(match.expression, std::string(match.value));
+    }
+    return result;
+}
+
+using Matches = std::vector<std::pair<std::size_t, std::string>>;
+
+} // namespace
+
+TEST(JsonQueryTest, JsonPointers) {
+    EXPECT_EQ(matches({"/address/zipcode"}), (Matches{{0, "\"10001\""}}));
+    EXPECT_EQ(matches({"/skills/1"}), (Matches{{0, "\"Python\""}}));
+    EXPECT_EQ(matches({"/odd key/a~1b", "/odd key/m~0n"}), (Matches{{0, "1"}, {1, "2"}}));
+    EXPECT_EQ(matches({"/address/*"}), (Matches{{0, "\"123 Main St\""}, {0, "\"10001\""}}));
+    EXPECT_EQ(matches({""}, "[1, 2]"), (Matches{{0, "[1, 2]"}}));
+    EXPECT_TRUE(matches({"/missing", "/skills/3", "/age/0"}).empty());
+}
+
+TEST(JsonQueryTest, JsonPaths) {
+    EXPECT_EQ(matches({"$.address.zipcode"}), (Matches{{0, "\"10001\""}}));
+    EXPECT_EQ(matches({"$.skills[*]"}), (Matches{{0, "\"C++\""}, {0, "\"Python\""}, {0, "\"JavaScript\""}}));
+    EXPECT_EQ(matches({"$.skills[2]"}), (Matches{{0, "\"JavaScript\""}}));
+    EXPECT_EQ(matches({"$['odd key']['a/b']"}), (Matches{{0, "1"}}));
+    EXPECT_EQ(matches({"$.nested[0]"}), (Matches{{0, "[1, 2]"}}));
+    EXPECT_EQ(matches({"$.escaped"}), (Matches{{0, "\"say \\\"hi\\\" ]}\""}}));
+    EXPECT_EQ(matches({"$.*"}).size(), 8u);
+}
+
+TEST(JsonQueryTest, ExpressionsRunTogetherInEndOrder) {
+    // Matches are reported when the matched value ends, so a container comes after its children
+    EXPECT_EQ(matches({"$.address", "$.address.street", "/age"}),
+              (Matches{{2, "30"}, {1, "\"123 Main St\""}, {0, R"({"street": "123 Main St", "zipcode": "10001"})"}}));
+
+    const JsonQuery query({"$.name", "$.active"});
+    ASSERT_EQ(query.size(), 2u);
+    EXPECT_EQ(query.expression(1), "$.active");
+    const std::vector<JsonQuery::Match> found = query.run(kDocument);
+    ASSERT_EQ(found.size(), 2u);
+    EXPECT_EQ(found[0].text(), "John Doe");
+    EXPECT_EQ(found[0].parse(), "John Doe");
+    EXPECT_EQ(found[1].parse(), true);
+
+    // The same query runs against any number of documents
+    std::size_t calls = 0;
+    for (const char* record : {R"({"name": "A"})", R"({"active": false, "name": "B"})", "[]"}) {
+        query.run(record, [&](const JsonQuery::Match&) { ++calls; });
+    }
+    EXPECT_EQ(calls, 3u);
+}
+
+TEST(JsonQueryTest, InvalidExpressionsAreRejected) {
+    for (const char* expression : {"address", "$..name", "$.", "$[", "$[?(@.a)]", "$.a[", "/a~2"}) {
+        EXPECT_THROW(JsonQuery({expression}), std::invalid_argument) << expression;
+    }
+    EXPECT_THROW(JsonQuery(std::vector<std::string>(JsonQuery::kMaxExpressions + 1, "/a")), std::invalid_argument);
+    EXPECT_NO_THROW(JsonQuery(std::vector<std::string>(JsonQuery::kMaxExpressions, "/a")));
+}
+
+TEST(JsonQueryTest, BrokenDocumentsAreRejected) {
+    const JsonQuery query({"/a"});
+    for (const char* document : {"{\"a\": [1, 2}", "{\"a\": \"open", "{\"a\" 1}", "[1, 2"}) {
+        EXPECT_THROW(query.run(document), std::runtime_error) << document;
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * @file test_json_shape.cpp
+ * @brief ShapedDocument records, and the shapes and symbols they share
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "json_shape.h"
+
+using json = nlohmann::json;
+
+TEST(ShapedDocumentTest, RecordsConvertBackToTheSameJson) {
+    ShapedDocument document;
+    const std::vector<std::string> lines = {
+        R"({"id": 1, "name": "a", "tags": ["x", {"deep": null}], "score": 1.5, "big": 18446744073709551615})",
+        R"({"id": -2, "name": "b", "tags": [], "score": 2, "big": 0})",
+        R"([true, false, "text", {}])",
+        R"("just a string")",
+    };
+    for (const std::string& line : lines) {
+        EXPECT_EQ(document.parse(line).toJson(), json::parse(line)) << line;
+    }
+}
+
+TEST(ShapedDocumentTest, RecordsWithTheSameKeysShareOneShape) {
+    ShapedDocument document;
+    const ShapedValue& first = document.parse(R"({"id": 1, "name": "a"})");
+    const ShapedValue& second = document.parse(R"({"id": 2, "name": "b"})");
+    const ShapedValue& reversed = document.parse(R"({"name": "c", "id": 3})");
+    EXPECT_EQ(first.shape(), second.shape());
+    EXPECT_NE(first.shape(), reversed.shape());
+    ASSERT_NE(first.shape(), nullptr);
+    EXPECT_EQ(first.shape()->size(), 2u);
+    EXPECT_EQ(first.shape()->name(1), "name");
+
+    // Values parsed earlier stay valid as the document grows
+    for (int i = 0; i < 1000; ++i) {
+        document.parse(R"({"id": 0, "name": ")" + std::string(100, 'z') + "\"}");
+    }
+    EXPECT_EQ(first["name"].get<std::string_view>(), "a");
+    EXPECT_EQ(second["id"].get<int>(), 2);
+
+    const Symbol id = SymbolTable::global().intern("id");
+    EXPECT_EQ(SymbolTable::global().name(id), "id");
+    ASSERT_NE(reversed.find(id), nullptr);
+    EXPECT_EQ(reversed.find(id)->get<std::int64_t>(), 3);
+}
+
+TEST(ShapedDocumentTest, AccessErrors) {
+    ShapedDocument document;
+    const ShapedValue& record = document.parse(R"({"a": 1, "a": 2, "s": "t", "list": [1]})");
+    EXPECT_EQ(record.size(), 3u);        // the repeated key is stored once
+    EXPECT_EQ(record["a"].get<int>(), 2);  // the last value wins
+    EXPECT_TRUE(record.contains("s"));
+    EXPECT_FALSE(record.contains("missing"));
+    EXPECT_THROW(record["missing"], std::out_of_range);
+    EXPECT_THROW(record["list"][1], std::out_of_range);
+    EXPECT_THROW(record["s"].get<int>(), std::invalid_argument);
+    EXPECT_THROW(record["a"].get<bool>(), std::invalid_argument);
+    EXPECT_THROW(document.parse("{\"a\": "), std::runtime_error);
+    EXPECT_THROW(document.parse("[1e400]"), std::runtime_error);
+}
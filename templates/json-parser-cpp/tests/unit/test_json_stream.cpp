@@ -0,0 +1,129 @@
+/**
+ * @file test_json_stream.cpp
+ * @brief Summary fields extracted by SummaryHandler without a DOM
+ */
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "file_input.h"
+#include "json_stream.h"
+#include "test_files.h"
+
+namespace {
+
+const std::string kPerson = R"({
+  "name": "John Doe",
+  "age": 30,
+  "city": "New York",
+  "skills": ["C++", "Python", "JavaScript"],
+  "address": {"street": "123 Main St", "zipcode": "10001"},
+  "active": true,
+  "salary": 75000.50
+})";
+
+JsonSummary summarize(const std::string& text, StreamStats* stats = nullptr) {
+    std::istringstream input(text);
+    return summarizeJson(input, stats);
+}
+
+} // namespace
+
+TEST(SummaryHandlerTest, ExtractsThePersonFields) {
+    StreamStats stats;
+    const JsonSummary summary = summarize(kPerson, &stats);
+    EXPECT_EQ(summary.name, "John Doe");
+    EXPECT_EQ(summary.age, 30);
+    EXPECT_EQ(summary.city, "New York");
+    EXPECT_EQ(summary.active, true);
+    EXPECT_EQ(summary.salary, 75000.5);
+    EXPECT_EQ(summary.skills, (std::vector<std::string>{"C++", "Python", "JavaScript"}));
+    EXPECT_TRUE(summary.hasAddress);
+    EXPECT_EQ(summary.street, "123 Main St");
+    EXPECT_EQ(summary.zipcode, "10001");
+
+    // 2 + 2 + 5 container events, 9 keys, 9 values
+    EXPECT_EQ(stats.events, 25u);
+    EXPECT_EQ(stats.bytes, kPerson.size());
+}
+
+TEST(SummaryHandlerTest, MissingFieldsStayEmpty) {
+    const JsonSummary summary = summarize(R"({"name": "A", "other": 1})");
+    EXPECT_EQ(summary.name, "A");
+    EXPECT_FALSE(summary.age);
+    EXPECT_FALSE(summary.city);
+    EXPECT_FALSE(summary.active);
+    EXPECT_FALSE(summary.salary);
+    EXPECT_FALSE(summary.skills);
+    EXPECT_FALSE(summary.hasAddress);
+    EXPECT_FALSE(summary.street);
+}
+
+TEST(SummaryHandlerTest, FieldsOfTheWrongTypeAreIgnored) {
+    const JsonSummary summary = summarize(R"({"name": 1, "age": "thirty", "active": "yes", "skills": "C++",
+                                              "address": ["123 Main St"], "city": null})");
+    EXPECT_FALSE(summary.name);
+    EXPECT_FALSE(summary.age);
+    EXPECT_FALSE(summary.active);
+    EXPECT_FALSE(summary.skills);
+    EXPECT_FALSE(summary.hasAddress);
+    EXPECT_FALSE(summary.street);
+    EXPECT_FALSE(summary.city);
+
+    // Only integers in the int64 range are ages; any number is a salary
+    EXPECT_FALSE(summarize(R"({"age": 30.5})").age);
+    EXPECT_FALSE(summarize(R"({"age": 18446744073709551615})").age);
+    EXPECT_EQ(summarize(R"({"age": -1})").age, -1);
+    EXPECT_EQ(summarize(R"({"salary": 75000})").salary, 75000.0);
+}
+
+TEST(SummaryHandlerTest, OnlyTheRootObjectCounts) {
+    const JsonSummary nested = summarize(R"({"boss": {"name": "B", "address": {"street": "X"}},
+                                             "skills": ["C++", ["Go"], {"name": "Rust"}, 1, "SQL"],
+                                             "address": {"zipcode": "10001", "geo": {"street": "Y"}}})");
+    EXPECT_FALSE(nested.name);
+    EXPECT_EQ(nested.skills, (std::vector<std::string>{"C++", "SQL"}));
+    EXPECT_TRUE(nested.hasAddress);
+    EXPECT_FALSE(nested.street);
+    EXPECT_EQ(nested.zipcode, "10001");
+
+    const JsonSummary array = summarize(R"([{"name": "A"}, {"address": {"street": "X"}}])");
+    EXPECT_FALSE(array.name);
+    EXPECT_FALSE(array.hasAddress);
+    EXPECT_FALSE(array.street);
+    EXPECT_FALSE(summarize(R"("John Doe")").name);
+}
+
+TEST(SummaryHandlerTest, InvalidJsonIsAnError) {
+    for (const char* text : {"", "{\"name\": ", "{\"name\": \"A\"} trailing", "{\"age\": 1e400}"}) {
+        EXPECT_THROW(summarize(text), std::runtime_error) << text;
+    }
+
+    SummaryHandler handler;
+    EXPECT_FALSE(nlohmann::json::sax_parse(std::string("[1,"), &handler));
+    EXPECT_FALSE(handler.error().empty());
+}
+
+class SummarizeFileTest : public TestFiles {};
+
+TEST_F(SummarizeFileTest, FileInputMatchesTheStream) {
+    const std::string file = path("person.json");
+    write(file, kPerson);
+    StreamStats stats;
+    const JsonSummary summary = summarizeJsonFile(file, &stats);
+    EXPECT_EQ(summary.name, "John Doe");
+    EXPECT_EQ(summary.skills, summarize(kPerson).skills);
+    EXPECT_EQ(summary.zipcode, "10001");
+    EXPECT_EQ(stats.events, 25u);
+    EXPECT_EQ(stats.bytes, kPerson.size());
+
+    const FileInput input(file);
+    EXPECT_EQ(summarizeJson(input).salary, 75000.5);
+
+    write(file, "{\"name\": ");
+    EXPECT_THROW(summarizeJsonFile(file), std::runtime_error);
+    EXPECT_THROW(summarizeJsonFile(path("missing.json")), std::runtime_error);
+}
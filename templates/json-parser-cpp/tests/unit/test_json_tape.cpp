@@ -0,0 +1,236 @@
+/**
+ * @file test_json_tape.cpp
+ * @brief The simd backend (StructuralIndex + JsonTape) against nlohmann::json
+ *
+ * Every SIMD level must accept exactly the documents nlohmann accepts, with
+ * the documented exception of nesting deeper than JsonTape::kMaxDepth, and
+ * build the same DOM.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "json_tape.h"
+#include "parser_backend.h"
+#include "structural_index.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+const std::vector<std::string> kValid = {
+    "null",
+    "true",
+    "false",
+    "0",
+    "-0",
+    "1.5e3",
+    "-1.25E-2",
+    "1E+2",
+    "9223372036854775807",
+    "-9223372036854775808",
+    "18446744073709551615",
+    "123456789012345678901234567890",
+    "\"\"",
+    "\"h\xC3\xA9llo \xF0\x9F\x98\x80\"",
+    "\"\\u00e9\\uD83D\\uDE00\\n\\t\\\"\\\\\\/\\b\\f\\r\"",
+    "[]",
+    "{}",
+    "[[[]], {}, [{}]]",
+    "{\"a\": {\"b\": [1, 2, {\"c\": null}]}, \"d\": \"e\"}",
+    " \n\t[1 , 2 ]\r\n",
+    "{\"a\": 1, \"a\": 2}",
+    "[\"" + std::string(62, 'x') + "\\\\\", \"\\\"" + std::string(70, 'y') + "\"]",
+    "[" + std::string(63, ' ') + "true," + std::string(64, ' ') + "false]",
+};
+
+const std::vector<std::string> kInvalid = {
+    "",
+    " ",
+    "{",
+    "}",
+    "[1,]",
+    "[1 2]",
+    "[1]]",
+    "1 2",
+    "{\"a\" 1}",
+    "{\"a\":}",
+    "{\"a\":1,}",
+    "{1:2}",
+    "01",
+    "1.",
+    ".5",
+    "-",
+    "1e",
+    "+1",
+    "tru",
+    "nul",
+    "falsey",
+    "NaN",
+    "\"abc",
+    "\"\\x\"",
+    "\"\\u12\"",
+    "\"\\uD800\"",
+    "\"\t\"",
+    "\"\xFF\"",
+    "\"\xC0\xAF\"",
+    "1e400",
+    "[-1e400]",
+};
+
+/// Random document with every value type, keys and strings that need escapes
+json randomValue(std::mt19937_64& rng, int depth) {
+    std::uniform_int_distribution<int> kind(0, depth > 4 ? 5 : 7);
+    switch (kind(rng)) {
+    case 0:
+        return nullptr;
+    case 1:
+        return rng() % 2 == 0;
+    case 2:
+        return static_cast<std::int64_t>(rng());
+    case 3:
+        return static_cast<std::uint64_t>(rng());
+    case 4:
+        return std::uniform_real_distribution<double>(-1e9, 1e9)(rng);
+    case 5: {
+        static const char* const kPieces[] = {"a", "b", " ", "\"", "\\", "/",
+                                              "\n", "\t", "\x01", "\xC3\xA9", "\xE2\x82\xAC"};
+        std::string text;
+        for (std::size_t i = rng() % 90; i > 0; --i) {
+            text += kPieces[rng() % std::size(kPieces)];
+        }
+        return text;
+    }
+    case 6: {
+        json array = json::array();
+        for (std::size_t i = rng() % 6; i > 0; --i) {
+            array.push_back(randomValue(rng, depth + 1));
+        }
+        return array;
+    }
+    default: {
+        json object = json::object();
+        for (std::size_t i = rng() % 6; i > 0; --i) {
+            object["k" + std::to_string(rng() % 10) + "\\\""] = randomValue(rng, depth + 1);
+        }
+        return object;
+    }
+    }
+}
+
+std::string nested(std::size_t depth) {
+    return std::string(depth, '[') + std::string(depth, ']');
+}
+
+} // namespace
+
+class JsonTapeTest : public ::testing::TestWithParam<StructuralIndex::SimdLevel> {
+protected:
+    void SetUp() override {
+        StructuralIndex::setSimdLevel(GetParam());
+    }
+
+    void TearDown() override {
+        StructuralIndex::setSimdLevel(StructuralIndex::detectedSimdLevel());
+    }
+};
+
+TEST_P(JsonTapeTest, AgreesWithNlohmannOnValidDocuments) {
+    for (const std::string& text : kValid) {
+        EXPECT_EQ(parseJson(text, ParserBackend::Simd), json::parse(text)) << text;
+    }
+    EXPECT_EQ(parseJson("{\"a\": 1, \"a\": 2}", ParserBackend::Simd)["a"], 2);  // last key wins
+}
+
+TEST_P(JsonTapeTest, RejectsWhatNlohmannRejects) {
+    for (const std::string& text : kInvalid) {
+        EXPECT_THROW(parseJson(text, ParserBackend::Nlohmann), std::runtime_error) << text;
+        EXPECT_THROW(parseJson(text, ParserBackend::Simd), std::runtime_error) << text;
+    }
+}
+
+TEST_P(JsonTapeTest, RandomDocumentsRoundTrip) {
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < 300; ++i) {
+        const json document = randomValue(rng, 0);
+        for (const int indent : {-1, 2}) {
+            const std::string text = document.dump(indent);
+            ASSERT_EQ(parseJson(text, ParserBackend::Simd), json::parse(text)) << text;
+        }
+    }
+}
+
+TEST_P(JsonTapeTest, ByteOrderMarkIsSkipped) {
+    const std::string bom = "\xEF\xBB\xBF";
+    for (const std::string& text : {std::string("{\"a\": [1]}"), std::string("\"s\""), std::string("12"),
+                                    std::string("true"), std::string("  null"), std::string("[]")}) {
+        EXPECT_EQ(parseJson(bom + text, ParserBackend::Simd), json::parse(text)) << text;
+        EXPECT_EQ(parseJson(bom + text, ParserBackend::Nlohmann), json::parse(text)) << text;
+    }
+    for (const std::string& text : {bom, bom + bom + "1", "1" + bom, "[" + bom + "1]"}) {
+        EXPECT_THROW(parseJson(text, ParserBackend::Nlohmann), std::runtime_error);
+        EXPECT_THROW(parseJson(text, ParserBackend::Simd), std::runtime_error);
+    }
+}
+
+TEST_P(JsonTapeTest, NestingIsLimitedToMaxDepth) {
+    EXPECT_EQ(parseJson(nested(JsonTape::kMaxDepth), ParserBackend::Simd),
+              json::parse(nested(JsonTape::kMaxDepth)));
+    // Deeper documents are valid JSON, but only nlohmann accepts them
+    const std::string deeper = nested(JsonTape::kMaxDepth + 1);
+    EXPECT_NO_THROW(parseJson(deeper, ParserBackend::Nlohmann));
+    EXPECT_THROW(parseJson(deeper, ParserBackend::Simd), std::runtime_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, JsonTapeTest,
+                         ::testing::Values(StructuralIndex::SimdLevel::Scalar, StructuralIndex::SimdLevel::SSE2,
+                                           StructuralIndex::SimdLevel::AVX2),
+                         [](const ::testing::TestParamInfo<StructuralIndex::SimdLevel>& info) {
+                             return std::string(StructuralIndex::simdLevelName(info.param));
+                         });
+
+TEST(JsonTapeSerializeTest, RoundTripsThroughBytes) {
+    const JsonTape tape = JsonTape::parse(kValid[18]);
+    std::vector<std::uint8_t> bytes;
+    tape.serialize(bytes);
+    const JsonTape copy =
+        JsonTape::deserialize(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+    EXPECT_EQ(copy.size(), tape.size());
+    EXPECT_EQ(copy.toJson(), tape.toJson());
+}
+
+TEST(JsonTapeSerializeTest, DamagedBuffersAreRejected) {
+    const JsonTape tape = JsonTape::parse(kValid[18]);
+    std::vector<std::uint8_t> bytes;
+    tape.serialize(bytes);
+    const std::string good(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+    for (std::size_t size = 0; size < good.size(); ++size) {
+        EXPECT_THROW(JsonTape::deserialize(good.substr(0, size)), std::runtime_error) << "size " << size;
+    }
+    EXPECT_THROW(JsonTape::deserialize(good + '\0'), std::runtime_error);
+
+    // Any damaged byte is either rejected or still gives a consistent tape
+    for (std::size_t i = 0; i < good.size(); ++i) {
+        for (const unsigned char flip : {0x01, 0x80, 0xFF}) {
+            std::string damaged = good;
+            damaged[i] = static_cast<char>(damaged[i] ^ flip);
+            try {
+                JsonTape::deserialize(damaged).toJson();
+            } catch (const std::runtime_error&) {
+            }
+        }
+    }
+}
+
+TEST(ParserBackendTest, NamesRoundTrip) {
+    for (const ParserBackend backend : {ParserBackend::Nlohmann, ParserBackend::Simd}) {
+        EXPECT_EQ(parserBackendFromName(parserBackendName(backend)), backend);
+    }
+    EXPECT_THROW(parserBackendFromName("fast"), std::invalid_argument);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file test_json_writer.cpp
+ * @brief JsonWriter output against dump(), and parsing it back
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+#include "json_writer.h"
+#include "test_files.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+const json kDocument = json::parse(R"({
+    "name": "John Doe",
+    "age": 30,
+    "negative": -9223372036854775808,
+    "big": 18446744073709551615,
+    "salary": 75000.5,
+    "ratio": 0.1,
+    "tiny": 1e-300,
+    "skills": ["C++", "Python", []],
+    "address": {"street": "123 Main St", "zipcode": "10001", "empty": {}},
+    "escapes": "quote \" backslash \\ slash / tab \t newline \n control \u0001 \u001f",
+    "unicode": "héllo 😀",
+    "active": true,
+    "none": null
+})");
+
+} // namespace
+
+class JsonWriterTest : public TestFiles {
+protected:
+    /// Write a value to a file through JsonWriter and read the file back
+    std::string written(const json& value, int indent) {
+        const std::string file = path("out.json");
+        const int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        EXPECT_GE(fd, 0);
+        {
+            JsonWriter writer(fd, indent);
+            writer.write(value);
+            writer.flush();
+            EXPECT_EQ(writer.bytes(), read(file).size());
+        }
+        ::close(fd);
+        return read(file);
+    }
+};
+
+TEST_F(JsonWriterTest, MatchesDumpForEveryIndent) {
+    for (const int indent : {-1, 0, 2, 4}) {
+        EXPECT_EQ(written(kDocument, indent), kDocument.dump(indent)) << "indent " << indent;
+    }
+    for (const json& scalar : {json(nullptr), json(false), json(-1), json(2.5), json("")}) {
+        EXPECT_EQ(written(scalar, 2), scalar.dump(2));
+    }
+    EXPECT_EQ(written(json::array(), 2), "[]");
+    EXPECT_EQ(written(json::object(), 2), "{}");
+}
+
+TEST_F(JsonWriterTest, LargeValuesCrossTheBuffer) {
+    json document = json::array();
+    document.push_back(std::string(JsonWriter::kBufferBytes * 3 + 5, 'x'));  // written without a copy
+    for (int i = 0; i < 20000; ++i) {
+        document.push_back({{"id", i}, {"label", "item-" + std::to_string(i)}});
+    }
+    document.push_back(std::string(JsonWriter::kBufferBytes - 1, 'y'));
+    const std::string text = written(document, 1);
+    EXPECT_GT(text.size(), 2 * JsonWriter::kBufferBytes);
+    EXPECT_EQ(text, document.dump(1));
+}
+
+TEST_F(JsonWriterTest, DoublesRoundTrip) {
+    std::mt19937_64 rng(7);
+    json values = json::array();
+    for (int i = 0; i < 2000; ++i) {
+        std::uint64_t bits = rng();
+        double value = 0.0;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (std::isfinite(value)) {
+            values.push_back(value);
+        }
+    }
+    values.push_back(std::numeric_limits<double>::min());
+    values.push_back(std::numeric_limits<double>::max());
+    values.push_back(std::numeric_limits<double>::denorm_min());
+    values.push_back(-0.0);
+    values.push_back(1e21);
+    values.push_back(123456789.0);
+
+    const json parsed = json::parse(written(values, -1));
+    ASSERT_EQ(parsed.size(), values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(parsed[i].get<double>(), values[i].get<double>()) << "i = " << i;
+        ASSERT_TRUE(parsed[i].is_number_float()) << "i = " << i;
+    }
+}
+
+TEST_F(JsonWriterTest, NonFiniteAndBinaryValues) {
+    const json values = {std::numeric_limits<double>::infinity(), std::nan("")};
+    EXPECT_EQ(written(values, -1), "[null,null]");
+
+    const std::string file = path("binary.json");
+    const int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    JsonWriter writer(fd);
+    EXPECT_THROW(writer.write(json::binary({1, 2, 3})), std::invalid_argument);
+    ::close(fd);
+}
+
+TEST_F(JsonWriterTest, WriteErrorsAreReported) {
+    const int fd = ::open(path("readonly.json").c_str(), O_RDONLY | O_CREAT, 0644);
+    ASSERT_GE(fd, 0);
+    JsonWriter writer(fd);
+    writer.write(kDocument);
+    EXPECT_THROW(writer.flush(), std::runtime_error);
+    ::close(fd);
+}
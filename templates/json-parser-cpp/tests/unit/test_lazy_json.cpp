@@ -0,0 +1,74 @@
+/**
+ * @file test_lazy_json.cpp
+ * @brief LazyJson access against the same document parsed by nlohmann::json
+ */
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "lazy_json.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+const std::string kText = R"({"name": "John Doe", "age": 30, "city": "New York", "active": true,
+                              "salary": 75000.50, "skills": ["C++", "Python", "JavaScript"],
+                              "address": {"street": "123 Main St", "zipcode": "10001"},
+                              "none": null, "key": 1, "key": 2, "payload": [{"x": [1, {"y": "]"}]}, []]})";
+
+} // namespace
+
+TEST(LazyJsonTest, ReadsFieldsLikeTheDom) {
+    const LazyJson root = LazyJson::parse(kText);
+    const json dom = json::parse(kText);
+    EXPECT_TRUE(root.is_object());
+    EXPECT_EQ(root.size(), dom.size() + 1);  // both "key" members are listed
+    EXPECT_EQ(root["name"].get<std::string>(), "John Doe");
+    EXPECT_EQ(root["age"].get<int>(), 30);
+    EXPECT_EQ(root["salary"].get<double>(), 75000.5);
+    EXPECT_TRUE(root["active"].get<bool>());
+    EXPECT_TRUE(root["none"].is_null());
+    EXPECT_EQ(root["key"].get<int>(), 2);  // the last one wins
+    EXPECT_EQ(root["address"]["zipcode"].get<std::string>(), "10001");
+    EXPECT_EQ(root["skills"][1].get<std::string>(), "Python");
+    EXPECT_EQ(root["payload"][0]["x"][1]["y"].get<std::string>(), "]");
+    EXPECT_EQ(root["address"].materialize(), dom["address"]);
+    EXPECT_EQ(root["skills"].raw(), R"(["C++", "Python", "JavaScript"])");
+
+    std::vector<std::string> skills;
+    for (const LazyJson skill : root["skills"]) {
+        skills.push_back(skill.get<std::string>());
+    }
+    EXPECT_EQ(skills, dom["skills"].get<std::vector<std::string>>());
+    std::vector<std::string> keys;
+    for (auto it = root["address"].begin(); it != root["address"].end(); ++it) {
+        keys.push_back(it.key());
+    }
+    EXPECT_EQ(keys, (std::vector<std::string>{"street", "zipcode"}));
+}
+
+TEST(LazyJsonTest, MissingMembersThrowLikeAt) {
+    const LazyJson root = LazyJson::parse(kText);
+    EXPECT_FALSE(root.contains("missing"));
+    EXPECT_FALSE(root["name"].contains("x"));
+    EXPECT_THROW(root["missing"], std::out_of_range);
+    EXPECT_THROW(root["skills"][3], std::out_of_range);
+    EXPECT_THROW(root["name"][0], std::out_of_range);
+    EXPECT_THROW(root["name"].get<int>(), json::type_error);
+    EXPECT_TRUE(root["payload"][1].empty());
+}
+
+TEST(LazyJsonTest, ValidationIsDeferredToAccess) {
+    EXPECT_THROW(LazyJson::parse("{\"a\": [1, 2}"), std::runtime_error);
+    EXPECT_THROW(LazyJson::parse("[1] [2]"), std::runtime_error);
+    EXPECT_THROW(LazyJson::parse("\"open"), std::runtime_error);
+
+    // A bad scalar is only seen when it is decoded
+    const LazyJson root = LazyJson::parse(R"({"good": 1, "bad": 1x, "huge": 1e400})");
+    EXPECT_EQ(root["good"].get<int>(), 1);
+    EXPECT_THROW(root["bad"].get<int>(), std::runtime_error);
+    EXPECT_THROW(root["huge"].get<double>(), std::runtime_error);
+}
@@ -0,0 +1,130 @@
+/**
+ * @file test_ndjson.cpp
+ * @brief Chunking, ordering and error reporting of NdjsonProcessor
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "ndjson.h"
+
+namespace {
+
+std::string numbered(int count) {
+    std::string text;
+    for (int i = 0; i < count; ++i) {
+        text += "{\"i\": " + std::to_string(i) + "}\n";
+    }
+    return text;
+}
+
+NdjsonOptions options(bool ordered) {
+    NdjsonOptions result;
+    result.workers = 4;
+    result.ordered = ordered;
+    result.chunkBytes = 100;
+    return result;
+}
+
+/// Run and collect the output; each record is written back as its "i"
+NdjsonResult run(const NdjsonOptions& options, const std::string& input, std::string& output) {
+    output.clear();
+    return NdjsonProcessor(options).run(
+        input, [](nlohmann::json& record, std::string& out) { out += std::to_string(record.at("i").get<int>()) + ','; },
+        [&](std::string_view chunk) { output += chunk; });
+}
+
+} // namespace
+
+TEST(NdjsonProcessorTest, SplitEndsChunksAtNewlines) {
+    const std::string input = numbered(50) + "{\"i\": 50}";
+    const std::vector<std::string_view> chunks = NdjsonProcessor::split(input, 64);
+    ASSERT_GT(chunks.size(), 1u);
+    std::string joined;
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        if (i + 1 < chunks.size()) {
+            EXPECT_EQ(chunks[i].back(), '\n');
+        }
+        joined += chunks[i];
+    }
+    EXPECT_EQ(joined, input);
+    EXPECT_EQ(NdjsonProcessor::split(input, 1 << 20).size(), 1u);
+    EXPECT_TRUE(NdjsonProcessor::split("", 64).empty());
+}
+
+TEST(NdjsonProcessorTest, OrderedOutputFollowsTheInput) {
+    std::string output;
+    const NdjsonResult result = run(options(true), numbered(1000), output);
+    EXPECT_EQ(result.records, 1000u);
+    EXPECT_EQ(result.failedRecords, 0u);
+    EXPECT_EQ(result.lines, 1000u);
+    EXPECT_GT(result.chunks, 10u);
+    EXPECT_EQ(result.workers, 4u);
+
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+        expected += std::to_string(i) + ',';
+    }
+    EXPECT_EQ(output, expected);
+}
+
+TEST(NdjsonProcessorTest, SlowSinkKeepsTheOrderAndIsNeverConcurrent) {
+    // The sink runs outside the workers' lock, so others finish chunks meanwhile
+    std::string output;
+    std::atomic<int> inside{0};
+    bool overlapped = false;
+    const NdjsonResult result = NdjsonProcessor(options(true)).run(
+        numbered(300), [](nlohmann::json& record, std::string& out) { out += std::to_string(record.at("i").get<int>()) + ','; },
+        [&](std::string_view chunk) {
+            overlapped = overlapped || inside.fetch_add(1) != 0;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            output += chunk;
+            inside.fetch_sub(1);
+        });
+    EXPECT_EQ(result.records, 300u);
+    EXPECT_FALSE(overlapped);
+
+    std::string expected;
+    for (int i = 0; i < 300; ++i) {
+        expected += std::to_string(i) + ',';
+    }
+    EXPECT_EQ(output, expected);
+}
+
+TEST(NdjsonProcessorTest, UnorderedOutputHasEveryRecordOnce) {
+    std::string output;
+    EXPECT_EQ(run(options(false), numbered(1000), output).records, 1000u);
+    std::vector<int> seen;
+    for (std::size_t start = 0, comma; (comma = output.find(',', start)) != std::string::npos; start = comma + 1) {
+        seen.push_back(std::stoi(output.substr(start, comma - start)));
+    }
+    std::sort(seen.begin(), seen.end());
+    ASSERT_EQ(seen.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(seen[i], i);
+    }
+}
+
+TEST(NdjsonProcessorTest, FailedRecordsAreReportedByLine) {
+    const std::string input = "{\"i\": 1}\n\n  \r\nnot json\n{\"j\": 2}\r\n{\"i\": 3}\n{\"i\": 1e400}\n{\"i\": 4}";
+    std::string output;
+    const NdjsonResult result = run(options(true), input, output);
+    EXPECT_EQ(output, "1,3,4,");
+    EXPECT_EQ(result.records, 3u);
+    EXPECT_EQ(result.failedRecords, 3u);  // bad JSON, a callback that threw, a number out of range
+    EXPECT_EQ(result.lines, 8u);
+    ASSERT_EQ(result.errors.size(), 3u);
+    EXPECT_EQ(result.errors[0].line, 4u);
+    EXPECT_EQ(result.errors[1].line, 5u);
+    EXPECT_EQ(result.errors[2].line, 7u);
+
+    NdjsonOptions limited = options(true);
+    limited.maxErrors = 1;
+    EXPECT_EQ(run(limited, input, output).errors.size(), 1u);
+}
@@ -0,0 +1,207 @@
+/**
+ * @file test_ndjson_index.cpp
+ * @brief Building, appending to, updating and opening NdjsonIndex files
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include "ndjson_index.h"
+#include "test_files.h"
+
+namespace {
+
+std::string records(int first, int count) {
+    std::string text;
+    for (int i = first; i < first + count; ++i) {
+        text += R"({"id": )" + std::to_string(i) + R"(, "user": "u)" + std::to_string(i % 7) + R"(", "n": )" +
+                std::to_string(i * 10) + "}\n";
+    }
+    return text;
+}
+
+NdjsonIndexOptions keyedBy(const std::string& field) {
+    NdjsonIndexOptions options;
+    options.keyField = field;
+    options.workers = 3;
+    options.chunkBytes = 256;  // many chunks, so the thread pool is exercised
+    return options;
+}
+
+} // namespace
+
+class NdjsonIndexTest : public TestFiles {};
+
+TEST_F(NdjsonIndexTest, RecordsAndKeysAreFound) {
+    const std::string source = path("log.ndjson");
+    write(source, "\n" + records(0, 100) + "  \n" + records(100, 50));
+    const NdjsonIndexStats stats = NdjsonIndex::build(source, keyedBy("id"));
+    EXPECT_EQ(stats.status, NdjsonIndexStatus::Built);
+    EXPECT_EQ(stats.records, 150u);
+    EXPECT_EQ(stats.keys, 150u);
+    EXPECT_EQ(stats.newRecords, 150u);
+
+    const NdjsonIndex index(source);
+    ASSERT_EQ(index.size(), 150u);
+    EXPECT_EQ(index.keyField(), "id");
+    EXPECT_EQ(index.offset(0), 1u);  // blank lines are not records
+    EXPECT_EQ(index.record(0), R"({"id": 0, "user": "u0", "n": 0})");
+    EXPECT_EQ(index.at(123)["n"], 1230);
+    EXPECT_EQ(index.find("123"), std::optional<std::uint64_t>(123));
+    EXPECT_EQ(index.find("1000"), std::nullopt);
+    EXPECT_THROW(index.at(150), std::out_of_range);
+    EXPECT_THROW(index.offset(150), std::out_of_range);
+}
+
+TEST_F(NdjsonIndexTest, LastRecordWithAKeyWins) {
+    const std::string source = path("log.ndjson");
+    write(source, records(0, 20));
+    NdjsonIndex::build(source, keyedBy("user"));
+    const NdjsonIndex index(source);
+    EXPECT_EQ(index.find("u3"), std::optional<std::uint64_t>(17));
+    EXPECT_EQ(index.find("u6"), std::optional<std::uint64_t>(13));
+    EXPECT_EQ(index.find("u7"), std::nullopt);
+
+    NdjsonIndex::build(source, keyedBy(""));
+    EXPECT_THROW(NdjsonIndex(source).find("u3"), std::invalid_argument);
+}
+
+TEST_F(NdjsonIndexTest, UpdateAppendsOnlyNewRecords) {
+    const std::string source = path("log.ndjson");
+    write(source, records(0, 40));
+    EXPECT_EQ(NdjsonIndex::update(source, keyedBy("id")).status, NdjsonIndexStatus::Built);
+
+    const NdjsonIndex before(source);
+    append(source, records(40, 10));
+    EXPECT_EQ(before.size(), 40u);  // still usable while the file grows
+    EXPECT_EQ(before.at(39)["id"], 39);
+
+    const std::uint64_t oldBytes = records(0, 40).size();
+    const NdjsonIndexStats stats = NdjsonIndex::update(source, keyedBy("id"));
+    EXPECT_EQ(stats.status, NdjsonIndexStatus::Appended);
+    EXPECT_EQ(stats.records, 50u);
+    EXPECT_EQ(stats.newRecords, 10u);
+    EXPECT_EQ(stats.bytesScanned, read(source).size() - oldBytes);
+    EXPECT_EQ(NdjsonIndex(source).find("45"), std::optional<std::uint64_t>(45));
+
+    EXPECT_EQ(NdjsonIndex::update(source, keyedBy("id")).status, NdjsonIndexStatus::UpToDate);
+    EXPECT_EQ(NdjsonIndex::update(source, keyedBy("user")).status, NdjsonIndexStatus::Built);
+}
+
+TEST_F(NdjsonIndexTest, UnfinishedLastLineIsRescanned) {
+    const std::string source = path("log.ndjson");
+    write(source, records(0, 3) + R"({"id": 3, "n")");
+    NdjsonIndex::build(source, keyedBy("id"));
+    EXPECT_EQ(NdjsonIndex(source).size(), 4u);
+    EXPECT_THROW(NdjsonIndex(source).at(3), std::runtime_error);
+
+    append(source, ": 30}\n");
+    const NdjsonIndexStats stats = NdjsonIndex::update(source, keyedBy("id"));
+    EXPECT_EQ(stats.status, NdjsonIndexStatus::Appended);
+    EXPECT_EQ(stats.records, 4u);
+    const NdjsonIndex index(source);
+    EXPECT_EQ(index.at(3)["n"], 30);
+    EXPECT_EQ(index.find("3"), std::optional<std::uint64_t>(3));
+}
+
+TEST_F(NdjsonIndexTest, RewrittenSourceIsRebuilt) {
+    const std::string source = path("log.ndjson");
+    write(source, records(0, 30));
+    NdjsonIndex::build(source, keyedBy("id"));
+
+    std::string rewritten = records(0, 30);
+    rewritten[rewritten.find("\"u1\"")] = ' ';
+    write(source, rewritten + records(30, 5));
+    EXPECT_THROW(NdjsonIndex{source}, std::runtime_error);  // stale until updated
+    EXPECT_EQ(NdjsonIndex::readKeyField(source), "id");
+    const NdjsonIndexStats stats = NdjsonIndex::update(source, keyedBy("id"));
+    EXPECT_EQ(stats.status, NdjsonIndexStatus::Built);
+    EXPECT_EQ(stats.records, 35u);
+
+    write(source, records(0, 5));  // truncated
+    EXPECT_THROW(NdjsonIndex{source}, std::runtime_error);
+    EXPECT_EQ(NdjsonIndex::update(source, keyedBy("id")).status, NdjsonIndexStatus::Built);
+    EXPECT_EQ(NdjsonIndex(source).size(), 5u);
+}
+
+TEST_F(NdjsonIndexTest, SameSizeEditInTheMiddleIsRebuilt) {
+    const std::string source = path("log.ndjson");
+    const std::string original = records(0, 2000);  // well over the hashed 4 KiB at each end
+    write(source, original);
+    NdjsonIndex::build(source, keyedBy("id"));
+
+    // Touching the file without changing it only costs a hash
+    const auto touched = std::filesystem::last_write_time(source) + std::chrono::seconds(1);
+    std::filesystem::last_write_time(source, touched);
+    EXPECT_EQ(NdjsonIndex::update(source, keyedBy("id")).status, NdjsonIndexStatus::UpToDate);
+
+    std::string edited = original;
+    const std::size_t at = edited.find(R"({"id": 1000,)");
+    edited.replace(at, 12, R"({"id": 9999,)");
+    write(source, edited);
+    std::filesystem::last_write_time(source, touched + std::chrono::seconds(1));
+    EXPECT_EQ(NdjsonIndex::update(source, keyedBy("id")).status, NdjsonIndexStatus::Built);
+    EXPECT_EQ(NdjsonIndex(source).find("9999"), std::optional<std::uint64_t>(1000));
+    EXPECT_EQ(NdjsonIndex(source).find("1000"), std::nullopt);
+}
+
+TEST_F(NdjsonIndexTest, CorruptIndexFilesAreRejected) {
+    const std::string source = path("log.ndjson");
+    write(source, records(0, 10));
+    NdjsonIndex::build(source, keyedBy("id"));
+    const std::string indexPath = NdjsonIndex::defaultPath(source);
+    EXPECT_EQ(indexPath, source + ".idx");
+    const std::string good = read(indexPath);
+
+    for (std::size_t size = 0; size < good.size(); size += 8) {
+        write(indexPath, good.substr(0, size));
+        EXPECT_THROW(NdjsonIndex{source}, std::runtime_error) << "size " << size;
+    }
+    std::string badMagic = good;
+    badMagic[0] = 'X';
+    write(indexPath, badMagic);
+    EXPECT_THROW(NdjsonIndex{source}, std::runtime_error);
+
+    // Counts in the header (records, keys at bytes 64 and 72) that do not match the file size
+    for (const std::size_t field : {64u, 72u}) {
+        std::string damaged = good;
+        const std::uint64_t huge = ~std::uint64_t{0} / 8;
+        std::memcpy(&damaged[field], &huge, sizeof(huge));
+        write(indexPath, damaged);
+        EXPECT_THROW(NdjsonIndex{source}, std::runtime_error) << "field " << field;
+    }
+
+    // Any other damage either fails to open or gives lookups that stay in bounds
+    for (std::size_t i = 0; i < good.size(); ++i) {
+        std::string damaged = good;
+        damaged[i] = static_cast<char>(damaged[i] ^ 0x41);
+        write(indexPath, damaged);
+        try {
+            const NdjsonIndex index(source);
+            for (std::uint64_t r = 0; r < index.size(); ++r) {
+                try {
+                    index.record(r);
+                } catch (const std::runtime_error&) {
+                }
+            }
+            index.find("5");
+        } catch (const std::runtime_error&) {
+        }
+    }
+
+    // update() replaces a corrupt index
+    write(indexPath, badMagic);
+    EXPECT_EQ(NdjsonIndex::update(source, keyedBy("id")).status, NdjsonIndexStatus::Built);
+    EXPECT_EQ(NdjsonIndex(source).find("7"), std::optional<std::uint64_t>(7));
+}
+
+TEST_F(NdjsonIndexTest, MissingSourceIsAnError) {
+    EXPECT_THROW(NdjsonIndex::build(path("missing.ndjson"), keyedBy("id")), std::runtime_error);
+    EXPECT_THROW(NdjsonIndex{path("missing.ndjson")}, std::runtime_error);
+    EXPECT_THROW(NdjsonIndex::readKeyField(path("missing.ndjson")), std::runtime_error);
+}